@@ -202,6 +202,12 @@ void Agent::run() {
     
     // register ourselves to the script engine
     _scriptEngine.registerGlobalObject("Agent", this);
+    
+    // hosted avatars are sent once per script frame, their identities at the same rate as the main avatar's
+    connect(&_scriptEngine, &ScriptEngine::update, this, &Agent::sendHostedAvatarData);
+    QTimer hostedAvatarIdentityTimer;
+    connect(&hostedAvatarIdentityTimer, &QTimer::timeout, this, &Agent::sendHostedAvatarIdentities);
+    hostedAvatarIdentityTimer.start(AVATAR_IDENTITY_PACKET_SEND_INTERVAL_MSECS);
 
     _scriptEngine.init(); // must be done before we set up the viewers
     
@@ -214,9 +220,87 @@ void Agent::run() {
 
     _scriptEngine.setScriptContents(scriptContents);
     _scriptEngine.run();
+    
+    foreach (const QUuid& avatarUUID, _hostedAvatars.keys()) {
+        sendKillHostedAvatar(avatarUUID);
+    }
+    qDeleteAll(_hostedAvatars);
+    _hostedAvatars.clear();
+    
     setFinished(true);
 }
 
+QObject* Agent::createHostedAvatar() {
+    ScriptableAvatar* avatar = new ScriptableAvatar(&_scriptEngine);
+    avatar->setForceFaceshiftConnected(true);
+    
+    // call model URL setters with empty URLs so our avatar, if user, will have the default models
+    avatar->setFaceModelURL(QUrl());
+    avatar->setSkeletonModelURL(QUrl());
+    
+    QUuid avatarUUID = QUuid::createUuid();
+    avatar->setSessionUUID(avatarUUID);
+    _hostedAvatars.insert(avatarUUID, avatar);
+    return avatar;
+}
+
+void Agent::removeHostedAvatar(QObject* avatar) {
+    for (QHash<QUuid, ScriptableAvatar*>::iterator it = _hostedAvatars.begin(); it != _hostedAvatars.end(); ++it) {
+        if (it.value() == avatar) {
+            sendKillHostedAvatar(it.key());
+            it.value()->deleteLater();
+            _hostedAvatars.erase(it);
+            return;
+        }
+    }
+}
+
+void Agent::sendHostedAvatarData() {
+    if (_hostedAvatars.isEmpty()) {
+        return;
+    }
+    auto nodeList = DependencyManager::get<NodeList>();
+    
+    // pack as many avatars as fit in each packet
+    QByteArray hostedAvatarPacket = byteArrayWithPopulatedHeader(PacketTypeHostedAvatarData);
+    int numPacketHeaderBytes = hostedAvatarPacket.size();
+    
+    for (QHash<QUuid, ScriptableAvatar*>::const_iterator it = _hostedAvatars.constBegin();
+            it != _hostedAvatars.constEnd(); ++it) {
+        QByteArray avatarByteArray = it.key().toRfc4122();
+        avatarByteArray.append(it.value()->toByteArray());
+        
+        if (hostedAvatarPacket.size() + avatarByteArray.size() > MAX_PACKET_SIZE) {
+            nodeList->broadcastToNodes(hostedAvatarPacket, NodeSet() << NodeType::AvatarMixer);
+            hostedAvatarPacket.resize(numPacketHeaderBytes);
+        }
+        hostedAvatarPacket.append(avatarByteArray);
+    }
+    nodeList->broadcastToNodes(hostedAvatarPacket, NodeSet() << NodeType::AvatarMixer);
+}
+
+void Agent::sendHostedAvatarIdentities() {
+    auto nodeList = DependencyManager::get<NodeList>();
+    
+    for (QHash<QUuid, ScriptableAvatar*>::const_iterator it = _hostedAvatars.constBegin();
+            it != _hostedAvatars.constEnd(); ++it) {
+        // the mixer tells hosted avatars apart by the UUID at the start of the identity
+        QByteArray identityPacket = byteArrayWithPopulatedHeader(PacketTypeAvatarIdentity);
+        QByteArray individualData = it.value()->identityByteArray();
+        individualData.replace(0, NUM_BYTES_RFC4122_UUID, it.key().toRfc4122());
+        identityPacket.append(individualData);
+        
+        nodeList->broadcastToNodes(identityPacket, NodeSet() << NodeType::AvatarMixer);
+    }
+}
+
+void Agent::sendKillHostedAvatar(const QUuid& avatarUUID) {
+    QByteArray killPacket = byteArrayWithPopulatedHeader(PacketTypeKillAvatar);
+    killPacket += avatarUUID.toRfc4122();
+    
+    DependencyManager::get<NodeList>()->broadcastToNodes(killPacket, NodeSet() << NodeType::AvatarMixer);
+}
+
 void Agent::aboutToFinish() {
     _scriptEngine.stop();
     NetworkAccessManager::getInstance().clearAccessCache();
@@ -27,6 +27,7 @@
 
 #include "MixedAudioStream.h"
 
+class ScriptableAvatar;
 
 class Agent : public ThreadedAssignment {
     Q_OBJECT
@@ -51,12 +52,25 @@ public:
 
     virtual void aboutToFinish();
     
+    /// Creates an extra avatar driven by this agent's script. Hosted avatars are ticked along with the script
+    /// and their data is batched in PacketTypeHostedAvatarData packets, so one agent can simulate a whole crowd.
+    Q_INVOKABLE QObject* createHostedAvatar();
+    Q_INVOKABLE void removeHostedAvatar(QObject* avatar);
+    Q_INVOKABLE int getNumHostedAvatars() const { return _hostedAvatars.size(); }
+    
 public slots:
     void run();
     void readPendingDatagrams();
     void playAvatarSound(Sound* avatarSound) { _scriptEngine.setAvatarSound(avatarSound); }
 
+private slots:
+    void sendHostedAvatarData();
+    void sendHostedAvatarIdentities();
+    
 private:
+    void sendKillHostedAvatar(const QUuid& avatarUUID);
+    
+
     ScriptEngine _scriptEngine;
     EntityEditPacketSender _entityEditSender;
     EntityTreeHeadlessViewer _entityViewer;
@@ -65,6 +79,8 @@ private:
     float _lastReceivedAudioLoudness;
 
     AvatarHashMap _avatarHashMap;
+    
+    QHash<QUuid, ScriptableAvatar*> _hostedAvatars;
 };
 
 #endif // hifi_Agent_h
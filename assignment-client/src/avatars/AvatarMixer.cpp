@@ -133,6 +133,31 @@ void AvatarMixer::broadcastAvatarData() {
             AvatarData& avatar = nodeData->getAvatar();
             glm::vec3 myPosition = avatar.getPosition();
             
+            //  The full rate distance is the distance at which EVERY update will be sent for this avatar
+            //  at a distance of twice the full rate distance, there will be a 50% chance of sending this avatar's update
+            const float FULL_RATE_DISTANCE = 2.0f;
+            
+            // if the receiving avatar has just connected make sure we send out the mesh and billboard
+            // for every avatar (assuming they exist)
+            bool forceSend = !nodeData->checkAndSetHasReceivedFirstPackets();
+            
+            // appends one avatar to the bulk packet, flushing the packet first if it is full
+            auto appendAvatar = [&](const QUuid& avatarUUID, AvatarData& avatarData) {
+                QByteArray avatarByteArray;
+                avatarByteArray.append(avatarUUID.toRfc4122());
+                avatarByteArray.append(avatarData.toByteArray());
+                
+                if (avatarByteArray.size() + mixedAvatarByteArray.size() > MAX_PACKET_SIZE) {
+                    nodeList->writeDatagram(mixedAvatarByteArray, node);
+                    
+                    // reset the packet
+                    mixedAvatarByteArray.resize(numPacketHeaderBytes);
+                }
+                
+                // copy the avatar into the mixedAvatarByteArray packet
+                mixedAvatarByteArray.append(avatarByteArray);
+            };
+            
             // this is an AGENT we have received head data from
             // send back a packet with other active node data to this node
             nodeList->eachNode([&](const SharedNodePointer& otherNode) {
@@ -144,30 +169,11 @@ void AvatarMixer::broadcastAvatarData() {
                     glm::vec3 otherPosition = otherAvatar.getPosition();
             
                     float distanceToAvatar = glm::length(myPosition - otherPosition);
-                    //  The full rate distance is the distance at which EVERY update will be sent for this avatar
-                    //  at a distance of twice the full rate distance, there will be a 50% chance of sending this avatar's update
-                    const float FULL_RATE_DISTANCE = 2.0f;
                     
                     //  Decide whether to send this avatar's data based on it's distance from us
                     if ((_performanceThrottlingRatio == 0 || randFloat() < (1.0f - _performanceThrottlingRatio))
                         && (distanceToAvatar == 0.0f || randFloat() < FULL_RATE_DISTANCE / distanceToAvatar)) {
-                        QByteArray avatarByteArray;
-                        avatarByteArray.append(otherNode->getUUID().toRfc4122());
-                        avatarByteArray.append(otherAvatar.toByteArray());
-                        
-                        if (avatarByteArray.size() + mixedAvatarByteArray.size() > MAX_PACKET_SIZE) {
-                            nodeList->writeDatagram(mixedAvatarByteArray, node);
-                            
-                            // reset the packet
-                            mixedAvatarByteArray.resize(numPacketHeaderBytes);
-                        }
-                        
-                        // copy the avatar into the mixedAvatarByteArray packet
-                        mixedAvatarByteArray.append(avatarByteArray);
-                        
-                        // if the receiving avatar has just connected make sure we send out the mesh and billboard
-                        // for this avatar (assuming they exist)
-                        bool forceSend = !nodeData->checkAndSetHasReceivedFirstPackets();
+                        appendAvatar(otherNode->getUUID(), otherAvatar);
                         
                         // we will also force a send of billboard or identity packet
                         // if either has changed in the last frame
@@ -200,7 +206,35 @@ void AvatarMixer::broadcastAvatarData() {
                             ++_sumIdentityPackets;
                         }
                     }
-                
+                    
+                    // the avatars hosted by that node are culled and throttled the same way
+                    for (HostedAvatarHash::iterator it = otherNodeData->getHostedAvatars().begin();
+                            it != otherNodeData->getHostedAvatars().end(); ++it) {
+                        AvatarData& hostedAvatar = *it->avatar;
+                        float distanceToHostedAvatar = glm::length(myPosition - hostedAvatar.getPosition());
+                        if ((_performanceThrottlingRatio != 0 && randFloat() >= (1.0f - _performanceThrottlingRatio))
+                            || (distanceToHostedAvatar != 0.0f && randFloat() >= FULL_RATE_DISTANCE / distanceToHostedAvatar)) {
+                            continue;
+                        }
+                        appendAvatar(it.key(), hostedAvatar);
+                        
+                        if (it->identityChangeTimestamp > 0
+                            && (forceSend
+                                || it->identityChangeTimestamp > _lastFrameTimestamp
+                                || randFloat() < BILLBOARD_AND_IDENTITY_SEND_PROBABILITY)) {
+                            
+                            QByteArray identityPacket = byteArrayWithPopulatedHeader(PacketTypeAvatarIdentity);
+                            
+                            QByteArray individualData = hostedAvatar.identityByteArray();
+                            individualData.replace(0, NUM_BYTES_RFC4122_UUID, it.key().toRfc4122());
+                            identityPacket.append(individualData);
+                            
+                            nodeList->writeDatagram(identityPacket, node);
+                            
+                            ++_sumIdentityPackets;
+                        }
+                    }
+                    
                     otherNodeData->getMutex().unlock();
                 }
             });
@@ -224,9 +258,24 @@ void AvatarMixer::nodeKilled(SharedNodePointer killedNode) {
         
         DependencyManager::get<NodeList>()->broadcastToNodes(killPacket,
                                                   NodeSet() << NodeType::Agent);
+        
+        // along with all of the avatars it was hosting
+        AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(killedNode->getLinkedData());
+        QMutexLocker nodeDataLocker(&nodeData->getMutex());
+        foreach (const QUuid& hostedAvatarUUID, nodeData->getHostedAvatars().keys()) {
+            sendKillHostedAvatar(hostedAvatarUUID);
+        }
+        nodeData->getHostedAvatars().clear();
     }
 }
 
+void AvatarMixer::sendKillHostedAvatar(const QUuid& hostedAvatarUUID) {
+    QByteArray killPacket = byteArrayWithPopulatedHeader(PacketTypeKillAvatar);
+    killPacket += hostedAvatarUUID.toRfc4122();
+    
+    DependencyManager::get<NodeList>()->broadcastToNodes(killPacket, NodeSet() << NodeType::Agent);
+}
+
 void AvatarMixer::readPendingDatagrams() {
     QByteArray receivedPacket;
     HifiSockAddr senderSockAddr;
@@ -240,6 +289,18 @@ void AvatarMixer::readPendingDatagrams() {
                     nodeList->findNodeAndUpdateWithDataFromPacket(receivedPacket);
                     break;
                 }
+                case PacketTypeHostedAvatarData: {
+                    SharedNodePointer avatarNode = nodeList->sendingNodeForPacket(receivedPacket);
+                    
+                    if (avatarNode && avatarNode->getLinkedData()) {
+                        AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(avatarNode->getLinkedData());
+                        
+                        QMutexLocker nodeDataLocker(&nodeData->getMutex());
+                        nodeData->parseHostedAvatarData(receivedPacket);
+                        avatarNode->setLastHeardMicrostamp(usecTimestampNow());
+                    }
+                    break;
+                }
                 case PacketTypeAvatarIdentity: {
                     
                     // check if we have a matching node in our list
@@ -247,6 +308,20 @@ void AvatarMixer::readPendingDatagrams() {
                     
                     if (avatarNode && avatarNode->getLinkedData()) {
                         AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(avatarNode->getLinkedData());
+                        
+                        // identities of hosted avatars carry the hosted avatar UUID, the node's own identity a null one
+                        QUuid avatarUUID = QUuid::fromRfc4122(receivedPacket.mid(numBytesForPacketHeader(receivedPacket),
+                                                                                 NUM_BYTES_RFC4122_UUID));
+                        if (!avatarUUID.isNull()) {
+                            QMutexLocker nodeDataLocker(&nodeData->getMutex());
+                            HostedAvatarHash::iterator hostedAvatar = nodeData->getHostedAvatars().find(avatarUUID);
+                            if (hostedAvatar != nodeData->getHostedAvatars().end()
+                                && hostedAvatar->avatar->hasIdentityChangedAfterParsing(receivedPacket)) {
+                                hostedAvatar->identityChangeTimestamp = QDateTime::currentMSecsSinceEpoch();
+                            }
+                            break;
+                        }
+                        
                         AvatarData& avatar = nodeData->getAvatar();
                         
                         // parse the identity packet and update the change timestamp if appropriate
@@ -276,6 +351,18 @@ void AvatarMixer::readPendingDatagrams() {
                     break;
                 }
                 case PacketTypeKillAvatar: {
+                    // an agent can kill one of the avatars it hosts without going away itself
+                    SharedNodePointer avatarNode = nodeList->sendingNodeForPacket(receivedPacket);
+                    if (avatarNode && avatarNode->getLinkedData()) {
+                        AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(avatarNode->getLinkedData());
+                        QUuid avatarUUID = QUuid::fromRfc4122(receivedPacket.mid(numBytesForPacketHeader(receivedPacket),
+                                                                                 NUM_BYTES_RFC4122_UUID));
+                        QMutexLocker nodeDataLocker(&nodeData->getMutex());
+                        if (nodeData->removeHostedAvatar(avatarUUID)) {
+                            sendKillHostedAvatar(avatarUUID);
+                            break;
+                        }
+                    }
                     nodeList->processKillNode(receivedPacket);
                     break;
                 }
@@ -295,6 +382,16 @@ void AvatarMixer::sendStatsPacket() {
     statsObject["average_billboard_packets_per_frame"] = (float) _sumBillboardPackets / (float) _numStatFrames;
     statsObject["average_identity_packets_per_frame"] = (float) _sumIdentityPackets / (float) _numStatFrames;
     
+    int numHostedAvatars = 0;
+    DependencyManager::get<NodeList>()->eachNode([&](const SharedNodePointer& node) {
+        AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(node->getLinkedData());
+        if (nodeData) {
+            QMutexLocker nodeDataLocker(&nodeData->getMutex());
+            numHostedAvatars += nodeData->getHostedAvatars().size();
+        }
+    });
+    statsObject["hosted_avatars"] = numHostedAvatars;
+    
     statsObject["trailing_sleep_percentage"] = _trailingSleepRatio * 100;
     statsObject["performance_throttling_ratio"] = _performanceThrottlingRatio;
     
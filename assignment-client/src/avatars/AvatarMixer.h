@@ -35,6 +35,7 @@ public slots:
     
 private:
     void broadcastAvatarData();
+    void sendKillHostedAvatar(const QUuid& hostedAvatarUUID);
     
     QThread _broadcastThread;
     
@@ -13,6 +13,9 @@
 
 #include "AvatarMixerClientData.h"
 
+// guards the mixer against an agent flooding it with avatars
+const int MAX_HOSTED_AVATARS_PER_NODE = 2048;
+
 AvatarMixerClientData::AvatarMixerClientData() :
     NodeData(),
     _hasReceivedFirstPackets(false),
@@ -28,6 +31,28 @@ int AvatarMixerClientData::parseData(const QByteArray& packet) {
     return _avatar.parseDataAtOffset(packet, offset);
 }
 
+int AvatarMixerClientData::parseHostedAvatarData(const QByteArray& packet) {
+    int bytesRead = numBytesForPacketHeader(packet);
+    
+    // the packet is a sequence of hosted avatar UUIDs each followed by that avatar's data
+    while (bytesRead + NUM_BYTES_RFC4122_UUID < packet.size()) {
+        QUuid avatarUUID = QUuid::fromRfc4122(packet.mid(bytesRead, NUM_BYTES_RFC4122_UUID));
+        bytesRead += NUM_BYTES_RFC4122_UUID;
+        
+        HostedAvatarHash::iterator hostedAvatar = _hostedAvatars.find(avatarUUID);
+        if (hostedAvatar == _hostedAvatars.end()) {
+            if (_hostedAvatars.size() >= MAX_HOSTED_AVATARS_PER_NODE) {
+                break;
+            }
+            hostedAvatar = _hostedAvatars.insert(avatarUUID, HostedAvatar());
+            hostedAvatar->avatar = QSharedPointer<AvatarData>(new AvatarData());
+            hostedAvatar->avatar->setSessionUUID(avatarUUID);
+        }
+        bytesRead += hostedAvatar->avatar->parseDataAtOffset(packet, bytesRead);
+    }
+    return bytesRead;
+}
+
 bool AvatarMixerClientData::checkAndSetHasReceivedFirstPackets() {
     bool oldValue = _hasReceivedFirstPackets;
     _hasReceivedFirstPackets = true;
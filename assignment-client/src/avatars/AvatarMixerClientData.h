@@ -12,11 +12,24 @@
 #ifndef hifi_AvatarMixerClientData_h
 #define hifi_AvatarMixerClientData_h
 
+#include <QtCore/QHash>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QUrl>
 
 #include <AvatarData.h>
 #include <NodeData.h>
 
+/// An avatar simulated by an agent on top of its own, so that one process can drive many bots
+class HostedAvatar {
+public:
+    HostedAvatar() : identityChangeTimestamp(0) {}
+    
+    QSharedPointer<AvatarData> avatar;
+    quint64 identityChangeTimestamp;
+};
+
+typedef QHash<QUuid, HostedAvatar> HostedAvatarHash;
+
 class AvatarMixerClientData : public NodeData {
     Q_OBJECT
 public:
@@ -25,6 +38,11 @@ public:
     int parseData(const QByteArray& packet);
     AvatarData& getAvatar() { return _avatar; }
     
+    /// Parses a PacketTypeHostedAvatarData packet, adding the hosted avatars we haven't heard of yet
+    int parseHostedAvatarData(const QByteArray& packet);
+    HostedAvatarHash& getHostedAvatars() { return _hostedAvatars; }
+    bool removeHostedAvatar(const QUuid& uuid) { return _hostedAvatars.remove(uuid) > 0; }
+    
     bool checkAndSetHasReceivedFirstPackets();
     
     quint64 getBillboardChangeTimestamp() const { return _billboardChangeTimestamp; }
@@ -35,6 +53,7 @@ public:
     
 private:
     AvatarData _avatar;
+    HostedAvatarHash _hostedAvatars;
     bool _hasReceivedFirstPackets;
     quint64 _billboardChangeTimestamp;
     quint64 _identityChangeTimestamp;
@@ -53,7 +53,7 @@ AnimationDetails ScriptableAvatar::getAnimationDetails() {
 
 void ScriptableAvatar::update(float deltatime) {
     // Run animation
-    if (_animation != NULL && _animation->isValid() && _animation->getFrames().size() > 0) {
+    if (_animation != NULL && _animation->isValid() && _animation->getFrameCount() > 0) {
         QStringList modelJoints = getJointNames();
         QStringList animationJoints = _animation->getJointNames();
         
@@ -68,17 +68,15 @@ void ScriptableAvatar::update(float deltatime) {
             }
             _animationDetails.frameIndex = frameIndex;
             
-            const int frameCount = _animation->getFrames().size();
-            const FBXAnimationFrame& floorFrame = _animation->getFrames().at((int)glm::floor(frameIndex) % frameCount);
-            const FBXAnimationFrame& ceilFrame = _animation->getFrames().at((int)glm::ceil(frameIndex) % frameCount);
-            const float frameFraction = glm::fract(frameIndex);
+            // the pose blends between the closest two frames
+            QVector<glm::quat> rotations = _animation->getPose(frameIndex);
             
             for (int i = 0; i < modelJoints.size(); i++) {
                 int mapping = animationJoints.indexOf(modelJoints[i]);
-                if (mapping != -1 && !_maskedJoints.contains(modelJoints[i])) {
+                if (mapping != -1 && !_maskedJoints.contains(modelJoints[i]) && i < rotations.size()) {
                     JointData& data = _jointData[i];
                     data.valid = true;
-                    data.rotation = safeMix(floorFrame.rotations.at(i), ceilFrame.rotations.at(i), frameFraction);
+                    data.rotation = rotations.at(i);
                 } else {
                     _jointData[i].valid = false;
                 }
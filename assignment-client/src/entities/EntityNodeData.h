@@ -20,15 +20,20 @@ class EntityNodeData : public OctreeQueryNode {
 public:
     EntityNodeData() :
         OctreeQueryNode(),
-        _lastDeletedEntitiesSentAt(0) { }
+        _lastDeletedEntitiesSentAt(0),
+        _lastServerSimulationSentAt(0) { }
 
     virtual PacketType getMyPacketType() const { return PacketTypeEntityData; }
 
     quint64 getLastDeletedEntitiesSentAt() const { return _lastDeletedEntitiesSentAt; }
     void setLastDeletedEntitiesSentAt(quint64 sentAt) { _lastDeletedEntitiesSentAt = sentAt; }
 
+    quint64 getLastServerSimulationSentAt() const { return _lastServerSimulationSentAt; }
+    void setLastServerSimulationSentAt(quint64 sentAt) { _lastServerSimulationSentAt = sentAt; }
+
 private:
     quint64 _lastDeletedEntitiesSentAt;
+    quint64 _lastServerSimulationSentAt;
 };
 
 #endif // hifi_EntityNodeData_h
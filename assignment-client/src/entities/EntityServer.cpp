@@ -9,8 +9,11 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <QLocale>
 #include <QTimer>
 #include <EntityTree.h>
+#include <PhysicsEngine.h>
+#include <PhysicsHelpers.h>
 #include <SimpleEntitySimulation.h>
 
 #include "EntityServer.h"
@@ -22,7 +25,7 @@ const char* MODEL_SERVER_LOGGING_TARGET_NAME = "entity-server";
 const char* LOCAL_MODELS_PERSIST_FILE = "resources/models.svo";
 
 EntityServer::EntityServer(const QByteArray& packet) 
-    :   OctreeServer(packet), _entitySimulation(NULL) {
+    :   OctreeServer(packet), _entitySimulation(NULL), _physicsEngine(NULL) {
     // nothing special to do here...
 }
 
@@ -52,6 +55,57 @@ void EntityServer::beforeRun() {
     connect(pruneDeletedEntitiesTimer, SIGNAL(timeout()), this, SLOT(pruneDeletedEntities()));
     const int PRUNE_DELETED_MODELS_INTERVAL_MSECS = 1 * 1000; // once every second
     pruneDeletedEntitiesTimer->start(PRUNE_DELETED_MODELS_INTERVAL_MSECS);
+
+    if (_physicsEngine) {
+        // the dynamics world only takes fixed substeps, so ticking at the substep rate keeps it at one per tick
+        QTimer* physicsTimer = new QTimer(this);
+        physicsTimer->setTimerType(Qt::PreciseTimer);
+        connect(physicsTimer, SIGNAL(timeout()), this, SLOT(stepPhysics()));
+        const int PHYSICS_STEP_INTERVAL_MSECS = (int)(PHYSICS_ENGINE_FIXED_SUBSTEP * MSECS_PER_SECOND);
+        physicsTimer->start(PHYSICS_STEP_INTERVAL_MSECS);
+    }
+}
+
+void EntityServer::readAdditionalConfiguration(const QJsonObject& settingsSectionObject) {
+    bool simulatePhysics = false;
+    readOptionBool(QString("simulatePhysics"), settingsSectionObject, simulatePhysics);
+    qDebug() << "simulatePhysics=" << simulatePhysics;
+
+    if (simulatePhysics && !_physicsEngine) {
+        EntityTree* tree = static_cast<EntityTree*>(_tree);
+        _physicsEngine = new PhysicsEngine(glm::vec3(0.0f));
+        _physicsEngine->setEntityTree(tree);
+
+        // no packet sender: entities moved by the server reach clients through the regular octree stream
+        _physicsEngine->init(NULL);
+        tree->setSimulation(_physicsEngine);
+
+        delete _entitySimulation;
+        _entitySimulation = _physicsEngine;
+    }
+}
+
+void EntityServer::stepPhysics() {
+    _physicsEngine->stepSimulation();
+    _physicsStepTime.updateAverage((float)_physicsEngine->getLastStepTime());
+
+    // harvest the entities that moved so they get sorted and marked as changed, even when nothing is persisted
+    static_cast<EntityTree*>(_tree)->update();
+}
+
+QString EntityServer::serverSubclassStats() {
+    QString statsString;
+    if (_physicsEngine) {
+        QLocale locale(QLocale::English);
+        const int COLUMN_WIDTH = 10;
+        statsString += "<b>Entity Physics Statistics</b>\r\n";
+        statsString += QString("            Average Step Time: %1 usecs\r\n")
+            .arg(locale.toString((uint)_physicsStepTime.getAverage()).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("                Active Bodies: %1\r\n")
+            .arg(locale.toString(_physicsEngine->getNumActiveObjects()).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += "\r\n\r\n";
+    }
+    return statsString;
 }
 
 void EntityServer::entityCreated(const EntityItem& newEntity, const SharedNodePointer& senderNode) {
@@ -81,6 +135,7 @@ void EntityServer::entityCreated(const EntityItem& newEntity, const SharedNodePo
 
 
 // EntityServer will use the "special packets" to send list of recently deleted entities
+// and, when it simulates physics, to tell clients that it does
 bool EntityServer::hasSpecialPacketToSend(const SharedNodePointer& node) {
     bool shouldSendDeletedEntities = false;
 
@@ -93,23 +148,41 @@ bool EntityServer::hasSpecialPacketToSend(const SharedNodePointer& node) {
         shouldSendDeletedEntities = tree->hasEntitiesDeletedSince(deletedEntitiesSentAt);
     }
 
-    return shouldSendDeletedEntities;
+    return shouldSendDeletedEntities || shouldSendServerSimulation(node);
+}
+
+// the notice is unreliable like any other packet, so we keep repeating it every few seconds
+const quint64 SERVER_SIMULATION_RESEND_INTERVAL_USECS = 5 * USECS_PER_SECOND;
+
+bool EntityServer::shouldSendServerSimulation(const SharedNodePointer& node) {
+    EntityNodeData* nodeData = static_cast<EntityNodeData*>(node->getLinkedData());
+    return _physicsEngine && nodeData
+        && usecTimestampNow() - nodeData->getLastServerSimulationSentAt() > SERVER_SIMULATION_RESEND_INTERVAL_USECS;
 }
 
 int EntityServer::sendSpecialPacket(const SharedNodePointer& node, OctreeQueryNode* queryNode, int& packetsSent) {
     unsigned char outputBuffer[MAX_PACKET_SIZE];
     size_t packetLength = 0;
 
+    packetsSent = 0;
+
     EntityNodeData* nodeData = static_cast<EntityNodeData*>(node->getLinkedData());
-    if (nodeData) {
+    if (nodeData && shouldSendServerSimulation(node)) {
+        // tell the client that we own entity physics so it stops sending its own results back to us
+        packetLength = populatePacketHeader(reinterpret_cast<char*>(outputBuffer), PacketTypeEntityServerSimulation);
+        DependencyManager::get<NodeList>()->writeDatagram((char*) outputBuffer, packetLength, SharedNodePointer(node));
+        nodeData->setLastServerSimulationSentAt(usecTimestampNow());
+        packetsSent++;
+    }
+
+    EntityTree* tree = static_cast<EntityTree*>(_tree);
+    if (nodeData && tree->hasEntitiesDeletedSince(nodeData->getLastDeletedEntitiesSentAt())) {
         quint64 deletedEntitiesSentAt = nodeData->getLastDeletedEntitiesSentAt();
         quint64 deletePacketSentAt = usecTimestampNow();
 
-        EntityTree* tree = static_cast<EntityTree*>(_tree);
         bool hasMoreToSend = true;
 
         // TODO: is it possible to send too many of these packets? what if you deleted 1,000,000 entities?
-        packetsSent = 0;
         while (hasMoreToSend) {
             hasMoreToSend = tree->encodeEntitiesDeletedSince(queryNode->getSequenceNumber(), deletedEntitiesSentAt,
                                                 outputBuffer, MAX_PACKET_SIZE, packetLength);
@@ -12,12 +12,16 @@
 #ifndef hifi_EntityServer_h
 #define hifi_EntityServer_h
 
+#include <SimpleMovingAverage.h>
+
 #include "../octree/OctreeServer.h"
 
 #include "EntityItem.h"
 #include "EntityServerConsts.h"
 #include "EntityTree.h"
 
+class PhysicsEngine;
+
 /// Handles assignments of type EntityServer - sending entities to various clients.
 class EntityServer : public OctreeServer, public NewlyCreatedEntityHook {
     Q_OBJECT
@@ -40,16 +44,24 @@ public:
     virtual bool hasSpecialPacketToSend(const SharedNodePointer& node);
     virtual int sendSpecialPacket(const SharedNodePointer& node, OctreeQueryNode* queryNode, int& packetsSent);
 
+    virtual QString serverSubclassStats();
+
     virtual void entityCreated(const EntityItem& newEntity, const SharedNodePointer& senderNode);
 
 public slots:
     void pruneDeletedEntities();
+    void stepPhysics();
 
 protected:
     virtual Octree* createTree();
+    virtual void readAdditionalConfiguration(const QJsonObject& settingsSectionObject);
 
 private:
+    bool shouldSendServerSimulation(const SharedNodePointer& node);
+
     EntitySimulation* _entitySimulation;
+    PhysicsEngine* _physicsEngine; // non-NULL when the server is the authority for entity physics
+    SimpleMovingAverage _physicsStepTime;
 };
 
 #endif // hifi_EntityServer_h
@@ -17,6 +17,7 @@
 #include <QThread>
 
 #include <PacketHeaders.h>
+#include <SharedUtil.h>
 
 #include <MetavoxelMessages.h>
 #include <MetavoxelUtil.h>
@@ -180,12 +181,48 @@ void MetavoxelSender::addSession(QObject* session) {
     connect(session, &QObject::destroyed, this, &MetavoxelSender::removeSession);
 }
 
+void MetavoxelSender::writeDelta(const MetavoxelData& reference, const MetavoxelLOD& referenceLOD,
+        Bitstream& out, const MetavoxelLOD& lod) {
+    // the cached bits refer to ids by their persistent values, so we can only use them if nothing else in the packet
+    // has been assigned a transient id
+    if (out.hasTransientWriteMappings()) {
+        _data.writeDelta(reference, referenceLOD, out, lod);
+        return;
+    }
+    CachedDelta* delta = NULL;
+    foreach (CachedDelta* cached, _cachedDeltas) {
+        if (cached->lod == lod && cached->referenceLOD == referenceLOD && cached->reference == reference &&
+                cached->stream.hasSamePersistentWriteMappings(out)) {
+            delta = cached;
+            break;
+        }
+    }
+    if (!delta) {
+        _cachedDeltas.append(delta = new CachedDelta(reference, referenceLOD, lod));
+        delta->stream.copyPersistentMappings(out);
+        _data.writeDelta(reference, referenceLOD, delta->stream, lod);
+        delta->bits = delta->bytes.size() * BITS_IN_BYTE + delta->stream.getUnflushedBits();
+        delta->stream.flush();
+        delta->mappings = delta->stream.getAndResetWriteMappings();
+    }
+    out.write(delta->bytes.constData(), delta->bits);
+    out.setTransientWriteMappings(delta->mappings);
+}
+
+void MetavoxelSender::setData(const MetavoxelData& data) {
+    _data = data;
+    clearCachedDeltas();
+}
+
 void MetavoxelSender::sendDeltas() {
     // send deltas for all sessions associated with our thread
     foreach (MetavoxelSession* session, _sessions) {
         session->update();
     }
     
+    // the references will have changed by the next pass as sessions receive acknowledgements
+    clearCachedDeltas();
+    
     // restart the send timer
     qint64 now = QDateTime::currentMSecsSinceEpoch();
     int elapsed = now - _lastSend;
@@ -198,6 +235,20 @@ void MetavoxelSender::removeSession(QObject* session) {
     _sessions.remove(static_cast<MetavoxelSession*>(session));
 }
 
+void MetavoxelSender::clearCachedDeltas() {
+    qDeleteAll(_cachedDeltas);
+    _cachedDeltas.clear();
+}
+
+CachedDelta::CachedDelta(const MetavoxelData& reference, const MetavoxelLOD& referenceLOD, const MetavoxelLOD& lod) :
+    reference(reference),
+    referenceLOD(referenceLOD),
+    lod(lod),
+    underlying(&bytes, QIODevice::WriteOnly),
+    stream(underlying),
+    bits(0) {
+}
+
 MetavoxelSession::MetavoxelSession(const SharedNodePointer& node, MetavoxelSender* sender) :
     Endpoint(node, new PacketRecord(), NULL),
     _sender(sender),
@@ -224,7 +275,7 @@ void MetavoxelSession::update() {
     int start = _sequencer.getOutputStream().getUnderlying().device()->pos(); 
     out << QVariant::fromValue(MetavoxelDeltaMessage());
     PacketRecord* sendRecord = getLastAcknowledgedSendRecord();
-    _sender->getData().writeDelta(sendRecord->getData(), sendRecord->getLOD(), out, _lod);
+    _sender->writeDelta(sendRecord->getData(), sendRecord->getLOD(), out, _lod);
     out.flush();
     int end = _sequencer.getOutputStream().getUnderlying().device()->pos();
     if (end > _sequencer.getMaxPacketSize()) {
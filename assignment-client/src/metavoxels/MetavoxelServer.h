@@ -19,6 +19,7 @@
 
 #include <Endpoint.h>
 
+class CachedDelta;
 class MetavoxelEditMessage;
 class MetavoxelPersister;
 class MetavoxelSender;
@@ -82,14 +83,20 @@ public:
     
     Q_INVOKABLE void addSession(QObject* session);
     
+    /// Writes the delta between the reference and the current data, reusing the bits written for another session in the
+    /// same send pass if it had the same reference, LODs, and persistent write mappings.
+    void writeDelta(const MetavoxelData& reference, const MetavoxelLOD& referenceLOD, Bitstream& out, const MetavoxelLOD& lod);
+    
 private slots:
     
-    void setData(const MetavoxelData& data) { _data = data; }
+    void setData(const MetavoxelData& data);
     void sendDeltas();
     void removeSession(QObject* session);
     
 private:
     
+    void clearCachedDeltas();
+    
     MetavoxelServer* _server;
     QSet<MetavoxelSession*> _sessions;
     
@@ -97,6 +104,25 @@ private:
     qint64 _lastSend;
     
     MetavoxelData _data;
+    
+    QList<CachedDelta*> _cachedDeltas;
+};
+
+/// A delta written by a MetavoxelSender, along with what it was written against.
+class CachedDelta {
+public:
+    
+    CachedDelta(const MetavoxelData& reference, const MetavoxelLOD& referenceLOD, const MetavoxelLOD& lod);
+    
+    MetavoxelData reference;
+    MetavoxelLOD referenceLOD;
+    MetavoxelLOD lod;
+    
+    QByteArray bytes;
+    QDataStream underlying;
+    Bitstream stream; ///< holds the persistent write mappings the delta was written against
+    int bits;
+    Bitstream::WriteMappings mappings;
 };
 
 /// Contains the state of a single client session.
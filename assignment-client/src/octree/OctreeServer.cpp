@@ -695,6 +695,9 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
 
         statsString += "\r\n\r\n";
 
+        // display any stats specific to the kind of server
+        statsString += serverSubclassStats();
+
         // display memory usage stats
         statsString += "<b>Current Memory Usage Statistics</b>\r\n";
         statsString += QString().sprintf("\r\nOctreeElement size... %ld bytes\r\n", sizeof(OctreeElement));
@@ -74,6 +74,7 @@ public:
     virtual void beforeRun() { }
     virtual bool hasSpecialPacketToSend(const SharedNodePointer& node) { return false; }
     virtual int sendSpecialPacket(const SharedNodePointer& node, OctreeQueryNode* queryNode, int& packetsSent) { return 0; }
+    virtual QString serverSubclassStats() { return QString(); }
 
     static void attachQueryNodeToNode(Node* newNode);
     
@@ -0,0 +1,45 @@
+//
+//  crowd.js
+//  examples/acScripts
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  This is an example script that uses a single agent to drive a crowd of hosted avatars walking in circles.
+//  Hosted avatars share the agent's script frame and are sent to the avatar mixer in batches.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+var NUM_AVATARS = 100;
+var CENTER = { x: 0, y: 0, z: 0 };
+var RADIUS = 20.0;
+var ANGULAR_SPEED = 0.2; // radians per second
+
+var crowd = [];
+for (var i = 0; i < NUM_AVATARS; i++) {
+    var avatar = Agent.createHostedAvatar();
+    avatar.displayName = "Crowd " + i;
+    avatar.skeletonModelURL = "http://public.highfidelity.io/models/skeletons/EmilyCutMesh_A.fst";
+    crowd.push({ avatar: avatar, angle: (i / NUM_AVATARS) * 2.0 * Math.PI });
+}
+
+Script.update.connect(function(deltaTime) {
+    for (var i = 0; i < crowd.length; i++) {
+        var member = crowd[i];
+        member.angle += ANGULAR_SPEED * deltaTime;
+        member.avatar.position = {
+            x: CENTER.x + RADIUS * Math.cos(member.angle),
+            y: CENTER.y,
+            z: CENTER.z + RADIUS * Math.sin(member.angle)
+        };
+        member.avatar.orientation = Quat.fromPitchYawRollRadians(0.0, -member.angle, 0.0);
+    }
+});
+
+Script.scriptEnding.connect(function() {
+    for (var i = 0; i < crowd.length; i++) {
+        Agent.removeHostedAvatar(crowd[i].avatar);
+    }
+});
@@ -394,7 +394,9 @@ Application::Application(int& argc, char** argv, QElapsedTimer &startup_time) :
     cache->setCacheDirectory(!cachePath.isEmpty() ? cachePath : "interfaceCache");
     networkAccessManager.setCache(cache);
 
-    ResourceCache::setRequestLimit(3);
+    // no more than three downloads from any one server, but slow servers shouldn't hold up the rest
+    ResourceCache::setRequestLimit(6);
+    ResourceCache::setHostRequestLimit(3);
 
     _window->setCentralWidget(glCanvas.data());
 
@@ -3217,6 +3219,9 @@ void Application::clearDomainOctreeDetails() {
     // reset the model renderer
     _entities.clear();
 
+    // the next entity server tells us again if it simulates physics itself
+    EntityItem::setServerSimulatesPhysics(false);
+
 }
 
 void Application::domainChanged(const QString& domainHostname) {
@@ -3484,6 +3489,8 @@ void Application::registerScriptEngineWithApplicationServices(ScriptEngine* scri
     scriptEngine->registerGlobalObject("AudioDevice", AudioDeviceScriptingInterface::getInstance());
     scriptEngine->registerGlobalObject("AnimationCache", DependencyManager::get<AnimationCache>().data());
     scriptEngine->registerGlobalObject("SoundCache", &SoundCache::getInstance());
+    scriptEngine->registerGlobalObject("GeometryCache", DependencyManager::get<GeometryCache>().data());
+    scriptEngine->registerGlobalObject("TextureCache", DependencyManager::get<TextureCache>().data());
     scriptEngine->registerGlobalObject("Account", AccountScriptingInterface::getInstance());
     scriptEngine->registerGlobalObject("Metavoxels", &_metavoxels);
 
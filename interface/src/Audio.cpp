@@ -896,12 +896,11 @@ bool Audio::outputLocalInjector(bool isStereo, qreal volume, AudioInjector* inje
                                                      localFormat);
         localOutput->setVolume(volume);
         
-        // move the localOutput to the same thread as the local injector buffer
-        localOutput->moveToThread(injector->getLocalBuffer()->thread());
-        
-        // have it be cleaned up when that thread is done
-        connect(injector->thread(), &QThread::finished, localOutput, &QAudioOutput::stop);
-        connect(injector->thread(), &QThread::finished, localOutput, &QAudioOutput::deleteLater);
+        // have it be cleaned up when the injector is done, or goes away before its local buffer does
+        connect(injector, &AudioInjector::finished, localOutput, &QAudioOutput::stop);
+        connect(injector, &AudioInjector::finished, localOutput, &QAudioOutput::deleteLater);
+        connect(injector, &QObject::destroyed, localOutput, &QAudioOutput::stop);
+        connect(injector, &QObject::destroyed, localOutput, &QAudioOutput::deleteLater);
         
         qDebug() << "Starting QAudioOutput for local injector" << localOutput;
         
@@ -83,6 +83,10 @@ void DatagramProcessor::processDatagrams() {
                     EntityItemID::handleAddEntityResponse(incomingPacket);
                     application->getEntities()->getTree()->handleAddEntityResponse(incomingPacket);
                     break;
+                case PacketTypeEntityServerSimulation:
+                    // the entity server owns physics, so our own simulation only predicts between its updates
+                    EntityItem::setServerSimulatesPhysics(true);
+                    break;
                 case PacketTypeEntityData:
                 case PacketTypeEntityErase:
                 case PacketTypeOctreeStats:
@@ -13,8 +13,10 @@
 #define hifi_MetavoxelSystem_h
 
 #include <QList>
+#include <QMutex>
 #include <QOpenGLBuffer>
 #include <QReadWriteLock>
+#include <QRect>
 #include <QVector>
 
 #include <glm/glm.hpp>
@@ -315,8 +317,8 @@ class VoxelBuffer : public BufferData {
 public:
     
     VoxelBuffer(const QVector<VoxelPoint>& vertices, const QVector<int>& indices, const QVector<glm::vec3>& hermite,
-        const QMultiHash<VoxelCoord, int>& quadIndices, int size, const QVector<SharedObjectPointer>& materials =
-            QVector<SharedObjectPointer>());
+        bool hermiteEnabled, const QMultiHash<VoxelCoord, int>& quadIndices, int size,
+        const QVector<SharedObjectPointer>& materials = QVector<SharedObjectPointer>());
     virtual ~VoxelBuffer();
 
     bool isHermiteEnabled() const { return _hermiteEnabled; }
@@ -353,6 +355,7 @@ public:
     
     Q_INVOKABLE DefaultMetavoxelRendererImplementation();
     
+    virtual void augment(MetavoxelData& data, const MetavoxelData& previous, MetavoxelInfo& info, const MetavoxelLOD& lod);
     virtual void simulate(MetavoxelData& data, float deltaTime, MetavoxelInfo& info, const MetavoxelLOD& lod);
     virtual void render(MetavoxelData& data, MetavoxelInfo& info, const MetavoxelLOD& lod);
 };
@@ -419,7 +422,17 @@ public:
 class HeightfieldNodeRenderer : public AbstractHeightfieldNodeRenderer {
 public:
     
+    /// Returns the renderer for the specified node, creating it if necessary.
+    static HeightfieldNodeRenderer* getRenderer(HeightfieldNode* node);
+    
     HeightfieldNodeRenderer();
+    
+    /// Creates a renderer (on the augmentation thread) for a node that replaced another in an edit.  When first rendered,
+    /// we take over the textures of the replaced node's renderer and upload only the regions that changed.  If the voxel
+    /// stack changed, we build its mesh here rather than on the render thread.
+    HeightfieldNodeRenderer(const HeightfieldNodePointer& node, const HeightfieldNodePointer& previousNode,
+        const glm::vec3& scale);
+    
     virtual ~HeightfieldNodeRenderer();
     
     virtual bool findRayIntersection(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale,
@@ -430,6 +443,10 @@ public:
     
 private:
 
+    void buildVoxels(const HeightfieldNodePointer& node, const glm::vec3& scale, bool displayHermite);
+    
+    bool takeOverTextures(const HeightfieldNodePointer& node);
+
     GLuint _heightTextureID;
     GLuint _colorTextureID;
     GLuint _materialTextureID;
@@ -437,6 +454,13 @@ private:
     
     BufferDataPointer _voxels;
     
+    HeightfieldNodePointer _previousNode; ///< the replaced node, until we take over its renderer's textures
+    QRect _heightBounds; ///< the region of the height texture that differs from the replaced node's
+    QRect _colorBounds;
+    QRect _materialBounds;
+    
+    static QMutex _previousNodeMutex; ///< guards the creation of renderers and the taking over of textures
+    
     typedef QPair<int, int> IntPair;    
     typedef QPair<QOpenGLBuffer, QOpenGLBuffer> BufferPair;
     static QHash<IntPair, BufferPair> _bufferPairs;
@@ -140,6 +140,8 @@ QScriptValue DownloadInfoResultToScriptValue(QScriptEngine* engine, const Downlo
 
     object.setProperty("downloading", array);
     object.setProperty("pending", result.pending);
+    object.setProperty("queueLengths", qScriptValueFromSequence(engine, result.queueLengths));
+    object.setProperty("loadTimes", qScriptValueFromSequence(engine, result.loadTimes));
     return object;
 }
 
@@ -151,6 +153,8 @@ void DownloadInfoResultFromScriptValue(const QScriptValue& object, DownloadInfoR
     }
 
     result.pending = object.property("pending").toVariant().toFloat();
+    qScriptValueToSequence(object.property("queueLengths"), result.queueLengths);
+    qScriptValueToSequence(object.property("loadTimes"), result.loadTimes);
 }
 
 DownloadInfoResult GlobalServicesScriptingInterface::getDownloadInfo() {
@@ -159,6 +163,8 @@ DownloadInfoResult GlobalServicesScriptingInterface::getDownloadInfo() {
         result.downloading.append(resource->getProgress() * 100.0f);
     }
     result.pending = ResourceCache::getPendingRequestCount();
+    result.queueLengths = ResourceCache::getQueueLengthHistogram().getCounts();
+    result.loadTimes = ResourceCache::getLoadTimeHistogram().getCounts();
     return result;
 }
 
@@ -18,6 +18,7 @@
 #include <QScriptValue>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 
 #ifdef HAVE_QXMPP
 
@@ -31,6 +32,8 @@ public:
     DownloadInfoResult();
     QList<float> downloading;  // List of percentages
     float pending;
+    QVector<int> queueLengths; // Histogram of pending queue lengths in power-of-two buckets
+    QVector<int> loadTimes;    // Histogram of load times in milliseconds in power-of-two buckets
 };
 
 Q_DECLARE_METATYPE(DownloadInfoResult)
@@ -45,6 +45,8 @@ CachesSizeDialog::CachesSizeDialog(QWidget* parent) :
     form->addRow("Scripts cache size (MB):", _scripts = createDoubleSpinBox(this));
     form->addRow("Sounds cache size (MB):", _sounds = createDoubleSpinBox(this));
     form->addRow("Textures cache size (MB):", _textures = createDoubleSpinBox(this));
+    form->addRow("Processed disk cache size (MB):", _processed = createDoubleSpinBox(this));
+    _processed->setRange(MIN_PROCESSED_MAX_SIZE / BYTES_PER_MEGABYTES, MAX_PROCESSED_MAX_SIZE / BYTES_PER_MEGABYTES);
     
     resetClicked(true);
     
@@ -62,6 +64,7 @@ void CachesSizeDialog::confirmClicked(bool checked) {
     ScriptCache::getInstance()->setUnusedResourceCacheSize(_scripts->value() * BYTES_PER_MEGABYTES);
     SoundCache::getInstance().setUnusedResourceCacheSize(_sounds->value() * BYTES_PER_MEGABYTES);
     DependencyManager::get<TextureCache>()->setUnusedResourceCacheSize(_textures->value() * BYTES_PER_MEGABYTES);
+    ProcessedResourceCache::getInstance().setMaxSize(_processed->value() * BYTES_PER_MEGABYTES);
     
     QDialog::close();
 }
@@ -72,6 +75,7 @@ void CachesSizeDialog::resetClicked(bool checked) {
     _scripts->setValue(ScriptCache::getInstance()->getUnusedResourceCacheSize() / BYTES_PER_MEGABYTES);
     _sounds->setValue(SoundCache::getInstance().getUnusedResourceCacheSize() / BYTES_PER_MEGABYTES);
     _textures->setValue(DependencyManager::get<TextureCache>()->getUnusedResourceCacheSize() / BYTES_PER_MEGABYTES);
+    _processed->setValue(ProcessedResourceCache::getInstance().getMaxSize() / BYTES_PER_MEGABYTES);
 }
 
 void CachesSizeDialog::reject() {
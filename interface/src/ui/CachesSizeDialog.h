@@ -40,6 +40,7 @@ private:
     QDoubleSpinBox* _scripts = nullptr;
     QDoubleSpinBox* _sounds = nullptr;
     QDoubleSpinBox* _textures = nullptr;
+    QDoubleSpinBox* _processed = nullptr;
 };
 
 #endif // hifi_CachesSizeDialog_h
\ No newline at end of file
@@ -439,7 +439,13 @@ void Stats::display(
         foreach (Resource* resource, ResourceCache::getLoadingRequests()) {
             downloads << (int)(resource->getProgress() * 100.0f) << "% ";
         }
-        downloads << "(" << ResourceCache::getPendingRequestCount() << " pending)";
+        downloads << "(" << ResourceCache::getPendingRequestCount() << " pending";
+        const PowerOfTwoHistogram& loadTimes = ResourceCache::getLoadTimeHistogram();
+        if (loadTimes.getTotal() > 0) {
+            downloads << ", load time 50% <= " << loadTimes.getPercentile(0.5f) << " ms, 90% <= " <<
+                loadTimes.getPercentile(0.9f) << " ms";
+        }
+        downloads << ")";
         
         verticalOffset += STATS_PELS_PER_LINE;
         drawText(horizontalOffset, verticalOffset, scale, rotation, font, downloads.str().c_str(), color);
@@ -484,7 +490,8 @@ void Stats::display(
     octreeStats.str("");
     octreeStats << "Entity Items rendered: " << entities->getItemsRendered() 
                 << " / Out of view:" << entities->getItemsOutOfView()
-                << " / Too small:" << entities->getItemsTooSmall();
+                << " / Too small:" << entities->getItemsTooSmall()
+                << " / Occluded:" << entities->getItemsOccluded();
     verticalOffset += STATS_PELS_PER_LINE;
     drawText(horizontalOffset, verticalOffset, scale, rotation, font, (char*)octreeStats.str().c_str(), color);
 
@@ -492,7 +499,8 @@ void Stats::display(
         octreeStats.str("");
         octreeStats << "  Meshes rendered: " << entities->getMeshesRendered() 
                     << " / Out of view:" << entities->getMeshesOutOfView()
-                    << " / Too small:" << entities->getMeshesTooSmall();
+                    << " / Too small:" << entities->getMeshesTooSmall()
+                    << " / Occluded:" << entities->getMeshesOccluded();
         verticalOffset += STATS_PELS_PER_LINE;
         drawText(horizontalOffset, verticalOffset, scale, rotation, font, (char*)octreeStats.str().c_str(), color);
 
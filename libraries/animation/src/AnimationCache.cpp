@@ -12,6 +12,8 @@
 #include <QRunnable>
 #include <QThreadPool>
 
+#include <BakedFBX.h>
+
 #include "AnimationCache.h"
 
 static int animationPointerMetaTypeId = qRegisterMetaType<AnimationPointer>();
@@ -40,7 +42,8 @@ QSharedPointer<Resource> AnimationCache::createResource(const QUrl& url, const Q
 
 Animation::Animation(const QUrl& url) :
     Resource(url),
-    _isValid(false) {
+    _isValid(false),
+    _nextCachedPose(0) {
 }
 
 class AnimationReader : public QRunnable {
@@ -64,8 +67,12 @@ AnimationReader::AnimationReader(const QWeakPointer<Resource>& animation, QNetwo
 void AnimationReader::run() {
     QSharedPointer<Resource> animation = _animation.toStrongRef();
     if (!animation.isNull()) {
-        QMetaObject::invokeMethod(animation.data(), "setGeometry",
-            Q_ARG(const FBXGeometry&, readFBX(_reply->readAll(), QVariantHash())));
+        // compress the frames here, off the main thread, and keep only the compressed clip
+        FBXGeometry geometry = readFBXCached(_reply->readAll(), QVariantHash());
+        AnimationClip clip(geometry.animationFrames);
+        geometry.animationFrames.clear();
+        QMetaObject::invokeMethod(animation.data(), "setGeometry", Q_ARG(const FBXGeometry&, geometry),
+            Q_ARG(const AnimationClip&, clip));
     }
     _reply->deleteLater();
 }
@@ -91,11 +98,52 @@ QVector<FBXAnimationFrame> Animation::getFrames() const {
             Q_RETURN_ARG(QVector<FBXAnimationFrame>, result));
         return result;
     }
-    return _geometry.animationFrames;
+    if (_frames.isEmpty()) {
+        _frames = _clip.getFrames();
+    }
+    return _frames;
+}
+
+int Animation::getFrameCount() const {
+    QMutexLocker locker(&_poseMutex);
+    return _clip.getFrameCount();
 }
 
-void Animation::setGeometry(const FBXGeometry& geometry) {
+QVector<glm::quat> Animation::getPose(float frameIndex) const {
+    QMutexLocker locker(&_poseMutex);
+    foreach (const CachedPose& pose, _cachedPoses) {
+        if (pose.frameIndex == frameIndex) {
+            return pose.rotations;
+        }
+    }
+    // sample outside the lock; the clip itself is never modified, only replaced
+    AnimationClip clip = _clip;
+    locker.unlock();
+    
+    QVector<glm::quat> rotations(clip.getJointCount());
+    clip.sample(frameIndex, rotations.data());
+    
+    locker.relock();
+    CachedPose pose = { frameIndex, rotations };
+    const int MAX_CACHED_POSES = 8;
+    if (_cachedPoses.size() < MAX_CACHED_POSES) {
+        _cachedPoses.append(pose);
+    } else {
+        _cachedPoses[_nextCachedPose] = pose;
+        _nextCachedPose = (_nextCachedPose + 1) % MAX_CACHED_POSES;
+    }
+    return rotations;
+}
+
+void Animation::setGeometry(const FBXGeometry& geometry, const AnimationClip& clip) {
     _geometry = geometry;
+    _frames.clear();
+    {
+        QMutexLocker locker(&_poseMutex);
+        _clip = clip;
+        _cachedPoses.clear();
+        _nextCachedPose = 0;
+    }
     finishedLoading(true);
     _isValid = true;
 }
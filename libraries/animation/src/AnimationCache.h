@@ -12,6 +12,7 @@
 #ifndef hifi_AnimationCache_h
 #define hifi_AnimationCache_h
 
+#include <QMutex>
 #include <QScriptEngine>
 #include <QScriptValue>
 
@@ -19,6 +20,8 @@
 #include <FBXReader.h>
 #include <ResourceCache.h>
 
+#include "AnimationClip.h"
+
 class Animation;
 
 typedef QSharedPointer<Animation> AnimationPointer;
@@ -52,24 +55,48 @@ public:
 
     Animation(const QUrl& url);
 
+    /// Returns the geometry (joints and so on) of the animation.  The frames are kept only in compressed form; see getClip.
     const FBXGeometry& getGeometry() const { return _geometry; }
     
+    const AnimationClip& getClip() const { return _clip; }
+    
     Q_INVOKABLE QStringList getJointNames() const;
     
+    /// Returns the frames as reconstructed from the compressed clip, so the rotations differ from the originals by up to
+    /// the clip's tolerance.  The frames are reconstructed on the first call and shared by the calls after it.
     Q_INVOKABLE QVector<FBXAnimationFrame> getFrames() const;
 
+    int getFrameCount() const;
+
+    /// Returns the rotations of all joints at the given frame index.  Recently sampled poses are cached, so that models
+    /// playing the animation in step (a crowd in the same idle, say) share the work.  Thread-safe.
+    QVector<glm::quat> getPose(float frameIndex) const;
+
     bool isValid() const { return _isValid; }
     
 protected:
 
-    Q_INVOKABLE void setGeometry(const FBXGeometry& geometry);
+    Q_INVOKABLE void setGeometry(const FBXGeometry& geometry, const AnimationClip& clip);
     
     virtual void downloadFinished(QNetworkReply* reply);
 
 private:
     
+    class CachedPose {
+    public:
+        float frameIndex;
+        QVector<glm::quat> rotations;
+    };
+    
     FBXGeometry _geometry;
+    AnimationClip _clip;
     bool _isValid;
+    
+    mutable QVector<FBXAnimationFrame> _frames; ///< reconstructed on demand by getFrames
+    
+    mutable QMutex _poseMutex;
+    mutable QVector<CachedPose> _cachedPoses;
+    mutable int _nextCachedPose;
 };
 
 
@@ -0,0 +1,223 @@
+//
+//  AnimationClip.cpp
+//  libraries/animation/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include <SharedUtil.h>
+
+#include "AnimationClip.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define ANIMATION_CLIP_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+static int animationClipMetaTypeId = qRegisterMetaType<AnimationClip>();
+
+const float AnimationClip::DEFAULT_TOLERANCE = 0.25f * PI / 180.0f;
+const int AnimationClip::MAX_KEY_SPACING;
+const int AnimationClip::MAX_FRAME_COUNT;
+
+static const float QUANTIZATION_SCALE = 32767.0f;
+static const float DEQUANTIZATION_SCALE = 1.0f / QUANTIZATION_SCALE;
+
+static qint16 quantize(float value) {
+    return (qint16)glm::round(glm::clamp(value, -1.0f, 1.0f) * QUANTIZATION_SCALE);
+}
+
+/// Returns the rotation as it will be after quantization, so that key reduction accounts for the quantization error.
+static glm::quat quantized(const glm::quat& rotation) {
+    return glm::quat(quantize(rotation.w) * DEQUANTIZATION_SCALE, quantize(rotation.x) * DEQUANTIZATION_SCALE,
+        quantize(rotation.y) * DEQUANTIZATION_SCALE, quantize(rotation.z) * DEQUANTIZATION_SCALE);
+}
+
+/// Interpolates linearly along the shorter arc and normalizes the result.
+static glm::quat nlerp(const glm::quat& first, const glm::quat& second, float proportion) {
+    glm::quat end = (glm::dot(first, second) < 0.0f) ? -second : second;
+    return glm::normalize(first * (1.0f - proportion) + end * proportion);
+}
+
+/// Checks whether interpolating between the stored rotations at the start and end frames reproduces every frame in between
+/// to within the tolerance, expressed as the minimum dot product (the cosine of half the angle between unit quaternions).
+static bool canInterpolate(const QVector<glm::quat>& track, const QVector<glm::quat>& stored, int start, int end,
+        float minimumDot) {
+    const glm::quat& first = stored.at(start);
+    const glm::quat& last = stored.at(end);
+    float span = end - start;
+    for (int i = start + 1; i < end; i++) {
+        if (glm::abs(glm::dot(nlerp(first, last, (i - start) / span), track.at(i))) < minimumDot) {
+            return false;
+        }
+    }
+    return true;
+}
+
+AnimationClip::AnimationClip() :
+    _frameCount(0),
+    _trackOffsets(1, 0) {
+}
+
+AnimationClip::AnimationClip(const QVector<FBXAnimationFrame>& frames, float tolerance) :
+    _frameCount(qMin(frames.size(), MAX_FRAME_COUNT)) {
+
+    int jointCount = frames.isEmpty() ? 0 : frames.first().rotations.size();
+    _trackOffsets.reserve(jointCount + 1);
+    float minimumDot = cosf(tolerance * 0.5f);
+    QVector<glm::quat> track(_frameCount), stored(_frameCount);
+    for (int i = 0; i < jointCount; i++) {
+        _trackOffsets.append(_keyFrames.size());
+
+        // gather the joint's rotations, flipping signs where necessary to keep neighbors in the same hemisphere
+        for (int j = 0; j < _frameCount; j++) {
+            glm::quat rotation = glm::normalize(frames.at(j).rotations.value(i));
+            if (j > 0 && glm::dot(rotation, track.at(j - 1)) < 0.0f) {
+                rotation = -rotation;
+            }
+            track[j] = rotation;
+            stored[j] = quantized(rotation);
+        }
+
+        // choose keys greedily, extending each span for as long as interpolating across it reproduces the frames within
+        appendKey(0, track.at(0));
+        for (int start = 0; start < _frameCount - 1; ) {
+            int end = start + 1;
+            for (int limit = qMin(start + MAX_KEY_SPACING, _frameCount - 1);
+                    end < limit && canInterpolate(track, stored, start, end + 1, minimumDot); end++);
+            appendKey(end, track.at(end));
+            start = end;
+        }
+    }
+    _trackOffsets.append(_keyFrames.size());
+}
+
+qint64 AnimationClip::getMemoryUsage() const {
+    return sizeof(AnimationClip) + _trackOffsets.size() * sizeof(int) +
+        _keyFrames.size() * (sizeof(quint16) + 4 * sizeof(qint16));
+}
+
+/// Interpolates four pairs of rotations, given as arrays of components, along the shorter arcs, normalizing the results
+/// (which replace the first rotations of the pairs).
+static void nlerp4(float* x0, float* y0, float* z0, float* w0, const float* x1, const float* y1, const float* z1,
+        const float* w1, const float* proportion) {
+#ifdef ANIMATION_CLIP_USE_SSE
+    __m128 ax = _mm_loadu_ps(x0), ay = _mm_loadu_ps(y0), az = _mm_loadu_ps(z0), aw = _mm_loadu_ps(w0);
+    __m128 bx = _mm_loadu_ps(x1), by = _mm_loadu_ps(y1), bz = _mm_loadu_ps(z1), bw = _mm_loadu_ps(w1);
+    __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+        _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+
+    // flip the sign of the second rotation where the dot product is negative
+    __m128 sign = _mm_and_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+    bx = _mm_xor_ps(bx, sign);
+    by = _mm_xor_ps(by, sign);
+    bz = _mm_xor_ps(bz, sign);
+    bw = _mm_xor_ps(bw, sign);
+
+    __m128 t = _mm_loadu_ps(proportion);
+    __m128 rx = _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(bx, ax), t));
+    __m128 ry = _mm_add_ps(ay, _mm_mul_ps(_mm_sub_ps(by, ay), t));
+    __m128 rz = _mm_add_ps(az, _mm_mul_ps(_mm_sub_ps(bz, az), t));
+    __m128 rw = _mm_add_ps(aw, _mm_mul_ps(_mm_sub_ps(bw, aw), t));
+
+    // normalize with the reciprocal square root estimate, refined by one Newton-Raphson step
+    __m128 length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)),
+        _mm_add_ps(_mm_mul_ps(rz, rz), _mm_mul_ps(rw, rw)));
+    __m128 estimate = _mm_rsqrt_ps(length2);
+    __m128 inverseLength = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), estimate),
+        _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_mul_ps(length2, estimate), estimate)));
+    _mm_storeu_ps(x0, _mm_mul_ps(rx, inverseLength));
+    _mm_storeu_ps(y0, _mm_mul_ps(ry, inverseLength));
+    _mm_storeu_ps(z0, _mm_mul_ps(rz, inverseLength));
+    _mm_storeu_ps(w0, _mm_mul_ps(rw, inverseLength));
+#else
+    for (int i = 0; i < 4; i++) {
+        float sign = (x0[i] * x1[i] + y0[i] * y1[i] + z0[i] * z1[i] + w0[i] * w1[i] < 0.0f) ? -1.0f : 1.0f;
+        float t = proportion[i];
+        float rx = x0[i] + (sign * x1[i] - x0[i]) * t;
+        float ry = y0[i] + (sign * y1[i] - y0[i]) * t;
+        float rz = z0[i] + (sign * z1[i] - z0[i]) * t;
+        float rw = w0[i] + (sign * w1[i] - w0[i]) * t;
+        float inverseLength = 1.0f / sqrtf(rx * rx + ry * ry + rz * rz + rw * rw);
+        x0[i] = rx * inverseLength;
+        y0[i] = ry * inverseLength;
+        z0[i] = rz * inverseLength;
+        w0[i] = rw * inverseLength;
+    }
+#endif
+}
+
+void AnimationClip::sample(float frameIndex, glm::quat* rotations) const {
+    if (_frameCount == 0) {
+        return;
+    }
+    float frame = fmodf(frameIndex, (float)_frameCount);
+    if (frame < 0.0f) {
+        frame += _frameCount;
+    }
+    int floorFrame = qMin((int)frame, _frameCount - 1);
+    const quint16* keyFrames = _keyFrames.constData();
+    const int* trackOffsets = _trackOffsets.constData();
+
+    // gather the keys on either side of the frame for four joints at a time, then interpolate all four at once
+    const int LANES = 4;
+    float x0[LANES], y0[LANES], z0[LANES], w0[LANES], x1[LANES], y1[LANES], z1[LANES], w1[LANES], proportion[LANES];
+    for (int base = 0, jointCount = getJointCount(); base < jointCount; base += LANES) {
+        int laneCount = qMin(LANES, jointCount - base);
+        for (int lane = 0; lane < LANES; lane++) {
+            if (lane >= laneCount) {
+                x0[lane] = y0[lane] = z0[lane] = x1[lane] = y1[lane] = z1[lane] = proportion[lane] = 0.0f;
+                w0[lane] = w1[lane] = 1.0f;
+                continue;
+            }
+            int begin = trackOffsets[base + lane], end = trackOffsets[base + lane + 1];
+            int key = std::upper_bound(keyFrames + begin, keyFrames + end, floorFrame) - keyFrames - 1;
+            int next = key + 1;
+            if (next < end) {
+                proportion[lane] = (frame - keyFrames[key]) / (keyFrames[next] - keyFrames[key]);
+
+            } else {
+                // the last key is on the last frame; past it, we blend towards the first
+                next = begin;
+                proportion[lane] = frame - keyFrames[key];
+            }
+            x0[lane] = _x.at(key) * DEQUANTIZATION_SCALE;
+            y0[lane] = _y.at(key) * DEQUANTIZATION_SCALE;
+            z0[lane] = _z.at(key) * DEQUANTIZATION_SCALE;
+            w0[lane] = _w.at(key) * DEQUANTIZATION_SCALE;
+            x1[lane] = _x.at(next) * DEQUANTIZATION_SCALE;
+            y1[lane] = _y.at(next) * DEQUANTIZATION_SCALE;
+            z1[lane] = _z.at(next) * DEQUANTIZATION_SCALE;
+            w1[lane] = _w.at(next) * DEQUANTIZATION_SCALE;
+        }
+        nlerp4(x0, y0, z0, w0, x1, y1, z1, w1, proportion);
+        for (int lane = 0; lane < laneCount; lane++) {
+            rotations[base + lane] = glm::quat(w0[lane], x0[lane], y0[lane], z0[lane]);
+        }
+    }
+}
+
+QVector<FBXAnimationFrame> AnimationClip::getFrames() const {
+    QVector<FBXAnimationFrame> frames(_frameCount);
+    for (int i = 0; i < _frameCount; i++) {
+        FBXAnimationFrame& frame = frames[i];
+        frame.rotations.resize(getJointCount());
+        sample(i, frame.rotations.data());
+    }
+    return frames;
+}
+
+void AnimationClip::appendKey(int frame, const glm::quat& rotation) {
+    _keyFrames.append(frame);
+    _x.append(quantize(rotation.x));
+    _y.append(quantize(rotation.y));
+    _z.append(quantize(rotation.z));
+    _w.append(quantize(rotation.w));
+}
@@ -0,0 +1,74 @@
+//
+//  AnimationClip.h
+//  libraries/animation/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AnimationClip_h
+#define hifi_AnimationClip_h
+
+#include <QMetaType>
+#include <QVector>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <FBXReader.h>
+
+/// The joint rotations of an animation in compressed form.  Each joint has a track holding only the keys needed to
+/// reproduce the original frames to within a tolerance (the frames between keys being interpolated), with the rotations
+/// quantized to 16 bits per component.  Tracks are stored as structure-of-arrays, with key frames and each quaternion
+/// component in arrays of their own, and are sampled with normalized linear interpolation four joints at a time.
+class AnimationClip {
+public:
+
+    /// The default tolerance for key reduction, in radians.
+    static const float DEFAULT_TOLERANCE;
+
+    /// The maximum number of frames between keys, which bounds the cost of key reduction.
+    static const int MAX_KEY_SPACING = 256;
+
+    /// The maximum number of frames (which must fit in the 16-bit key frame numbers); any beyond are dropped.
+    static const int MAX_FRAME_COUNT = 65536;
+
+    AnimationClip();
+
+    /// Compresses the given frames.
+    /// \param tolerance the maximum angle, in radians, by which reconstructed rotations may differ from the originals
+    AnimationClip(const QVector<FBXAnimationFrame>& frames, float tolerance = DEFAULT_TOLERANCE);
+
+    int getFrameCount() const { return _frameCount; }
+    int getJointCount() const { return _trackOffsets.size() - 1; }
+    int getKeyCount() const { return _keyFrames.size(); }
+
+    /// Returns the number of bytes used by the tracks.
+    qint64 getMemoryUsage() const;
+
+    /// Samples the rotations of all joints at the given frame index, which wraps around at the frame count.  Between the
+    /// last frame and the frame count, the rotations blend back towards the first frame.
+    /// \param rotations the array to fill, with room for getJointCount() rotations
+    void sample(float frameIndex, glm::quat* rotations) const;
+
+    /// Returns the frames as reconstructed from the tracks.
+    QVector<FBXAnimationFrame> getFrames() const;
+
+private:
+
+    void appendKey(int frame, const glm::quat& rotation);
+
+    int _frameCount;
+    QVector<int> _trackOffsets; ///< the index of each joint's first key, followed by the total number of keys
+    QVector<quint16> _keyFrames;
+    QVector<qint16> _x;
+    QVector<qint16> _y;
+    QVector<qint16> _z;
+    QVector<qint16> _w;
+};
+
+Q_DECLARE_METATYPE(AnimationClip)
+
+#endif // hifi_AnimationClip_h
@@ -26,6 +26,7 @@ public:
     AbstractAudioInterface(QObject* parent = 0) : QObject(parent) {};
     
 public slots:
+    /// Starts playing the injector's local buffer.  Called on this interface's thread, where local injectors live.
     virtual bool outputLocalInjector(bool isStereo, qreal volume, AudioInjector* injector) = 0;
 };
 
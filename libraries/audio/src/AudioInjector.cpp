@@ -17,6 +17,7 @@
 #include <UUID.h>
 
 #include "AbstractAudioInterface.h"
+#include "AudioInjectorScheduler.h"
 #include "AudioRingBuffer.h"
 
 #include "AudioInjector.h"
@@ -36,7 +37,12 @@ AudioInjector::AudioInjector(QObject* parent) :
     _loudness(0.0f),
     _isFinished(false),
     _currentSendPosition(0),
-    _localBuffer(NULL)
+    _localAudioInterface(NULL),
+    _localBuffer(NULL),
+    _positionOptionOffset(0),
+    _orientationOptionOffset(0),
+    _volumeOptionOffset(0),
+    _outgoingSequenceNumber(0)
 {
 }
 
@@ -47,7 +53,12 @@ AudioInjector::AudioInjector(Sound* sound, const AudioInjectorOptions& injectorO
     _loudness(0.0f),
     _isFinished(false),
     _currentSendPosition(0),
-    _localBuffer(NULL)
+    _localAudioInterface(NULL),
+    _localBuffer(NULL),
+    _positionOptionOffset(0),
+    _orientationOptionOffset(0),
+    _volumeOptionOffset(0),
+    _outgoingSequenceNumber(0)
 {
 }
 
@@ -58,7 +69,12 @@ AudioInjector::AudioInjector(const QByteArray& audioData, const AudioInjectorOpt
     _loudness(0.0f),
     _isFinished(false),
     _currentSendPosition(0),
-    _localBuffer(NULL)
+    _localAudioInterface(NULL),
+    _localBuffer(NULL),
+    _positionOptionOffset(0),
+    _orientationOptionOffset(0),
+    _volumeOptionOffset(0),
+    _outgoingSequenceNumber(0)
 {
     
 }
@@ -108,12 +124,8 @@ void AudioInjector::injectLocally() {
             // give our current send position to the local buffer
             _localBuffer->setCurrentOffset(_currentSendPosition);
             
-            QMetaObject::invokeMethod(_localAudioInterface, "outputLocalInjector",
-                                      Qt::BlockingQueuedConnection,
-                                      Q_RETURN_ARG(bool, success),
-                                      Q_ARG(bool, _options.stereo),
-                                      Q_ARG(qreal, _options.volume),
-                                      Q_ARG(AudioInjector*, this));
+            // the scheduler started us on the interface's thread, so this neither blocks nor crosses threads
+            success = _localAudioInterface->outputLocalInjector(_options.stereo, _options.volume, this);
             
             // if we're not looping and the buffer tells us it is empty then emit finished
             connect(_localBuffer, &AudioInjectorLocalBuffer::bufferEmpty, this, &AudioInjector::stop);
@@ -145,117 +157,109 @@ void AudioInjector::injectToMixer() {
     }
     
     // make sure we actually have samples downloaded to inject
-    if (_audioData.size()) {
-        
-        // setup the packet for injected audio
-        QByteArray injectAudioPacket = byteArrayWithPopulatedHeader(PacketTypeInjectAudio);
-        QDataStream packetStream(&injectAudioPacket, QIODevice::Append);
-        
-        // pack some placeholder sequence number for now
-        int numPreSequenceNumberBytes = injectAudioPacket.size();
-        packetStream << (quint16)0;
-        
-        // pack stream identifier (a generated UUID)
-        packetStream << QUuid::createUuid();
-        
-        // pack the stereo/mono type of the stream
-        packetStream << _options.stereo;
-        
-        // pack the flag for loopback
-        uchar loopbackFlag = (uchar) true;
-        packetStream << loopbackFlag;
-        
-        // pack the position for injected audio
-        int positionOptionOffset = injectAudioPacket.size();
-        packetStream.writeRawData(reinterpret_cast<const char*>(&_options.position),
-                                  sizeof(_options.position));
-        
-        // pack our orientation for injected audio
-        int orientationOptionOffset = injectAudioPacket.size();
-        packetStream.writeRawData(reinterpret_cast<const char*>(&_options.orientation),
-                                  sizeof(_options.orientation));
-        
-        // pack zero for radius
-        float radius = 0;
-        packetStream << radius;
-        
-        // pack 255 for attenuation byte
-        int volumeOptionOffset = injectAudioPacket.size();
-        quint8 volume = MAX_INJECTOR_VOLUME * _options.volume;
-        packetStream << volume;
-        
-        packetStream << _options.ignorePenumbra;
-        
-        QElapsedTimer timer;
-        timer.start();
-        int nextFrame = 0;
-        
-        int numPreAudioDataBytes = injectAudioPacket.size();
-        bool shouldLoop = _options.loop;
-        
-        // loop to send off our audio in NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL byte chunks
-        quint16 outgoingInjectedAudioSequenceNumber = 0;
-        while (_currentSendPosition < _audioData.size() && !_shouldStop) {
-            
-            int bytesToCopy = std::min(((_options.stereo) ? 2 : 1) * AudioConstants::NETWORK_FRAME_BYTES_PER_CHANNEL,
-                                       _audioData.size() - _currentSendPosition);
-            
-            //  Measure the loudness of this frame
-            _loudness = 0.0f;
-            for (int i = 0; i < bytesToCopy; i += sizeof(int16_t)) {
-                _loudness += abs(*reinterpret_cast<int16_t*>(_audioData.data() + _currentSendPosition + i)) /
-                (AudioConstants::MAX_SAMPLE_VALUE / 2.0f);
-            }
-            _loudness /= (float)(bytesToCopy / sizeof(int16_t));
-
-            memcpy(injectAudioPacket.data() + positionOptionOffset,
-                   &_options.position,
-                   sizeof(_options.position));
-            memcpy(injectAudioPacket.data() + orientationOptionOffset,
-                   &_options.orientation,
-                   sizeof(_options.orientation));
-            volume = MAX_INJECTOR_VOLUME * _options.volume;
-            memcpy(injectAudioPacket.data() + volumeOptionOffset, &volume, sizeof(volume));
-            
-            // resize the QByteArray to the right size
-            injectAudioPacket.resize(numPreAudioDataBytes + bytesToCopy);
-
-            // pack the sequence number
-            memcpy(injectAudioPacket.data() + numPreSequenceNumberBytes,
-                   &outgoingInjectedAudioSequenceNumber, sizeof(quint16));
-            
-            // copy the next NETWORK_BUFFER_LENGTH_BYTES_PER_CHANNEL bytes to the packet
-            memcpy(injectAudioPacket.data() + numPreAudioDataBytes,
-                   _audioData.data() + _currentSendPosition, bytesToCopy);
-            
-            // grab our audio mixer from the NodeList, if it exists
-            auto nodeList = DependencyManager::get<NodeList>();
-            SharedNodePointer audioMixer = nodeList->soloNodeOfType(NodeType::AudioMixer);
-            
-            // send off this audio packet
-            nodeList->writeDatagram(injectAudioPacket, audioMixer);
-            outgoingInjectedAudioSequenceNumber++;
-            
-            _currentSendPosition += bytesToCopy;
-            
-            // send two packets before the first sleep so the mixer can start playback right away
-            
-            if (_currentSendPosition != bytesToCopy && _currentSendPosition < _audioData.size()) {
-                // not the first packet and not done
-                // sleep for the appropriate time
-                int usecToSleep = (++nextFrame * AudioConstants::NETWORK_FRAME_USECS) - timer.nsecsElapsed() / 1000;
-                
-                if (usecToSleep > 0) {
-                    usleep(usecToSleep);
-                } 
-            }
+    if (!_audioData.size()) {
+        finishInjection();
+        return;
+    }
+    
+    // setup the packet for injected audio
+    _injectAudioPacketPrefix = byteArrayWithPopulatedHeader(PacketTypeInjectAudio);
+    QDataStream packetStream(&_injectAudioPacketPrefix, QIODevice::Append);
+    
+    // pack some placeholder sequence number for now, it is filled in for each frame
+    packetStream << (quint16)0;
+    
+    // pack stream identifier (a generated UUID)
+    packetStream << QUuid::createUuid();
+    
+    // pack the stereo/mono type of the stream
+    packetStream << _options.stereo;
+    
+    // pack the flag for loopback
+    uchar loopbackFlag = (uchar) true;
+    packetStream << loopbackFlag;
+    
+    // pack the position for injected audio
+    _positionOptionOffset = _injectAudioPacketPrefix.size();
+    packetStream.writeRawData(reinterpret_cast<const char*>(&_options.position),
+                              sizeof(_options.position));
+    
+    // pack our orientation for injected audio
+    _orientationOptionOffset = _injectAudioPacketPrefix.size();
+    packetStream.writeRawData(reinterpret_cast<const char*>(&_options.orientation),
+                              sizeof(_options.orientation));
+    
+    // pack zero for radius
+    float radius = 0;
+    packetStream << radius;
+    
+    // pack 255 for attenuation byte
+    _volumeOptionOffset = _injectAudioPacketPrefix.size();
+    quint8 volume = MAX_INJECTOR_VOLUME * _options.volume;
+    packetStream << volume;
+    
+    packetStream << _options.ignorePenumbra;
+    
+    _outgoingSequenceNumber = 0;
+    
+    // the scheduler sends our frames from here on, in step with every other injector
+    AudioInjectorScheduler::getInstance().addInjector(this);
+}
 
-            if (shouldLoop && _currentSendPosition >= _audioData.size()) {
-                _currentSendPosition = 0;
-            }
-        }
+bool AudioInjector::sendNextFrame(QByteArray& packet) {
+    if (_shouldStop || _currentSendPosition >= _audioData.size()) {
+        finishInjection();
+        return false;
     }
     
+    int bytesToCopy = std::min(((_options.stereo) ? 2 : 1) * AudioConstants::NETWORK_FRAME_BYTES_PER_CHANNEL,
+                               _audioData.size() - _currentSendPosition);
+    const char* frameData = _audioData.constData() + _currentSendPosition;
+    
+    //  Measure the loudness of this frame
+    _loudness = 0.0f;
+    for (int i = 0; i < bytesToCopy; i += sizeof(int16_t)) {
+        _loudness += abs(*reinterpret_cast<const int16_t*>(frameData + i)) /
+        (AudioConstants::MAX_SAMPLE_VALUE / 2.0f);
+    }
+    _loudness /= (float)(bytesToCopy / sizeof(int16_t));
+    
+    // resize the shared packet to the right size and fill it from our prefix, with the current options
+    int numPreAudioDataBytes = _injectAudioPacketPrefix.size();
+    packet.resize(numPreAudioDataBytes + bytesToCopy);
+    char* packetData = packet.data();
+    memcpy(packetData, _injectAudioPacketPrefix.constData(), numPreAudioDataBytes);
+    
+    memcpy(packetData + numBytesForPacketHeader(packet), &_outgoingSequenceNumber, sizeof(quint16));
+    memcpy(packetData + _positionOptionOffset, &_options.position, sizeof(_options.position));
+    memcpy(packetData + _orientationOptionOffset, &_options.orientation, sizeof(_options.orientation));
+    quint8 volume = MAX_INJECTOR_VOLUME * _options.volume;
+    memcpy(packetData + _volumeOptionOffset, &volume, sizeof(volume));
+    
+    // copy the next NETWORK_BUFFER_LENGTH_BYTES_PER_CHANNEL bytes to the packet
+    memcpy(packetData + numPreAudioDataBytes, frameData, bytesToCopy);
+    
+    // grab our audio mixer from the NodeList, if it exists
+    auto nodeList = DependencyManager::get<NodeList>();
+    SharedNodePointer audioMixer = nodeList->soloNodeOfType(NodeType::AudioMixer);
+    
+    // send off this audio packet
+    nodeList->writeDatagram(packet, audioMixer);
+    _outgoingSequenceNumber++;
+    
+    _currentSendPosition += bytesToCopy;
+    
+    if (_currentSendPosition >= _audioData.size()) {
+        if (!_options.loop) {
+            finishInjection();
+            return false;
+        }
+        _currentSendPosition = 0;
+    }
+    return true;
+}
+
+void AudioInjector::finishInjection() {
     _isFinished = true;
     emit finished();
 }
@@ -265,7 +269,6 @@ void AudioInjector::stop() {
     
     if (_options.localOnly) {
         // we're only a local injector, so we can say we are finished right away too
-        _isFinished = true;
-        emit finished();
+        finishInjection();
     }
 }
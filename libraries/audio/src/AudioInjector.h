@@ -52,6 +52,9 @@ private:
     void injectToMixer();
     void injectLocally();
     
+    bool sendNextFrame(QByteArray& packet);
+    void finishInjection();
+    
     QByteArray _audioData;
     AudioInjectorOptions _options;
     bool _shouldStop;
@@ -60,6 +63,15 @@ private:
     int _currentSendPosition;
     AbstractAudioInterface* _localAudioInterface;
     AudioInjectorLocalBuffer* _localBuffer;
+    
+    // everything in the injected audio packet before the samples, patched and copied out for each frame
+    QByteArray _injectAudioPacketPrefix;
+    int _positionOptionOffset;
+    int _orientationOptionOffset;
+    int _volumeOptionOffset;
+    quint16 _outgoingSequenceNumber;
+    
+    friend class AudioInjectorScheduler;
 };
 
 Q_DECLARE_METATYPE(AudioInjector*)
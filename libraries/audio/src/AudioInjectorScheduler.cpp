@@ -0,0 +1,137 @@
+//
+//  AudioInjectorScheduler.cpp
+//  libraries/audio/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+
+#include <LimitedNodeList.h>
+
+#include "AbstractAudioInterface.h"
+#include "AudioConstants.h"
+#include "AudioInjector.h"
+
+#include "AudioInjectorScheduler.h"
+
+// wake up a few times per frame so a frame is never sent much later than it is due
+const int FRAME_TIMER_INTERVAL_MSECS = AudioConstants::NETWORK_FRAME_MSECS / 4;
+
+// if we fall further behind than this we drop the backlog instead of flooding the mixer with it
+const int MAX_CATCH_UP_FRAMES = 4;
+
+// matches the two packets a thread per injector used to send before its first sleep
+const int NUM_INITIAL_FRAMES = 2;
+
+AudioInjectorScheduler& AudioInjectorScheduler::getInstance() {
+    static AudioInjectorScheduler staticInstance;
+    return staticInstance;
+}
+
+AudioInjectorScheduler::AudioInjectorScheduler() :
+    _frameTimer(new QTimer(this)),
+    _nextFrameUsecs(0)
+{
+    _packet.reserve(MAX_PACKET_SIZE);
+
+    _frameTimer->setTimerType(Qt::PreciseTimer);
+    _frameTimer->setInterval(FRAME_TIMER_INTERVAL_MSECS);
+    connect(_frameTimer, &QTimer::timeout, this, &AudioInjectorScheduler::sendFrames);
+
+    _thread.setObjectName("Audio Injector Scheduler");
+    moveToThread(&_thread);
+    _thread.start();
+
+    // shut down from the quitting thread, while the application is still around
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &AudioInjectorScheduler::shutdown,
+            Qt::DirectConnection);
+    }
+}
+
+AudioInjectorScheduler::~AudioInjectorScheduler() {
+    shutdown();
+}
+
+void AudioInjectorScheduler::shutdown() {
+    if (!_thread.isRunning()) {
+        return;
+    }
+    // the timer and the injectors live on the scheduler thread, so they have to be stopped there
+    QMetaObject::invokeMethod(this, "stopSending", Qt::BlockingQueuedConnection);
+    _thread.quit();
+    _thread.wait();
+}
+
+void AudioInjectorScheduler::start(AudioInjector* injector) {
+    // local injectors send nothing, they only feed an output that lives on the audio interface's thread
+    if (injector->isLocalOnly() && injector->_localAudioInterface) {
+        injector->moveToThread(injector->_localAudioInterface->thread());
+    } else {
+        injector->moveToThread(&_thread);
+    }
+    QMetaObject::invokeMethod(injector, "injectAudio", Qt::QueuedConnection);
+}
+
+void AudioInjectorScheduler::addInjector(AudioInjector* injector) {
+    Q_ASSERT(QThread::currentThread() == &_thread);
+
+    // send the first frames right away so the mixer can start playback, the rest go out with everyone else's
+    for (int i = 0; i < NUM_INITIAL_FRAMES; i++) {
+        if (!injector->sendNextFrame(_packet)) {
+            return;
+        }
+    }
+
+    if (_injectors.isEmpty()) {
+        _clock.start();
+        _nextFrameUsecs = AudioConstants::NETWORK_FRAME_USECS;
+        _frameTimer->start();
+    }
+    _injectors.append(QPointer<AudioInjector>(injector));
+}
+
+void AudioInjectorScheduler::sendFrames() {
+    qint64 now = _clock.nsecsElapsed() / 1000;
+
+    if (now - _nextFrameUsecs > MAX_CATCH_UP_FRAMES * AudioConstants::NETWORK_FRAME_USECS) {
+        qDebug() << "AudioInjectorScheduler fell" << (now - _nextFrameUsecs) << "usecs behind, skipping ahead.";
+        _nextFrameUsecs = now;
+    }
+
+    while (_nextFrameUsecs <= now && !_injectors.isEmpty()) {
+        // injectors are deleted on this thread, so anything that went away since the last frame shows up as null here
+        QList<QPointer<AudioInjector> >::iterator injector = _injectors.begin();
+        while (injector != _injectors.end()) {
+            if (injector->isNull() || !injector->data()->sendNextFrame(_packet)) {
+                injector = _injectors.erase(injector);
+            } else {
+                ++injector;
+            }
+        }
+        _nextFrameUsecs += AudioConstants::NETWORK_FRAME_USECS;
+    }
+
+    if (_injectors.isEmpty()) {
+        // nothing to send, don't wake up again until someone starts injecting
+        _frameTimer->stop();
+    }
+}
+
+void AudioInjectorScheduler::stopSending() {
+    _frameTimer->stop();
+
+    // finishing lets the injectors' owners delete them, which happens as the thread exits
+    foreach (const QPointer<AudioInjector>& injector, _injectors) {
+        if (!injector.isNull()) {
+            injector->finishInjection();
+        }
+    }
+    _injectors.clear();
+}
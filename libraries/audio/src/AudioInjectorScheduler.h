@@ -0,0 +1,57 @@
+//
+//  AudioInjectorScheduler.h
+//  libraries/audio/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioInjectorScheduler_h
+#define hifi_AudioInjectorScheduler_h
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+class AudioInjector;
+
+/// Services every active AudioInjector from a single thread, sending one frame per injector each network audio frame.
+class AudioInjectorScheduler : public QObject {
+    Q_OBJECT
+public:
+    static AudioInjectorScheduler& getInstance();
+
+    /// Moves the injector to the scheduler thread (or, if it is local only, to its audio interface's thread) and starts it
+    /// there. Must be called from the injector's thread.
+    void start(AudioInjector* injector);
+
+    /// Adds an injector that is ready to send, must be called on the scheduler thread.
+    void addInjector(AudioInjector* injector);
+
+    /// Finishes the active injectors and stops the scheduler thread.  Called when the application is about to quit, since
+    /// the static instance outlives the application.  Must not be called on the scheduler thread.
+    void shutdown();
+
+private slots:
+    void sendFrames();
+    void stopSending();
+
+private:
+    AudioInjectorScheduler();
+    ~AudioInjectorScheduler();
+
+    QThread _thread;
+    QTimer* _frameTimer;
+    QElapsedTimer _clock;
+    qint64 _nextFrameUsecs;
+
+    QList<QPointer<AudioInjector> > _injectors;
+    QByteArray _packet; // reused for every injected audio packet
+};
+
+#endif // hifi_AudioInjectorScheduler_h
@@ -9,6 +9,8 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include "AudioInjectorScheduler.h"
+
 #include "AudioScriptingInterface.h"
 
 void registerAudioMetaTypes(QScriptEngine* engine) {
@@ -52,20 +54,12 @@ AudioInjector* AudioScriptingInterface::playSound(Sound* sound, const AudioInjec
         AudioInjector* injector = new AudioInjector(sound, optionsCopy);
         injector->setLocalAudioInterface(_localAudioInterface);
         
-        QThread* injectorThread = new QThread();
-        
-        injector->moveToThread(injectorThread);
-        
-        // start injecting when the injector thread starts
-        connect(injectorThread, &QThread::started, injector, &AudioInjector::injectAudio);
-        
         // connect the right slots and signals so that the AudioInjector is killed once the injection is complete
         connect(injector, &AudioInjector::finished, injector, &AudioInjector::deleteLater);
-        connect(injector, &AudioInjector::finished, injectorThread, &QThread::quit);
         connect(injector, &AudioInjector::finished, this, &AudioScriptingInterface::injectorStopped);
-        connect(injectorThread, &QThread::finished, injectorThread, &QThread::deleteLater);
         
-        injectorThread->start();
+        // all injectors share the scheduler thread instead of getting one each
+        AudioInjectorScheduler::getInstance().start(injector);
         
         _activeInjectors.append(QPointer<AudioInjector>(injector));
         
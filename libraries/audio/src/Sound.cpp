@@ -14,6 +14,8 @@
 #include <glm/glm.hpp>
 
 #include <QDataStream>
+#include <QRunnable>
+#include <QThreadPool>
 #include <QtCore/QDebug>
 #include <QtNetwork/QNetworkRequest>
 #include <QtNetwork/QNetworkReply>
@@ -55,58 +57,104 @@ Sound::Sound(const QUrl& url, bool isStereo) :
     
 }
 
-void Sound::downloadFinished(QNetworkReply* reply) {
-    // replace our byte array with the downloaded data
-    QByteArray rawAudioByteArray = reply->readAll();
+/// Converts a downloaded sound to the network format (or loads the converted samples from the processed resource cache)
+/// on a worker thread.
+class SoundProcessor : public QRunnable {
+public:
+    
+    SoundProcessor(const QWeakPointer<Resource>& sound, QNetworkReply* reply, bool isStereo) :
+        _sound(sound), _reply(reply), _isStereo(isStereo) { }
+    
+    virtual void run();
 
-    if (reply->hasRawHeader("Content-Type")) {
+private:
+    
+    QWeakPointer<Resource> _sound;
+    QNetworkReply* _reply;
+    bool _isStereo;
+};
 
-        QByteArray headerContentType = reply->rawHeader("Content-Type");
+void SoundProcessor::run() {
+    QSharedPointer<Resource> sound = _sound.toStrongRef();
+    if (sound.isNull()) {
+        _reply->deleteLater();
+        return;
+    }
+    QByteArray rawAudioByteArray = _reply->readAll();
+    QByteArray samples;
+    
+    if (_reply->hasRawHeader("Content-Type")) {
 
-        // WAV audio file encountered
-        if (headerContentType == "audio/x-wav"
+        QByteArray headerContentType = _reply->rawHeader("Content-Type");
+        bool isWav = (headerContentType == "audio/x-wav"
             || headerContentType == "audio/wav"
-            || headerContentType == "audio/wave") {
-
-            QByteArray outputAudioByteArray;
-
-            interpretAsWav(rawAudioByteArray, outputAudioByteArray);
-            downSample(outputAudioByteArray);
+            || headerContentType == "audio/wave");
+        
+        // check if this was a stereo raw file
+        // since it's raw the only way for us to know that is if the file was called .stereo.raw
+        if (!isWav && _reply->url().fileName().toLower().endsWith("stereo.raw")) {
+            _isStereo = true;
+            qDebug() << "Processing sound from" << _reply->url() << "as stereo audio file.";
+        }
+        
+        // the converted samples are cached along with the stereo flag, which a WAV header may have changed
+        const QByteArray CONVERTED_SOUND_VERSION = "1";
+        QString key = ProcessedResourceCache::getKey("sound", rawAudioByteArray, CONVERTED_SOUND_VERSION +
+            (isWav ? " wav" : " raw") + (_isStereo ? " stereo" : " mono"));
+        QByteArray converted = ProcessedResourceCache::getInstance().load(key);
+        if (!converted.isEmpty()) {
+            _isStereo = (converted.at(0) != 0);
+            samples = converted.mid(1);
+            
         } else {
-            // check if this was a stereo raw file
-            // since it's raw the only way for us to know that is if the file was called .stereo.raw
-            if (reply->url().fileName().toLower().endsWith("stereo.raw")) {
-                _isStereo = true;
-                qDebug() << "Processing sound from" << reply->url() << "as stereo audio file.";
+            if (isWav) {
+                // WAV audio file encountered
+                QByteArray outputAudioByteArray;
+                
+                Sound::interpretAsWav(rawAudioByteArray, outputAudioByteArray, _isStereo);
+                Sound::downSample(outputAudioByteArray, _isStereo, samples);
+            } else {
+                // Process as RAW file
+                Sound::downSample(rawAudioByteArray, _isStereo, samples);
             }
-            
-            // Process as RAW file
-            downSample(rawAudioByteArray);
+            Sound::trimFrames(samples);
+            ProcessedResourceCache::getInstance().insert(key, QByteArray(1, _isStereo ? 1 : 0) + samples);
         }
-        trimFrames();
     } else {
         qDebug() << "Network reply without 'Content-Type'.";
     }
     
+    QMetaObject::invokeMethod(sound.data(), "setSamples", Q_ARG(const QByteArray&, samples), Q_ARG(bool, _isStereo));
+    _reply->deleteLater();
+}
+
+void Sound::downloadFinished(QNetworkReply* reply) {
+    // send the processor off to the thread pool
+    QThreadPool::globalInstance()->start(new SoundProcessor(_self, reply, _isStereo));
+}
+
+void Sound::setSamples(const QByteArray& samples, bool isStereo) {
+    _byteArray = samples;
+    _isStereo = isStereo;
     _isReady = true;
-    reply->deleteLater();
+    finishedLoading(true);
 }
 
-void Sound::downSample(const QByteArray& rawAudioByteArray) {
+void Sound::downSample(const QByteArray& rawAudioByteArray, bool isStereo, QByteArray& samples) {
     // assume that this was a RAW file and is now an array of samples that are
     // signed, 16-bit, 48Khz, mono
 
     // we want to convert it to the format that the audio-mixer wants
     // which is signed, 16-bit, 24Khz, mono
 
-    _byteArray.resize(rawAudioByteArray.size() / 2);
+    samples.resize(rawAudioByteArray.size() / 2);
 
     int numSourceSamples = rawAudioByteArray.size() / sizeof(int16_t);
-    int16_t* sourceSamples = (int16_t*) rawAudioByteArray.data();
-    int16_t* destinationSamples = (int16_t*) _byteArray.data();
+    const int16_t* sourceSamples = (const int16_t*) rawAudioByteArray.constData();
+    int16_t* destinationSamples = (int16_t*) samples.data();
 
     
-    if (_isStereo) {
+    if (isStereo) {
         for (int i = 0; i < numSourceSamples; i += 4) {
             destinationSamples[i / 2] = (sourceSamples[i] / 2) + (sourceSamples[i + 2] / 2);
             destinationSamples[(i / 2) + 1] = (sourceSamples[i + 1] / 2) + (sourceSamples[i + 3] / 2);
@@ -123,16 +171,16 @@ void Sound::downSample(const QByteArray& rawAudioByteArray) {
     }
 }
 
-void Sound::trimFrames() {
+void Sound::trimFrames(QByteArray& samples) {
     
-    const uint32_t inputFrameCount = _byteArray.size() / sizeof(int16_t);
+    const uint32_t inputFrameCount = samples.size() / sizeof(int16_t);
     const uint32_t trimCount = 1024;  // number of leading and trailing frames to trim
     
     if (inputFrameCount <= (2 * trimCount)) {
         return;
     }
     
-    int16_t* inputFrameData = (int16_t*)_byteArray.data();
+    int16_t* inputFrameData = (int16_t*)samples.data();
 
     AudioEditBufferFloat32 editBuffer(1, inputFrameCount);
     editBuffer.copyFrames(1, inputFrameCount, inputFrameData, false /*copy in*/);
@@ -194,7 +242,7 @@ struct CombinedHeader {
     WAVEHeader  wave;
 };
 
-void Sound::interpretAsWav(const QByteArray& inputAudioByteArray, QByteArray& outputAudioByteArray) {
+void Sound::interpretAsWav(const QByteArray& inputAudioByteArray, QByteArray& outputAudioByteArray, bool& isStereo) {
 
     CombinedHeader fileHeader;
 
@@ -224,7 +272,7 @@ void Sound::interpretAsWav(const QByteArray& inputAudioByteArray, QByteArray& ou
             return;
         }
         if (qFromLittleEndian<quint16>(fileHeader.wave.numChannels) == 2) {
-            _isStereo = true;
+            isStereo = true;
         } else if (qFromLittleEndian<quint16>(fileHeader.wave.numChannels) > 2) {
             qDebug() << "Currently not support audio files with more than 2 channels.";
         }
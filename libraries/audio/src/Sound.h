@@ -28,18 +28,27 @@ public:
     bool isStereo() const { return _isStereo; }    
     bool isReady() const { return _isReady; }
      
-    const QByteArray& getByteArray() { return _byteArray; }
+    /// Returns the samples, already converted to the network format (24 kHz, 16 bit). Injectors share this data
+    /// rather than copying it, so it must not be modified once the sound is ready.
+    const QByteArray& getByteArray() const { return _byteArray; }
+    
+    /// The decoded samples are what we keep around, so they are what counts against the cache budget.
+    virtual qint64 getBytes() const { return _byteArray.size(); }
 
 private:
     QByteArray _byteArray;
     bool _isStereo;
     bool _isReady;
     
-    void trimFrames();
-    void downSample(const QByteArray& rawAudioByteArray);
-    void interpretAsWav(const QByteArray& inputAudioByteArray, QByteArray& outputAudioByteArray);
+    friend class SoundProcessor;
+    
+    static void trimFrames(QByteArray& samples);
+    static void downSample(const QByteArray& rawAudioByteArray, bool isStereo, QByteArray& samples);
+    static void interpretAsWav(const QByteArray& inputAudioByteArray, QByteArray& outputAudioByteArray, bool& isStereo);
     
     virtual void downloadFinished(QNetworkReply* reply);
+    
+    Q_INVOKABLE void setSamples(const QByteArray& samples, bool isStereo);
 };
 
 typedef QSharedPointer<Sound> SharedSoundPointer;
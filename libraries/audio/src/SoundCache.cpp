@@ -23,6 +23,7 @@ SoundCache& SoundCache::getInstance() {
 SoundCache::SoundCache(QObject* parent) :
     ResourceCache(parent)
 {
+    // unused sounds are charged by their decoded samples, which is what injectors stream from
     const qint64 SOUND_DEFAULT_UNUSED_MAX_SIZE = 50 * BYTES_PER_MEGABYTES;
     setUnusedResourceCacheSize(SOUND_DEFAULT_UNUSED_MAX_SIZE);
 }
@@ -10,6 +10,7 @@
 //
 
 #include <AudioConstants.h>
+#include <AudioInjectorScheduler.h>
 #include <GLMHelpers.h>
 #include <NodeList.h>
 #include <StreamUtils.h>
@@ -27,7 +28,6 @@ Player::Player(AvatarData* avatar) :
     _pausedFrame(INVALID_FRAME),
     _timerOffset(0),
     _audioOffset(0),
-    _audioThread(NULL),
     _playFromCurrentPosition(true),
     _loop(false),
     _useAttachments(true),
@@ -113,13 +113,13 @@ void Player::startPlaying() {
         _avatar->setForceFaceshiftConnected(true);
         
         qDebug() << "Recorder::startPlaying()";
-        setupAudioThread();
+        setupAudioInjector();
         _currentFrame = 0;
         _timerOffset = 0;
         _timer.start();
     } else {
         qDebug() << "Recorder::startPlaying(): Unpause";
-        setupAudioThread();
+        setupAudioInjector();
         _timer.start();
         
         setCurrentFrame(_pausedFrame);
@@ -133,7 +133,7 @@ void Player::stopPlaying() {
     }
     _pausedFrame = INVALID_FRAME;
     _timer.invalidate();
-    cleanupAudioThread();
+    cleanupAudioInjector();
     _avatar->clearJointsData();
     
     // Turn off fake faceshift connection
@@ -158,37 +158,29 @@ void Player::stopPlaying() {
 void Player::pausePlayer() {
     _timerOffset = elapsed();
     _timer.invalidate();
-    cleanupAudioThread();
+    cleanupAudioInjector();
     
     _pausedFrame = _currentFrame;
     qDebug() << "Recorder::pausePlayer()";
 }
 
-void Player::setupAudioThread() {
-    _audioThread = new QThread();
+void Player::setupAudioInjector() {
     _options.position = _avatar->getPosition();
     _options.orientation = _avatar->getOrientation();
     _injector.reset(new AudioInjector(_recording->getAudioData(), _options), &QObject::deleteLater);
-    _injector->moveToThread(_audioThread);
-    _audioThread->start();
-    QMetaObject::invokeMethod(_injector.data(), "injectAudio", Qt::QueuedConnection);
+    AudioInjectorScheduler::getInstance().start(_injector.data());
 }
 
-void Player::cleanupAudioThread() {
+void Player::cleanupAudioInjector() {
     _injector->stop();
     QObject::connect(_injector.data(), &AudioInjector::finished,
                      _injector.data(), &AudioInjector::deleteLater);
-    QObject::connect(_injector.data(), &AudioInjector::destroyed,
-                     _audioThread, &QThread::quit);
-    QObject::connect(_audioThread, &QThread::finished,
-                     _audioThread, &QThread::deleteLater);
     _injector.clear();
-    _audioThread = NULL;
 }
 
 void Player::loopRecording() {
-    cleanupAudioThread();
-    setupAudioThread();
+    cleanupAudioInjector();
+    setupAudioInjector();
     _currentFrame = 0;
     _timerOffset = 0;
     _timer.restart();
@@ -321,32 +313,7 @@ void Player::setCurrentTime(int currentTime) {
     }
     
     // Find correct frame
-    int lowestBound = 0;
-    int highestBound = _recording->getFrameNumber() - 1;
-    while (lowestBound + 1 != highestBound) {
-        assert(lowestBound < highestBound);
-        
-        int bestGuess = lowestBound +
-                    (highestBound - lowestBound) *
-                    (float)(currentTime - _recording->getFrameTimestamp(lowestBound)) /
-                    (float)(_recording->getFrameTimestamp(highestBound) - _recording->getFrameTimestamp(lowestBound));
-        
-        if (_recording->getFrameTimestamp(bestGuess) <= currentTime) {
-            if (currentTime < _recording->getFrameTimestamp(bestGuess + 1)) {
-                lowestBound = bestGuess;
-                highestBound = bestGuess + 1;
-            } else {
-                lowestBound = bestGuess + 1;
-            }
-        } else {
-            if (_recording->getFrameTimestamp(bestGuess - 1) <= currentTime) {
-                lowestBound = bestGuess - 1;
-                highestBound = bestGuess;
-            } else {
-                highestBound = bestGuess - 1;
-            }
-        }
-    }
+    int lowestBound = _recording->getFrameIndex(currentTime);
     
     _currentFrame = lowestBound;
     _timerOffset = _recording->getFrameTimestamp(lowestBound);
@@ -58,8 +58,8 @@ public slots:
     void useSkeletonModel(bool useSkeletonURL) { _useSkeletonURL = useSkeletonURL; }
     
 private:
-    void setupAudioThread();
-    void cleanupAudioThread();
+    void setupAudioInjector();
+    void cleanupAudioInjector();
     void loopRecording();
     void setAudionInjectorPosition();
     bool computeCurrentFrame();
@@ -74,7 +74,6 @@ private:
     int _timerOffset;
     int _audioOffset;
     
-    QThread* _audioThread;
     QSharedPointer<AudioInjector> _injector;
     AudioInjectorOptions _options;
     
@@ -23,6 +23,8 @@
 #include <QFileInfo>
 #include <QPair>
 
+#include <algorithm>
+
 #include "AvatarData.h"
 #include "Recording.h"
 
@@ -33,7 +35,13 @@
 static const int MAGIC_NUMBER_SIZE = 8;
 static const char MAGIC_NUMBER[MAGIC_NUMBER_SIZE] = {17, 72, 70, 82, 13, 10, 26, 10};
 // Version (Major, Minor)
-static const QPair<quint8, quint8> VERSION(0, 2);
+static const QPair<quint8, quint8> VERSION(0, 3);
+// Version 0.3 splits the frames in compressed chunks that can be decoded independently
+static const QPair<quint8, quint8> CHUNKED_VERSION(0, 3);
+
+static const int FRAMES_PER_CHUNK = 64; // about a second of frames
+static const int MAX_DECODED_CHUNKS = 3; // the player needs two consecutive frames, that may be in two chunks
+static const int NUM_FIXED_FIELDS = 7; // translation, rotation, scale, head rotation, leans and look at
 
 int SCALE_RADIX = 10;
 int BLENDSHAPE_RADIX = 15;
@@ -60,8 +68,17 @@ qint32 Recording::getFrameTimestamp(int i) const {
     return _timestamps[i];
 }
 
+int Recording::getFrameIndex(qint32 timestamp) const {
+    // index of the last frame whose timestamp is lower or equal to the one given
+    QVector<qint32>::const_iterator it = std::upper_bound(_timestamps.constBegin(), _timestamps.constEnd(), timestamp);
+    return glm::max((int)(it - _timestamps.constBegin()) - 1, 0);
+}
+
 const RecordingFrame& Recording::getFrame(int i) const {
     assert(i < _timestamps.size());
+    if (isStreamed()) {
+        return getStreamedFrame(i);
+    }
     return _frames[i];
 }
 
@@ -74,6 +91,81 @@ void Recording::clear() {
     _timestamps.clear();
     _frames.clear();
     _audioData.clear();
+    
+    _decodedChunks.clear();
+    _firstChunk.clear();
+    _chunks.clear();
+    _chunkData.clear(); // release the data before unmapping the file
+    _file.clear();
+}
+
+const RecordingFrame& Recording::getStreamedFrame(int i) const {
+    // find the chunk containing this frame
+    int chunkIndex = 0;
+    for (int lowest = 0, highest = _chunks.size(); lowest < highest; ) {
+        int middle = (lowest + highest) / 2;
+        if (_chunks[middle].firstFrame <= i) {
+            chunkIndex = middle;
+            lowest = middle + 1;
+        } else {
+            highest = middle;
+        }
+    }
+    int indexInChunk = i - _chunks[chunkIndex].firstFrame;
+    if (chunkIndex == 0) {
+        return _firstChunk[indexInChunk];
+    }
+    
+    for (int j = 0; j < _decodedChunks.size(); ++j) {
+        if (_decodedChunks[j].first == chunkIndex) {
+            if (j != 0) {
+                _decodedChunks.move(j, 0);
+            }
+            return _decodedChunks.first().second[indexInChunk];
+        }
+    }
+    
+    if (_decodedChunks.size() >= MAX_DECODED_CHUNKS) {
+        _decodedChunks.removeLast();
+    }
+    _decodedChunks.prepend(QPair<int, QVector<RecordingFrame> >(chunkIndex, QVector<RecordingFrame>()));
+    QVector<RecordingFrame>& frames = _decodedChunks.first().second;
+    if (!decodeChunk(chunkIndex, frames)) {
+        qDebug() << "Couldn't decode recording chunk" << chunkIndex << "falling back to first frame.";
+        int numFrames = ((chunkIndex + 1 < _chunks.size()) ? _chunks[chunkIndex + 1].firstFrame : _timestamps.size()) -
+                        _chunks[chunkIndex].firstFrame;
+        frames.fill(_firstChunk.first(), numFrames);
+    }
+    return frames[indexInChunk];
+}
+
+bool Recording::decodeChunk(int chunkIndex, QVector<RecordingFrame>& frames) const {
+    const RecordingChunk& chunk = _chunks[chunkIndex];
+    if ((qint64)chunk.offset + chunk.size > _chunkData.size()) {
+        return false;
+    }
+    const char* data = _chunkData.constData() + chunk.offset;
+    if (qChecksum(data, chunk.size) != chunk.crc16) {
+        return false;
+    }
+    QByteArray buffer = qUncompress(reinterpret_cast<const uchar*>(data), chunk.size);
+    if (buffer.isEmpty()) {
+        return false;
+    }
+    
+    int numFrames = ((chunkIndex + 1 < _chunks.size()) ? _chunks[chunkIndex + 1].firstFrame : _timestamps.size()) -
+                    chunk.firstFrame;
+    frames.resize(numFrames);
+    
+    QDataStream stream(buffer);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    QBitArray mask;
+    for (int i = 0; i < numFrames; ++i) {
+        if (!readFrame(stream, frames[i], frames[(i != 0) ? i - 1 : i], i == 0, mask)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 void writeVec3(QDataStream& stream, const glm::vec3& value) {
@@ -117,6 +209,178 @@ bool readFloat(QDataStream& stream, float& value, int radix) {
     return true;
 }
 
+QByteArray Recording::encodeChunk(int firstFrame, int numFrames) const {
+    QByteArray buffer;
+    QDataStream stream(&buffer, QIODevice::WriteOnly);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    QBitArray mask;
+    for (int i = firstFrame; i < firstFrame + numFrames; ++i) {
+        writeFrame(stream, getFrame(i), getFrame((i != firstFrame) ? i - 1 : i), i == firstFrame, mask);
+    }
+    return qCompress(buffer);
+}
+
+void Recording::writeFrame(QDataStream& stream, const RecordingFrame& frame,
+                           const RecordingFrame& previousFrame, bool isKeyFrame, QBitArray& mask) {
+    int numBlendshapes = frame._blendshapeCoefficients.size();
+    int numJoints = frame._jointRotations.size();
+    
+    // Deltas need the arrays to keep the same size as in the previous frame
+    isKeyFrame = isKeyFrame || numBlendshapes != previousFrame._blendshapeCoefficients.size() ||
+                 numJoints != previousFrame._jointRotations.size();
+    stream << (quint8)isKeyFrame;
+    if (isKeyFrame) {
+        // Key frames are complete and carry the array sizes for the following deltas
+        stream << (quint32)numBlendshapes;
+        stream << (quint32)numJoints;
+        foreach (float coefficient, frame._blendshapeCoefficients) {
+            stream << coefficient;
+        }
+        foreach (const glm::quat& rotation, frame._jointRotations) {
+            writeQuat(stream, rotation);
+        }
+        writeVec3(stream, frame._translation);
+        writeQuat(stream, frame._rotation);
+        stream << frame._scale;
+        writeQuat(stream, frame._headRotation);
+        stream << frame._leanSideways;
+        stream << frame._leanForward;
+        writeVec3(stream, frame._lookAtPosition);
+        return;
+    }
+    
+    // Delta frames: a mask of the changed values followed by these values.
+    // The mask is reused from frame to frame to avoid reallocating it.
+    mask.resize(numBlendshapes + numJoints + NUM_FIXED_FIELDS);
+    mask.fill(false);
+    int maskIndex = 0;
+    
+    for (int j = 0; j < numBlendshapes; ++j, ++maskIndex) {
+        mask.setBit(maskIndex, frame._blendshapeCoefficients[j] != previousFrame._blendshapeCoefficients[j]);
+    }
+    for (int j = 0; j < numJoints; ++j, ++maskIndex) {
+        mask.setBit(maskIndex, frame._jointRotations[j] != previousFrame._jointRotations[j]);
+    }
+    mask.setBit(maskIndex++, frame._translation != previousFrame._translation);
+    mask.setBit(maskIndex++, frame._rotation != previousFrame._rotation);
+    mask.setBit(maskIndex++, frame._scale != previousFrame._scale);
+    mask.setBit(maskIndex++, frame._headRotation != previousFrame._headRotation);
+    mask.setBit(maskIndex++, frame._leanSideways != previousFrame._leanSideways);
+    mask.setBit(maskIndex++, frame._leanForward != previousFrame._leanForward);
+    mask.setBit(maskIndex++, frame._lookAtPosition != previousFrame._lookAtPosition);
+    stream << mask;
+    
+    maskIndex = 0;
+    for (int j = 0; j < numBlendshapes; ++j) {
+        if (mask[maskIndex++]) {
+            stream << frame._blendshapeCoefficients[j];
+        }
+    }
+    for (int j = 0; j < numJoints; ++j) {
+        if (mask[maskIndex++]) {
+            writeQuat(stream, frame._jointRotations[j]);
+        }
+    }
+    if (mask[maskIndex++]) {
+        writeVec3(stream, frame._translation);
+    }
+    if (mask[maskIndex++]) {
+        writeQuat(stream, frame._rotation);
+    }
+    if (mask[maskIndex++]) {
+        stream << frame._scale;
+    }
+    if (mask[maskIndex++]) {
+        writeQuat(stream, frame._headRotation);
+    }
+    if (mask[maskIndex++]) {
+        stream << frame._leanSideways;
+    }
+    if (mask[maskIndex++]) {
+        stream << frame._leanForward;
+    }
+    if (mask[maskIndex++]) {
+        writeVec3(stream, frame._lookAtPosition);
+    }
+}
+
+bool Recording::readFrame(QDataStream& stream, RecordingFrame& frame,
+                          const RecordingFrame& previousFrame, bool isFirstFrame, QBitArray& mask) {
+    quint8 isKeyFrame = 0;
+    stream >> isKeyFrame;
+    if (!isKeyFrame && isFirstFrame) {
+        return false;
+    }
+    if (isKeyFrame) {
+        quint32 numBlendshapes = 0;
+        quint32 numJoints = 0;
+        stream >> numBlendshapes;
+        stream >> numJoints;
+        if (stream.status() != QDataStream::Ok) {
+            return false;
+        }
+        frame._blendshapeCoefficients.resize(numBlendshapes);
+        for (quint32 j = 0; j < numBlendshapes; ++j) {
+            stream >> frame._blendshapeCoefficients[j];
+        }
+        frame._jointRotations.resize(numJoints);
+        for (quint32 j = 0; j < numJoints; ++j) {
+            readQuat(stream, frame._jointRotations[j]);
+        }
+        readVec3(stream, frame._translation);
+        readQuat(stream, frame._rotation);
+        stream >> frame._scale;
+        readQuat(stream, frame._headRotation);
+        stream >> frame._leanSideways;
+        stream >> frame._leanForward;
+        readVec3(stream, frame._lookAtPosition);
+        return stream.status() == QDataStream::Ok;
+    }
+    
+    // Start from the previous frame and overwrite what changed
+    frame = previousFrame;
+    int numBlendshapes = frame._blendshapeCoefficients.size();
+    int numJoints = frame._jointRotations.size();
+    stream >> mask;
+    if (stream.status() != QDataStream::Ok || mask.size() != numBlendshapes + numJoints + NUM_FIXED_FIELDS) {
+        return false;
+    }
+    
+    int maskIndex = 0;
+    for (int j = 0; j < numBlendshapes; ++j) {
+        if (mask[maskIndex++]) {
+            stream >> frame._blendshapeCoefficients[j];
+        }
+    }
+    for (int j = 0; j < numJoints; ++j) {
+        if (mask[maskIndex++]) {
+            readQuat(stream, frame._jointRotations[j]);
+        }
+    }
+    if (mask[maskIndex++]) {
+        readVec3(stream, frame._translation);
+    }
+    if (mask[maskIndex++]) {
+        readQuat(stream, frame._rotation);
+    }
+    if (mask[maskIndex++]) {
+        stream >> frame._scale;
+    }
+    if (mask[maskIndex++]) {
+        readQuat(stream, frame._headRotation);
+    }
+    if (mask[maskIndex++]) {
+        stream >> frame._leanSideways;
+    }
+    if (mask[maskIndex++]) {
+        stream >> frame._leanForward;
+    }
+    if (mask[maskIndex++]) {
+        readVec3(stream, frame._lookAtPosition);
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
 void writeRecordingToFile(RecordingPointer recording, const QString& filename) {
     if (!recording || recording->getFrameNumber() < 1) {
         qDebug() << "Can't save empty recording";
@@ -192,135 +456,53 @@ void writeRecordingToFile(RecordingPointer recording, const QString& filename) {
     // RECORDING
     fileStream << recording->_timestamps;
     
-    QBitArray mask;
-    quint32 numBlendshapes = 0;
-    quint32 numJoints = 0;
-    
-    for (int i = 0; i < recording->_timestamps.size(); ++i) {
-        mask.fill(false);
-        int maskIndex = 0;
-        QByteArray buffer;
-        QDataStream stream(&buffer, QIODevice::WriteOnly);
-        RecordingFrame& previousFrame = recording->_frames[(i != 0) ? i - 1 : i];
-        RecordingFrame& frame = recording->_frames[i];
-        
-        // Blendshape Coefficients
-        if (i == 0) {
-            numBlendshapes = frame.getBlendshapeCoefficients().size();
-            stream << numBlendshapes;
-            mask.resize(mask.size() + numBlendshapes);
-        }
-        for (quint32 j = 0; j < numBlendshapes; ++j) {
-            if (i == 0 ||
-                frame._blendshapeCoefficients[j] != previousFrame._blendshapeCoefficients[j]) {
-                stream << frame.getBlendshapeCoefficients()[j];
-                mask.setBit(maskIndex);
-            }
-            ++maskIndex;
-        }
-        
-        // Joint Rotations
-        if (i == 0) {
-            numJoints = frame.getJointRotations().size();
-            stream << numJoints;
-            mask.resize(mask.size() + numJoints);
-        }
-        for (quint32 j = 0; j < numJoints; ++j) {
-            if (i == 0 ||
-                frame._jointRotations[j] != previousFrame._jointRotations[j]) {
-                writeQuat(stream, frame._jointRotations[j]);
-                mask.setBit(maskIndex);
-            }
-            maskIndex++;
-        }
-        
-        // Translation
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._translation != previousFrame._translation) {
-            writeVec3(stream, frame._translation);
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // Rotation
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._rotation != previousFrame._rotation) {
-            writeQuat(stream, frame._rotation);
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // Scale
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._scale != previousFrame._scale) {
-            stream << frame._scale;
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // Head Rotation
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._headRotation != previousFrame._headRotation) {
-            writeQuat(stream, frame._headRotation);
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // Lean Sideways
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._leanSideways != previousFrame._leanSideways) {
-            stream << frame._leanSideways;
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // Lean Forward
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._leanForward != previousFrame._leanForward) {
-            stream << frame._leanForward;
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
-        
-        // LookAt Position
-        if (i == 0) {
-            mask.resize(mask.size() + 1);
-        }
-        if (i == 0 || frame._lookAtPosition != previousFrame._lookAtPosition) {
-            writeVec3(stream, frame._lookAtPosition);
-            mask.setBit(maskIndex);
-        }
-        maskIndex++;
+    // Chunks are compressed up front so that the index can be written before them
+    QVector<RecordingChunk> chunks;
+    QVector<QByteArray> chunkBuffers;
+    quint32 chunkOffset = 0;
+    for (int i = 0; i < recording->getFrameNumber(); i += FRAMES_PER_CHUNK) {
+        int numFrames = glm::min(FRAMES_PER_CHUNK, recording->getFrameNumber() - i);
+        QByteArray buffer = recording->encodeChunk(i, numFrames);
         
-        fileStream << mask;
-        fileStream << buffer;
+        RecordingChunk chunk;
+        chunk.firstFrame = i;
+        chunk.offset = chunkOffset;
+        chunk.size = buffer.size();
+        chunk.crc16 = qChecksum(buffer.constData(), buffer.size());
+        chunks << chunk;
+        chunkBuffers << buffer;
+        chunkOffset += buffer.size();
     }
     
-    fileStream << recording->getAudioData();
+    // Seek index
+    fileStream << (quint32)chunks.size();
+    foreach (const RecordingChunk& chunk, chunks) {
+        fileStream << chunk.firstFrame << chunk.offset << chunk.size << chunk.crc16;
+    }
+    fileStream << (quint32)recording->getAudioData().size();
+    
+    // The checksum only covers the context and the index, chunks carry their own
+    quint32 dataLength = file.pos() - dataOffset;
+    
+    // AUDIO
+    fileStream.writeRawData(recording->getAudioData().constData(), recording->getAudioData().size());
+    
+    // FRAMES
+    foreach (const QByteArray& buffer, chunkBuffers) {
+        fileStream.writeRawData(buffer.constData(), buffer.size());
+    }
     
     qint64 writingTime = timer.restart();
     // Write data length and CRC-16
-    quint32 dataLength = file.pos() - dataOffset;
+    qint64 endPos = file.pos();
     file.seek(dataOffset); // Go to beginning of data for checksum
-    quint16 crc16 = qChecksum(file.readAll().constData(), dataLength);
+    quint16 crc16 = qChecksum(file.read(dataLength).constData(), dataLength);
     
     file.seek(dataLengthPos);
     fileStream << dataLength;
     file.seek(crc16Pos);
     fileStream << crc16;
-    file.seek(dataOffset + dataLength);
+    file.seek(endPos);
     
     bool wantDebug = true;
     if (wantDebug) {
@@ -351,6 +533,7 @@ void writeRecordingToFile(RecordingPointer recording, const QString& filename) {
         
         qDebug() << "Recording:";
         qDebug() << "Total frames:" << recording->getFrameNumber();
+        qDebug() << "Total chunks:" << chunks.size();
         qDebug() << "Audio array:" << recording->getAudioData().size();
     }
     
@@ -360,6 +543,7 @@ void writeRecordingToFile(RecordingPointer recording, const QString& filename) {
 
 RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString& filename) {
     QByteArray byteArray;
+    QSharedPointer<QFile> file;
     QUrl url(filename);
     QElapsedTimer timer;
     timer.start(); // timer used for debug informations (download/parsing time)
@@ -384,15 +568,19 @@ RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString
         // print debug + restart timer
         qDebug() << "Downloaded " << byteArray.size() << " bytes in " << timer.restart() << " ms.";
     } else {
-        // If local file, just read it.
+        // If local file, map it so that chunked recordings can be streamed from it.
         qDebug() << "Reading recording from " << filename << ".";
-        QFile file(filename);
-        if (!file.open(QIODevice::ReadOnly)){
+        file = QSharedPointer<QFile>(new QFile(filename));
+        if (!file->open(QIODevice::ReadOnly)){
             qDebug() << "Could not open local file: " << url;
             return recording;
         }
-        byteArray = file.readAll();
-        file.close();
+        uchar* mappedData = file->map(0, file->size());
+        if (mappedData) {
+            byteArray = QByteArray::fromRawData(reinterpret_cast<const char*>(mappedData), file->size());
+        } else {
+            byteArray = file->readAll();
+        }
     }
     
     if (filename.endsWith(".rec") || filename.endsWith(".REC")) {
@@ -420,7 +608,7 @@ RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString
     
     QPair<quint8, quint8> version;
     fileStream >> version; // File format version
-    if (version != VERSION && version != QPair<quint8, quint8>(0,1)) {
+    if (version != VERSION && version != QPair<quint8, quint8>(0,2) && version != QPair<quint8, quint8>(0,1)) {
         qDebug() << "ERROR: This file format version is not supported.";
         return recording;
     }
@@ -434,6 +622,11 @@ RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString
     
     
     // Check checksum
+    if ((qint64)dataOffset + dataLength > byteArray.size()) {
+        qDebug() << "File is truncated. Bailling!";
+        recording.clear();
+        return recording;
+    }
     quint16 computedCRC16 = qChecksum(byteArray.constData() + dataOffset, dataLength);
     if (computedCRC16 != crc16) {
         qDebug() << "Checksum does not match. Bailling!";
@@ -509,6 +702,66 @@ RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString
         context.attachments << data;
     }
     
+    if (version >= CHUNKED_VERSION) {
+        // RECORDING
+        fileStream >> recording->_timestamps;
+        
+        // Seek index
+        // every chunk holds at least one frame, the first chunk starts at frame zero and the others follow in order,
+        // otherwise the frame counts of the chunks come out negative or past the end of the timestamps
+        quint32 numChunks = 0;
+        fileStream >> numChunks;
+        bool validIndex = (numChunks != 0 && numChunks <= (quint32)recording->_timestamps.size());
+        if (validIndex) {
+            recording->_chunks.resize(numChunks);
+            for (quint32 i = 0; i < numChunks; ++i) {
+                RecordingChunk& chunk = recording->_chunks[i];
+                fileStream >> chunk.firstFrame >> chunk.offset >> chunk.size >> chunk.crc16;
+                qint32 minFirstFrame = (i == 0) ? 0 : recording->_chunks[i - 1].firstFrame + 1;
+                qint32 maxFirstFrame = (i == 0) ? 0 : recording->_timestamps.size() - 1;
+                if (chunk.firstFrame < minFirstFrame || chunk.firstFrame > maxFirstFrame) {
+                    validIndex = false;
+                    break;
+                }
+            }
+        }
+        quint32 audioSize = 0;
+        fileStream >> audioSize;
+        
+        qint64 audioOffset = (qint64)dataOffset + dataLength;
+        qint64 chunksOffset = audioOffset + audioSize;
+        if (fileStream.status() != QDataStream::Ok || !validIndex || chunksOffset > byteArray.size()) {
+            qDebug() << "Couldn't read file correctly. (Invalid index)";
+            recording->clear();
+            recording.clear();
+            return recording;
+        }
+        
+        // Audio is copied since injectors keep using it after the recording is gone
+        recording->addAudioPacket(QByteArray(byteArray.constData() + audioOffset, audioSize));
+        
+        // Frames are only decoded when played, keep the mapped file around
+        if (file) {
+            recording->_file = file;
+            recording->_chunkData = QByteArray::fromRawData(byteArray.constData() + chunksOffset,
+                                                            byteArray.size() - chunksOffset);
+        } else {
+            // Downloaded data, the recording has to own it
+            recording->_chunkData = byteArray.mid(chunksOffset);
+        }
+        
+        if (!recording->decodeChunk(0, recording->_firstChunk)) {
+            qDebug() << "Couldn't read file correctly. (Invalid first chunk)";
+            recording->clear();
+            recording.clear();
+            return recording;
+        }
+        
+        qDebug() << "Indexed" << recording->getFrameNumber() << "frames in" << numChunks << "chunks in"
+                 << timer.elapsed() << "ms.";
+        return recording;
+    }
+    
     quint32 numBlendshapes = 0;
     quint32 numJoints = 0;
     // RECORDING
@@ -12,14 +12,18 @@
 #ifndef hifi_Recording_h
 #define hifi_Recording_h
 
+#include <QBitArray>
+#include <QList>
+#include <QPair>
+#include <QSharedPointer>
 #include <QString>
 #include <QVector>
 
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
 
-template<class C>
-class QSharedPointer;
+class QDataStream;
+class QFile;
 
 class AttachmentData;
 class Recording;
@@ -45,6 +49,16 @@ public:
     glm::quat orientationInv;
 };
 
+/// Locates a block of frames inside a streamed recording.
+/// Each chunk starts with a key frame, the following frames are stored as deltas.
+class RecordingChunk {
+public:
+    qint32 firstFrame;
+    quint32 offset; // relative to the beginning of the chunks block
+    quint32 size;
+    quint16 crc16;
+};
+
 /// Stores a recording
 class Recording {
 public:
@@ -52,23 +66,43 @@ public:
     int getLength() const; // in ms
     
     RecordingContext& getContext() { return _context; }
-    int getFrameNumber() const { return _frames.size(); }
+    int getFrameNumber() const { return _timestamps.size(); }
     qint32 getFrameTimestamp(int i) const;
+    int getFrameIndex(qint32 timestamp) const;
     const RecordingFrame& getFrame(int i) const;
     const QByteArray& getAudioData() const { return _audioData; }
     
+    /// Returns true if the frames are decoded on demand from the file instead of being held in memory
+    bool isStreamed() const { return !_chunks.isEmpty(); }
+    
 protected:
     void addFrame(int timestamp, RecordingFrame& frame);
     void addAudioPacket(const QByteArray& byteArray) { _audioData.append(byteArray); }
     void clear();
     
 private:
+    const RecordingFrame& getStreamedFrame(int i) const;
+    bool decodeChunk(int chunkIndex, QVector<RecordingFrame>& frames) const;
+    
+    QByteArray encodeChunk(int firstFrame, int numFrames) const;
+    static void writeFrame(QDataStream& stream, const RecordingFrame& frame,
+                           const RecordingFrame& previousFrame, bool isKeyFrame, QBitArray& mask);
+    static bool readFrame(QDataStream& stream, RecordingFrame& frame,
+                          const RecordingFrame& previousFrame, bool isFirstFrame, QBitArray& mask);
+    
     RecordingContext _context;
     QVector<qint32> _timestamps;
     QVector<RecordingFrame> _frames;
     
     QByteArray _audioData;
     
+    // Streaming state, only used by recordings read from the chunked file format
+    QVector<RecordingChunk> _chunks;
+    QSharedPointer<QFile> _file;
+    QByteArray _chunkData; // may point directly into the memory mapped file
+    QVector<RecordingFrame> _firstChunk; // always decoded, also used as a fallback for corrupted chunks
+    mutable QList<QPair<int, QVector<RecordingFrame> > > _decodedChunks; // most recently used first
+    
     friend class Recorder;
     friend class Player;
     friend void writeRecordingToFile(RecordingPointer recording, const QString& file);
@@ -113,6 +147,7 @@ private:
     glm::vec3 _lookAtPosition;
     
     friend class Recorder;
+    friend class Recording;
     friend void writeRecordingToFile(RecordingPointer recording, const QString& file);
     friend RecordingPointer readRecordingFromFile(RecordingPointer recording, const QString& file);
     friend RecordingPointer readRecordingFromRecFile(RecordingPointer recording, const QString& filename,
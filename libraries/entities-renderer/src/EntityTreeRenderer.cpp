@@ -11,7 +11,10 @@
 
 #include <gpu/GPUConfig.h>
 
+#include <algorithm>
+
 #include <glm/gtx/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
 
 #include <QEventLoop>
 #include <QScriptSyntaxCheckResult>
@@ -46,7 +49,8 @@ EntityTreeRenderer::EntityTreeRenderer(bool wantScripts, AbstractViewStateInterf
     _displayElementChildProxies(false),
     _displayModelBounds(false),
     _displayModelElementProxy(false),
-    _dontDoPrecisionPicking(false)
+    _dontDoPrecisionPicking(false),
+    _dontCullOccludedEntities(false)
 {
     REGISTER_ENTITY_TYPE_WITH_FACTORY(Model, RenderableModelEntityItem::factory)
     REGISTER_ENTITY_TYPE_WITH_FACTORY(Box, RenderableBoxEntityItem::factory)
@@ -333,6 +337,9 @@ void EntityTreeRenderer::render(RenderArgs::RenderMode renderMode, RenderArgs::R
         RenderArgs args = { this, _viewFrustum, getSizeScale(), getBoundaryLevelAdjust(), renderMode, renderSide,
                                             0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
         _tree->lockForRead();
+        if (renderMode == RenderArgs::DEFAULT_RENDER_MODE && !_dontCullOccludedEntities) {
+            rasterizeOccluders(&args);
+        }
         _tree->recurseTreeWithOperation(renderOperation, &args);
 
         Model::RenderMode modelRenderMode = renderMode == RenderArgs::SHADOW_RENDER_MODE
@@ -348,11 +355,13 @@ void EntityTreeRenderer::render(RenderArgs::RenderMode renderMode, RenderArgs::R
         _meshesRendered = args._meshesRendered;
         _meshesOutOfView = args._meshesOutOfView;
         _meshesTooSmall = args._meshesTooSmall;
+        _meshesOccluded = args._meshesOccluded;
 
         _elementsTouched = args._elementsTouched;
         _itemsRendered = args._itemsRendered;
         _itemsOutOfView = args._itemsOutOfView;
         _itemsTooSmall = args._itemsTooSmall;
+        _itemsOccluded = args._itemsOccluded;
 
         _materialSwitches = args._materialSwitches;
         _trianglesRendered = args._trianglesRendered;
@@ -364,6 +373,69 @@ void EntityTreeRenderer::render(RenderArgs::RenderMode renderMode, RenderArgs::R
     deleteReleasedModels(); // seems like as good as any other place to do some memory cleanup
 }
 
+/// A box entity that may hide others, with its distance from the camera.
+class OccluderCandidate {
+public:
+    float distance;
+    const EntityItem* entity;
+
+    bool operator<(const OccluderCandidate& other) const { return distance < other.distance; }
+};
+
+class OccluderSearch {
+public:
+    const ViewFrustum* viewFrustum;
+    std::vector<OccluderCandidate> candidates;
+};
+
+// boxes must be at least this large for their distance to be worth rasterizing
+const float MIN_OCCLUDER_SIZE_TO_DISTANCE = 0.1f;
+
+const int MAX_OCCLUDERS = 32;
+
+bool EntityTreeRenderer::findOccludersOperation(OctreeElement* element, void* extraData) {
+    OccluderSearch* search = static_cast<OccluderSearch*>(extraData);
+    if (!element->isInView(*search->viewFrustum)) {
+        return false;
+    }
+    foreach (const EntityItem* entity, static_cast<EntityTreeElement*>(element)->getEntities()) {
+        if (entity->getType() != EntityTypes::Box || !entity->isVisible() || entity->getLocalRenderAlpha() < 1.0f) {
+            continue;
+        }
+        // judge boxes by their middle dimension, so that long, thin ones aren't taken for walls
+        glm::vec3 dimensions = entity->getDimensionsInMeters();
+        float size = glm::max(glm::min(dimensions.x, dimensions.y),
+            glm::min(glm::max(dimensions.x, dimensions.y), dimensions.z));
+        float distance = search->viewFrustum->distanceToCamera(entity->getCenterInMeters());
+        if (size > distance * MIN_OCCLUDER_SIZE_TO_DISTANCE) {
+            OccluderCandidate candidate = { distance, entity };
+            search->candidates.push_back(candidate);
+        }
+    }
+    return true;
+}
+
+void EntityTreeRenderer::rasterizeOccluders(RenderArgs* args) {
+    PerformanceTimer perfTimer("rasterizeOccluders");
+
+    // use the nearest of the large, opaque boxes in view, transformed just as they're rendered
+    OccluderSearch search;
+    search.viewFrustum = args->_viewFrustum;
+    _tree->recurseTreeWithOperation(findOccludersOperation, &search);
+    std::sort(search.candidates.begin(), search.candidates.end());
+
+    _occlusionBuffer.begin(args->_viewFrustum->computeViewProjection());
+    for (int i = 0, count = qMin((int)search.candidates.size(), MAX_OCCLUDERS); i < count; i++) {
+        const EntityItem* entity = search.candidates.at(i).entity;
+        glm::vec3 position = entity->getPositionInMeters();
+        _occlusionBuffer.addOccluderBox(glm::translate(position) * glm::mat4_cast(entity->getRotation()) *
+            glm::translate(entity->getCenterInMeters() - position) * glm::scale(entity->getDimensionsInMeters()));
+    }
+    if (_occlusionBuffer.getOccluderCount() > 0) {
+        args->_occlusionBuffer = &_occlusionBuffer;
+    }
+}
+
 const FBXGeometry* EntityTreeRenderer::getGeometryForEntity(const EntityItem* entityItem) {
     const FBXGeometry* result = NULL;
     
@@ -536,7 +608,10 @@ void EntityTreeRenderer::renderElement(OctreeElement* element, RenderArgs* args)
             if (!outOfView) {
                 bool bigEnoughToRender = _viewState->shouldRenderMesh(entityBox.getLargestDimension(), distance);
                 
-                if (bigEnoughToRender) {
+                if (bigEnoughToRender && args->_occlusionBuffer && args->_occlusionBuffer->isOccluded(entityBox)) {
+                    args->_itemsOccluded++;
+
+                } else if (bigEnoughToRender) {
                     renderProxies(entityItem, args);
 
                     Glower* glower = NULL;
@@ -15,6 +15,7 @@
 #include <EntityTree.h>
 #include <EntityScriptingInterface.h> // for RayToEntityIntersectionResult
 #include <MouseEvent.h>
+#include <OcclusionBuffer.h>
 #include <OctreeRenderer.h>
 
 class Model;
@@ -109,12 +110,16 @@ public slots:
     void setDisplayModelBounds(bool value) { _displayModelBounds = value; }
     void setDisplayModelElementProxy(bool value) { _displayModelElementProxy = value; }
     void setDontDoPrecisionPicking(bool value) { _dontDoPrecisionPicking = value; }
+    void setDontCullOccludedEntities(bool value) { _dontCullOccludedEntities = value; }
     
 protected:
     virtual Octree* createTree() { return new EntityTree(true); }
 
 private:
     void renderElementProxy(EntityTreeElement* entityTreeElement);
+
+    static bool findOccludersOperation(OctreeElement* element, void* extraData);
+    void rasterizeOccluders(RenderArgs* args);
     void checkAndCallPreload(const EntityItemID& entityID);
     void checkAndCallUnload(const EntityItemID& entityID);
 
@@ -153,7 +158,9 @@ private:
     bool _displayModelBounds;
     bool _displayModelElementProxy;
     bool _dontDoPrecisionPicking;
-    
+    bool _dontCullOccludedEntities;
+
+    OcclusionBuffer _occlusionBuffer;
 };
 
 #endif // hifi_EntityTreeRenderer_h
@@ -10,18 +10,32 @@
 //
 
 #include <assert.h>
+#include <algorithm>
+
 #include <PerfStat.h>
 #include <OctalCode.h>
 #include <PacketHeaders.h>
 #include "EntityEditPacketSender.h"
 #include "EntityItem.h"
 
+const int DEFAULT_MOTION_UPDATE_BANDWIDTH = 32 * 1024; // bytes per second
+const float MAX_SAVED_MOTION_UPDATE_BUDGET = 0.1f; // seconds worth of bandwidth that can be saved up for a burst
+const float HELD_MOTION_UPDATE_PRIORITY_BOOST = 1.0f; // per release, so that nothing waits forever
+
+EntityEditPacketSender::EntityEditPacketSender() :
+    _motionUpdateBandwidth(DEFAULT_MOTION_UPDATE_BANDWIDTH),
+    _motionUpdateBudget(MAX_SAVED_MOTION_UPDATE_BUDGET * DEFAULT_MOTION_UPDATE_BANDWIDTH),
+    _lastMotionUpdateRelease(0) {
+}
 
 void EntityEditPacketSender::adjustEditPacketForClockSkew(PacketType type, 
                                         unsigned char* editBuffer, size_t length, int clockSkew) {
                                         
     if (type == PacketTypeEntityAddOrEdit) {
         EntityItem::adjustEditPacketForClockSkew(editBuffer, length, clockSkew);
+
+    } else if (type == PacketTypeEntityMotionUpdate) {
+        EntityMotionUpdate::adjustMessageForClockSkew(editBuffer, length, clockSkew);
     }
 }
 
@@ -56,3 +70,70 @@ void EntityEditPacketSender::queueEraseEntityMessage(const EntityItemID& entityI
         queueOctreeEditMessage(PacketTypeEntityErase, bufferOut, sizeOut);
     }
 }
+
+void EntityEditPacketSender::queueMotionUpdate(const EntityMotionUpdate& update) {
+    if (!_shouldSend) {
+        return; // bail early
+    }
+    QHash<QUuid, EntityMotionUpdate>::iterator itr = _heldMotionUpdates.find(update.id);
+    if (itr == _heldMotionUpdates.end()) {
+        _heldMotionUpdates.insert(update.id, update);
+    } else {
+        // the new motion supersedes the old, but it has been waiting as long as the old one
+        float priority = glm::max(update.priority, itr.value().priority);
+        itr.value() = update;
+        itr.value().priority = priority;
+    }
+}
+
+static bool moreUrgentMotionUpdate(const EntityMotionUpdate& a, const EntityMotionUpdate& b) {
+    return a.priority > b.priority;
+}
+
+void EntityEditPacketSender::releaseMotionUpdates(const quint64& now) {
+    if (_lastMotionUpdateRelease != 0 && now > _lastMotionUpdateRelease) {
+        float dt = (float)(now - _lastMotionUpdateRelease) / (float)USECS_PER_SECOND;
+        _motionUpdateBudget = glm::min(_motionUpdateBudget + dt * (float)_motionUpdateBandwidth,
+                MAX_SAVED_MOTION_UPDATE_BUDGET * (float)_motionUpdateBandwidth);
+    }
+    _lastMotionUpdateRelease = now;
+    if (_heldMotionUpdates.isEmpty()) {
+        return;
+    }
+
+    int maxNumUpdates = (int)(_motionUpdateBudget / (float)EntityMotionUpdate::ENCODED_SIZE);
+    QVector<EntityMotionUpdate> updates;
+    updates.reserve(_heldMotionUpdates.size());
+    foreach (const EntityMotionUpdate& update, _heldMotionUpdates) {
+        updates.push_back(update);
+    }
+    if (maxNumUpdates < updates.size()) {
+        std::sort(updates.begin(), updates.end(), moreUrgentMotionUpdate);
+        updates.resize(glm::max(maxNumUpdates, 0));
+    }
+    int numUpdates = updates.size();
+
+    // each message must fit in one edit packet along with the packet header, sequence number and timestamp
+    const int MAX_MESSAGE_SIZE = _maxPacketSize - MAX_PACKET_HEADER_BYTES - (int)(sizeof(quint16) + sizeof(quint64));
+    unsigned char bufferOut[MAX_PACKET_SIZE];
+    int start = 0;
+    while (start < numUpdates) {
+        int numPacked = 0;
+        int sizeOut = EntityMotionUpdate::packMessage(updates, start, bufferOut, MAX_MESSAGE_SIZE, numPacked);
+        if (numPacked == 0) {
+            break;
+        }
+        queueOctreeEditMessage(PacketTypeEntityMotionUpdate, bufferOut, sizeOut);
+        _motionUpdateBudget -= (float)sizeOut;
+        start += numPacked;
+    }
+
+    for (int i = 0; i < start; ++i) {
+        _heldMotionUpdates.remove(updates.at(i).id);
+    }
+    QHash<QUuid, EntityMotionUpdate>::iterator itr = _heldMotionUpdates.begin();
+    while (itr != _heldMotionUpdates.end()) {
+        itr.value().priority += HELD_MOTION_UPDATE_PRIORITY_BOOST;
+        ++itr;
+    }
+}
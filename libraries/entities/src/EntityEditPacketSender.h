@@ -12,14 +12,19 @@
 #ifndef hifi_EntityEditPacketSender_h
 #define hifi_EntityEditPacketSender_h
 
+#include <QHash>
+
 #include <OctreeEditPacketSender.h>
 
 #include "EntityItem.h"
+#include "EntityMotionUpdate.h"
 
 /// Utility for processing, packing, queueing and sending of outbound edit voxel messages.
 class EntityEditPacketSender :  public OctreeEditPacketSender {
     Q_OBJECT
 public:
+    EntityEditPacketSender();
+
     /// Queues an array of several voxel edit messages. Will potentially send a pending multi-command packet. Determines
     /// which voxel-server node or nodes the packet should be sent to. Can be called even before voxel servers are known, in
     /// which case up to MaxPendingMessages will be buffered and processed when voxel servers are known.
@@ -28,8 +33,27 @@ public:
 
     void queueEraseEntityMessage(const EntityItemID& entityItemID);
 
+    /// Holds the motion of an entity until the next releaseMotionUpdates(), replacing any motion still held for it.
+    void queueMotionUpdate(const EntityMotionUpdate& update);
+
+    /// Packs the most urgent of the held motion updates into PacketTypeEntityMotionUpdate messages, as many as the
+    /// motion update bandwidth allows.  Updates that don't make it wait for the next release with a raised priority.
+    /// Call once per simulation frame.
+    void releaseMotionUpdates(const quint64& now);
+
+    void setMotionUpdateBandwidth(int bytesPerSecond) { _motionUpdateBandwidth = bytesPerSecond; }
+    int getMotionUpdateBandwidth() const { return _motionUpdateBandwidth; }
+
+    int getNumHeldMotionUpdates() const { return _heldMotionUpdates.size(); }
+
     // My server type is the model server
     virtual char getMyNodeType() const { return NodeType::EntityServer; }
     virtual void adjustEditPacketForClockSkew(PacketType type, unsigned char* editBuffer, size_t length, int clockSkew);
+
+private:
+    QHash<QUuid, EntityMotionUpdate> _heldMotionUpdates;
+    int _motionUpdateBandwidth; // bytes per second
+    float _motionUpdateBudget; // bytes we may still send
+    quint64 _lastMotionUpdateRelease;
 };
 #endif // hifi_EntityEditPacketSender_h
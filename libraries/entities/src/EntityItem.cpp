@@ -23,6 +23,7 @@
 #include "EntityTree.h"
 
 bool EntityItem::_sendPhysicsUpdates = true;
+bool EntityItem::_serverSimulatesPhysics = false;
 
 void EntityItem::initFromEntityItemID(const EntityItemID& entityItemID) {
     _id = entityItemID.id;
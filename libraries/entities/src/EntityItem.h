@@ -295,10 +295,14 @@ public:
     static void setSendPhysicsUpdates(bool value) { _sendPhysicsUpdates = value; }
     static bool getSendPhysicsUpdates() { return _sendPhysicsUpdates; }
 
+    /// set when the entity server runs its own physics, in which case local simulation is only a prediction
+    static void setServerSimulatesPhysics(bool value) { _serverSimulatesPhysics = value; }
+    static bool getServerSimulatesPhysics() { return _serverSimulatesPhysics; }
 
 protected:
 
     static bool _sendPhysicsUpdates;
+    static bool _serverSimulatesPhysics;
 
     virtual void initFromEntityItemID(const EntityItemID& entityItemID); // maybe useful to allow subclasses to init
     virtual void recalculateCollisionShape();
@@ -0,0 +1,147 @@
+//
+//  EntityMotionUpdate.cpp
+//  libraries/entities/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <string.h>
+
+#include <GLMHelpers.h>
+#include <UUID.h>
+
+#include "EntityMotionUpdate.h"
+
+// fixed point radix for the velocities: 1/64 m/sec steps up to 512 m/sec, 1/512 rad/sec steps up to 64 rad/sec
+const int VELOCITY_RADIX = 6;
+const int ANGULAR_VELOCITY_RADIX = 9;
+const float MAX_PACKED_VELOCITY = 511.0f;
+const float MAX_PACKED_ANGULAR_VELOCITY = 63.0f;
+
+// gravity goes in 1/64 m/sec^2 steps up to 512 m/sec^2
+const int GRAVITY_RADIX = 6;
+const float MAX_PACKED_GRAVITY = 511.0f;
+
+const int ENCODED_QUAT_SIZE = 8;
+const int ENCODED_FIXED_VEC3_SIZE = 3 * sizeof(int16_t);
+
+const int EntityMotionUpdate::ENCODED_SIZE = NUM_BYTES_RFC4122_UUID + sizeof(quint64) + sizeof(glm::vec3)
+        + ENCODED_QUAT_SIZE + 3 * ENCODED_FIXED_VEC3_SIZE;
+
+EntityMotionUpdate::EntityMotionUpdate() :
+    lastEdited(0),
+    rotation(),
+    velocity(0.0f),
+    angularVelocity(0.0f),
+    gravity(0.0f),
+    priority(0.0f) {
+}
+
+int EntityMotionUpdate::pack(unsigned char* buffer) const {
+    unsigned char* dataAt = buffer;
+
+    QByteArray encodedID = id.toRfc4122();
+    memcpy(dataAt, encodedID.constData(), NUM_BYTES_RFC4122_UUID);
+    dataAt += NUM_BYTES_RFC4122_UUID;
+
+    memcpy(dataAt, &lastEdited, sizeof(lastEdited));
+    dataAt += sizeof(lastEdited);
+
+    memcpy(dataAt, &position, sizeof(position));
+    dataAt += sizeof(position);
+
+    dataAt += packOrientationQuatToBytes(dataAt, rotation);
+    dataAt += packFloatVec3ToSignedTwoByteFixed(dataAt,
+            glm::clamp(velocity, -MAX_PACKED_VELOCITY, MAX_PACKED_VELOCITY), VELOCITY_RADIX);
+    dataAt += packFloatVec3ToSignedTwoByteFixed(dataAt,
+            glm::clamp(angularVelocity, -MAX_PACKED_ANGULAR_VELOCITY, MAX_PACKED_ANGULAR_VELOCITY), ANGULAR_VELOCITY_RADIX);
+    dataAt += packFloatVec3ToSignedTwoByteFixed(dataAt,
+            glm::clamp(gravity, -MAX_PACKED_GRAVITY, MAX_PACKED_GRAVITY), GRAVITY_RADIX);
+
+    return dataAt - buffer;
+}
+
+int EntityMotionUpdate::unpack(const unsigned char* buffer) {
+    const unsigned char* dataAt = buffer;
+
+    id = QUuid::fromRfc4122(QByteArray::fromRawData(reinterpret_cast<const char*>(dataAt), NUM_BYTES_RFC4122_UUID));
+    dataAt += NUM_BYTES_RFC4122_UUID;
+
+    memcpy(&lastEdited, dataAt, sizeof(lastEdited));
+    dataAt += sizeof(lastEdited);
+
+    memcpy(&position, dataAt, sizeof(position));
+    dataAt += sizeof(position);
+
+    dataAt += unpackOrientationQuatFromBytes(dataAt, rotation);
+    rotation = glm::normalize(rotation);
+    dataAt += unpackFloatVec3FromSignedTwoByteFixed(dataAt, velocity, VELOCITY_RADIX);
+    dataAt += unpackFloatVec3FromSignedTwoByteFixed(dataAt, angularVelocity, ANGULAR_VELOCITY_RADIX);
+    dataAt += unpackFloatVec3FromSignedTwoByteFixed(dataAt, gravity, GRAVITY_RADIX);
+    priority = 0.0f;
+
+    return dataAt - buffer;
+}
+
+int EntityMotionUpdate::packMessage(const QVector<EntityMotionUpdate>& updates, int start, unsigned char* buffer,
+        int maxLength, int& numPacked) {
+    numPacked = 0;
+    int maxNumPacked = (maxLength - (int)sizeof(quint16)) / ENCODED_SIZE;
+    if (maxNumPacked <= 0) {
+        return 0;
+    }
+    numPacked = glm::min(updates.size() - start, maxNumPacked);
+
+    unsigned char* dataAt = buffer;
+    quint16 count = (quint16)numPacked;
+    memcpy(dataAt, &count, sizeof(count));
+    dataAt += sizeof(count);
+    for (int i = 0; i < numPacked; ++i) {
+        dataAt += updates.at(start + i).pack(dataAt);
+    }
+    return dataAt - buffer;
+}
+
+int EntityMotionUpdate::unpackMessage(const unsigned char* buffer, int maxLength, QVector<EntityMotionUpdate>& updates) {
+    quint16 count = 0;
+    if (maxLength < (int)sizeof(count)) {
+        return maxLength;
+    }
+    memcpy(&count, buffer, sizeof(count));
+    int length = sizeof(count) + (int)count * ENCODED_SIZE;
+    if (length > maxLength) {
+        // truncated message, skip the rest of the packet rather than guess where the next message starts
+        return maxLength;
+    }
+
+    const unsigned char* dataAt = buffer + sizeof(count);
+    EntityMotionUpdate update;
+    for (int i = 0; i < count; ++i) {
+        dataAt += update.unpack(dataAt);
+        updates.push_back(update);
+    }
+    return length;
+}
+
+void EntityMotionUpdate::adjustMessageForClockSkew(unsigned char* buffer, int length, int clockSkew) {
+    quint16 count = 0;
+    if (length < (int)sizeof(count)) {
+        return;
+    }
+    memcpy(&count, buffer, sizeof(count));
+    if ((int)sizeof(count) + (int)count * ENCODED_SIZE > length) {
+        return;
+    }
+    unsigned char* dataAt = buffer + sizeof(count) + NUM_BYTES_RFC4122_UUID;
+    for (int i = 0; i < count; ++i) {
+        quint64 lastEdited;
+        memcpy(&lastEdited, dataAt, sizeof(lastEdited));
+        lastEdited += clockSkew;
+        memcpy(dataAt, &lastEdited, sizeof(lastEdited));
+        dataAt += ENCODED_SIZE;
+    }
+}
@@ -0,0 +1,61 @@
+//
+//  EntityMotionUpdate.h
+//  libraries/entities/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityMotionUpdate_h
+#define hifi_EntityMotionUpdate_h
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <QUuid>
+#include <QVector>
+
+/// The motion of one entity as reported by a physics simulation, many of which are packed into a single
+/// PacketTypeEntityMotionUpdate edit message.  Velocities, gravity and rotation are quantized on the wire.
+class EntityMotionUpdate {
+public:
+    EntityMotionUpdate();
+
+    QUuid id;
+    quint64 lastEdited; // usecs, in the time of whoever holds the update
+    glm::vec3 position; // meters
+    glm::quat rotation;
+    glm::vec3 velocity; // meters/sec
+    glm::vec3 angularVelocity; // radians/sec
+    glm::vec3 gravity; // meters/sec^2
+    float priority; // not sent, larger is more urgent
+
+    /// number of bytes one update takes in a message
+    static const int ENCODED_SIZE;
+
+    /// \return number of bytes written
+    int pack(unsigned char* buffer) const;
+
+    /// \return number of bytes read
+    int unpack(const unsigned char* buffer);
+
+    /// \param updates the updates to pack, in order
+    /// \param start index of first update to pack
+    /// \param maxLength size of buffer
+    /// \param[out] numPacked number of updates packed
+    /// \return number of bytes written
+    static int packMessage(const QVector<EntityMotionUpdate>& updates, int start, unsigned char* buffer, int maxLength,
+            int& numPacked);
+
+    /// \param[out] updates where to append the unpacked updates
+    /// \return number of bytes read, which is the whole of maxLength when the message is malformed
+    static int unpackMessage(const unsigned char* buffer, int maxLength, QVector<EntityMotionUpdate>& updates);
+
+    /// Shifts the lastEdited times of a packed message into the time of the server it is going to.
+    static void adjustMessageForClockSkew(unsigned char* buffer, int length, int clockSkew);
+};
+
+#endif // hifi_EntityMotionUpdate_h
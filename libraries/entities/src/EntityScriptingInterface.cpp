@@ -254,6 +254,14 @@ bool EntityScriptingInterface::getSendPhysicsUpdates() const {
     return EntityItem::getSendPhysicsUpdates();
 }
 
+void EntityScriptingInterface::setPhysicsUpdateBandwidth(int bytesPerSecond) {
+    getEntityPacketSender()->setMotionUpdateBandwidth(bytesPerSecond);
+}
+
+int EntityScriptingInterface::getPhysicsUpdateBandwidth() const {
+    return getEntityPacketSender()->getMotionUpdateBandwidth();
+}
+
 
 RayToEntityIntersectionResult::RayToEntityIntersectionResult() : 
     intersects(false), 
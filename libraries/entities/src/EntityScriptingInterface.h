@@ -102,6 +102,9 @@ public slots:
     Q_INVOKABLE void setSendPhysicsUpdates(bool value);
     Q_INVOKABLE bool getSendPhysicsUpdates() const;
 
+    Q_INVOKABLE void setPhysicsUpdateBandwidth(int bytesPerSecond);
+    Q_INVOKABLE int getPhysicsUpdateBandwidth() const;
+
     Q_INVOKABLE void dumpTree() const;
 
 signals:
@@ -15,6 +15,7 @@
 #include "EntitySimulation.h"
 
 #include "AddEntityOperator.h"
+#include "EntityMotionUpdate.h"
 #include "MovingEntitiesOperator.h"
 #include "UpdateEntityOperator.h"
 
@@ -55,6 +56,7 @@ bool EntityTree::handlesEditPacketType(PacketType packetType) const {
     switch (packetType) {
         case PacketTypeEntityAddOrEdit:
         case PacketTypeEntityErase:
+        case PacketTypeEntityMotionUpdate:
             return true;
         default:
             return false;
@@ -604,6 +606,11 @@ int EntityTree::processEditPacketData(PacketType packetType, const unsigned char
             break;
         }
 
+        case PacketTypeEntityMotionUpdate: {
+            processedBytes = processMotionUpdateMessage(editData, maxLength);
+            break;
+        }
+
         default:
             processedBytes = 0;
             break;
@@ -611,6 +618,70 @@ int EntityTree::processEditPacketData(PacketType packetType, const unsigned char
     return processedBytes;
 }
 
+int EntityTree::processMotionUpdateMessage(const unsigned char* editData, int maxLength) {
+    QVector<EntityMotionUpdate> updates;
+    int processedBytes = EntityMotionUpdate::unpackMessage(editData, maxLength, updates);
+
+    quint64 now = usecTimestampNow();
+    MovingEntitiesOperator moveOperator(this);
+    QVector<EntityItem*> changedEntities;
+    foreach (const EntityMotionUpdate& update, updates) {
+        EntityItem* entity = findEntityByEntityItemID(EntityItemID(update.id));
+        if (!entity || entity->getLocked()) {
+            // unknown entities are expected, the sender packs motion for every entity server in one message
+            continue;
+        }
+        if (update.lastEdited < entity->getLastEdited()) {
+            // the entity was edited after this motion was sampled
+            continue;
+        }
+        // the update methods only assign values that changed enough to matter, so compare the values themselves: the
+        // dirty flags may still be set from an earlier update that the simulation hasn't handled yet
+        glm::vec3 oldPosition = entity->getPosition();
+        glm::quat oldRotation = entity->getRotation();
+        glm::vec3 oldVelocity = entity->getVelocity();
+        glm::vec3 oldAngularVelocity = entity->getAngularVelocity();
+        glm::vec3 oldGravity = entity->getGravity();
+        entity->updatePositionInMeters(update.position);
+        entity->updateRotation(update.rotation);
+        entity->updateVelocityInMeters(update.velocity);
+        // DANGER! EntityItem stores angularVelocity in degrees/sec!!!
+        entity->updateAngularVelocity(glm::degrees(update.angularVelocity));
+        entity->updateGravityInMeters(update.gravity);
+        if (entity->getPosition() != oldPosition || entity->getRotation() != oldRotation ||
+                entity->getVelocity() != oldVelocity || entity->getAngularVelocity() != oldAngularVelocity ||
+                entity->getGravity() != oldGravity) {
+            entity->setLastEdited(glm::min(update.lastEdited, now));
+            entity->setLastSimulated(now);
+            entity->markAsChangedOnServer();
+            moveOperator.addEntityToUpdateList(entity, entity->getMaximumAACube());
+            changedEntities.push_back(entity);
+        }
+    }
+
+    // one recursion moves and marks every entity in the message instead of one UpdateEntityOperator per entity
+    if (moveOperator.hasMovingEntities()) {
+        recurseTreeWithOperator(&moveOperator);
+        _isDirty = true;
+    }
+
+    if (_simulation) {
+        _simulation->lock();
+        foreach (EntityItem* entity, changedEntities) {
+            if (entity->getDirtyFlags() & DIRTY_SIMULATION_FLAGS) {
+                _simulation->entityChanged(entity);
+            }
+        }
+        _simulation->unlock();
+    } else {
+        // normally the _simulation clears ALL updateFlags, but since there is none we do it explicitly
+        foreach (EntityItem* entity, changedEntities) {
+            entity->clearDirtyFlags();
+        }
+    }
+    return processedBytes;
+}
+
 
 void EntityTree::notifyNewlyCreatedEntity(const EntityItem& newEntity, const SharedNodePointer& senderNode) {
     _newlyCreatedHooksLock.lockForRead();
@@ -126,6 +126,10 @@ public:
 
     int processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
     int processEraseMessageDetails(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
+
+    /// Applies a PacketTypeEntityMotionUpdate message: all of its entities are moved with one pass over the tree
+    /// \return number of bytes of editData consumed
+    int processMotionUpdateMessage(const unsigned char* editData, int maxLength);
     void handleAddEntityResponse(const QByteArray& packet);
     
     EntityItemFBXService* getFBXService() const { return _fbxService; }
@@ -213,15 +213,14 @@ QVector<glm::quat> ModelEntityItem::getAnimationFrame() {
     QVector<glm::quat> frameData;
     if (hasAnimation() && _jointMappingCompleted) {
         Animation* myAnimation = getAnimation(_animationURL);
-        QVector<FBXAnimationFrame> frames = myAnimation->getFrames();
-        int frameCount = frames.size();
+        int frameCount = myAnimation->getFrameCount();
         if (frameCount > 0) {
             int animationFrameIndex = (int)(glm::floor(getAnimationFrameIndex())) % frameCount;
             if (animationFrameIndex < 0 || animationFrameIndex > frameCount) {
                 animationFrameIndex = 0;
             }
             
-            QVector<glm::quat> rotations = frames[animationFrameIndex].rotations;
+            QVector<glm::quat> rotations = myAnimation->getPose(animationFrameIndex);
 
             frameData.resize(_jointMapping.size());
             for (int j = 0; j < _jointMapping.size(); j++) {
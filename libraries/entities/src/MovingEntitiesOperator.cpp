@@ -50,6 +50,14 @@ MovingEntitiesOperator::~MovingEntitiesOperator() {
 
 
 void MovingEntitiesOperator::addEntityToMoveList(EntityItem* entity, const AACube& newCube) {
+    addEntity(entity, newCube, false);
+}
+
+void MovingEntitiesOperator::addEntityToUpdateList(EntityItem* entity, const AACube& newCube) {
+    addEntity(entity, newCube, true);
+}
+
+void MovingEntitiesOperator::addEntity(EntityItem* entity, const AACube& newCube, bool markInPlace) {
     EntityTreeElement* oldContainingElement = _tree->getContainingElement(entity->getEntityItemID());
     AABox newCubeClamped = newCube.clamp(0.0f, 1.0f);
 
@@ -73,8 +81,9 @@ void MovingEntitiesOperator::addEntityToMoveList(EntityItem* entity, const AACub
     }
 
     // If the original containing element is the best fit for the requested newCube locations then
-    // we don't actually need to add the entity for moving and we can short circuit all this work
-    if (!oldContainingElement->bestFitBounds(newCubeClamped)) {
+    // we don't actually need to add the entity for moving and we can short circuit all this work,
+    // unless the path to the entity has to be marked as changed anyway
+    if (markInPlace || !oldContainingElement->bestFitBounds(newCubeClamped)) {
         // check our tree, to determine if this entity is known
         EntityToMoveDetails details;
         details.oldContainingElement = oldContainingElement;
@@ -38,6 +38,11 @@ public:
     ~MovingEntitiesOperator();
 
     void addEntityToMoveList(EntityItem* entity, const AACube& newCube);
+
+    /// Same as addEntityToMoveList() but the path to the entity is marked as changed even when it stays in its
+    /// element, so that its new state goes out with the octree stream
+    void addEntityToUpdateList(EntityItem* entity, const AACube& newCube);
+
     virtual bool preRecursion(OctreeElement* element);
     virtual bool postRecursion(OctreeElement* element);
     virtual OctreeElement* possiblyCreateChildAt(OctreeElement* element, int childIndex);
@@ -50,6 +55,7 @@ private:
     int _foundNewCount;
     int _lookingCount;
     bool shouldRecurseSubTree(OctreeElement* element);
+    void addEntity(EntityItem* entity, const AACube& newCube, bool markInPlace);
     
     bool _wantDebug;
 };
@@ -0,0 +1,412 @@
+//
+//  BakedFBX.cpp
+//  libraries/fbx/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cstring>
+#include <type_traits>
+
+#include <QFile>
+#include <QStringList>
+#include <QtDebug>
+
+#include <ResourceCache.h>
+
+#include "BakedFBX.h"
+
+/// Identifies baked geometry ("HFBG" when read as little-endian bytes).
+static const quint32 BAKED_FBX_MAGIC = 0x47424648;
+
+/// Must be incremented whenever the layout of the baked data or of any structure stored as a raw block changes.
+static const quint32 BAKED_FBX_VERSION = 1;
+
+/// The alignment of raw data blocks relative to the start of the baked data.
+static const int BAKED_FBX_ALIGNMENT = 16;
+
+/// Types that are stored as raw bytes (individually and in bulk, when in vectors).
+template<class T> class IsBlittable {
+public:
+    static const bool value = std::is_arithmetic<T>::value || std::is_enum<T>::value;
+};
+template<> class IsBlittable<glm::vec2> { public: static const bool value = true; };
+template<> class IsBlittable<glm::vec3> { public: static const bool value = true; };
+template<> class IsBlittable<glm::vec4> { public: static const bool value = true; };
+template<> class IsBlittable<glm::quat> { public: static const bool value = true; };
+template<> class IsBlittable<glm::mat4> { public: static const bool value = true; };
+template<> class IsBlittable<Extents> { public: static const bool value = true; };
+template<> class IsBlittable<FBXCluster> { public: static const bool value = true; };
+
+class BakeWriter;
+class BakeReader;
+
+// each structure is described once, by a template that either writes or reads its fields in order
+template<class S> void bake(S& stream, FBXBlendshape& blendshape);
+template<class S> void bake(S& stream, FBXJoint& joint);
+template<class S> void bake(S& stream, FBXTexture& texture);
+template<class S> void bake(S& stream, FBXMeshPart& part);
+template<class S> void bake(S& stream, FBXMesh& mesh);
+template<class S> void bake(S& stream, FBXAnimationFrame& frame);
+template<class S> void bake(S& stream, FBXAttachment& attachment);
+template<class S> void bake(S& stream, SittingPoint& point);
+template<class S> void bake(S& stream, FBXGeometry& geometry);
+void bake(BakeWriter& stream, Transform& transform);
+void bake(BakeReader& stream, Transform& transform);
+void bake(BakeWriter& stream, QUrl& url);
+void bake(BakeReader& stream, QUrl& url);
+void bakeMaterial(BakeWriter& stream, FBXMeshPart& part);
+void bakeMaterial(BakeReader& stream, FBXMeshPart& part);
+
+/// Appends baked data to a byte array.
+class BakeWriter {
+public:
+
+    QByteArray data;
+
+    template<class T> BakeWriter& operator&(const T& value) {
+        write(value, std::integral_constant<bool, IsBlittable<T>::value>());
+        return *this;
+    }
+
+    template<class T> BakeWriter& operator&(const QVector<T>& vector) {
+        *this & vector.size();
+        writeArray(vector, std::integral_constant<bool, IsBlittable<T>::value>());
+        return *this;
+    }
+
+    template<class K, class V> BakeWriter& operator&(const QHash<K, V>& hash) {
+        *this & hash.size();
+        for (typename QHash<K, V>::const_iterator it = hash.constBegin(); it != hash.constEnd(); it++) {
+            *this & it.key() & it.value();
+        }
+        return *this;
+    }
+
+    BakeWriter& operator&(const QByteArray& bytes) {
+        if (bytes.isNull()) {
+            return *this & -1;
+        }
+        *this & bytes.size();
+        align();
+        data.append(bytes);
+        return *this;
+    }
+
+    BakeWriter& operator&(const QString& string) {
+        return *this & (string.isNull() ? QByteArray() : string.toUtf8());
+    }
+
+    void align() {
+        data.append(QByteArray((BAKED_FBX_ALIGNMENT - data.size() % BAKED_FBX_ALIGNMENT) % BAKED_FBX_ALIGNMENT, 0));
+    }
+
+private:
+
+    template<class T> void write(const T& value, std::true_type) {
+        data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<class T> void write(const T& value, std::false_type) {
+        bake(*this, const_cast<T&>(value));
+    }
+
+    template<class T> void writeArray(const QVector<T>& vector, std::true_type) {
+        align();
+        data.append(reinterpret_cast<const char*>(vector.constData()), vector.size() * sizeof(T));
+    }
+
+    template<class T> void writeArray(const QVector<T>& vector, std::false_type) {
+        foreach (const T& element, vector) {
+            *this & element;
+        }
+    }
+};
+
+/// Reads baked data from a block of memory.
+class BakeReader {
+public:
+
+    /// Materials restored so far, by ID, so that parts that shared a material before baking share it again.
+    QHash<QString, model::MaterialPointer> materials;
+
+    BakeReader(const char* data, qint64 size) : _data(data), _size(size), _offset(0) { }
+
+    template<class T> BakeReader& operator&(T& value) {
+        read(value, std::integral_constant<bool, IsBlittable<T>::value>());
+        return *this;
+    }
+
+    template<class T> BakeReader& operator&(QVector<T>& vector) {
+        int size = readCount(IsBlittable<T>::value ? sizeof(T) : 1);
+        vector.resize(size);
+        readArray(vector, std::integral_constant<bool, IsBlittable<T>::value>());
+        return *this;
+    }
+
+    template<class K, class V> BakeReader& operator&(QHash<K, V>& hash) {
+        int size = readCount(1);
+        hash.clear();
+        hash.reserve(size);
+        for (int i = 0; i < size; i++) {
+            K key;
+            V value;
+            *this & key & value;
+            hash.insert(key, value);
+        }
+        return *this;
+    }
+
+    BakeReader& operator&(QByteArray& bytes) {
+        int size;
+        *this & size;
+        if (size < 0) {
+            bytes = QByteArray();
+            return *this;
+        }
+        align();
+        bytes = QByteArray(take(size), size);
+        return *this;
+    }
+
+    BakeReader& operator&(QString& string) {
+        QByteArray bytes;
+        *this & bytes;
+        string = bytes.isNull() ? QString() : QString::fromUtf8(bytes);
+        return *this;
+    }
+
+    void align() {
+        take((BAKED_FBX_ALIGNMENT - _offset % BAKED_FBX_ALIGNMENT) % BAKED_FBX_ALIGNMENT);
+    }
+
+    const char* take(qint64 bytes) {
+        if (bytes < 0 || bytes > _size - _offset) {
+            throw QString("Baked geometry is truncated.");
+        }
+        const char* data = _data + _offset;
+        _offset += bytes;
+        return data;
+    }
+
+private:
+
+    /// Reads an element count, checking it against the remaining data so that corrupt counts fail cleanly rather than
+    /// allocating huge vectors.
+    int readCount(int minimumElementSize) {
+        int count;
+        *this & count;
+        if (count < 0 || count > (_size - _offset) / minimumElementSize) {
+            throw QString("Baked geometry is truncated.");
+        }
+        return count;
+    }
+
+    template<class T> void read(T& value, std::true_type) {
+        memcpy(&value, take(sizeof(T)), sizeof(T));
+    }
+
+    template<class T> void read(T& value, std::false_type) {
+        bake(*this, value);
+    }
+
+    template<class T> void readArray(QVector<T>& vector, std::true_type) {
+        align();
+        qint64 bytes = vector.size() * sizeof(T);
+        memcpy(vector.data(), take(bytes), bytes);
+    }
+
+    template<class T> void readArray(QVector<T>& vector, std::false_type) {
+        for (int i = 0; i < vector.size(); i++) {
+            *this & vector[i];
+        }
+    }
+
+    const char* _data;
+    qint64 _size;
+    qint64 _offset;
+};
+
+template<class S> void bake(S& stream, FBXBlendshape& blendshape) {
+    stream & blendshape.indices & blendshape.vertices & blendshape.normals;
+}
+
+template<class S> void bake(S& stream, FBXJoint& joint) {
+    stream & joint.isFree & joint.freeLineage & joint.parentIndex & joint.distanceToParent & joint.boneRadius &
+        joint.translation & joint.preTransform & joint.preRotation & joint.rotation & joint.postRotation &
+        joint.postTransform & joint.transform & joint.rotationMin & joint.rotationMax & joint.inverseDefaultRotation &
+        joint.inverseBindRotation & joint.bindTransform & joint.name & joint.shapePosition & joint.shapeRotation &
+        joint.shapeType & joint.isSkeletonJoint;
+}
+
+template<class S> void bake(S& stream, FBXTexture& texture) {
+    stream & texture.name & texture.filename & texture.content & texture.transform & texture.texcoordSet &
+        texture.texcoordSetName;
+}
+
+template<class S> void bake(S& stream, FBXMeshPart& part) {
+    stream & part.quadIndices & part.triangleIndices & part.diffuseColor & part.specularColor & part.emissiveColor &
+        part.emissiveParams & part.shininess & part.opacity & part.diffuseTexture & part.normalTexture &
+        part.specularTexture & part.emissiveTexture & part.materialID;
+    bakeMaterial(stream, part);
+}
+
+template<class S> void bake(S& stream, FBXMesh& mesh) {
+    stream & mesh.parts & mesh.vertices & mesh.normals & mesh.tangents & mesh.colors & mesh.texCoords & mesh.texCoords1 &
+        mesh.clusterIndices & mesh.clusterWeights & mesh.clusters & mesh.meshExtents & mesh.modelTransform &
+        mesh.isEye & mesh.blendshapes;
+}
+
+template<class S> void bake(S& stream, FBXAnimationFrame& frame) {
+    stream & frame.rotations;
+}
+
+template<class S> void bake(S& stream, FBXAttachment& attachment) {
+    stream & attachment.jointIndex & attachment.url & attachment.translation & attachment.rotation & attachment.scale;
+}
+
+template<class S> void bake(S& stream, SittingPoint& point) {
+    stream & point.name & point.position & point.rotation;
+}
+
+template<class S> void bake(S& stream, FBXGeometry& geometry) {
+    stream & geometry.author & geometry.applicationName & geometry.joints & geometry.jointIndices &
+        geometry.hasSkeletonJoints & geometry.meshes & geometry.offset & geometry.leftEyeJointIndex &
+        geometry.rightEyeJointIndex & geometry.neckJointIndex & geometry.rootJointIndex & geometry.leanJointIndex &
+        geometry.headJointIndex & geometry.leftHandJointIndex & geometry.rightHandJointIndex &
+        geometry.leftToeJointIndex & geometry.rightToeJointIndex & geometry.humanIKJointIndices &
+        geometry.palmDirection & geometry.sittingPoints & geometry.neckPivot & geometry.bindExtents &
+        geometry.meshExtents & geometry.animationFrames & geometry.attachments & geometry.meshIndicesToModelNames;
+}
+
+void bake(BakeWriter& stream, Transform& transform) {
+    stream & transform.getTranslation() & transform.getRotation() & transform.getScale();
+}
+
+void bake(BakeReader& stream, Transform& transform) {
+    glm::vec3 translation, scale;
+    glm::quat rotation;
+    stream & translation & rotation & scale;
+
+    // the setters maintain the flags that isIdentity and friends depend on
+    transform.setTranslation(translation);
+    transform.setRotation(rotation);
+    transform.setScale(scale);
+}
+
+void bake(BakeWriter& stream, QUrl& url) {
+    stream & url.toString();
+}
+
+void bake(BakeReader& stream, QUrl& url) {
+    QString string;
+    stream & string;
+    url = QUrl(string);
+}
+
+void bakeMaterial(BakeWriter& stream, FBXMeshPart& part) {
+    stream & !part._material.isNull();
+}
+
+void bakeMaterial(BakeReader& stream, FBXMeshPart& part) {
+    bool hasMaterial;
+    stream & hasMaterial;
+    if (!hasMaterial) {
+        return;
+    }
+    // the reader copies the material's properties into the part, so we can recreate the material from those
+    model::MaterialPointer& material = stream.materials[part.materialID];
+    if (!material) {
+        material = model::MaterialPointer(new model::Material());
+        material->setEmissive(part.emissiveColor);
+        material->setDiffuse(part.diffuseColor);
+        material->setSpecular(part.specularColor);
+        material->setShininess(part.shininess);
+        material->setOpacity(part.opacity);
+    }
+    part._material = material;
+}
+
+QByteArray bakeFBX(const FBXGeometry& geometry) {
+    BakeWriter writer;
+    writer & BAKED_FBX_MAGIC & BAKED_FBX_VERSION & geometry;
+    return writer.data;
+}
+
+FBXGeometry readBakedFBX(const char* data, qint64 size) {
+    BakeReader reader(data, size);
+    quint32 magic, version;
+    reader & magic & version;
+    if (magic != BAKED_FBX_MAGIC) {
+        throw QString("Not baked geometry.");
+    }
+    if (version != BAKED_FBX_VERSION) {
+        throw QString("Unsupported baked geometry version: %1").arg(version);
+    }
+    FBXGeometry geometry;
+    reader & geometry;
+    return geometry;
+}
+
+/// Appends a mapping value in a form that doesn't depend on QHash ordering, which varies between runs.
+static void appendMapping(QByteArray& parameters, const QVariant& value) {
+    if (value.type() == QVariant::Hash) {
+        QVariantHash mapping = value.toHash();
+        QStringList keys = mapping.keys();
+        keys.sort();
+        parameters.append("{");
+        foreach (const QString& key, keys) {
+            parameters.append(key.toUtf8());
+            parameters.append("=");
+            appendMapping(parameters, mapping.value(key));
+        }
+        parameters.append("}");
+
+    } else if (value.type() == QVariant::List) {
+        parameters.append("[");
+        foreach (const QVariant& element, value.toList()) {
+            appendMapping(parameters, element);
+        }
+        parameters.append("]");
+
+    } else {
+        parameters.append(value.toString().toUtf8());
+        parameters.append(";");
+    }
+}
+
+FBXGeometry readFBXCached(const QByteArray& model, const QVariantHash& mapping, bool loadLightmaps, float lightmapLevel) {
+    QByteArray parameters;
+    parameters.append(reinterpret_cast<const char*>(&BAKED_FBX_VERSION), sizeof(BAKED_FBX_VERSION));
+    parameters.append(reinterpret_cast<const char*>(&loadLightmaps), sizeof(loadLightmaps));
+    parameters.append(reinterpret_cast<const char*>(&lightmapLevel), sizeof(lightmapLevel));
+    appendMapping(parameters, mapping);
+    ProcessedResourceCache& cache = ProcessedResourceCache::getInstance();
+    QString key = ProcessedResourceCache::getKey("geometry", model, parameters);
+
+    QString path = cache.find(key);
+    if (!path.isEmpty()) {
+        QFile file(path);
+        const char* data = NULL;
+        if (file.open(QIODevice::ReadOnly) && (data = reinterpret_cast<const char*>(file.map(0, file.size())))) {
+            try {
+                FBXGeometry geometry = readBakedFBX(data, file.size());
+                file.unmap((uchar*)data);
+                return geometry;
+
+            } catch (const QString& error) {
+                qDebug() << "Discarding baked geometry" << path << ":" << error;
+                file.unmap((uchar*)data);
+            }
+        }
+        file.close();
+        cache.remove(key);
+    }
+    FBXGeometry geometry = readFBX(model, mapping, loadLightmaps, lightmapLevel);
+    cache.insert(key, bakeFBX(geometry));
+    return geometry;
+}
@@ -0,0 +1,31 @@
+//
+//  BakedFBX.h
+//  libraries/fbx/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BakedFBX_h
+#define hifi_BakedFBX_h
+
+#include "FBXReader.h"
+
+/// Writes geometry in the flat, versioned baked format.  Vertex, index, and other plain data arrays are stored as raw,
+/// aligned blocks, so that reading them back is a matter of bulk copies rather than parsing.
+QByteArray bakeFBX(const FBXGeometry& geometry);
+
+/// Reads geometry written by bakeFBX.
+/// \exception QString if the data is truncated or was written by a different version
+FBXGeometry readBakedFBX(const char* data, qint64 size);
+
+/// Reads FBX geometry, using the baked copy in the processed resource cache if the same model has been read with the same
+/// mapping and parameters before.  Otherwise, reads the model with readFBX and adds the baked result to the cache.
+/// \exception QString if an error occurs in parsing
+FBXGeometry readFBXCached(const QByteArray& model, const QVariantHash& mapping,
+    bool loadLightmaps = true, float lightmapLevel = 1.0f);
+
+#endif // hifi_BakedFBX_h
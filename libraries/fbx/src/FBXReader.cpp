@@ -9,14 +9,22 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <type_traits>
+#include <QAtomicInt>
 #include <QBuffer>
-#include <QDataStream>
+#include <QFile>
 #include <QIODevice>
+#include <QRunnable>
+#include <QSemaphore>
 #include <QStringList>
 #include <QTextStream>
+#include <QThreadPool>
 #include <QtDebug>
-#include <QtEndian>
+
+#include <zlib.h>
 
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/quaternion.hpp>
@@ -136,156 +144,287 @@ static int fbxGeometryMetaTypeId = qRegisterMetaType<FBXGeometry>();
 static int fbxAnimationFrameMetaTypeId = qRegisterMetaType<FBXAnimationFrame>();
 static int fbxAnimationFrameVectorMetaTypeId = qRegisterMetaType<QVector<FBXAnimationFrame> >();
 
-template<class T> int streamSize() {
-    return sizeof(T);
+/// A compressed array whose storage was allocated while parsing, to be inflated once the structure has been read.
+class ArrayInflation {
+public:
+    const char* compressed;
+    quint32 compressedLength;
+    char* destination;
+    quint32 length;
+    int elementSize;
+    bool isBool;
+
+    void inflate() const;
+};
+
+/// Converts an array of little-endian values to host byte order in place.
+static void fromLittleEndian(char* data, quint32 length, int elementSize) {
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    for (char* element = data, *end = data + length; element != end; element += elementSize) {
+        std::reverse(element, element + elementSize);
+    }
+#endif
 }
 
-template<bool> int streamSize() {
-    return 1;
+/// Makes sure that the bytes of an array of bools hold only zero or one, as QDataStream would have read them.
+static void normalizeBools(char* data, quint32 length) {
+    for (char* value = data, *end = data + length; value != end; value++) {
+        *value = (*value != 0);
+    }
 }
 
-template<class T> QVariant readBinaryArray(QDataStream& in, int& position) {
-    quint32 arrayLength;
-    quint32 encoding;
-    quint32 compressedLength;
+void ArrayInflation::inflate() const {
+    uLongf inflatedLength = length;
+    int result = uncompress((Bytef*)destination, &inflatedLength, (const Bytef*)compressed, compressedLength);
+    if (result != Z_OK && result != Z_BUF_ERROR) {
+        // corrupt data reads as zeros
+        memset(destination, 0, length);
+        return;
+    }
+    fromLittleEndian(destination, length, elementSize);
+    if (isBool) {
+        normalizeBools(destination, length);
+    }
+}
 
-    in >> arrayLength;
-    in >> encoding;
-    in >> compressedLength;
-    position += sizeof(quint32) * 3;
+static bool isLargerInflation(const ArrayInflation& first, const ArrayInflation& second) {
+    return first.compressedLength > second.compressedLength;
+}
 
-    QVector<T> values;
-    const unsigned int DEFLATE_ENCODING = 1;
-    if (encoding == DEFLATE_ENCODING) {
-        // preface encoded data with uncompressed length
-        QByteArray compressed(sizeof(quint32) + compressedLength, 0);
-        *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-        in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-        position += compressedLength;
-        QByteArray uncompressed = qUncompress(compressed);
-        QDataStream uncompressedIn(uncompressed);
-        uncompressedIn.setByteOrder(QDataStream::LittleEndian);
-        uncompressedIn.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
-        for (quint32 i = 0; i < arrayLength; i++) {
-            T value;
-            uncompressedIn >> value;
-            values.append(value);
-        }
-    } else {
-        for (quint32 i = 0; i < arrayLength; i++) {
-            T value;
-            in >> value;
-            position += streamSize<T>();
-            values.append(value);
+/// Reads binary FBX records directly from a block of memory into typed properties.  Records that extractFBXGeometry never
+/// looks at are skipped without being parsed, and compressed arrays are inflated in parallel after the structure is read.
+class BinaryFBXParser {
+public:
+
+    BinaryFBXParser(const char* data, qint64 size);
+
+    FBXNode parse();
+
+    void inflateNextArrays();
+
+private:
+
+    template<class T> T read();
+    const char* take(qint64 bytes);
+
+    bool parseNode(FBXNode& parent, int depth);
+    QVariant parseProperty();
+    template<class T> QVariant parseArray();
+
+    void inflateArrays();
+
+    const char* _data;
+    qint64 _size;
+    qint64 _offset;
+
+    QVector<ArrayInflation> _inflations;
+    QAtomicInt _nextInflation;
+};
+
+/// Runs alongside the parsing thread to inflate the parser's compressed arrays.
+class ArrayInflater : public QRunnable {
+public:
+
+    ArrayInflater(BinaryFBXParser* parser, QSemaphore* finished) : _parser(parser), _finished(finished) { }
+
+    virtual void run() {
+        _parser->inflateNextArrays();
+        _finished->release();
+    }
+
+private:
+
+    BinaryFBXParser* _parser;
+    QSemaphore* _finished;
+};
+
+BinaryFBXParser::BinaryFBXParser(const char* data, qint64 size) :
+    _data(data),
+    _size(size),
+    _offset(0) {
+}
+
+FBXNode BinaryFBXParser::parse() {
+    // see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
+    // of the FBX binary format
+
+    // skip the rest of the header
+    const int HEADER_SIZE = 27;
+    take(HEADER_SIZE);
+
+    // parse the top-level node
+    FBXNode top;
+    while (_offset < _size && parseNode(top, 0));
+
+    inflateArrays();
+    return top;
+}
+
+void BinaryFBXParser::inflateNextArrays() {
+    for (int index; (index = _nextInflation.fetchAndAddOrdered(1)) < _inflations.size(); ) {
+        _inflations.at(index).inflate();
+    }
+}
+
+template<class T> T BinaryFBXParser::read() {
+    T value;
+    memcpy(&value, take(sizeof(T)), sizeof(T));
+    fromLittleEndian(reinterpret_cast<char*>(&value), sizeof(T), sizeof(T));
+    return value;
+}
+
+const char* BinaryFBXParser::take(qint64 bytes) {
+    if (bytes < 0) {
+        throw QString("Invalid FBX length.");
+    }
+    if (bytes > _size - _offset) {
+        throw QString("FBX file is truncated.");
+    }
+    const char* data = _data + _offset;
+    _offset += bytes;
+    return data;
+}
+
+/// Checks whether extractFBXGeometry uses nodes with the given name at the given depth (under the given parent).
+static bool isExtractedNode(int depth, const QByteArray& parentName, const QByteArray& name) {
+    if (depth == 0) {
+        return name == "FBXHeaderExtension" || name == "GlobalSettings" || name == "Objects" || name == "Connections";
+    }
+    if (depth == 1 && parentName == "Objects") {
+        return name == "Geometry" || name == "Model" || name == "Texture" || name == "Video" || name == "Material" ||
+            name == "NodeAttribute" || name == "Deformer" || name == "AnimationCurve";
+    }
+    return true;
+}
+
+bool BinaryFBXParser::parseNode(FBXNode& parent, int depth) {
+    qint32 endOffset = read<qint32>();
+    quint32 propertyCount = read<quint32>();
+    read<quint32>(); // property list length
+    quint8 nameLength = read<quint8>();
+
+    const int MIN_VALID_OFFSET = 40;
+    if (endOffset < MIN_VALID_OFFSET || nameLength == 0) {
+        // a null record terminates the list
+        return false;
+    }
+    FBXNode node;
+    node.name = QByteArray(take(nameLength), nameLength);
+
+    if (!isExtractedNode(depth, parent.name, node.name)) {
+        if (endOffset < _offset || endOffset > _size) {
+            throw QString("Invalid FBX node end offset.");
         }
+        take(endOffset - _offset);
+        return true;
     }
-    return QVariant::fromValue(values);
+    for (quint32 i = 0; i < propertyCount; i++) {
+        node.properties.append(parseProperty());
+    }
+    while (endOffset > _offset && parseNode(node, depth + 1));
+
+    parent.children.append(node);
+    return true;
 }
 
-QVariant parseBinaryFBXProperty(QDataStream& in, int& position) {
-    char ch;
-    in.device()->getChar(&ch);
-    position++;
+QVariant BinaryFBXParser::parseProperty() {
+    char ch = read<char>();
     switch (ch) {
-        case 'Y': {
-            qint16 value;
-            in >> value;
-            position += sizeof(qint16);
-            return QVariant::fromValue(value);
-        }
-        case 'C': {
-            bool value;
-            in >> value;
-            position++;
-            return QVariant::fromValue(value);
-        }
-        case 'I': {
-            qint32 value;
-            in >> value;
-            position += sizeof(qint32);
-            return QVariant::fromValue(value);
-        }
-        case 'F': {
-            float value;
-            in >> value;
-            position += sizeof(float);
-            return QVariant::fromValue(value);
-        }
-        case 'D': {
-            double value;
-            in >> value;
-            position += sizeof(double);
-            return QVariant::fromValue(value);
-        }
-        case 'L': {
-            qint64 value;
-            in >> value;
-            position += sizeof(qint64);
-            return QVariant::fromValue(value);
-        }
-        case 'f': {
-            return readBinaryArray<float>(in, position);
-        }
-        case 'd': {
-            return readBinaryArray<double>(in, position);
-        }
-        case 'l': {
-            return readBinaryArray<qint64>(in, position);
-        }
-        case 'i': {
-            return readBinaryArray<qint32>(in, position);
-        }
-        case 'b': {
-            return readBinaryArray<bool>(in, position);
-        }
+        case 'Y':
+            return QVariant::fromValue(read<qint16>());
+
+        case 'C':
+            return QVariant::fromValue(read<quint8>() != 0);
+
+        case 'I':
+            return QVariant::fromValue(read<qint32>());
+
+        case 'F':
+            return QVariant::fromValue(read<float>());
+
+        case 'D':
+            return QVariant::fromValue(read<double>());
+
+        case 'L':
+            return QVariant::fromValue(read<qint64>());
+
+        case 'f':
+            return parseArray<float>();
+
+        case 'd':
+            return parseArray<double>();
+
+        case 'l':
+            return parseArray<qint64>();
+
+        case 'i':
+            return parseArray<qint32>();
+
+        case 'b':
+            return parseArray<bool>();
+
         case 'S':
         case 'R': {
-            quint32 length;
-            in >> length;
-            position += sizeof(quint32) + length;
-            return QVariant::fromValue(in.device()->read(length));
+            quint32 length = read<quint32>();
+            return QVariant::fromValue(QByteArray(take(length), length));
         }
         default:
             throw QString("Unknown property type: ") + ch;
     }
 }
 
-FBXNode parseBinaryFBXNode(QDataStream& in, int& position) {
-    qint32 endOffset;
-    quint32 propertyCount;
-    quint32 propertyListLength;
-    quint8 nameLength;
+template<class T> QVariant BinaryFBXParser::parseArray() {
+    quint32 arrayLength = read<quint32>();
+    quint32 encoding = read<quint32>();
+    quint32 compressedLength = read<quint32>();
 
-    in >> endOffset;
-    in >> propertyCount;
-    in >> propertyListLength;
-    in >> nameLength;
-    position += sizeof(quint32) * 3 + sizeof(quint8);
-
-    FBXNode node;
-    const int MIN_VALID_OFFSET = 40;
-    if (endOffset < MIN_VALID_OFFSET || nameLength == 0) {
-        // use a null name to indicate a null node
-        return node;
+    const unsigned int DEFLATE_ENCODING = 1;
+    const char* compressed = NULL;
+    if (encoding == DEFLATE_ENCODING) {
+        // deflate can't do better than about 1032:1, so anything beyond that is a corrupt length
+        const qint64 MAX_DEFLATE_RATIO = 1032;
+        compressed = take(compressedLength);
+        if ((qint64)arrayLength * sizeof(T) > compressedLength * MAX_DEFLATE_RATIO) {
+            throw QString("Invalid FBX array length.");
+        }
+    } else if ((qint64)arrayLength * sizeof(T) > _size - _offset) {
+        throw QString("FBX file is truncated.");
     }
-    node.name = in.device()->read(nameLength);
-    position += nameLength;
 
-    for (quint32 i = 0; i < propertyCount; i++) {
-        node.properties.append(parseBinaryFBXProperty(in, position));
+    // the variant shares the vector's storage, so filling that storage later fills the property
+    QVector<T> values(arrayLength);
+    char* destination = reinterpret_cast<char*>(values.data());
+    quint32 length = arrayLength * sizeof(T);
+    if (length == 0) {
+        return QVariant::fromValue(values);
     }
+    if (compressed) {
+        ArrayInflation inflation = { compressed, compressedLength, destination, length, (int)sizeof(T),
+            std::is_same<T, bool>::value };
+        _inflations.append(inflation);
 
-    while (endOffset > position) {
-        FBXNode child = parseBinaryFBXNode(in, position);
-        if (child.name.isNull()) {
-            return node;
-
-        } else {
-            node.children.append(child);
+    } else {
+        memcpy(destination, take(length), length);
+        fromLittleEndian(destination, length, sizeof(T));
+        if (std::is_same<T, bool>::value) {
+            normalizeBools(destination, length);
         }
     }
+    return QVariant::fromValue(values);
+}
 
-    return node;
+void BinaryFBXParser::inflateArrays() {
+    // start with the largest arrays so that the work evens out across threads
+    std::sort(_inflations.begin(), _inflations.end(), isLargerInflation);
+
+    // this thread takes part, so there's no need to wait for workers that can't start immediately
+    QThreadPool* pool = QThreadPool::globalInstance();
+    QSemaphore finished;
+    int workers = 0;
+    for (int maxWorkers = qMin(_inflations.size() - 1, pool->maxThreadCount()); workers < maxWorkers &&
+            pool->tryStart(new ArrayInflater(this, &finished)); workers++);
+    inflateNextArrays();
+    finished.acquire(workers);
 }
 
 class Tokenizer {
@@ -425,31 +564,37 @@ FBXNode parseFBX(QIODevice* device) {
         }
         return top;
     }
-    QDataStream in(device);
-    in.setByteOrder(QDataStream::LittleEndian);
-    in.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
-
-    // see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
-    // of the FBX binary format
+    // parse straight from the buffer or file contents where we can, rather than copying them
+    const char* data;
+    qint64 size = device->bytesAvailable();
+    QByteArray contents;
+    QFile* file = qobject_cast<QFile*>(device);
+    uchar* mapped = NULL;
+    QBuffer* buffer = qobject_cast<QBuffer*>(device);
+    if (buffer) {
+        data = buffer->data().constData() + buffer->pos();
 
-    // skip the rest of the header
-    const int HEADER_SIZE = 27;
-    in.skipRawData(HEADER_SIZE);
-    int position = HEADER_SIZE;
+    } else if (file && (mapped = file->map(file->pos(), size))) {
+        data = reinterpret_cast<const char*>(mapped);
 
-    // parse the top-level node
-    FBXNode top;
-    while (device->bytesAvailable()) {
-        FBXNode next = parseBinaryFBXNode(in, position);
-        if (next.name.isNull()) {
-            return top;
+    } else {
+        contents = device->readAll();
+        data = contents.constData();
+        size = contents.size();
+    }
+    try {
+        FBXNode top = BinaryFBXParser(data, size).parse();
+        if (mapped) {
+            file->unmap(mapped);
+        }
+        return top;
 
-        } else {
-            top.children.append(next);
+    } catch (const QString&) {
+        if (mapped) {
+            file->unmap(mapped);
         }
+        throw;
     }
-
-    return top;
 }
 
 QVariantHash parseMapping(QIODevice* device) {
@@ -488,22 +633,24 @@ QVariantHash parseMapping(QIODevice* device) {
 }
 
 QVector<glm::vec3> createVec3Vector(const QVector<double>& doubleVector) {
-    QVector<glm::vec3> values;
-    for (const double* it = doubleVector.constData(), *end = it + (doubleVector.size() / 3 * 3); it != end; ) {
+    QVector<glm::vec3> values(doubleVector.size() / 3);
+    glm::vec3* value = values.data();
+    for (const double* it = doubleVector.constData(), *end = it + values.size() * 3; it != end; ) {
         float x = *it++;
         float y = *it++;
         float z = *it++;
-        values.append(glm::vec3(x, y, z));
+        *value++ = glm::vec3(x, y, z);
     }
     return values;
 }
 
 QVector<glm::vec2> createVec2Vector(const QVector<double>& doubleVector) {
-    QVector<glm::vec2> values;
-    for (const double* it = doubleVector.constData(), *end = it + (doubleVector.size() / 2 * 2); it != end; ) {
+    QVector<glm::vec2> values(doubleVector.size() / 2);
+    glm::vec2* value = values.data();
+    for (const double* it = doubleVector.constData(), *end = it + values.size() * 2; it != end; ) {
         float s = *it++;
         float t = *it++;
-        values.append(glm::vec2(s, -t));
+        *value++ = glm::vec2(s, -t);
     }
     return values;
 }
@@ -275,6 +275,10 @@ QVariantHash readMapping(const QByteArray& data);
 /// Writes an FST mapping to a byte array.
 QByteArray writeMapping(const QVariantHash& mapping);
 
+/// Parses the node tree of an FBX document.  Binary documents only include the records that geometry extraction uses.
+/// \exception QString if an error occurs in parsing
+FBXNode parseFBX(QIODevice* device);
+
 /// Reads FBX geometry from the supplied model and mapping data.
 /// \exception QString if an error occurs in parsing
 FBXGeometry readFBX(const QByteArray& model, const QVariantHash& mapping, bool loadLightmaps = true, float lightmapLevel = 1.0f);
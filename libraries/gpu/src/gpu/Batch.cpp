@@ -10,12 +10,43 @@
 //
 #include "Batch.h"
 
+#include <QCoreApplication>
 #include <QDebug>
+#include <QThreadStorage>
 
 #define ADD_COMMAND(call) _commands.push_back(COMMAND_##call); _commandOffsets.push_back(_params.size());
 
 using namespace gpu;
 
+class Batch::Storage {
+public:
+    Commands commands;
+    CommandOffsets commandOffsets;
+    Params params;
+    Resources resources;
+    Bytes data;
+
+    BufferCaches buffers;
+    TextureCaches textures;
+    StreamFormatCaches streamFormats;
+    TransformCaches transforms;
+};
+
+const int MAX_RECYCLED_STORAGE = 16;
+
+/// The storage given up by the batches destroyed on a thread.
+class RecycledStorage {
+public:
+    Batch::Storage storage[MAX_RECYCLED_STORAGE];
+    int count;
+
+    RecycledStorage() : count(0) { }
+};
+
+// allocated and never freed, so that it outlives any batches destroyed during static destruction; batches constructed
+// during static initialization, before it's allocated, simply go without
+static QThreadStorage<RecycledStorage*>* recycledStorage = new QThreadStorage<RecycledStorage*>();
+
 Batch::Batch() :
     _commands(),
     _commandOffsets(),
@@ -27,9 +58,27 @@ Batch::Batch() :
     _streamFormats(),
     _transforms()
 {
+    if (recycledStorage && recycledStorage->hasLocalData()) {
+        RecycledStorage* recycled = recycledStorage->localData();
+        if (recycled->count > 0) {
+            swapStorage(recycled->storage[--recycled->count]);
+        }
+    }
 }
 
 Batch::~Batch() {
+    // the thread data is gone by the time the statics are destroyed
+    if (!recycledStorage || QCoreApplication::closingDown()) {
+        return;
+    }
+    if (!recycledStorage->hasLocalData()) {
+        recycledStorage->setLocalData(new RecycledStorage());
+    }
+    RecycledStorage* recycled = recycledStorage->localData();
+    if (recycled->count < MAX_RECYCLED_STORAGE) {
+        clear();
+        swapStorage(recycled->storage[recycled->count++]);
+    }
 }
 
 void Batch::clear() {
@@ -44,6 +93,18 @@ void Batch::clear() {
     _transforms.clear();
 }
 
+void Batch::swapStorage(Storage& storage) {
+    _commands.swap(storage.commands);
+    _commandOffsets.swap(storage.commandOffsets);
+    _params.swap(storage.params);
+    _resources.swap(storage.resources);
+    _data.swap(storage.data);
+    _buffers.swap(storage.buffers);
+    _textures.swap(storage.textures);
+    _streamFormats.swap(storage.streamFormats);
+    _transforms.swap(storage.transforms);
+}
+
 uint32 Batch::cacheResource(Resource* res) {
     uint32 offset = _resources.size();
     _resources.push_back(ResourceCache(res));
@@ -159,6 +220,13 @@ void Batch::setProjectionTransform(const Transform& proj) {
     _params.push_back(_transforms.cache(proj));
 }
 
+void Batch::setInstanceTransformBuffer(const BufferPointer& buffer, Offset offset) {
+    ADD_COMMAND(setInstanceTransformBuffer);
+
+    _params.push_back(offset);
+    _params.push_back(_buffers.cache(buffer));
+}
+
 void Batch::setUniformBuffer(uint32 slot, const BufferPointer& buffer, Offset offset, Offset size) {
     ADD_COMMAND(setUniformBuffer);
 
@@ -184,3 +252,9 @@ void Batch::setUniformTexture(uint32 slot, const TextureView& view) {
     setUniformTexture(slot, view._texture);
 }
 
+void Batch::runBatch(const Batch& batch) {
+    ADD_COMMAND(runBatch);
+
+    _params.push_back(cacheResource(&batch));
+}
+
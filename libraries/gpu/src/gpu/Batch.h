@@ -53,6 +53,17 @@ enum Primitive {
     NUM_PRIMITIVES,
 };
 
+/// Checks whether two cached values are the same.  Only shared pointers are compared; other values are taken to differ.
+template <typename T> inline bool isSameCachedData(const T& first, const T& second) {
+    return false;
+}
+
+template <typename T> inline bool isSameCachedData(const QSharedPointer<T>& first, const QSharedPointer<T>& second) {
+    return first == second;
+}
+
+/// A batch may be recorded on any thread, so long as it's used by one thread at a time.  Batches recorded in parallel can
+/// be joined with runBatch for rendering on the GPU thread.
 class Batch {
 public:
     typedef Stream::Slot Slot;
@@ -63,6 +74,11 @@ public:
 
     void clear();
 
+    /// The containers in which batches record their commands.  When a batch is destroyed, its containers are kept (up to a
+    /// limit) for reuse by the next batch created on the same thread, so that the batches recorded anew every frame don't
+    /// have to allocate them anew as well.
+    class Storage;
+
     // Drawcalls
     void draw(Primitive primitiveType, uint32 numVertices, uint32 startVertex = 0);
     void drawIndexed(Primitive primitiveType, uint32 nbIndices, uint32 startIndex = 0);
@@ -91,6 +107,11 @@ public:
     void setViewTransform(const Transform& view);
     void setProjectionTransform(const Transform& proj);
 
+    // Instancing
+    // drawInstanced and drawIndexedInstanced draw each instance with the model transform replaced by the instance's own,
+    // read as a glm::mat4 from the buffer at offset + instance * sizeof(glm::mat4)
+    void setInstanceTransformBuffer(const BufferPointer& buffer, Offset offset = 0);
+
     // Shader Stage
     void setUniformBuffer(uint32 slot, const BufferPointer& buffer, Offset offset, Offset size);
     void setUniformBuffer(uint32 slot, const BufferView& view); // not a command, just a shortcut from a BufferView
@@ -98,6 +119,11 @@ public:
     void setUniformTexture(uint32 slot, const TexturePointer& view);
     void setUniformTexture(uint32 slot, const TextureView& view); // not a command, just a shortcut from a TextureView
 
+    // Batches
+    // Runs the commands of another batch at this point, starting from the state set by this one.  The batch isn't copied,
+    // so it must outlive the rendering of this one; static content can thus be recorded once and run every frame
+    void runBatch(const Batch& batch);
+
 
     // TODO: As long as we have gl calls explicitely issued from interface
     // code, we need to be able to record and batch these calls. THe long 
@@ -169,9 +195,13 @@ public:
         COMMAND_setViewTransform,
         COMMAND_setProjectionTransform,
 
+        COMMAND_setInstanceTransformBuffer,
+
         COMMAND_setUniformBuffer,
         COMMAND_setUniformTexture,
 
+        COMMAND_runBatch,
+
         // TODO: As long as we have gl calls explicitely issued from interface
         // code, we need to be able to record and batch these calls. THe long 
         // term strategy is to get rid of any GL calls in favor of the HIFI GPU API
@@ -274,6 +304,10 @@ public:
             std::vector< Cache<T> > _items;
 
             uint32 cache(const Data& data) {
+                // share the last entry if it holds the same data, as when a buffer is bound to several channels in a row
+                if (!_items.empty() && isSameCachedData(_items.back()._data, data)) {
+                    return _items.size() - 1;
+                }
                 uint32 offset = _items.size();
                 _items.push_back(Cache<T>(data));
                 return offset;
@@ -289,6 +323,10 @@ public:
             void clear() {
                 _items.clear();
             }
+
+            void swap(Vector& other) {
+                _items.swap(other._items);
+            }
         };
     };
 
@@ -337,6 +375,8 @@ public:
     TransformCaches _transforms;
 
 protected:
+
+    void swapStorage(Storage& storage);
 };
 
 };
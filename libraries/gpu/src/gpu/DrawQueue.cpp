@@ -0,0 +1,104 @@
+//
+//  DrawQueue.cpp
+//  libraries/gpu/src/gpu
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+#include "DrawQueue.h"
+
+#include <Radix2InplaceSort.h>
+#include <Radix2IntegerScanner.h>
+
+using namespace gpu;
+
+/// Extracts the bits of the sort entries' keys for the radix sort.
+class DrawQueue::SortEntryScanner : public Radix2IntegerScanner<quint64> {
+public:
+
+    bool bit(const SortEntry& entry, state_type const& state) const { return base::bit(entry.key, state); }
+
+private:
+
+    typedef Radix2IntegerScanner<quint64> base;
+};
+
+quint64 DrawQueue::makeKey(uint32 program, uint32 material, uint32 mesh, uint32 part) {
+    return ((quint64)(program & ((1 << PROGRAM_BITS) - 1)) << (MATERIAL_BITS + MESH_BITS + PART_BITS)) |
+        ((quint64)(material & ((1 << MATERIAL_BITS) - 1)) << (MESH_BITS + PART_BITS)) |
+        ((quint64)(mesh & ((1 << MESH_BITS) - 1)) << PART_BITS) | (part & ((1 << PART_BITS) - 1));
+}
+
+DrawQueue::Submitter::~Submitter() {
+}
+
+void DrawQueue::add(quint64 key, uint32 data, bool instanceable, const glm::mat4& transform) {
+    Item item = { key, data, instanceable, transform };
+    _items.push_back(item);
+}
+
+int DrawQueue::submit(Batch& batch, Submitter& submitter) {
+    // sort compact entries rather than the items themselves, which are large to swap
+    _sortEntries.resize(_items.size());
+    for (uint32 i = 0; i < _items.size(); i++) {
+        SortEntry& entry = _sortEntries[i];
+        entry.key = _items[i].key;
+        entry.index = i;
+    }
+    radix2InplaceSort(_sortEntries.begin(), _sortEntries.end(), SortEntryScanner());
+
+    BufferPointer instanceBuffer;
+    int draws = 0;
+    quint64 lastKey = 0;
+    for (uint32 i = 0; i < _sortEntries.size(); ) {
+        const Item& item = _items[_sortEntries[i].index];
+        bool programChanged = (i == 0 || getProgram(item.key) != getProgram(lastKey));
+        if (programChanged) {
+            submitter.setProgram(batch, item);
+        }
+        if (programChanged || getMaterial(item.key) != getMaterial(lastKey)) {
+            submitter.setMaterial(batch, item);
+        }
+        if (programChanged || getMesh(item.key) != getMesh(lastKey)) {
+            submitter.setMesh(batch, item);
+        }
+        lastKey = item.key;
+
+        // extend the run for as long as the following items can be drawn as instances of this one
+        uint32 end = i + 1;
+        if (item.instanceable) {
+            while (end < _sortEntries.size() && _sortEntries[end].key == item.key &&
+                    _items[_sortEntries[end].index].instanceable) {
+                end++;
+            }
+        }
+        if (end - i > 1) {
+            if (!instanceBuffer) {
+                instanceBuffer = BufferPointer(new Buffer());
+                batch.setInstanceTransformBuffer(instanceBuffer);
+            }
+            uint32 firstInstance = instanceBuffer->getSize() / sizeof(glm::mat4);
+            for (uint32 j = i; j < end; j++) {
+                instanceBuffer->append(sizeof(glm::mat4),
+                    reinterpret_cast<const Buffer::Byte*>(&_items[_sortEntries[j].index].transform));
+            }
+            submitter.drawInstanced(batch, item, end - i, firstInstance);
+
+        } else {
+            batch.setModelTransform(Transform(item.transform));
+            submitter.draw(batch, item);
+        }
+        draws++;
+        i = end;
+    }
+    clear();
+    return draws;
+}
+
+void DrawQueue::clear() {
+    _items.clear();
+    _sortEntries.clear();
+}
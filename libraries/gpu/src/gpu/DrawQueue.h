@@ -0,0 +1,97 @@
+//
+//  DrawQueue.h
+//  libraries/gpu/src/gpu
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+#ifndef hifi_gpu_DrawQueue_h
+#define hifi_gpu_DrawQueue_h
+
+#include <QtGlobal>
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Batch.h"
+
+namespace gpu {
+
+/// Collects draws so that they can be submitted in the order that requires the fewest state changes.  Each item has a
+/// sort key made up of the program, material, mesh, and part that it uses, in decreasing order of significance.  Sorting
+/// brings the items that share state together, so that each program, material, and mesh is bound once per run of items
+/// rather than once per item, and runs of instanceable items with identical keys become single instanced draws.
+class DrawQueue {
+public:
+
+    static const int PART_BITS = 12;
+    static const int MESH_BITS = 24;
+    static const int MATERIAL_BITS = 20;
+    static const int PROGRAM_BITS = 8;
+
+    /// Combines the ids of an item's state into a sort key.  Ids are truncated to the widths given above.
+    static quint64 makeKey(uint32 program, uint32 material, uint32 mesh, uint32 part);
+
+    static uint32 getProgram(quint64 key) { return (uint32)(key >> (MATERIAL_BITS + MESH_BITS + PART_BITS)); }
+    static uint32 getMaterial(quint64 key) { return (uint32)(key >> (MESH_BITS + PART_BITS)) & ((1 << MATERIAL_BITS) - 1); }
+    static uint32 getMesh(quint64 key) { return (uint32)(key >> PART_BITS) & ((1 << MESH_BITS) - 1); }
+    static uint32 getPart(quint64 key) { return (uint32)key & ((1 << PART_BITS) - 1); }
+
+    class Item {
+    public:
+        quint64 key;
+        uint32 data; ///< the submitter's own index for the item
+        bool instanceable; ///< whether the item may be drawn as an instance along with others having the same key
+        glm::mat4 transform; ///< the model transform
+    };
+
+    /// Issues the state changes and draws for the items, as the queue walks through them in sorted order.
+    class Submitter {
+    public:
+        virtual ~Submitter();
+
+        /// Binds the item's program.  Afterwards, the item's material and mesh are bound as well.
+        virtual void setProgram(Batch& batch, const Item& item) = 0;
+
+        virtual void setMaterial(Batch& batch, const Item& item) = 0;
+        virtual void setMesh(Batch& batch, const Item& item) = 0;
+
+        /// Draws the item, whose transform has been set as the model transform.
+        virtual void draw(Batch& batch, const Item& item) = 0;
+
+        /// Draws the item as the given range of instances, whose transforms are in the instance transform buffer.
+        virtual void drawInstanced(Batch& batch, const Item& item, uint32 instanceCount, uint32 firstInstance) = 0;
+    };
+
+    int getItemCount() const { return _items.size(); }
+    bool isEmpty() const { return _items.empty(); }
+
+    void add(quint64 key, uint32 data, bool instanceable, const glm::mat4& transform);
+
+    /// Sorts the items and submits them to the batch through the submitter, leaving the queue empty.
+    /// \return the number of draws submitted
+    int submit(Batch& batch, Submitter& submitter);
+
+    void clear();
+
+private:
+
+    class SortEntry {
+    public:
+        quint64 key;
+        uint32 index;
+    };
+
+    class SortEntryScanner;
+
+    std::vector<Item> _items;
+    std::vector<SortEntry> _sortEntries;
+};
+
+};
+
+#endif
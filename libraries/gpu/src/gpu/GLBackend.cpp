@@ -25,9 +25,13 @@ GLBackend::CommandCall GLBackend::_commandCalls[Batch::NUM_COMMANDS] =
     (&::gpu::GLBackend::do_setViewTransform),
     (&::gpu::GLBackend::do_setProjectionTransform),
 
+    (&::gpu::GLBackend::do_setInstanceTransformBuffer),
+
     (&::gpu::GLBackend::do_setUniformBuffer),
     (&::gpu::GLBackend::do_setUniformTexture),
 
+    (&::gpu::GLBackend::do_runBatch),
+
     (&::gpu::GLBackend::do_glEnable),
     (&::gpu::GLBackend::do_glDisable),
 
@@ -91,15 +95,18 @@ GLBackend::~GLBackend() {
 }
 
 void GLBackend::renderBatch(Batch& batch) {
+    GLBackend backend;
+    backend.render(batch);
+}
+
+void GLBackend::render(Batch& batch) {
     uint32 numCommands = batch.getCommands().size();
     const Batch::Commands::value_type* command = batch.getCommands().data();
     const Batch::CommandOffsets::value_type* offset = batch.getCommandOffsets().data();
 
-    GLBackend backend;
-
     for (unsigned int i = 0; i < numCommands; i++) {
         CommandCall call = _commandCalls[(*command)];
-        (backend.*(call))(batch, *offset);
+        (this->*(call))(batch, *offset);
         command++;
         offset++;
     }
@@ -165,11 +172,49 @@ void GLBackend::do_drawIndexed(Batch& batch, uint32 paramOffset) {
     CHECK_GL_ERROR();
 }
 
+// The model shaders take their transform from the fixed function modelview matrix rather than from a per-instance
+// attribute, so instances are drawn one after another with each instance's transform loaded in turn.  The batch still
+// records a single command for all of them, and the state shared by the instances is bound only once.
+
 void GLBackend::do_drawInstanced(Batch& batch, uint32 paramOffset) {
+    updateInput();
+
+    uint32 numInstances = batch._params[paramOffset + 4]._uint;
+    Primitive primitiveType = (Primitive)batch._params[paramOffset + 3]._uint;
+    GLenum mode = _primitiveToGLmode[primitiveType];
+    uint32 numVertices = batch._params[paramOffset + 2]._uint;
+    uint32 startVertex = batch._params[paramOffset + 1]._uint;
+    uint32 startInstance = batch._params[paramOffset + 0]._uint;
+
+    Transform model = _transform._model;
+    for (uint32 i = 0; i < numInstances; i++) {
+        updateInstanceTransform(startInstance + i);
+        glDrawArrays(mode, startVertex, numVertices);
+    }
+    _transform._model = model;
+    _transform._invalidModel = true;
     CHECK_GL_ERROR();
 }
 
 void GLBackend::do_drawIndexedInstanced(Batch& batch, uint32 paramOffset) {
+    updateInput();
+
+    uint32 numInstances = batch._params[paramOffset + 4]._uint;
+    Primitive primitiveType = (Primitive)batch._params[paramOffset + 3]._uint;
+    GLenum mode = _primitiveToGLmode[primitiveType];
+    uint32 numIndices = batch._params[paramOffset + 2]._uint;
+    uint32 startIndex = batch._params[paramOffset + 1]._uint;
+    uint32 startInstance = batch._params[paramOffset + 0]._uint;
+
+    GLenum glType = _elementTypeToGLType[_input._indexBufferType];
+
+    Transform model = _transform._model;
+    for (uint32 i = 0; i < numInstances; i++) {
+        updateInstanceTransform(startInstance + i);
+        glDrawElements(mode, numIndices, glType, reinterpret_cast<GLvoid*>(startIndex + _input._indexBufferOffset));
+    }
+    _transform._model = model;
+    _transform._invalidModel = true;
     CHECK_GL_ERROR();
 }
 
@@ -400,6 +445,23 @@ void GLBackend::do_setProjectionTransform(Batch& batch, uint32 paramOffset) {
     _transform._invalidProj = true;
 }
 
+void GLBackend::do_setInstanceTransformBuffer(Batch& batch, uint32 paramOffset) {
+    _transform._instanceBuffer = batch._buffers.get(batch._params[paramOffset + 1]._uint);
+    _transform._instanceBufferOffset = batch._params[paramOffset + 0]._uint;
+}
+
+void GLBackend::updateInstanceTransform(uint32 instance) {
+    if (_transform._instanceBuffer) {
+        Offset offset = _transform._instanceBufferOffset + instance * sizeof(Transform::Mat4);
+        if (offset + sizeof(Transform::Mat4) <= _transform._instanceBuffer->getSize()) {
+            _transform._model = Transform(*reinterpret_cast<const Transform::Mat4*>(
+                _transform._instanceBuffer->getData() + offset));
+            _transform._invalidModel = true;
+        }
+    }
+    updateTransform();
+}
+
 void GLBackend::updateTransform() {
     if (_transform._invalidProj) {
         // TODO: implement the projection matrix assignment to gl state
@@ -479,6 +541,12 @@ void GLBackend::do_setUniformTexture(Batch& batch, uint32 paramOffset) {
     CHECK_GL_ERROR();
 }
 
+void GLBackend::do_runBatch(Batch& batch, uint32 paramOffset) {
+    // the commands take their batch by non-const reference, though they only read from it
+    const Batch* other = static_cast<const Batch*>(batch.editResource(batch._params[paramOffset]._uint)->_pointer);
+    render(const_cast<Batch&>(*other));
+}
+
 
 // TODO: As long as we have gl calls explicitely issued from interface
 // code, we need to be able to record and batch these calls. THe long 
@@ -29,6 +29,9 @@ public:
 
     static void renderBatch(Batch& batch);
 
+    /// Executes the batch's commands, starting from the state left by those executed before.
+    void render(Batch& batch);
+
     static void checkGLError();
 
 
@@ -112,8 +115,10 @@ protected:
     void do_setModelTransform(Batch& batch, uint32 paramOffset);
     void do_setViewTransform(Batch& batch, uint32 paramOffset);
     void do_setProjectionTransform(Batch& batch, uint32 paramOffset);
+    void do_setInstanceTransformBuffer(Batch& batch, uint32 paramOffset);
 
     void updateTransform();
+    void updateInstanceTransform(uint32 instance);
     struct TransformStageState {
         Transform _model;
         Transform _view;
@@ -122,6 +127,9 @@ protected:
         bool _invalidView;
         bool _invalidProj;
 
+        BufferPointer _instanceBuffer;
+        Offset _instanceBufferOffset;
+
         GLenum _lastMode;
 
         TransformStageState() :
@@ -131,6 +139,8 @@ protected:
             _invalidModel(true),
             _invalidView(true),
             _invalidProj(true),
+            _instanceBuffer(0),
+            _instanceBufferOffset(0),
             _lastMode(GL_TEXTURE) {}
     } _transform;
 
@@ -147,6 +157,9 @@ protected:
             _program(0) {}
     } _shader;
 
+    // Batches
+    void do_runBatch(Batch& batch, uint32 paramOffset);
+
  
     // TODO: As long as we have gl calls explicitely issued from interface
     // code, we need to be able to record and batch these calls. THe long 
@@ -222,6 +222,19 @@ public:
     }
 };
 
+// Uploads the mips provided through assignStoredMip past the first, for textures that don't generate their own
+static void uploadStoredMips(const Texture& texture) {
+    uint16 level = 1;
+    for (; level <= texture.maxMip() && texture.isStoredMipAvailable(level); level++) {
+        Texture::PixelsPointer mip = texture.accessStoredMip(level);
+        GLTexelFormat texelFormat = GLTexelFormat::evalGLTexelFormat(texture.getTexelFormat(), mip->_format);
+        glTexImage2D(GL_TEXTURE_2D, level,
+            texelFormat.internalFormat, texture.evalMipWidth(level), texture.evalMipHeight(level), 0,
+            texelFormat.format, texelFormat.type, mip->_sysmem.read<Resource::Byte>());
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+}
 
 void GLBackend::syncGPUObject(const Texture& texture) {
     GLTexture* object = Backend::getGPUObject<GLBackend::GLTexture>(texture);
@@ -271,6 +284,8 @@ void GLBackend::syncGPUObject(const Texture& texture) {
 
                 if (texture.isAutogenerateMips()) {
                     glGenerateMipmap(GL_TEXTURE_2D);
+                } else if (texture.maxMip() > 0) {
+                    uploadStoredMips(texture);
                 }
                 glBindTexture(GL_TEXTURE_2D, boundTex);
                 object->_contentStamp = texture.getDataStamp();
@@ -300,6 +315,9 @@ void GLBackend::syncGPUObject(const Texture& texture) {
             if (bytes && texture.isAutogenerateMips()) {
                 glGenerateMipmap(GL_TEXTURE_2D);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+            } else if (bytes && texture.maxMip() > 0) {
+                uploadStoredMips(texture);
             }
 
             glBindTexture(GL_TEXTURE_2D, boundTex);
@@ -0,0 +1,89 @@
+//
+//  NullBackend.cpp
+//  libraries/gpu/src/gpu
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+#include "NullBackend.h"
+
+using namespace gpu;
+
+NullBackend::Stats::Stats() :
+    commands(0),
+    programBinds(0),
+    textureBinds(0),
+    uniformBufferBinds(0),
+    uniforms(0),
+    inputBinds(0),
+    transforms(0),
+    draws(0),
+    instances(0) {
+}
+
+void NullBackend::renderBatch(const Batch& batch) {
+    const Batch::Params& params = batch.getParams();
+    for (uint32 i = 0; i < batch.getCommands().size(); i++) {
+        uint32 offset = batch.getCommandOffsets()[i];
+        _stats.commands++;
+        switch (batch.getCommands()[i]) {
+            case Batch::COMMAND_draw:
+            case Batch::COMMAND_drawIndexed:
+            case Batch::COMMAND_glDrawArrays:
+            case Batch::COMMAND_glDrawRangeElements:
+                _stats.draws++;
+                _stats.instances++;
+                break;
+
+            case Batch::COMMAND_drawInstanced:
+            case Batch::COMMAND_drawIndexedInstanced:
+                _stats.draws++;
+                _stats.instances += params[offset + 4]._uint;
+                break;
+
+            case Batch::COMMAND_setInputFormat:
+            case Batch::COMMAND_setInputBuffer:
+            case Batch::COMMAND_setIndexBuffer:
+                _stats.inputBinds++;
+                break;
+
+            case Batch::COMMAND_setModelTransform:
+            case Batch::COMMAND_setViewTransform:
+            case Batch::COMMAND_setProjectionTransform:
+                _stats.transforms++;
+                break;
+
+            case Batch::COMMAND_setUniformBuffer:
+                _stats.uniformBufferBinds++;
+                break;
+
+            case Batch::COMMAND_setUniformTexture:
+            case Batch::COMMAND_glBindTexture:
+                _stats.textureBinds++;
+                break;
+
+            case Batch::COMMAND_glUseProgram:
+                if (params[offset]._uint != 0) {
+                    _stats.programBinds++;
+                }
+                break;
+
+            case Batch::COMMAND_glUniform1f:
+            case Batch::COMMAND_glUniform2f:
+            case Batch::COMMAND_glUniform4fv:
+            case Batch::COMMAND_glUniformMatrix4fv:
+                _stats.uniforms++;
+                break;
+
+            case Batch::COMMAND_runBatch:
+                renderBatch(*static_cast<const Batch*>(batch._resources[params[offset]._uint]._pointer));
+                break;
+
+            default:
+                break;
+        }
+    }
+}
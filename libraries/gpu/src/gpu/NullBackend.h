@@ -0,0 +1,52 @@
+//
+//  NullBackend.h
+//  libraries/gpu/src/gpu
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+#ifndef hifi_gpu_NullBackend_h
+#define hifi_gpu_NullBackend_h
+
+#include "Context.h"
+#include "Batch.h"
+
+namespace gpu {
+
+/// A backend that executes nothing, but counts the binds and draws in the batches that it renders, so that what a
+/// renderer submits can be checked without a GPU.
+class NullBackend : public Backend {
+public:
+
+    class Stats {
+    public:
+        int commands;
+        int programBinds; ///< program changes, not counting unbinds
+        int textureBinds;
+        int uniformBufferBinds;
+        int uniforms;
+        int inputBinds; ///< input format, input buffer, and index buffer changes
+        int transforms;
+        int draws;
+        int instances; ///< the total number of instances drawn, counting each non-instanced draw as one
+
+        Stats();
+    };
+
+    /// Counts the batch's commands, along with those of any batches that it runs.
+    void renderBatch(const Batch& batch);
+
+    const Stats& getStats() const { return _stats; }
+    void resetStats() { _stats = Stats(); }
+
+private:
+
+    Stats _stats;
+};
+
+};
+
+#endif
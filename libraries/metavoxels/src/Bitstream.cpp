@@ -262,6 +262,29 @@ void Bitstream::persistAndResetWriteMappings() {
     persistWriteMappings(getAndResetWriteMappings());
 }
 
+bool Bitstream::hasTransientWriteMappings() const {
+    return _objectStreamerStreamer.hasTransientOffsets() || _typeStreamerStreamer.hasTransientOffsets() ||
+        _attributeStreamer.hasTransientOffsets() || _scriptStringStreamer.hasTransientOffsets() ||
+        _sharedObjectStreamer.hasTransientOffsets();
+}
+
+void Bitstream::setTransientWriteMappings(const WriteMappings& mappings) {
+    _objectStreamerStreamer.setTransientOffsets(mappings.objectStreamerOffsets);
+    _typeStreamerStreamer.setTransientOffsets(mappings.typeStreamerOffsets);
+    _attributeStreamer.setTransientOffsets(mappings.attributeOffsets);
+    _scriptStringStreamer.setTransientOffsets(mappings.scriptStringOffsets);
+    _sharedObjectStreamer.setTransientOffsets(mappings.sharedObjectOffsets);
+}
+
+bool Bitstream::hasSamePersistentWriteMappings(const Bitstream& other) const {
+    return _objectStreamerStreamer.hasSamePersistentIDs(other._objectStreamerStreamer) &&
+        _typeStreamerStreamer.hasSamePersistentIDs(other._typeStreamerStreamer) &&
+        _attributeStreamer.hasSamePersistentIDs(other._attributeStreamer) &&
+        _scriptStringStreamer.hasSamePersistentIDs(other._scriptStringStreamer) &&
+        _sharedObjectStreamer.hasSamePersistentIDs(other._sharedObjectStreamer) &&
+        _sharedObjectReferences == other._sharedObjectReferences;
+}
+
 Bitstream::ReadMappings Bitstream::getAndResetReadMappings() {
     ReadMappings mappings = { _objectStreamerStreamer.getAndResetTransientValues(),
         _typeStreamerStreamer.getAndResetTransientValues(),
@@ -2334,7 +2357,17 @@ const QVector<StreamerPropertyPair>& ObjectStreamer::getProperties() const {
 
 MappedObjectStreamer::MappedObjectStreamer(const QMetaObject* metaObject, const QVector<StreamerPropertyPair>& properties) :
     ObjectStreamer(metaObject),
-    _properties(properties) {
+    _properties(properties),
+    _directIndices(properties.size(), -1) {
+    
+    // properties whose local type matches the streamed type can skip the QVariant round trip
+    for (int i = 0; i < _properties.size(); i++) {
+        const StreamerPropertyPair& property = _properties.at(i);
+        if (property.second.isValid() && !property.second.isEnumType() && property.first->streamsPropertiesDirectly() &&
+                property.first->getType() == property.second.userType()) {
+            _directIndices[i] = property.second.propertyIndex();
+        }
+    }
 }
 
 const char* MappedObjectStreamer::getName() const {
@@ -2410,8 +2443,11 @@ QObject* MappedObjectStreamer::putJSONData(JSONReader& reader, const QJsonObject
 }
 
 bool MappedObjectStreamer::equal(const QObject* first, const QObject* second) const {
-    foreach (const StreamerPropertyPair& property, _properties) {
-        if (!property.first->equal(property.second.read(first), property.second.read(second))) {
+    for (int i = 0; i < _properties.size(); i++) {
+        const StreamerPropertyPair& property = _properties.at(i);
+        int index = _directIndices.at(i);
+        if (!(index == -1 ? property.first->equal(property.second.read(first), property.second.read(second)) :
+                property.first->propertiesEqual(first, second, index))) {
             return false;
         }
     }
@@ -2419,15 +2455,30 @@ bool MappedObjectStreamer::equal(const QObject* first, const QObject* second) co
 }
 
 void MappedObjectStreamer::write(Bitstream& out, const QObject* object) const {
-    foreach (const StreamerPropertyPair& property, _properties) {
-        property.first->write(out, property.second.read(object));
+    for (int i = 0; i < _properties.size(); i++) {
+        const StreamerPropertyPair& property = _properties.at(i);
+        int index = _directIndices.at(i);
+        if (index == -1) {
+            property.first->write(out, property.second.read(object));
+        } else {
+            property.first->writeProperty(out, object, index);
+        }
     }
 }
 
 void MappedObjectStreamer::writeRawDelta(Bitstream& out, const QObject* object, const QObject* reference) const {
-    foreach (const StreamerPropertyPair& property, _properties) {
-        property.first->writeDelta(out, property.second.read(object), (reference && reference->metaObject() == _metaObject) ?
-            property.second.read(reference) : QVariant());
+    if (reference && reference->metaObject() != _metaObject) {
+        reference = NULL;
+    }
+    for (int i = 0; i < _properties.size(); i++) {
+        const StreamerPropertyPair& property = _properties.at(i);
+        int index = _directIndices.at(i);
+        if (index == -1) {
+            property.first->writeDelta(out, property.second.read(object),
+                reference ? property.second.read(reference) : QVariant());
+        } else {
+            property.first->writePropertyDelta(out, object, reference, index);
+        }
     }
 }
 
@@ -2436,10 +2487,17 @@ QObject* MappedObjectStreamer::read(Bitstream& in, QObject* object) const {
     if (!object && _metaObject) {
         object = _metaObject->newInstance();
     }
-    foreach (const StreamerPropertyPair& property, _properties) {
+    QObject* target = reread ? NULL : object;
+    for (int i = 0; i < _properties.size(); i++) {
+        const StreamerPropertyPair& property = _properties.at(i);
+        int index = _directIndices.at(i);
+        if (index != -1) {
+            property.first->readProperty(in, target, index);
+            continue;
+        }
         QVariant value = property.first->read(in);
-        if (property.second.isValid() && object && !reread) {
-            property.second.write(object, value);
+        if (property.second.isValid() && target) {
+            property.second.write(target, value);
         }
     }
     return object;
@@ -2450,12 +2508,22 @@ QObject* MappedObjectStreamer::readRawDelta(Bitstream& in, const QObject* refere
     if (!object && _metaObject) {
         object = _metaObject->newInstance();
     }
-    foreach (const StreamerPropertyPair& property, _properties) {
+    if (reference && reference->metaObject() != _metaObject) {
+        reference = NULL;
+    }
+    QObject* target = reread ? NULL : object;
+    for (int i = 0; i < _properties.size(); i++) {
+        const StreamerPropertyPair& property = _properties.at(i);
+        int index = _directIndices.at(i);
+        if (index != -1) {
+            property.first->readPropertyDelta(in, target, reference, index);
+            continue;
+        }
         QVariant value;
-        property.first->readDelta(in, value, (property.second.isValid() && reference &&
-            reference->metaObject() == _metaObject) ? property.second.read(reference) : QVariant());
-        if (property.second.isValid() && object && !reread) {
-            property.second.write(object, value);
+        property.first->readDelta(in, value, (property.second.isValid() && reference) ?
+            property.second.read(reference) : QVariant());
+        if (property.second.isValid() && target) {
+            property.second.write(target, value);
         }
     }
     return object;
@@ -2798,6 +2866,39 @@ void TypeStreamer::setEnumValue(QVariant& object, int value, const QHash<int, in
     // nothing by default
 }
 
+bool TypeStreamer::streamsPropertiesDirectly() const {
+    return false;
+}
+
+bool TypeStreamer::propertiesEqual(const QObject* first, const QObject* second, int index) const {
+    QMetaProperty property = first->metaObject()->property(index);
+    return equal(property.read(first), property.read(second));
+}
+
+void TypeStreamer::writeProperty(Bitstream& out, const QObject* object, int index) const {
+    write(out, object->metaObject()->property(index).read(object));
+}
+
+void TypeStreamer::readProperty(Bitstream& in, QObject* object, int index) const {
+    QVariant value = read(in);
+    if (object) {
+        object->metaObject()->property(index).write(object, value);
+    }
+}
+
+void TypeStreamer::writePropertyDelta(Bitstream& out, const QObject* object, const QObject* reference, int index) const {
+    QMetaProperty property = object->metaObject()->property(index);
+    writeDelta(out, property.read(object), reference ? property.read(reference) : QVariant());
+}
+
+void TypeStreamer::readPropertyDelta(Bitstream& in, QObject* object, const QObject* reference, int index) const {
+    QVariant value;
+    readDelta(in, value, reference ? reference->metaObject()->property(index).read(reference) : QVariant());
+    if (object) {
+        object->metaObject()->property(index).write(object, value);
+    }
+}
+
 const QVector<MetaField>& TypeStreamer::getMetaFields() const {
     static QVector<MetaField> emptyMetaFields;
     return emptyMetaFields;
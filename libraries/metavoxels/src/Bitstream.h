@@ -91,6 +91,10 @@ public:
     
     void persistTransientOffsets(const QHash<K, int>& transientOffsets);
     
+    bool hasTransientOffsets() const { return !_transientOffsets.isEmpty(); }
+    
+    void setTransientOffsets(const QHash<K, int>& transientOffsets);
+    
     QHash<int, V> getAndResetTransientValues();
     
     void persistTransientValues(const QHash<int, V>& transientValues);
@@ -108,6 +112,8 @@ public:
     void copyPersistentMappings(const RepeatedValueStreamer& other);
     void clearPersistentMappings();
     
+    bool hasSamePersistentIDs(const RepeatedValueStreamer& other) const;
+    
     RepeatedValueStreamer& operator<<(K value);
     RepeatedValueStreamer& operator>>(V& value);
     
@@ -145,6 +151,14 @@ template<class K, class P, class V> inline void RepeatedValueStreamer<K, P, V>::
     _idStreamer.setBitsFromValue(_lastPersistentID);
 }
 
+template<class K, class P, class V> inline void RepeatedValueStreamer<K, P, V>::setTransientOffsets(
+        const QHash<K, int>& transientOffsets) {
+    // offsets are assigned consecutively from one, and the id width grows with the highest id written
+    _transientOffsets = transientOffsets;
+    _lastTransientOffset = transientOffsets.size();
+    _idStreamer.setBitsFromValue(_lastPersistentID + _lastTransientOffset);
+}
+
 template<class K, class P, class V> inline QHash<int, V> RepeatedValueStreamer<K, P, V>::getAndResetTransientValues() {
     QHash<int, V> transientValues;
     _transientValues.swap(transientValues);
@@ -228,6 +242,11 @@ template<class K, class P, class V> inline void RepeatedValueStreamer<K, P, V>::
     _valueIDs.clear();
 }
 
+template<class K, class P, class V> inline bool RepeatedValueStreamer<K, P, V>::hasSamePersistentIDs(
+        const RepeatedValueStreamer<K, P, V>& other) const {
+    return _lastPersistentID == other._lastPersistentID && _persistentIDs == other._persistentIDs;
+}
+
 /// A stream for bit-aligned data.  Through a combination of code generation, reflection, macros, and templates, provides a
 /// serialization mechanism that may be used for both networking and persistent storage.  For unreliable networking, the
 /// class provides a mapping system that resends mappings for ids until they are acknowledged (and thus persisted).  For
@@ -374,6 +393,9 @@ public:
     /// Flushes any unwritten bits to the underlying stream.
     void flush();
 
+    /// Returns the number of bits written since the last flush (those that have yet to reach the underlying stream).
+    int getUnflushedBits() const { return _position; }
+
     /// Resets to the initial state.
     void reset();
 
@@ -389,6 +411,16 @@ public:
     /// Immediately persists and resets the write mappings.
     void persistAndResetWriteMappings();
 
+    /// Checks whether any mappings have been written since the write mappings were last reset.
+    bool hasTransientWriteMappings() const;
+    
+    /// Replaces the transient write mappings with a set gathered by another stream.  Used after appending bits written by
+    /// a stream with the same persistent write mappings and no transient ones of its own.
+    void setTransientWriteMappings(const WriteMappings& mappings);
+    
+    /// Checks whether the other stream would write the same ids (and shared object deltas) as this one.
+    bool hasSamePersistentWriteMappings(const Bitstream& other) const;
+
     /// Returns the set of transient mappings gathered during reading and resets them.
     ReadMappings getAndResetReadMappings();
     
@@ -1139,6 +1171,7 @@ public:
 private:
     
     QVector<StreamerPropertyPair> _properties;
+    QVector<int> _directIndices; ///< absolute indices of properties streamed without QVariant, or -1
 };
 
 /// A streamer that maps to a local shared object class.  Shared objects can write extra, non-property data.
@@ -1284,6 +1317,16 @@ public:
     
     virtual void setEnumValue(QVariant& object, int value, const QHash<int, int>& mappings) const;
     
+    /// Checks whether this streamer can stream object properties of its type directly, without going through QVariant.
+    virtual bool streamsPropertiesDirectly() const;
+    
+    // property streaming by absolute property index; the property must be of this streamer's type
+    virtual bool propertiesEqual(const QObject* first, const QObject* second, int index) const;
+    virtual void writeProperty(Bitstream& out, const QObject* object, int index) const;
+    virtual void readProperty(Bitstream& in, QObject* object, int index) const;
+    virtual void writePropertyDelta(Bitstream& out, const QObject* object, const QObject* reference, int index) const;
+    virtual void readPropertyDelta(Bitstream& in, QObject* object, const QObject* reference, int index) const;
+    
     virtual const QVector<MetaField>& getMetaFields() const;
     virtual int getFieldIndex(const QByteArray& name) const;
     virtual void setField(QVariant& object, int index, const QVariant& value) const;
@@ -1319,6 +1362,21 @@ QDebug& operator<<(QDebug& debug, const TypeStreamer* typeStreamer);
 
 QDebug& operator<<(QDebug& debug, const QMetaObject* metaObject);
 
+/// Reads a property of type T through the object's (moc-generated) metacall, straight into a typed value.
+template<class T> inline void readPropertyValue(const QObject* object, int index, T& value) {
+    int status = -1;
+    void* arguments[] = { &value, NULL, &status };
+    QMetaObject::metacall(const_cast<QObject*>(object), QMetaObject::ReadProperty, index, arguments);
+}
+
+/// Writes a property of type T through the object's (moc-generated) metacall, straight from a typed value.
+template<class T> inline void writePropertyValue(QObject* object, int index, const T& value) {
+    int status = -1;
+    int flags = 0;
+    void* arguments[] = { const_cast<T*>(&value), NULL, &status, &flags };
+    QMetaObject::metacall(object, QMetaObject::WriteProperty, index, arguments);
+}
+
 /// A streamer that works with Bitstream's operators.
 template<class T> class SimpleTypeStreamer : public TypeStreamer {
 public:
@@ -1338,6 +1396,21 @@ public:
         out.writeRawDelta(value.value<T>(), reference.value<T>()); }
     virtual void readRawDelta(Bitstream& in, QVariant& value, const QVariant& reference) const {
         T rawValue; in.readRawDelta(rawValue, reference.value<T>()); value = QVariant::fromValue(rawValue); }
+    virtual bool streamsPropertiesDirectly() const { return true; }
+    virtual bool propertiesEqual(const QObject* first, const QObject* second, int index) const {
+        T firstValue, secondValue; readPropertyValue(first, index, firstValue); readPropertyValue(second, index, secondValue);
+        return firstValue == secondValue; }
+    virtual void writeProperty(Bitstream& out, const QObject* object, int index) const {
+        T value; readPropertyValue(object, index, value); out << value; }
+    virtual void readProperty(Bitstream& in, QObject* object, int index) const {
+        T value; in >> value; if (object) writePropertyValue(object, index, value); }
+    virtual void writePropertyDelta(Bitstream& out, const QObject* object, const QObject* reference, int index) const {
+        T value, referenceValue = T(); readPropertyValue(object, index, value);
+        if (reference) readPropertyValue(reference, index, referenceValue);
+        out.writeDelta(value, referenceValue); }
+    virtual void readPropertyDelta(Bitstream& in, QObject* object, const QObject* reference, int index) const {
+        T value, referenceValue = T(); if (reference) readPropertyValue(reference, index, referenceValue);
+        in.readDelta(value, referenceValue); if (object) writePropertyValue(object, index, value); }
 };
 
 /// A streamer class for enumerated types.
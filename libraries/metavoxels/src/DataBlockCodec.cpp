@@ -0,0 +1,743 @@
+//
+//  DataBlockCodec.cpp
+//  libraries/metavoxels/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <functional>
+#include <string.h>
+
+#include <QBuffer>
+#include <QImage>
+#include <QtDebug>
+
+#include "DataBlockCodec.h"
+#include "Spanner.h"
+
+const int DataBlockCodec::COLOR_LUMA_ERROR = 2;
+const int DataBlockCodec::COLOR_CHROMA_ERROR = 3;
+
+const int DATA_BLOCK_HEADER_SIZE = sizeof(qint32) * 4;
+
+// the largest block we'll agree to decode, to keep corrupt headers from allocating the world
+const int MAX_DATA_BLOCK_AREA = 1 << 24;
+
+static void writeHeader(char* dest, int offsetX, int offsetY, int width, int height) {
+    // the header follows the codec byte, so it isn't aligned
+    qint32 header[] = { offsetX, offsetY, width, height };
+    memcpy(dest, header, sizeof(header));
+}
+
+static bool readHeader(const char* src, int size, int& offsetX, int& offsetY, int& width, int& height) {
+    if (size < DATA_BLOCK_HEADER_SIZE) {
+        offsetX = offsetY = width = height = 0;
+        return false;
+    }
+    qint32 header[4];
+    memcpy(header, src, sizeof(header));
+    offsetX = header[0];
+    offsetY = header[1];
+    width = header[2];
+    height = header[3];
+    return true;
+}
+
+static bool isValidArea(int width, int height) {
+    return width > 0 && height > 0 && width <= MAX_DATA_BLOCK_AREA / height;
+}
+
+static void appendUInt32(QByteArray& out, quint32 value) {
+    out.append((const char*)&value, sizeof(value));
+}
+
+static bool readUInt32(const char*& data, const char* end, quint32& value) {
+    if (end - data < (int)sizeof(value)) {
+        return false;
+    }
+    memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return true;
+}
+
+// order-0 rANS over bytes (see https://github.com/rygorous/ryg_rans)
+const int RANS_SYMBOLS = 256;
+const int RANS_PROBABILITY_BITS = 12;
+const quint32 RANS_PROBABILITY_SCALE = 1 << RANS_PROBABILITY_BITS;
+const quint32 RANS_LOWER_BOUND = 1 << 23;
+
+static void normalizeFrequencies(const quint32* counts, quint32 total, quint32* frequencies) {
+    quint32 sum = 0;
+    int largest = -1;
+    for (int i = 0; i < RANS_SYMBOLS; i++) {
+        if (counts[i] == 0) {
+            frequencies[i] = 0;
+            continue;
+        }
+        frequencies[i] = qMax((quint32)((quint64)counts[i] * RANS_PROBABILITY_SCALE / total), (quint32)1);
+        sum += frequencies[i];
+        if (largest == -1 || frequencies[i] > frequencies[largest]) {
+            largest = i;
+        }
+    }
+    if (sum <= RANS_PROBABILITY_SCALE) {
+        frequencies[largest] += RANS_PROBABILITY_SCALE - sum;
+        return;
+    }
+    // rounding rare symbols up to one can overshoot; take the excess back from the most frequent ones
+    while (sum > RANS_PROBABILITY_SCALE) {
+        for (int i = 0; i < RANS_SYMBOLS; i++) {
+            if (frequencies[i] > frequencies[largest]) {
+                largest = i;
+            }
+        }
+        quint32 taken = qMin(sum - RANS_PROBABILITY_SCALE, frequencies[largest] - 1);
+        frequencies[largest] -= taken;
+        sum -= taken;
+    }
+}
+
+static void encodeRANS(const QByteArray& symbols, QByteArray& out) {
+    if (symbols.isEmpty()) {
+        return;
+    }
+    const uchar* begin = (const uchar*)symbols.constData();
+    const uchar* end = begin + symbols.size();
+    quint32 counts[RANS_SYMBOLS];
+    memset(counts, 0, sizeof(counts));
+    for (const uchar* symbol = begin; symbol != end; symbol++) {
+        counts[*symbol]++;
+    }
+    quint32 frequencies[RANS_SYMBOLS];
+    normalizeFrequencies(counts, symbols.size(), frequencies);
+
+    // the table: number of symbols present, then each symbol and its frequency
+    quint32 starts[RANS_SYMBOLS];
+    quint32 start = 0;
+    int symbolCount = 0;
+    QByteArray table;
+    for (int i = 0; i < RANS_SYMBOLS; i++) {
+        starts[i] = start;
+        if (frequencies[i] != 0) {
+            quint16 frequency = frequencies[i];
+            table.append((char)i);
+            table.append((const char*)&frequency, sizeof(frequency));
+            start += frequencies[i];
+            symbolCount++;
+        }
+    }
+    out.append((char)(symbolCount - 1));
+    out.append(table);
+
+    // encode in reverse so that the decoder reads forwards; each symbol costs at most RANS_PROBABILITY_BITS
+    // even symbols use the first state and odd ones the second, so that the decoder can work on both at once
+    QByteArray buffer(symbols.size() * 2 + 2 * sizeof(quint32), 0);
+    char* bufferEnd = buffer.data() + buffer.size();
+    char* dest = bufferEnd;
+    quint32 states[] = { RANS_LOWER_BOUND, RANS_LOWER_BOUND };
+    for (int i = symbols.size() - 1; i >= 0; i--) {
+        quint32& state = states[i & 1];
+        int value = begin[i];
+        quint32 frequency = frequencies[value];
+        quint32 limit = ((RANS_LOWER_BOUND >> RANS_PROBABILITY_BITS) << 8) * frequency;
+        while (state >= limit) {
+            *--dest = (char)(state & 0xFF);
+            state >>= 8;
+        }
+        state = ((state / frequency) << RANS_PROBABILITY_BITS) + (state % frequency) + starts[value];
+    }
+    for (int i = 1; i >= 0; i--) {
+        dest -= sizeof(quint32);
+        dest[0] = (char)states[i];
+        dest[1] = (char)(states[i] >> 8);
+        dest[2] = (char)(states[i] >> 16);
+        dest[3] = (char)(states[i] >> 24);
+    }
+
+    appendUInt32(out, bufferEnd - dest);
+    out.append(dest, bufferEnd - dest);
+}
+
+static inline bool decodeRANSSymbol(quint32& state, const uchar* lookup, const quint32* frequencies,
+        const quint32* starts, const uchar*& src, const uchar* srcEnd, uchar& symbol) {
+    quint32 slot = state & (RANS_PROBABILITY_SCALE - 1);
+    symbol = lookup[slot];
+    state = frequencies[symbol] * (state >> RANS_PROBABILITY_BITS) + slot - starts[symbol];
+    while (state < RANS_LOWER_BOUND) {
+        if (src == srcEnd) {
+            return false;
+        }
+        state = (state << 8) | *src++;
+    }
+    return true;
+}
+
+static bool decodeRANS(const char*& data, const char* end, int count, QByteArray& symbols) {
+    symbols.resize(count);
+    if (count == 0) {
+        return true;
+    }
+    if (data == end) {
+        return false;
+    }
+    int symbolCount = (uchar)*data++ + 1;
+    quint32 frequencies[RANS_SYMBOLS];
+    quint32 starts[RANS_SYMBOLS];
+    uchar lookup[RANS_PROBABILITY_SCALE];
+    quint32 start = 0;
+    for (int i = 0; i < symbolCount; i++) {
+        if (end - data < (int)(1 + sizeof(quint16))) {
+            return false;
+        }
+        uchar symbol = *data++;
+        quint16 frequency;
+        memcpy(&frequency, data, sizeof(frequency));
+        data += sizeof(frequency);
+        if (frequency == 0 || start + frequency > RANS_PROBABILITY_SCALE) {
+            return false;
+        }
+        frequencies[symbol] = frequency;
+        starts[symbol] = start;
+        memset(lookup + start, symbol, frequency);
+        start += frequency;
+    }
+    quint32 size;
+    if (start != RANS_PROBABILITY_SCALE || !readUInt32(data, end, size) || size < 2 * sizeof(quint32) ||
+            (quint32)(end - data) < size) {
+        return false;
+    }
+    const uchar* src = (const uchar*)data;
+    const uchar* srcEnd = src + size;
+    data += size;
+
+    quint32 evenState = src[0] | (src[1] << 8) | (src[2] << 16) | ((quint32)src[3] << 24);
+    quint32 oddState = src[4] | (src[5] << 8) | (src[6] << 16) | ((quint32)src[7] << 24);
+    src += 2 * sizeof(quint32);
+    uchar* dest = (uchar*)symbols.data();
+    uchar* pairsEnd = dest + (count & ~1);
+    for (; dest != pairsEnd; dest += 2) {
+        if (!(decodeRANSSymbol(evenState, lookup, frequencies, starts, src, srcEnd, dest[0]) &&
+                decodeRANSSymbol(oddState, lookup, frequencies, starts, src, srcEnd, dest[1]))) {
+            return false;
+        }
+    }
+    return (count & 1) ? decodeRANSSymbol(evenState, lookup, frequencies, starts, src, srcEnd, *dest) : true;
+}
+
+// the most frequent residuals of a block get their own tokens; the rest are tokenized by bit length with the bits
+// below the leading one stored raw
+const int RESIDUAL_VALUES = 1 << 16;
+const int LENGTH_TOKENS = 17;
+const int MAX_DICTIONARY_SIZE = RANS_SYMBOLS - LENGTH_TOKENS;
+
+// a residual must occur this often to be worth a dictionary entry
+const quint32 MIN_DICTIONARY_COUNT = 4;
+
+static inline quint16 zigzag(int value) {
+    return (value >= 0) ? (value << 1) : (((-value) << 1) - 1);
+}
+
+static inline int unzigzag(quint16 value) {
+    return (value & 1) ? -(int)((value + 1) >> 1) : (int)(value >> 1);
+}
+
+// tokens are coded with separate statistics depending on how many of the residuals above and above left were zero;
+// looking only at the previous row keeps each decoded residual from waiting on the one before it
+const int RESIDUAL_CONTEXTS = 3;
+
+static inline int getResidualContext(const quint16* values, int index, int width) {
+    return (index >= width && values[index - width] == 0) + (index > width && values[index - width - 1] == 0);
+}
+
+/// Writes zigzagged residuals (in row order, width to a row) as a dictionary of the most frequent ones, a stream of raw
+/// bits, and a stream of rANS-coded tokens for each context.
+static void writeResiduals(const QVector<quint16>& values, int width, QByteArray& out) {
+    QVector<quint32> counts(RESIDUAL_VALUES);
+    quint32* countData = counts.data();
+    const quint16* begin = values.constData();
+    const quint16* end = begin + values.size();
+    for (const quint16* value = begin; value != end; value++) {
+        countData[*value]++;
+    }
+
+    // pick the most frequent values, keyed by count and then value
+    QVector<quint64> candidates;
+    for (int i = 0; i < RESIDUAL_VALUES; i++) {
+        if (countData[i] >= MIN_DICTIONARY_COUNT) {
+            candidates.append(((quint64)countData[i] << 16) | i);
+        }
+    }
+    if (candidates.size() > MAX_DICTIONARY_SIZE) {
+        std::nth_element(candidates.begin(), candidates.begin() + MAX_DICTIONARY_SIZE, candidates.end(),
+            std::greater<quint64>());
+        candidates.resize(MAX_DICTIONARY_SIZE);
+    }
+
+    // reuse the counts as a map from value to token, with MAX_DICTIONARY_SIZE meaning not in the dictionary
+    for (int i = 0; i < RESIDUAL_VALUES; i++) {
+        countData[i] = MAX_DICTIONARY_SIZE;
+    }
+    out.append((char)candidates.size());
+    for (int i = 0; i < candidates.size(); i++) {
+        quint16 value = candidates.at(i) & 0xFFFF;
+        out.append((const char*)&value, sizeof(value));
+        countData[value] = i;
+    }
+
+    QByteArray tokens[RESIDUAL_CONTEXTS];
+    for (int i = 0; i < RESIDUAL_CONTEXTS; i++) {
+        tokens[i].reserve(values.size());
+    }
+    QByteArray extra;
+    quint32 bits = 0;
+    int bitCount = 0;
+    for (const quint16* value = begin; value != end; value++) {
+        QByteArray& contextTokens = tokens[getResidualContext(begin, value - begin, width)];
+        quint32 dictionaryToken = countData[*value];
+        if (dictionaryToken != (quint32)MAX_DICTIONARY_SIZE) {
+            contextTokens.append((char)dictionaryToken);
+            continue;
+        }
+        int length = 0;
+        while (*value >> length) {
+            length++;
+        }
+        contextTokens.append((char)(MAX_DICTIONARY_SIZE + length));
+        if (length > 1) {
+            int extraBits = length - 1;
+            bits |= (*value & ((1 << extraBits) - 1)) << bitCount;
+            bitCount += extraBits;
+            while (bitCount >= 8) {
+                extra.append((char)bits);
+                bits >>= 8;
+                bitCount -= 8;
+            }
+        }
+    }
+    if (bitCount > 0) {
+        extra.append((char)bits);
+    }
+    appendUInt32(out, extra.size());
+    out.append(extra);
+    for (int i = 0; i < RESIDUAL_CONTEXTS; i++) {
+        appendUInt32(out, tokens[i].size());
+        encodeRANS(tokens[i], out);
+    }
+}
+
+/// Reads back count residuals written by writeResiduals.
+static bool readResiduals(const char*& data, const char* end, int width, int count, quint16* values) {
+    if (data == end) {
+        return false;
+    }
+    // each token stands for a base value plus some number of raw bits
+    quint16 tokenBases[RANS_SYMBOLS];
+    int tokenBits[RANS_SYMBOLS];
+    memset(tokenBases, 0, sizeof(tokenBases));
+    memset(tokenBits, 0, sizeof(tokenBits));
+    int dictionarySize = (uchar)*data++;
+    if (dictionarySize > MAX_DICTIONARY_SIZE || end - data < dictionarySize * (int)sizeof(quint16)) {
+        return false;
+    }
+    memcpy(tokenBases, data, dictionarySize * sizeof(quint16));
+    data += dictionarySize * sizeof(quint16);
+    tokenBases[MAX_DICTIONARY_SIZE + 1] = 1;
+    for (int length = 2; length < LENGTH_TOKENS; length++) {
+        tokenBases[MAX_DICTIONARY_SIZE + length] = 1 << (length - 1);
+        tokenBits[MAX_DICTIONARY_SIZE + length] = length - 1;
+    }
+
+    quint32 extraSize;
+    if (!readUInt32(data, end, extraSize) || (quint32)(end - data) < extraSize) {
+        return false;
+    }
+    const uchar* extra = (const uchar*)data;
+    const uchar* extraEnd = extra + extraSize;
+    data += extraSize;
+
+    QByteArray tokens[RESIDUAL_CONTEXTS];
+    const uchar* token[RESIDUAL_CONTEXTS];
+    const uchar* tokenEnd[RESIDUAL_CONTEXTS];
+    int total = 0;
+    for (int i = 0; i < RESIDUAL_CONTEXTS; i++) {
+        quint32 tokenCount;
+        if (!readUInt32(data, end, tokenCount) || tokenCount > (quint32)(count - total) ||
+                !decodeRANS(data, end, tokenCount, tokens[i])) {
+            return false;
+        }
+        total += tokenCount;
+        token[i] = (const uchar*)tokens[i].constData();
+        tokenEnd[i] = token[i] + tokenCount;
+    }
+    if (total != count) {
+        return false;
+    }
+
+    quint64 bits = 0;
+    int bitCount = 0;
+    for (int i = 0; i < count; i++) {
+        int context = getResidualContext(values, i, width);
+        if (token[context] == tokenEnd[context]) {
+            return false;
+        }
+        int value = *token[context]++;
+        int extraBits = tokenBits[value];
+        if (bitCount < extraBits) {
+            for (; bitCount <= 56 && extra != extraEnd; bitCount += 8) {
+                bits |= (quint64)*extra++ << bitCount;
+            }
+            bitCount = qMax(bitCount, extraBits); // past the end of the data, read zeros
+        }
+        values[i] = tokenBases[value] | (bits & ((1 << extraBits) - 1));
+        bits >>= extraBits;
+        bitCount -= extraBits;
+    }
+    return true;
+}
+
+/// The median edge detector from LOCO-I/JPEG-LS, given the values to the left, above, and above left.
+static inline int predictMedian(int a, int b, int c) {
+    if (c >= qMax(a, b)) {
+        return qMin(a, b);
+    }
+    if (c <= qMin(a, b)) {
+        return qMax(a, b);
+    }
+    return a + b - c;
+}
+
+/// Visits the values of a width x height plane in order, passing each one's prediction from the values before it.  The
+/// first row predicts from the left, the first column from above, and the rest from the median edge detector.
+template<class T, class F> inline void predictPlane(T* values, int width, int height, F function) {
+    function(*values, 0);
+    for (T* end = values + width, *value = values + 1; value != end; value++) {
+        function(*value, value[-1]);
+    }
+    for (int y = 1; y < height; y++) {
+        T* row = values + y * width;
+        function(*row, row[-width]);
+        for (T* end = row + width, *value = row + 1; value != end; value++) {
+            function(*value, predictMedian(value[-1], value[-width], value[-width - 1]));
+        }
+    }
+}
+
+static void encodePlane(const int* values, int width, int height, int error, int minimum, int maximum,
+        QVector<quint16>& residuals) {
+    // predict from the values as the decoder will reconstruct them
+    QVector<int> reconstructed(width * height);
+    int* dest = reconstructed.data();
+    memcpy(dest, values, width * height * sizeof(int));
+    int step = 2 * error + 1;
+    predictPlane(dest, width, height, [&](int& value, int prediction) {
+        int residual = value - prediction;
+        int quantized = (residual >= 0) ? (residual + error) / step : -((error - residual) / step);
+        residuals.append(zigzag(quantized));
+        value = qMax(minimum, qMin(prediction + quantized * step, maximum));
+    });
+}
+
+static void decodePlane(int* values, int width, int height, int error, int minimum, int maximum,
+        const quint16* residuals) {
+    int step = 2 * error + 1;
+    predictPlane(values, width, height, [&](int& value, int prediction) {
+        value = qMax(minimum, qMin(prediction + unzigzag(*residuals++) * step, maximum));
+    });
+}
+
+static QByteArray encodeLegacyHeights(int offsetX, int offsetY, int width, int height, const QVector<quint16>& contents) {
+    QByteArray inflated(DATA_BLOCK_HEADER_SIZE, 0);
+    writeHeader(inflated.data(), offsetX, offsetY, width, height);
+    if (!contents.isEmpty()) {
+        // encode with Paeth filter (see http://en.wikipedia.org/wiki/Portable_Network_Graphics#Filtering)
+        QVector<quint16> filteredContents(contents.size());
+        const quint16* src = contents.constData();
+        quint16* dest = filteredContents.data();
+        *dest++ = *src++;
+        for (quint16* end = dest + width - 1; dest != end; dest++, src++) {
+            *dest = *src - src[-1];
+        }
+        for (int y = 1; y < height; y++) {
+            *dest++ = *src - src[-width];
+            src++;
+            for (quint16* end = dest + width - 1; dest != end; dest++, src++) {
+                int a = src[-1];
+                int b = src[-width];
+                int c = src[-width - 1];
+                int p = a + b - c;
+                int ad = abs(a - p);
+                int bd = abs(b - p);
+                int cd = abs(c - p);
+                *dest = *src - (ad < bd ? (ad < cd ? a : c) : (bd < cd ? b : c));
+            }
+        }
+        inflated.append((const char*)filteredContents.constData(), filteredContents.size() * sizeof(quint16));
+    }
+    return qCompress(inflated);
+}
+
+static QVector<quint16> decodeLegacyHeights(const QByteArray& encoded, int& offsetX, int& offsetY,
+        int& width, int& height) {
+    QByteArray inflated = qUncompress(encoded);
+    if (!readHeader(inflated.constData(), inflated.size(), offsetX, offsetY, width, height)) {
+        return QVector<quint16>();
+    }
+    int payloadSize = inflated.size() - DATA_BLOCK_HEADER_SIZE;
+    QVector<quint16> unfiltered(payloadSize / sizeof(quint16));
+    if (!unfiltered.isEmpty()) {
+        quint16* dest = unfiltered.data();
+        const quint16* src = (const quint16*)(inflated.constData() + DATA_BLOCK_HEADER_SIZE);
+        *dest++ = *src++;
+        for (quint16* end = dest + width - 1; dest != end; dest++, src++) {
+            *dest = *src + dest[-1];
+        }
+        for (int y = 1; y < height; y++) {
+            *dest = (*src++) + dest[-width];
+            dest++;
+            for (quint16* end = dest + width - 1; dest != end; dest++, src++) {
+                int a = dest[-1];
+                int b = dest[-width];
+                int c = dest[-width - 1];
+                int p = a + b - c;
+                int ad = abs(a - p);
+                int bd = abs(b - p);
+                int cd = abs(c - p);
+                *dest = *src + (ad < bd ? (ad < cd ? a : c) : (bd < cd ? b : c));
+            }
+        }
+    }
+    return unfiltered;
+}
+
+QByteArray DataBlockCodec::encodeHeights(int offsetX, int offsetY, int width, int height,
+        const QVector<quint16>& contents, Codec codec) {
+    if (codec == LEGACY_CODEC) {
+        return encodeLegacyHeights(offsetX, offsetY, width, height, contents);
+    }
+    QByteArray encoded(1 + DATA_BLOCK_HEADER_SIZE, 0);
+    encoded[0] = (char)RANS_CODEC;
+    writeHeader(encoded.data() + 1, offsetX, offsetY, width, height);
+    if (contents.isEmpty()) {
+        return encoded;
+    }
+    // heights wrap around like the legacy filter, so every residual fits in sixteen bits
+    QVector<quint16> residuals;
+    residuals.reserve(contents.size());
+    predictPlane(contents.constData(), width, height, [&](quint16 value, int prediction) {
+        residuals.append(zigzag((qint16)(quint16)(value - prediction)));
+    });
+    writeResiduals(residuals, width, encoded);
+    return encoded;
+}
+
+QVector<quint16> DataBlockCodec::decodeHeights(const QByteArray& encoded, int& offsetX, int& offsetY,
+        int& width, int& height) {
+    offsetX = offsetY = width = height = 0;
+    if (encoded.isEmpty()) {
+        return QVector<quint16>();
+    }
+    switch (encoded.at(0)) {
+        case LEGACY_CODEC:
+            return decodeLegacyHeights(encoded, offsetX, offsetY, width, height);
+
+        case RANS_CODEC:
+            break;
+
+        default:
+            qWarning() << "Unknown height codec:" << (int)encoded.at(0);
+            return QVector<quint16>();
+    }
+    const char* data = encoded.constData() + 1;
+    const char* end = encoded.constData() + encoded.size();
+    if (!readHeader(data, end - data, offsetX, offsetY, width, height) || end - data == DATA_BLOCK_HEADER_SIZE) {
+        return QVector<quint16>();
+    }
+    data += DATA_BLOCK_HEADER_SIZE;
+    if (!isValidArea(width, height)) {
+        qWarning() << "Invalid encoded heights [width=" << width << ", height=" << height << "]";
+        return QVector<quint16>();
+    }
+    // decode the residuals in place, then replace them with the heights
+    QVector<quint16> contents(width * height);
+    if (!readResiduals(data, end, width, contents.size(), contents.data())) {
+        qWarning() << "Invalid encoded heights [width=" << width << ", height=" << height << "]";
+        return QVector<quint16>();
+    }
+    predictPlane(contents.data(), width, height, [&](quint16& value, int prediction) {
+        value = prediction + unzigzag(value);
+    });
+    return contents;
+}
+
+static QByteArray encodeLegacyColors(int offsetX, int offsetY, int width, int height, const QByteArray& contents) {
+    QByteArray inflated(DATA_BLOCK_HEADER_SIZE, 0);
+    writeHeader(inflated.data(), offsetX, offsetY, width, height);
+    if (!contents.isEmpty()) {
+        QBuffer buffer(&inflated);
+        buffer.open(QIODevice::WriteOnly | QIODevice::Append);
+        QImage((const uchar*)contents.constData(), width, height, width * DataBlock::COLOR_BYTES,
+            QImage::Format_RGB888).save(&buffer, "JPG");
+    }
+    return qCompress(inflated);
+}
+
+static QByteArray decodeLegacyColors(const QByteArray& encoded, int& offsetX, int& offsetY, int& width, int& height) {
+    QByteArray inflated = qUncompress(encoded);
+    if (!readHeader(inflated.constData(), inflated.size(), offsetX, offsetY, width, height)) {
+        return QByteArray();
+    }
+    int payloadSize = inflated.size() - DATA_BLOCK_HEADER_SIZE;
+    if (payloadSize == 0) {
+        return QByteArray();
+    }
+    QImage image = QImage::fromData((const uchar*)inflated.constData() + DATA_BLOCK_HEADER_SIZE, payloadSize, "JPG");
+    if (image.format() != QImage::Format_RGB888) {
+        image = image.convertToFormat(QImage::Format_RGB888);
+    }
+    QByteArray contents(width * height * DataBlock::COLOR_BYTES, 0);
+    char* dest = contents.data();
+    int stride = width * DataBlock::COLOR_BYTES;
+    for (int y = 0; y < height; y++, dest += stride) {
+        memcpy(dest, image.constScanLine(y), stride);
+    }
+    return contents;
+}
+
+// the range of the YCoCg-R chroma channels
+const int MIN_CHROMA = -255;
+const int MAX_CHROMA = 255;
+
+QByteArray DataBlockCodec::encodeColors(int offsetX, int offsetY, int width, int height,
+        const QByteArray& contents, Codec codec) {
+    if (codec == LEGACY_CODEC) {
+        return encodeLegacyColors(offsetX, offsetY, width, height, contents);
+    }
+    QByteArray encoded(1 + DATA_BLOCK_HEADER_SIZE, 0);
+    encoded[0] = (char)RANS_CODEC;
+    writeHeader(encoded.data() + 1, offsetX, offsetY, width, height);
+    if (contents.isEmpty()) {
+        return encoded;
+    }
+    // convert to YCoCg-R (see http://research.microsoft.com/pubs/102040/2008_colortransforms_malvarsullivansrinivasan.pdf)
+    int area = width * height;
+    QVector<int> luma(area);
+    QVector<int> orange(area);
+    QVector<int> green(area);
+    const uchar* src = (const uchar*)contents.constData();
+    for (int i = 0; i < area; i++, src += DataBlock::COLOR_BYTES) {
+        int co = src[0] - src[2];
+        int t = src[2] + (co >> 1);
+        int cg = src[1] - t;
+        luma[i] = t + (cg >> 1);
+        orange[i] = co;
+        green[i] = cg;
+    }
+
+    // average the chroma over 2x2 blocks, as in JPEG's 4:2:0
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    int chromaArea = chromaWidth * chromaHeight;
+    QVector<int> chroma(chromaArea * 2);
+    int* orangeDest = chroma.data();
+    int* greenDest = orangeDest + chromaArea;
+    for (int y = 0; y < chromaHeight; y++) {
+        for (int x = 0; x < chromaWidth; x++) {
+            int orangeSum = 0, greenSum = 0, count = 0;
+            for (int j = y * 2, maxJ = qMin(j + 2, height); j < maxJ; j++) {
+                for (int i = x * 2, maxI = qMin(i + 2, width); i < maxI; i++) {
+                    orangeSum += orange.at(j * width + i);
+                    greenSum += green.at(j * width + i);
+                    count++;
+                }
+            }
+            int half = count / 2;
+            *orangeDest++ = (orangeSum >= 0) ? (orangeSum + half) / count : -((half - orangeSum) / count);
+            *greenDest++ = (greenSum >= 0) ? (greenSum + half) / count : -((half - greenSum) / count);
+        }
+    }
+
+    QVector<quint16> residuals;
+    residuals.reserve(area);
+    encodePlane(luma.constData(), width, height, COLOR_LUMA_ERROR, 0, 255, residuals);
+    writeResiduals(residuals, width, encoded);
+
+    residuals.clear();
+    encodePlane(chroma.constData(), chromaWidth, chromaHeight, COLOR_CHROMA_ERROR, MIN_CHROMA, MAX_CHROMA, residuals);
+    encodePlane(chroma.constData() + chromaArea, chromaWidth, chromaHeight, COLOR_CHROMA_ERROR,
+        MIN_CHROMA, MAX_CHROMA, residuals);
+    writeResiduals(residuals, chromaWidth, encoded);
+
+    return encoded;
+}
+
+QByteArray DataBlockCodec::decodeColors(const QByteArray& encoded, int& offsetX, int& offsetY, int& width, int& height) {
+    offsetX = offsetY = width = height = 0;
+    if (encoded.isEmpty()) {
+        return QByteArray();
+    }
+    switch (encoded.at(0)) {
+        case LEGACY_CODEC:
+            return decodeLegacyColors(encoded, offsetX, offsetY, width, height);
+
+        case RANS_CODEC:
+            break;
+
+        default:
+            qWarning() << "Unknown color codec:" << (int)encoded.at(0);
+            return QByteArray();
+    }
+    const char* data = encoded.constData() + 1;
+    const char* end = encoded.constData() + encoded.size();
+    if (!readHeader(data, end - data, offsetX, offsetY, width, height) || end - data == DATA_BLOCK_HEADER_SIZE) {
+        return QByteArray();
+    }
+    data += DATA_BLOCK_HEADER_SIZE;
+    if (!isValidArea(width, height)) {
+        qWarning() << "Invalid encoded colors [width=" << width << ", height=" << height << "]";
+        return QByteArray();
+    }
+    int area = width * height;
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    int chromaArea = chromaWidth * chromaHeight;
+
+    QVector<quint16> lumaResiduals(area);
+    QVector<quint16> chromaResiduals(chromaArea * 2);
+    if (!(readResiduals(data, end, width, area, lumaResiduals.data()) &&
+            readResiduals(data, end, chromaWidth, chromaResiduals.size(), chromaResiduals.data()))) {
+        qWarning() << "Invalid encoded colors [width=" << width << ", height=" << height << "]";
+        return QByteArray();
+    }
+    QVector<int> luma(area);
+    decodePlane(luma.data(), width, height, COLOR_LUMA_ERROR, 0, 255, lumaResiduals.constData());
+    QVector<int> chroma(chromaArea * 2);
+    decodePlane(chroma.data(), chromaWidth, chromaHeight, COLOR_CHROMA_ERROR, MIN_CHROMA, MAX_CHROMA,
+        chromaResiduals.constData());
+    decodePlane(chroma.data() + chromaArea, chromaWidth, chromaHeight, COLOR_CHROMA_ERROR,
+        MIN_CHROMA, MAX_CHROMA, chromaResiduals.constData() + chromaArea);
+
+    QByteArray contents(area * DataBlock::COLOR_BYTES, 0);
+    uchar* dest = (uchar*)contents.data();
+    const int* lumaSrc = luma.constData();
+    for (int y = 0; y < height; y++) {
+        const int* orangeRow = chroma.constData() + (y / 2) * chromaWidth;
+        const int* greenRow = orangeRow + chromaArea;
+        for (int x = 0; x < width; x++, dest += DataBlock::COLOR_BYTES) {
+            int co = orangeRow[x / 2];
+            int cg = greenRow[x / 2];
+            int t = *lumaSrc++ - (cg >> 1);
+            int g = cg + t;
+            int b = t - (co >> 1);
+            int r = b + co;
+            dest[0] = qMax(0, qMin(r, 255));
+            dest[1] = qMax(0, qMin(g, 255));
+            dest[2] = qMax(0, qMin(b, 255));
+        }
+    }
+    return contents;
+}
@@ -0,0 +1,44 @@
+//
+//  DataBlockCodec.h
+//  libraries/metavoxels/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_DataBlockCodec_h
+#define hifi_DataBlockCodec_h
+
+#include <QByteArray>
+#include <QVector>
+
+/// Encodes and decodes the contents of heightfield data blocks along with their offset/size headers.  The first byte of
+/// an encoded block identifies its codec.  Blocks written before codecs were identified are zlib streams, whose first
+/// byte (the high byte of the big-endian uncompressed size) is always zero for blocks of the sizes we use, so they
+/// decode as LEGACY_CODEC.
+class DataBlockCodec {
+public:
+
+    enum Codec { LEGACY_CODEC = 0, RANS_CODEC = 1 };
+
+    /// Heights are coded losslessly: median-predicted residuals, entropy coded with rANS.
+    static QByteArray encodeHeights(int offsetX, int offsetY, int width, int height,
+        const QVector<quint16>& contents, Codec codec = RANS_CODEC);
+
+    static QVector<quint16> decodeHeights(const QByteArray& encoded, int& offsetX, int& offsetY, int& width, int& height);
+
+    /// Colors (RGB888) are coded lossily: YCoCg with subsampled chroma, each plane coded by near-lossless prediction
+    /// (luma within COLOR_LUMA_ERROR, chroma within COLOR_CHROMA_ERROR) and rANS.
+    static QByteArray encodeColors(int offsetX, int offsetY, int width, int height,
+        const QByteArray& contents, Codec codec = RANS_CODEC);
+
+    static QByteArray decodeColors(const QByteArray& encoded, int& offsetX, int& offsetY, int& width, int& height);
+
+    static const int COLOR_LUMA_ERROR;
+    static const int COLOR_CHROMA_ERROR;
+};
+
+#endif // hifi_DataBlockCodec_h
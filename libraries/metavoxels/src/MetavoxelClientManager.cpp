@@ -238,9 +238,12 @@ void MetavoxelUpdater::getStats(QObject* receiver, const QByteArray& method) {
         Q_ARG(int, sendTotal), Q_ARG(int, receiveProgress), Q_ARG(int, receiveTotal));
 }
 
+// the grid to which we snap the LOD position, so that the server can share deltas between clients in the same area
+const float LOD_POSITION_GRANULARITY = 2.0f;
+
 void MetavoxelUpdater::sendUpdates() {
     // get the latest LOD from the client manager
-    _lod = _clientManager->getLOD();
+    _lod = _clientManager->getLOD().getQuantized(LOD_POSITION_GRANULARITY);
 
     // send updates for all clients
     foreach (MetavoxelClient* client, _clients) {
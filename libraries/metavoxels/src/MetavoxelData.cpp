@@ -11,6 +11,10 @@
 
 #include <QDateTime>
 #include <QDebugStateSaver>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
 #include <QtDebug>
 
 #include "MetavoxelData.h"
@@ -23,11 +27,62 @@ REGISTER_META_OBJECT(DefaultMetavoxelRenderer)
 
 static int metavoxelDataTypeId = registerSimpleMetaType<MetavoxelData>();
 
+/// Splits the independent subtrees of a tour among worker threads from the global pool.  Each node above the split depth
+/// queues its children as tasks, then helps run queued tasks until its own are done.  The thread that queued a task is the
+/// one most likely to run it (we take the most recent tasks first), while idle workers steal the oldest (largest) ones.
+class ParallelTour {
+public:
+    
+    ParallelTour(MetavoxelVisitor& visitor, float size);
+    ~ParallelTour();
+    
+    MetavoxelVisitationStack& getRootStack() { return _rootStack; }
+    
+    /// Checks whether we should split the children of the visited node into separate tasks.
+    bool shouldSplit(const MetavoxelVisitation& visitation) const { return visitation.info.size > _minimumSplitSize; }
+    
+    /// Guides the visitor to the children of the visited node in separate tasks, waiting for them to finish.
+    /// \return true to keep going, false to short circuit the tour
+    bool guideToChildren(MetavoxelVisitation& visitation, int encodedOrder);
+    
+    /// Runs queued tasks until the tour is finished.
+    void work();
+
+private:
+    
+    class Task {
+    public:
+        MetavoxelVisitation* parent;
+        int index;
+        int* remaining;
+    };
+    
+    void runTask(const Task& task);
+    
+    MetavoxelVisitor& _visitor;
+    QThread* _thread;
+    float _minimumSplitSize;
+    MetavoxelVisitationStack _rootStack;
+    
+    QMutex _mutex;
+    QWaitCondition _tasksChanged;
+    QList<Task> _tasks;
+    QList<MetavoxelVisitationStack*> _freeStacks;
+    QHash<QThread*, MetavoxelVisitor*> _threadVisitors;
+    int _workers;
+    bool _finished;
+    QAtomicInt _shortCircuited;
+};
+
 MetavoxelLOD::MetavoxelLOD(const glm::vec3& position, float threshold) :
     position(position),
     threshold(threshold) {
 }
 
+MetavoxelLOD MetavoxelLOD::getQuantized(float granularity) const {
+    return MetavoxelLOD((glm::floor(position / granularity) + glm::vec3(0.5f, 0.5f, 0.5f)) * granularity, threshold);
+}
+
 bool MetavoxelLOD::shouldSubdivide(const glm::vec3& minimum, float size, float multiplier) const {
     float halfSize = size * 0.5f;
     return size >= (glm::distance(position, minimum + glm::vec3(halfSize, halfSize, halfSize)) - halfSize) *
@@ -122,7 +177,9 @@ void MetavoxelData::guide(MetavoxelVisitor& visitor) {
     // start with the root values/defaults (plus the guide attribute)
     const QVector<AttributePointer>& inputs = visitor.getInputs();
     const QVector<AttributePointer>& outputs = visitor.getOutputs();
-    MetavoxelVisitation& firstVisitation = visitor.acquireVisitation();
+    ParallelTour* tour = (visitor.isParallel() && outputs.isEmpty()) ? new ParallelTour(visitor, _size) : NULL;
+    MetavoxelVisitationStack& stack = tour ? tour->getRootStack() : visitor.getVisitations();
+    MetavoxelVisitation& firstVisitation = stack.acquire(&visitor);
     firstVisitation.info.minimum = getMinimum();
     firstVisitation.info.size = _size;
     for (int i = 0; i < inputs.size(); i++) {
@@ -159,7 +216,10 @@ void MetavoxelData::guide(MetavoxelVisitor& visitor) {
         }
         value = AttributeValue();
     }
-    visitor.releaseVisitation();
+    stack.release();
+    
+    // wait for the workers and merge their state
+    delete tour;
 }
 
 void MetavoxelData::guideToDifferent(const MetavoxelData& other, MetavoxelVisitor& visitor) {
@@ -395,6 +455,13 @@ public:
     
     SpannerFetchVisitor(const AttributePointer& attribute, const Box& bounds, QVector<SharedObjectPointer>& results);
     
+    /// Creates a copy for a worker thread that collects its results locally.
+    SpannerFetchVisitor(const SpannerFetchVisitor& other);
+    
+    virtual bool isParallel() const;
+    virtual MetavoxelVisitor* createThreadVisitor();
+    virtual void mergeThreadVisitor(MetavoxelVisitor* visitor);
+    
     virtual bool visit(Spanner* spanner);
     
     virtual int visit(MetavoxelInfo& info);
@@ -403,6 +470,7 @@ private:
     
     const Box& _bounds;
     QVector<SharedObjectPointer>& _results;
+    QVector<SharedObjectPointer> _threadResults;
 };
 
 SpannerFetchVisitor::SpannerFetchVisitor(const AttributePointer& attribute, const Box& bounds,
@@ -412,6 +480,24 @@ SpannerFetchVisitor::SpannerFetchVisitor(const AttributePointer& attribute, cons
     _results(results) {
 }
 
+SpannerFetchVisitor::SpannerFetchVisitor(const SpannerFetchVisitor& other) :
+    SpannerVisitor(other),
+    _bounds(other._bounds),
+    _results(_threadResults) {
+}
+
+bool SpannerFetchVisitor::isParallel() const {
+    return true;
+}
+
+MetavoxelVisitor* SpannerFetchVisitor::createThreadVisitor() {
+    return new SpannerFetchVisitor(*this);
+}
+
+void SpannerFetchVisitor::mergeThreadVisitor(MetavoxelVisitor* visitor) {
+    _results += static_cast<SpannerFetchVisitor*>(visitor)->_threadResults;
+}
+
 bool SpannerFetchVisitor::visit(Spanner* spanner) {
     if (spanner->getBounds().intersects(_bounds)) {
         _results.append(spanner);
@@ -1347,8 +1433,7 @@ MetavoxelVisitor::MetavoxelVisitor(const QVector<AttributePointer>& inputs,
     _inputs(inputs),
     _outputs(outputs),
     _lod(lod),
-    _minimumLODThresholdMultiplier(FLT_MAX),
-    _depth(-1) {
+    _minimumLODThresholdMultiplier(FLT_MAX) {
     
     // find the minimum LOD threshold multiplier over all attributes
     foreach (const AttributePointer& attribute, _inputs) {
@@ -1370,12 +1455,16 @@ bool MetavoxelVisitor::postVisit(MetavoxelInfo& info) {
     return false;
 }
 
-MetavoxelVisitation& MetavoxelVisitor::acquireVisitation() {
-    if (++_depth >= _visitations.size()) {
-        _visitations.append(MetavoxelVisitation(_depth == 0 ? NULL : &_visitations[_depth - 1],
-            this, _inputs.size() + 1, _outputs.size()));
-    }
-    return _visitations[_depth];
+bool MetavoxelVisitor::isParallel() const {
+    return false;
+}
+
+MetavoxelVisitor* MetavoxelVisitor::createThreadVisitor() {
+    return NULL;
+}
+
+void MetavoxelVisitor::mergeThreadVisitor(MetavoxelVisitor* visitor) {
+    // nothing by default
 }
 
 SpannerVisitor::SpannerVisitor(const QVector<AttributePointer>& spannerInputs, const QVector<AttributePointer>& inputs,
@@ -1388,13 +1477,16 @@ SpannerVisitor::SpannerVisitor(const QVector<AttributePointer>& spannerInputs, c
 void SpannerVisitor::prepare(MetavoxelData* data) {
     MetavoxelVisitor::prepare(data);
     _visit = Spanner::getAndIncrementNextVisit();
+    
+    // the workers of a parallel tour share the visit marks of the thread that started it
+    _visitThread = QThread::currentThread();
 }
 
 int SpannerVisitor::visit(MetavoxelInfo& info) {
     for (int end = _inputs.size(), i = end - _spannerInputCount; i < end; i++) {
         foreach (const SharedObjectPointer& object, info.inputValues.at(i).getInlineValue<SharedObjectSet>()) {
             Spanner* spanner = static_cast<Spanner*>(object.data());
-            if (spanner->testAndSetVisited(_visit) && !visit(spanner)) {
+            if (spanner->testAndSetVisited(_visit, _visitThread) && !visit(spanner)) {
                 return SHORT_CIRCUIT;
             }
         }
@@ -1469,31 +1561,185 @@ bool MetavoxelGuide::guideToDifferent(MetavoxelVisitation& visitation) {
 DefaultMetavoxelGuide::DefaultMetavoxelGuide() {
 }
 
+static inline void setUpChildVisitation(const MetavoxelVisitation& visitation,
+        MetavoxelVisitation& nextVisitation, int index) {
+    for (int j = 0; j < visitation.inputNodes.size(); j++) {
+        MetavoxelNode* node = visitation.inputNodes.at(j);
+        const AttributeValue& parentValue = visitation.info.inputValues.at(j);
+        MetavoxelNode* child = (node && (visitation.info.size >= visitation.info.lodBase *
+            parentValue.getAttribute()->getLODThresholdMultiplier())) ? node->getChild(index) : NULL;
+        nextVisitation.info.inputValues[j] = ((nextVisitation.inputNodes[j] = child)) ?
+            child->getAttributeValue(parentValue.getAttribute()) : parentValue.getAttribute()->inherit(parentValue);
+    }
+    for (int j = 0; j < visitation.outputNodes.size(); j++) {
+        MetavoxelNode* node = visitation.outputNodes.at(j);
+        MetavoxelNode* child = (node && (visitation.info.size >= visitation.info.lodBase *
+            visitation.visitor->getOutputs().at(j)->getLODThresholdMultiplier())) ? node->getChild(index) : NULL;
+        nextVisitation.outputNodes[j] = child;
+    }
+    nextVisitation.info.minimum = getNextMinimum(visitation.info.minimum, nextVisitation.info.size, index);
+}
+
+class ParallelTourWorker : public QRunnable {
+public:
+    
+    ParallelTourWorker(ParallelTour* tour);
+    
+    virtual void run();
+
+private:
+    
+    ParallelTour* _tour;
+};
+
+ParallelTourWorker::ParallelTourWorker(ParallelTour* tour) :
+    _tour(tour) {
+}
+
+void ParallelTourWorker::run() {
+    _tour->work();
+}
+
+/// The depth (below the root) at which parallel tours stop splitting nodes into tasks: 8^3 = 512 subtrees.
+const int PARALLEL_SPLIT_DEPTH = 3;
+
+ParallelTour::ParallelTour(MetavoxelVisitor& visitor, float size) :
+    _visitor(visitor),
+    _thread(QThread::currentThread()),
+    _minimumSplitSize(size / (1 << PARALLEL_SPLIT_DEPTH)),
+    _rootStack(this),
+    _workers(0),
+    _finished(false),
+    _shortCircuited(0) {
+    
+    // only take the threads that are free; this thread helps out as well
+    QMutexLocker locker(&_mutex);
+    for (int i = 1, count = QThread::idealThreadCount(); i < count; i++) {
+        ParallelTourWorker* worker = new ParallelTourWorker(this);
+        if (!QThreadPool::globalInstance()->tryStart(worker)) {
+            delete worker;
+            break;
+        }
+        _workers++;
+    }
+}
+
+ParallelTour::~ParallelTour() {
+    QMutexLocker locker(&_mutex);
+    _finished = true;
+    _tasksChanged.wakeAll();
+    while (_workers > 0) {
+        _tasksChanged.wait(&_mutex);
+    }
+    locker.unlock();
+    
+    foreach (MetavoxelVisitor* visitor, _threadVisitors) {
+        if (visitor != &_visitor) {
+            _visitor.mergeThreadVisitor(visitor);
+            delete visitor;
+        }
+    }
+    qDeleteAll(_freeStacks);
+}
+
+bool ParallelTour::guideToChildren(MetavoxelVisitation& visitation, int encodedOrder) {
+    int remaining = MetavoxelNode::CHILD_COUNT;
+    QMutexLocker locker(&_mutex);
+    for (int i = 0; i < MetavoxelNode::CHILD_COUNT; i++) {
+        Task task = { &visitation, encodedOrder & ORDER_ELEMENT_MASK, &remaining };
+        _tasks.append(task);
+        encodedOrder >>= ORDER_ELEMENT_BITS;
+    }
+    _tasksChanged.wakeAll();
+    
+    // help out (starting with our own tasks) until the children are done
+    while (remaining > 0) {
+        if (_tasks.isEmpty()) {
+            _tasksChanged.wait(&_mutex);
+            continue;
+        }
+        Task task = _tasks.takeLast();
+        locker.unlock();
+        runTask(task);
+        locker.relock();
+    }
+    locker.unlock();
+    
+    if (_shortCircuited.load()) {
+        return false;
+    }
+    visitation.visitor->postVisit(visitation.info);
+    return true;
+}
+
+void ParallelTour::work() {
+    QMutexLocker locker(&_mutex);
+    while (!_finished) {
+        if (_tasks.isEmpty()) {
+            _tasksChanged.wait(&_mutex);
+            continue;
+        }
+        Task task = _tasks.takeFirst();
+        locker.unlock();
+        runTask(task);
+        locker.relock();
+    }
+    if (--_workers == 0) {
+        _tasksChanged.wakeAll();
+    }
+}
+
+void ParallelTour::runTask(const Task& task) {
+    QMutexLocker locker(&_mutex);
+    if (!_shortCircuited.load()) {
+        // each task gets a visitation stack from the pool and the visitor belonging to its thread
+        MetavoxelVisitationStack* stack = _freeStacks.isEmpty() ? new MetavoxelVisitationStack(this) :
+            _freeStacks.takeLast();
+        MetavoxelVisitor* visitor = &_visitor;
+        QThread* thread = QThread::currentThread();
+        if (thread != _thread) {
+            MetavoxelVisitor*& threadVisitor = _threadVisitors[thread];
+            if (!threadVisitor) {
+                threadVisitor = _visitor.createThreadVisitor();
+                if (!threadVisitor) {
+                    threadVisitor = &_visitor;
+                }
+            }
+            visitor = threadVisitor;
+        }
+        locker.unlock();
+        
+        MetavoxelVisitation& visitation = stack->acquire(visitor, task.parent);
+        visitation.info.size = task.parent->info.size * 0.5f;
+        setUpChildVisitation(*task.parent, visitation, task.index);
+        if (!static_cast<MetavoxelGuide*>(visitation.info.inputValues.last().getInlineValue<
+                SharedObjectPointer>().data())->guide(visitation)) {
+            _shortCircuited.store(1);
+        }
+        stack->release();
+        
+        locker.relock();
+        _freeStacks.append(stack);
+    }
+    (*task.remaining)--;
+    _tasksChanged.wakeAll();
+}
+
 static inline bool defaultGuideToChildren(MetavoxelVisitation& visitation, int encodedOrder) {
-    MetavoxelVisitation& nextVisitation = visitation.visitor->acquireVisitation();
+    ParallelTour* tour = visitation.stack->getTour();
+    if (tour && tour->shouldSplit(visitation)) {
+        return tour->guideToChildren(visitation, encodedOrder);
+    }
+    MetavoxelVisitation& nextVisitation = visitation.stack->acquire(visitation.visitor);
     nextVisitation.info.size = visitation.info.size * 0.5f;
     for (int i = 0; i < MetavoxelNode::CHILD_COUNT; i++) {
         // the encoded order tells us the child indices for each iteration
         int index = encodedOrder & ORDER_ELEMENT_MASK;
         encodedOrder >>= ORDER_ELEMENT_BITS;
-        for (int j = 0; j < visitation.inputNodes.size(); j++) {
-            MetavoxelNode* node = visitation.inputNodes.at(j);
-            const AttributeValue& parentValue = visitation.info.inputValues.at(j);
-            MetavoxelNode* child = (node && (visitation.info.size >= visitation.info.lodBase *
-                parentValue.getAttribute()->getLODThresholdMultiplier())) ? node->getChild(index) : NULL;
-            nextVisitation.info.inputValues[j] = ((nextVisitation.inputNodes[j] = child)) ?
-                child->getAttributeValue(parentValue.getAttribute()) : parentValue.getAttribute()->inherit(parentValue);
-        }
-        for (int j = 0; j < visitation.outputNodes.size(); j++) {
-            MetavoxelNode* node = visitation.outputNodes.at(j);
-            MetavoxelNode* child = (node && (visitation.info.size >= visitation.info.lodBase *
-                visitation.visitor->getOutputs().at(j)->getLODThresholdMultiplier())) ? node->getChild(index) : NULL;
-            nextVisitation.outputNodes[j] = child;
-        }
-        nextVisitation.info.minimum = getNextMinimum(visitation.info.minimum, nextVisitation.info.size, index);
+        setUpChildVisitation(visitation, nextVisitation, index);
         if (!static_cast<MetavoxelGuide*>(nextVisitation.info.inputValues.last().getInlineValue<
                 SharedObjectPointer>().data())->guide(nextVisitation)) {
-            visitation.visitor->releaseVisitation();
+            visitation.stack->release();
             return false;
         }
         for (int j = 0; j < nextVisitation.outputNodes.size(); j++) {
@@ -1537,7 +1783,7 @@ static inline bool defaultGuideToChildren(MetavoxelVisitation& visitation, int e
             value = node->getAttributeValue(value.getAttribute()); 
         }
     }
-    visitation.visitor->releaseVisitation();
+    visitation.stack->release();
     visitation.info.outputValues.swap(nextVisitation.info.outputValues);
     bool changed = visitation.visitor->postVisit(visitation.info);
     visitation.info.outputValues.swap(nextVisitation.info.outputValues);
@@ -1625,7 +1871,7 @@ bool DefaultMetavoxelGuide::guideToDifferent(MetavoxelVisitation& visitation) {
         return defaultGuideToChildren(visitation, encodedOrder);
     }
     bool onlyVisitDifferent = !(encodedOrder & MetavoxelVisitor::ALL_NODES);
-    MetavoxelVisitation& nextVisitation = visitation.visitor->acquireVisitation();
+    MetavoxelVisitation& nextVisitation = visitation.stack->acquire(visitation.visitor);
     nextVisitation.compareNodes.resize(visitation.compareNodes.size());
     nextVisitation.info.size = visitation.info.size * 0.5f;
     for (int i = 0; i < MetavoxelNode::CHILD_COUNT; i++) {
@@ -1658,7 +1904,7 @@ bool DefaultMetavoxelGuide::guideToDifferent(MetavoxelVisitation& visitation) {
         nextVisitation.info.minimum = getNextMinimum(visitation.info.minimum, nextVisitation.info.size, index);
         if (!static_cast<MetavoxelGuide*>(nextVisitation.info.inputValues.last().getInlineValue<
                 SharedObjectPointer>().data())->guideToDifferent(nextVisitation)) {
-            visitation.visitor->releaseVisitation();
+            visitation.stack->release();
             return false;
         }
         for (int j = 0; j < nextVisitation.outputNodes.size(); j++) {
@@ -1702,7 +1948,7 @@ bool DefaultMetavoxelGuide::guideToDifferent(MetavoxelVisitation& visitation) {
             value = node->getAttributeValue(value.getAttribute()); 
         }
     }
-    visitation.visitor->releaseVisitation();
+    visitation.stack->release();
     visitation.info.outputValues.swap(nextVisitation.info.outputValues);
     bool changed = visitation.visitor->postVisit(visitation.info);
     visitation.info.outputValues.swap(nextVisitation.info.outputValues);
@@ -1727,16 +1973,52 @@ bool DefaultMetavoxelGuide::guideToDifferent(MetavoxelVisitation& visitation) {
     return true;
 }
 
+MetavoxelVisitationStack::MetavoxelVisitationStack(ParallelTour* tour) :
+    _tour(tour),
+    _depth(-1) {
+}
+
+MetavoxelVisitationStack::MetavoxelVisitationStack(const MetavoxelVisitationStack& other) :
+    _tour(other._tour),
+    _depth(-1) {
+}
+
+MetavoxelVisitationStack::~MetavoxelVisitationStack() {
+}
+
+MetavoxelVisitationStack& MetavoxelVisitationStack::operator=(const MetavoxelVisitationStack& other) {
+    _tour = other._tour;
+    return *this;
+}
+
+MetavoxelVisitation& MetavoxelVisitationStack::acquire(MetavoxelVisitor* visitor, MetavoxelVisitation* parent) {
+    if (++_depth >= _visitations.size()) {
+        _visitations.append(MetavoxelVisitation(_depth == 0 ? parent : &_visitations[_depth - 1],
+            visitor, visitor->getInputs().size() + 1, visitor->getOutputs().size()));
+    }
+    MetavoxelVisitation& visitation = _visitations[_depth];
+    if (_depth == 0) {
+        // the bottom of a task's stack continues from the visitation that spawned the task
+        visitation.previous = parent;
+        visitation.info.parentInfo = parent ? &parent->info : NULL;
+    }
+    visitation.visitor = visitor;
+    visitation.stack = this;
+    return visitation;
+}
+
 MetavoxelVisitation::MetavoxelVisitation(MetavoxelVisitation* previous,
         MetavoxelVisitor* visitor, int inputNodesSize, int outputNodesSize) :
     previous(previous),
     visitor(visitor),
+    stack(NULL),
     inputNodes(inputNodesSize),
     outputNodes(outputNodesSize),
     info(previous ? &previous->info : NULL, inputNodesSize, outputNodesSize) {
 }
 
-MetavoxelVisitation::MetavoxelVisitation() {
+MetavoxelVisitation::MetavoxelVisitation() :
+    stack(NULL) {
 }
 
 bool MetavoxelVisitation::isInputLeaf(int index) const {   
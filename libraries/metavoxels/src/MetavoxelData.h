@@ -28,6 +28,8 @@ class MetavoxelNode;
 class MetavoxelRendererImplementation;
 class MetavoxelVisitation;
 class MetavoxelVisitor;
+class ParallelTour;
+class QThread;
 class Spanner;
 
 /// Determines whether to subdivide each node when traversing.  Contains the position (presumed to be of the viewer) and a
@@ -43,6 +45,10 @@ public:
     
     bool isValid() const { return threshold > 0.0f; }
     
+    /// Returns a copy of this LOD with the position snapped to the center of a grid cell of the given size, so that
+    /// viewers close to one another end up with identical LODs.
+    MetavoxelLOD getQuantized(float granularity) const;
+    
     /// Checks whether, according to this LOD, we should subdivide the described voxel.
     bool shouldSubdivide(const glm::vec3& minimum, float size, float multiplier = 1.0f) const;
     
@@ -294,6 +300,36 @@ public:
     glm::vec3 getCenter() const { return minimum + glm::vec3(size, size, size) * 0.5f; }
 };
 
+/// A stack of visitations, one for each level of a tour, reused from tour to tour.  Visitors have one for their serial
+/// tours; parallel tours draw one for each of their tasks from a pool.
+class MetavoxelVisitationStack {
+public:
+    
+    MetavoxelVisitationStack(ParallelTour* tour = NULL);
+    
+    /// Copies start out empty, since our visitations point to one another.
+    MetavoxelVisitationStack(const MetavoxelVisitationStack& other);
+    ~MetavoxelVisitationStack();
+    
+    MetavoxelVisitationStack& operator=(const MetavoxelVisitationStack& other);
+    
+    /// Returns a pointer to the parallel tour to which the stack belongs, if any.
+    ParallelTour* getTour() const { return _tour; }
+    
+    /// Acquires the next visitation, incrementing the depth.
+    /// \param parent for the first visitation on the stack, the visitation to which it should point as its predecessor
+    MetavoxelVisitation& acquire(MetavoxelVisitor* visitor, MetavoxelVisitation* parent = NULL);
+    
+    /// Releases the current visitation, decrementing the depth.
+    void release() { _depth--; }
+
+private:
+    
+    ParallelTour* _tour;
+    QList<MetavoxelVisitation> _visitations;
+    int _depth;
+};
+
 /// Base class for visitors to metavoxels.
 class MetavoxelVisitor {
 public:
@@ -356,11 +392,26 @@ public:
     /// \return whether or not any outputs were set in the info
     virtual bool postVisit(MetavoxelInfo& info);
 
+    /// Checks whether the guide may split the tour's independent subtrees among worker threads.  Only visitors without
+    /// outputs can be parallel.  Parallel tours don't follow the visitation order, and a short circuit stops the tour only
+    /// once the subtrees already under way are done.
+    virtual bool isParallel() const;
+    
+    /// Creates a copy of this visitor to hold the state of one worker thread of a parallel tour, or returns NULL to share
+    /// this visitor between all threads (in which case visit and postVisit must be thread-safe).
+    virtual MetavoxelVisitor* createThreadVisitor();
+    
+    /// Merges the state of a visitor returned by createThreadVisitor back into this one at the end of a parallel tour.
+    virtual void mergeThreadVisitor(MetavoxelVisitor* visitor);
+
+    /// Returns a reference to the stack used for our serial tours.
+    MetavoxelVisitationStack& getVisitations() { return _visitations; }
+
     /// Acquires the next visitation, incrementing the depth.
-    MetavoxelVisitation& acquireVisitation();
+    MetavoxelVisitation& acquireVisitation() { return _visitations.acquire(this); }
 
     /// Releases the current visitation, decrementing the depth.
-    void releaseVisitation() { _depth--; }
+    void releaseVisitation() { _visitations.release(); }
 
 protected:
 
@@ -369,8 +420,7 @@ protected:
     MetavoxelLOD _lod;
     float _minimumLODThresholdMultiplier;
     MetavoxelData* _data;
-    QList<MetavoxelVisitation> _visitations;
-    int _depth;
+    MetavoxelVisitationStack _visitations;
 };
 
 /// Base class for visitors to spanners.
@@ -395,6 +445,7 @@ protected:
     int _spannerInputCount;
     int _order;
     int _visit;
+    QThread* _visitThread;
 };
 
 /// Base class for ray intersection visitors.
@@ -474,6 +525,7 @@ public:
 
     MetavoxelVisitation* previous;
     MetavoxelVisitor* visitor;
+    MetavoxelVisitationStack* stack;
     QVector<MetavoxelNode*> inputNodes;
     QVector<MetavoxelNode*> outputNodes;
     QVector<MetavoxelNode*> compareNodes;
@@ -11,7 +11,6 @@
 
 #include <limits>
 
-#include <QBuffer>
 #include <QFileDialog>
 #include <QHBoxLayout>
 #include <QItemEditorFactory>
@@ -24,6 +23,7 @@
 #include <GeometryUtil.h>
 #include <Settings.h>
 
+#include "DataBlockCodec.h"
 #include "MetavoxelData.h"
 #include "Spanner.h"
 
@@ -79,8 +79,12 @@ void Spanner::setBounds(const Box& bounds) {
 }
 
 bool Spanner::testAndSetVisited(int visit) {
+    return testAndSetVisited(visit, QThread::currentThread());
+}
+
+bool Spanner::testAndSetVisited(int visit, QThread* thread) {
     QMutexLocker locker(&_lastVisitsMutex);
-    int& lastVisit = _lastVisits[QThread::currentThread()];
+    int& lastVisit = _lastVisits[thread];
     if (lastVisit == visit) {
         return false;
     }
@@ -377,76 +381,6 @@ HeightfieldData::HeightfieldData(int width) :
 
 const int HEIGHTFIELD_DATA_HEADER_SIZE = sizeof(qint32) * 4;
 
-static QByteArray encodeHeightfieldHeight(int offsetX, int offsetY, int width, int height, const QVector<quint16>& contents) {
-    QByteArray inflated(HEIGHTFIELD_DATA_HEADER_SIZE, 0);
-    qint32* header = (qint32*)inflated.data();
-    *header++ = offsetX;
-    *header++ = offsetY;
-    *header++ = width;
-    *header++ = height;
-    if (!contents.isEmpty()) {
-        // encode with Paeth filter (see http://en.wikipedia.org/wiki/Portable_Network_Graphics#Filtering)
-        QVector<quint16> filteredContents(contents.size());
-        const quint16* src = contents.constData();
-        quint16* dest = filteredContents.data();
-        *dest++ = *src++;
-        for (quint16* end = dest + width - 1; dest != end; dest++, src++) {
-            *dest = *src - src[-1];
-        }
-        for (int y = 1; y < height; y++) {
-            *dest++ = *src - src[-width];
-            src++;
-            for (quint16* end = dest + width - 1; dest != end; dest++, src++) {
-                int a = src[-1];
-                int b = src[-width];
-                int c = src[-width - 1];
-                int p = a + b - c;
-                int ad = abs(a - p);
-                int bd = abs(b - p);
-                int cd = abs(c - p);
-                *dest = *src - (ad < bd ? (ad < cd ? a : c) : (bd < cd ? b : c));
-            }
-        }  
-        inflated.append((const char*)filteredContents.constData(), filteredContents.size() * sizeof(quint16));
-    }
-    return qCompress(inflated);
-}
-
-static QVector<quint16> decodeHeightfieldHeight(const QByteArray& encoded, int& offsetX, int& offsetY,
-        int& width, int& height) {
-    QByteArray inflated = qUncompress(encoded);
-    const qint32* header = (const qint32*)inflated.constData();
-    offsetX = *header++;
-    offsetY = *header++;
-    width = *header++;
-    height = *header++;
-    int payloadSize = inflated.size() - HEIGHTFIELD_DATA_HEADER_SIZE;
-    QVector<quint16> unfiltered(payloadSize / sizeof(quint16));
-    if (!unfiltered.isEmpty()) {
-        quint16* dest = unfiltered.data();
-        const quint16* src = (const quint16*)(inflated.constData() + HEIGHTFIELD_DATA_HEADER_SIZE);
-        *dest++ = *src++;
-        for (quint16* end = dest + width - 1; dest != end; dest++, src++) {
-            *dest = *src + dest[-1];
-        }
-        for (int y = 1; y < height; y++) {
-            *dest = (*src++) + dest[-width];
-            dest++;
-            for (quint16* end = dest + width - 1; dest != end; dest++, src++) {
-                int a = dest[-1];
-                int b = dest[-width];
-                int c = dest[-width - 1];
-                int p = a + b - c;
-                int ad = abs(a - p);
-                int bd = abs(b - p);
-                int cd = abs(c - p);
-                *dest = *src + (ad < bd ? (ad < cd ? a : c) : (bd < cd ? b : c));
-            }
-        }
-    }
-    return unfiltered;
-}
-
 const int HeightfieldHeight::HEIGHT_BORDER = 1;
 const int HeightfieldHeight::HEIGHT_EXTENSION = SHARED_EDGE + 2 * HEIGHT_BORDER;
 
@@ -471,7 +405,7 @@ HeightfieldHeight::HeightfieldHeight(Bitstream& in, int bytes, const Heightfield
     _contents = reference->getContents();
     
     int offsetX, offsetY, width, height;
-    QVector<quint16> delta = decodeHeightfieldHeight(reference->getEncodedDelta(), offsetX, offsetY, width, height);
+    QVector<quint16> delta = DataBlockCodec::decodeHeights(reference->getEncodedDelta(), offsetX, offsetY, width, height);
     if (delta.isEmpty()) {
         return;
     }
@@ -492,7 +426,7 @@ HeightfieldHeight::HeightfieldHeight(Bitstream& in, int bytes, const Heightfield
 void HeightfieldHeight::write(Bitstream& out) {
     QMutexLocker locker(&_encodedMutex);
     if (_encoded.isEmpty()) {
-        _encoded = encodeHeightfieldHeight(0, 0, _width, _contents.size() / _width, _contents);
+        _encoded = DataBlockCodec::encodeHeights(0, 0, _width, _contents.size() / _width, _contents);
     }
     out << _encoded.size();
     out.writeAligned(_encoded);
@@ -536,7 +470,7 @@ void HeightfieldHeight::writeDelta(Bitstream& out, const HeightfieldHeightPointe
                 memcpy(dest, src, deltaWidth * sizeof(quint16));
             }
         }
-        reference->setEncodedDelta(encodeHeightfieldHeight(minX + 1, minY + 1, deltaWidth, deltaHeight, delta));
+        reference->setEncodedDelta(DataBlockCodec::encodeHeights(minX + 1, minY + 1, deltaWidth, deltaHeight, delta));
         reference->setDeltaData(DataBlockPointer(this));
     }
     out << reference->getEncodedDelta().size();
@@ -545,7 +479,7 @@ void HeightfieldHeight::writeDelta(Bitstream& out, const HeightfieldHeightPointe
 
 void HeightfieldHeight::read(Bitstream& in, int bytes) {
     int offsetX, offsetY, height;
-    _contents = decodeHeightfieldHeight(_encoded = in.readAligned(bytes), offsetX, offsetY, _width, height);
+    _contents = DataBlockCodec::decodeHeights(_encoded = in.readAligned(bytes), offsetX, offsetY, _width, height);
 }
 
 Bitstream& operator<<(Bitstream& out, const HeightfieldHeightPointer& value) {
@@ -684,46 +618,6 @@ void HeightfieldHeightEditor::clear() {
     _clear->setEnabled(false);
 }
 
-static QByteArray encodeHeightfieldColor(int offsetX, int offsetY, int width, int height, const QByteArray& contents) {
-    QByteArray inflated(HEIGHTFIELD_DATA_HEADER_SIZE, 0);
-    qint32* header = (qint32*)inflated.data();
-    *header++ = offsetX;
-    *header++ = offsetY;
-    *header++ = width;
-    *header++ = height;
-    if (!contents.isEmpty()) {
-        QBuffer buffer(&inflated);
-        buffer.open(QIODevice::WriteOnly | QIODevice::Append);
-        QImage((const uchar*)contents.constData(), width, height, width * DataBlock::COLOR_BYTES,
-            QImage::Format_RGB888).save(&buffer, "JPG");
-    }
-    return qCompress(inflated);
-}
-
-static QByteArray decodeHeightfieldColor(const QByteArray& encoded, int& offsetX, int& offsetY, int& width, int& height) {
-    QByteArray inflated = qUncompress(encoded);
-    const qint32* header = (const qint32*)inflated.constData();
-    offsetX = *header++;
-    offsetY = *header++;
-    width = *header++;
-    height = *header++;
-    int payloadSize = inflated.size() - HEIGHTFIELD_DATA_HEADER_SIZE;
-    if (payloadSize == 0) {
-        return QByteArray();
-    }
-    QImage image = QImage::fromData((const uchar*)inflated.constData() + HEIGHTFIELD_DATA_HEADER_SIZE, payloadSize, "JPG");
-    if (image.format() != QImage::Format_RGB888) {
-        image = image.convertToFormat(QImage::Format_RGB888);
-    }
-    QByteArray contents(width * height * DataBlock::COLOR_BYTES, 0);
-    char* dest = contents.data();
-    int stride = width * DataBlock::COLOR_BYTES;
-    for (int y = 0; y < height; y++, dest += stride) {
-        memcpy(dest, image.constScanLine(y), stride);
-    }
-    return contents;
-}
-
 HeightfieldColor::HeightfieldColor(int width, const QByteArray& contents) :
     HeightfieldData(width),
     _contents(contents) {
@@ -745,7 +639,7 @@ HeightfieldColor::HeightfieldColor(Bitstream& in, int bytes, const HeightfieldCo
     _contents = reference->getContents();
     
     int offsetX, offsetY, width, height;
-    QByteArray delta = decodeHeightfieldColor(reference->getEncodedDelta(), offsetX, offsetY, width, height);
+    QByteArray delta = DataBlockCodec::decodeColors(reference->getEncodedDelta(), offsetX, offsetY, width, height);
     if (delta.isEmpty()) {
         return;
     }
@@ -766,7 +660,7 @@ HeightfieldColor::HeightfieldColor(Bitstream& in, int bytes, const HeightfieldCo
 void HeightfieldColor::write(Bitstream& out) {
     QMutexLocker locker(&_encodedMutex);
     if (_encoded.isEmpty()) {
-        _encoded = encodeHeightfieldColor(0, 0, _width, _contents.size() / (_width * DataBlock::COLOR_BYTES), _contents);
+        _encoded = DataBlockCodec::encodeColors(0, 0, _width, _contents.size() / (_width * DataBlock::COLOR_BYTES), _contents);
     }
     out << _encoded.size();
     out.writeAligned(_encoded);
@@ -811,7 +705,7 @@ void HeightfieldColor::writeDelta(Bitstream& out, const HeightfieldColorPointer&
                 memcpy(dest, src, deltaWidth * DataBlock::COLOR_BYTES);
             }
         }
-        reference->setEncodedDelta(encodeHeightfieldColor(minX + 1, minY + 1, deltaWidth, deltaHeight, delta));
+        reference->setEncodedDelta(DataBlockCodec::encodeColors(minX + 1, minY + 1, deltaWidth, deltaHeight, delta));
         reference->setDeltaData(DataBlockPointer(this));
     }
     out << reference->getEncodedDelta().size();
@@ -820,7 +714,7 @@ void HeightfieldColor::writeDelta(Bitstream& out, const HeightfieldColorPointer&
 
 void HeightfieldColor::read(Bitstream& in, int bytes) {
     int offsetX, offsetY, height;
-    _contents = decodeHeightfieldColor(_encoded = in.readAligned(bytes), offsetX, offsetY, _width, height);
+    _contents = DataBlockCodec::decodeColors(_encoded = in.readAligned(bytes), offsetX, offsetY, _width, height);
 }
 
 Bitstream& operator<<(Bitstream& out, const HeightfieldColorPointer& value) {
@@ -61,6 +61,10 @@ public:
     /// If we haven't, sets the last visit identifier and returns true.
     bool testAndSetVisited(int visit);
 
+    /// Checks and sets the visit identifier for a traversal started on the specified thread (the workers of a parallel
+    /// traversal share the marks of the thread that started it).
+    bool testAndSetVisited(int visit, QThread* thread);
+
     /// Returns a pointer to the renderer, creating it if necessary.
     SpannerRenderer* getRenderer();
 
@@ -57,6 +57,7 @@ PacketVersion versionForPacketType(PacketType type) {
         case PacketTypeInjectAudio:
             return 1;
         case PacketTypeAvatarData:
+        case PacketTypeHostedAvatarData:
             return 5;
         case PacketTypeAvatarIdentity:
             return 1;
@@ -78,7 +79,7 @@ PacketVersion versionForPacketType(PacketType type) {
         case PacketTypeAudioStreamStats:
             return 1;
         case PacketTypeMetavoxelData:
-            return 13;
+            return 14;
         default:
             return 0;
     }
@@ -109,6 +110,9 @@ QString nameForPacketType(PacketType type) {
         PACKET_TYPE_NAME_LOOKUP(PacketTypeMuteEnvironment);
         PACKET_TYPE_NAME_LOOKUP(PacketTypeAudioStreamStats);
         PACKET_TYPE_NAME_LOOKUP(PacketTypeDataServerConfirm);
+        PACKET_TYPE_NAME_LOOKUP(PacketTypeHostedAvatarData);
+        PACKET_TYPE_NAME_LOOKUP(PacketTypeEntityServerSimulation);
+        PACKET_TYPE_NAME_LOOKUP(PacketTypeEntityMotionUpdate);
         PACKET_TYPE_NAME_LOOKUP(PacketTypeOctreeStats);
         PACKET_TYPE_NAME_LOOKUP(PacketTypeJurisdiction);
         PACKET_TYPE_NAME_LOOKUP(PacketTypeJurisdictionRequest);
@@ -42,9 +42,9 @@ enum PacketType {
     PacketTypeMuteEnvironment,
     PacketTypeAudioStreamStats,
     PacketTypeDataServerConfirm, // 20
-    UNUSED_5,
-    UNUSED_6,
-    UNUSED_7,
+    PacketTypeHostedAvatarData,
+    PacketTypeEntityServerSimulation,
+    PacketTypeEntityMotionUpdate,
     UNUSED_8,
     UNUSED_9, // 25
     PacketTypeOctreeStats,
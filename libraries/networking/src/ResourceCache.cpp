@@ -12,7 +12,20 @@
 #include <cfloat>
 #include <cmath>
 
+#ifdef Q_OS_WIN
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QThread>
+#include <QThreadPool>
 #include <QTimer>
 #include <QtDebug>
 
@@ -29,6 +42,11 @@ ResourceCache::ResourceCache(QObject* parent) :
 }
 
 ResourceCache::~ResourceCache() {
+    foreach (const QSharedPointer<Resource>& resource, _prefetchedResources) {
+        resource->setCache(nullptr);
+    }
+    _prefetchedResources.clear();
+    
     // the unused resources may themselves reference resources that will be added to the unused
     // list on destruction, so keep clearing until there are no references left
     while (!_unusedResources.isEmpty()) {
@@ -46,6 +64,23 @@ void ResourceCache::refresh(const QUrl& url) {
     }
 }
 
+void ResourceCache::prefetch(const QUrl& url) {
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, "prefetch", Q_ARG(const QUrl&, url));
+        return;
+    }
+    // hold on to the resource while it loads; if we let go now, it would be charged to the unused list before its
+    // size was known
+    QSharedPointer<Resource> resource = getResource(url);
+    if (!(resource->isLoaded() || resource->_failedToLoad)) {
+        _prefetchedResources.insert(url, resource);
+    }
+}
+
+void ResourceCache::releasePrefetchedResource(const QUrl& url) {
+    _prefetchedResources.remove(url);
+}
+
 QSharedPointer<Resource> ResourceCache::getResource(const QUrl& url, const QUrl& fallback, bool delayLoad, void* extra) {
 
     if (QThread::currentThread() != thread()) {
@@ -79,22 +114,25 @@ void ResourceCache::setUnusedResourceCacheSize(qint64 unusedResourcesMaxSize) {
 }
 
 void ResourceCache::addUnusedResource(const QSharedPointer<Resource>& resource) {
-    if (resource->getBytesTotal() > _unusedResourcesMaxSize) {
+    if (resource->getBytes() > _unusedResourcesMaxSize) {
         // If it doesn't fit anyway, let's leave whatever is already in the cache.
         resource->setCache(nullptr);
         return;
     }
-    reserveUnusedResource(resource->getBytesTotal());
+    reserveUnusedResource(resource->getBytes());
     
     resource->setLRUKey(++_lastLRUKey);
     _unusedResources.insert(resource->getLRUKey(), resource);
-    _unusedResourcesSize += resource->getBytesTotal();
+    
+    // the size may change while unused (a download finishing, say), so take back exactly what was charged
+    resource->_unusedBytes = resource->getBytes();
+    _unusedResourcesSize += resource->_unusedBytes;
 }
 
 void ResourceCache::removeUnusedResource(const QSharedPointer<Resource>& resource) {
     if (_unusedResources.contains(resource->getLRUKey())) {
         _unusedResources.remove(resource->getLRUKey());
-        _unusedResourcesSize -= resource->getBytesTotal();
+        _unusedResourcesSize -= resource->_unusedBytes;
     }
 }
 
@@ -104,53 +142,224 @@ void ResourceCache::reserveUnusedResource(qint64 resourceSize) {
         // unload the oldest resource
         QMap<int, QSharedPointer<Resource> >::iterator it = _unusedResources.begin();
         
-        _unusedResourcesSize -= it.value()->getBytesTotal();
+        _unusedResourcesSize -= it.value()->_unusedBytes;
         it.value()->setCache(nullptr);
         _unusedResources.erase(it);
     }
 }
 
+void ResourceCache::setRequestLimit(int limit) {
+    _requestLimit = limit;
+    startPendingRequests();
+}
+
+void ResourceCache::setHostRequestLimit(int limit) {
+    _hostRequestLimit = limit;
+    startPendingRequests();
+}
+
 void ResourceCache::attemptRequest(Resource* resource) {
-    if (_requestLimit <= 0) {
-        // wait until a slot becomes available
-        _pendingRequests.append(resource);
-        return;
+    _pendingRequests[resource->_url.host()].push(resource);
+    _pendingRequestCount++;
+    startPendingRequests();
+    
+    if (resource->_queueIndex != -1) {
+        _queueLengthHistogram.add(_pendingRequestCount);
     }
-    _requestLimit--;
-    _loadingRequests.append(resource);
-    resource->makeRequest();
 }
 
 void ResourceCache::requestCompleted(Resource* resource) {
-    _loadingRequests.removeOne(resource);
-    _requestLimit++;
-    
-    // look for the highest priority pending request
-    int highestIndex = -1;
-    float highestPriority = -FLT_MAX;
-    for (int i = 0; i < _pendingRequests.size(); ) {
-        Resource* resource = _pendingRequests.at(i).data();
-        if (!resource) {
-            _pendingRequests.removeAt(i);
-            continue;
+    releaseRequestSlot(resource);
+    startPendingRequests();
+}
+
+void ResourceCache::requestPriorityChanged(Resource* resource) {
+    if (resource->_queueIndex != -1) {
+        _pendingRequests[resource->_url.host()].update(resource);
+        startPendingRequests();
+        
+    } else if (resource->_reply && _pendingRequestCount > 0) {
+        // a download whose priority has fallen may now be preempted
+        startPendingRequests();
+    }
+}
+
+void ResourceCache::cancelPendingRequest(Resource* resource) {
+    QHash<QString, ResourceRequestQueue>::iterator it = _pendingRequests.find(resource->_url.host());
+    it.value().remove(resource);
+    if (it.value().isEmpty()) {
+        _pendingRequests.erase(it);
+    }
+    _pendingRequestCount--;
+}
+
+void ResourceCache::startPendingRequests() {
+    while (_pendingRequestCount > 0) {
+        if (_loadingRequests.size() < _requestLimit) {
+            ResourceRequestQueue* queue = getStartableQueue();
+            if (queue) {
+                Resource* resource = queue->top();
+                cancelPendingRequest(resource);
+                _loadingRequests.append(resource);
+                _hostRequestCounts[resource->_url.host()]++;
+                resource->makeRequest();
+                continue;
+            }
+        }
+        // nothing can start outright; see whether the most important waiting request should take a slot from a
+        // less important download
+        Resource* pending = nullptr;
+        for (QHash<QString, ResourceRequestQueue>::const_iterator it = _pendingRequests.constBegin();
+                it != _pendingRequests.constEnd(); it++) {
+            if (!pending || it.value().top()->_loadPriority > pending->_loadPriority) {
+                pending = it.value().top();
+            }
+        }
+        Resource* preempted = findPreemptableRequest(pending);
+        if (!preempted) {
+            return;
+        }
+        preempted->cancelRequest();
+        releaseRequestSlot(preempted);
+        _pendingRequests[preempted->_url.host()].push(preempted);
+        _pendingRequestCount++;
+    }
+}
+
+ResourceRequestQueue* ResourceCache::getStartableQueue() {
+    ResourceRequestQueue* highestQueue = nullptr;
+    for (QHash<QString, ResourceRequestQueue>::iterator it = _pendingRequests.begin(); it != _pendingRequests.end(); it++) {
+        if (_hostRequestCounts.value(it.key()) < _hostRequestLimit &&
+                (!highestQueue || it.value().top()->_loadPriority > highestQueue->top()->_loadPriority)) {
+            highestQueue = &it.value();
         }
-        float priority = resource->getLoadPriority();
-        if (priority >= highestPriority) {
-            highestPriority = priority;
-            highestIndex = i;
+    }
+    return highestQueue;
+}
+
+Resource* ResourceCache::findPreemptableRequest(Resource* pending) {
+    // preempting must free a slot that the pending request can actually use: if its host is at its limit, the
+    // preempted request has to be for the same host
+    QString host = pending->_url.host();
+    bool hostFull = _hostRequestCounts.value(host) >= _hostRequestLimit;
+    
+    // priorities are usually negated distances, so small differences (or a fresh start, which wastes little but would
+    // have us trading the slot back and forth) aren't worth the download thrown away
+    const float MIN_PREEMPTING_PRIORITY_MARGIN = 10.0f;
+    const qint64 MIN_PREEMPTABLE_MSECS = 500;
+    const qint64 MIN_PREEMPTABLE_BYTES = 64 * 1024;
+    const float MAX_PREEMPTABLE_PROGRESS = 0.5f;
+    Resource* lowest = nullptr;
+    foreach (Resource* resource, _loadingRequests) {
+        if (resource->_loadPriority + MIN_PREEMPTING_PRIORITY_MARGIN < pending->_loadPriority &&
+                resource->_bytesTotal > 0 && resource->getProgress() < MAX_PREEMPTABLE_PROGRESS &&
+                (resource->_requestTimer.elapsed() >= MIN_PREEMPTABLE_MSECS ||
+                    resource->_bytesReceived >= MIN_PREEMPTABLE_BYTES) &&
+                (!hostFull || resource->_url.host() == host) &&
+                (!lowest || resource->_loadPriority < lowest->_loadPriority)) {
+            lowest = resource;
         }
-        i++;
     }
-    if (highestIndex >= 0) {
-        attemptRequest(_pendingRequests.takeAt(highestIndex));
+    return lowest;
+}
+
+void ResourceCache::releaseRequestSlot(Resource* resource) {
+    _loadingRequests.removeOne(resource);
+    QHash<QString, int>::iterator it = _hostRequestCounts.find(resource->_url.host());
+    if (it != _hostRequestCounts.end() && --it.value() == 0) {
+        _hostRequestCounts.erase(it);
     }
 }
 
 const int DEFAULT_REQUEST_LIMIT = 10;
 int ResourceCache::_requestLimit = DEFAULT_REQUEST_LIMIT;
 
-QList<QPointer<Resource> > ResourceCache::_pendingRequests;
+const int DEFAULT_HOST_REQUEST_LIMIT = 6;
+int ResourceCache::_hostRequestLimit = DEFAULT_HOST_REQUEST_LIMIT;
+
+QHash<QString, ResourceRequestQueue> ResourceCache::_pendingRequests;
+int ResourceCache::_pendingRequestCount = 0;
 QList<Resource*> ResourceCache::_loadingRequests;
+QHash<QString, int> ResourceCache::_hostRequestCounts;
+PowerOfTwoHistogram ResourceCache::_queueLengthHistogram;
+PowerOfTwoHistogram ResourceCache::_loadTimeHistogram;
+
+PowerOfTwoHistogram::PowerOfTwoHistogram() :
+    _counts(BUCKET_COUNT, 0),
+    _total(0) {
+}
+
+void PowerOfTwoHistogram::add(qint64 value) {
+    int bucket = 0;
+    for (; value > 0 && bucket < BUCKET_COUNT - 1; value >>= 1) {
+        bucket++;
+    }
+    _counts[bucket]++;
+    _total++;
+}
+
+qint64 PowerOfTwoHistogram::getPercentile(float percentile) const {
+    int remaining = (int)ceilf(percentile * _total);
+    for (int i = 0; i < BUCKET_COUNT - 1; i++) {
+        if ((remaining -= _counts.at(i)) <= 0) {
+            return (i == 0) ? 0 : ((qint64)1 << i) - 1;
+        }
+    }
+    return (qint64)1 << (BUCKET_COUNT - 1);
+}
+
+void ResourceRequestQueue::push(Resource* resource) {
+    _heap.append(resource);
+    resource->_queueIndex = _heap.size() - 1;
+    siftUp(resource->_queueIndex);
+}
+
+void ResourceRequestQueue::update(Resource* resource) {
+    siftUp(resource->_queueIndex);
+    siftDown(resource->_queueIndex);
+}
+
+void ResourceRequestQueue::remove(Resource* resource) {
+    int index = resource->_queueIndex;
+    resource->_queueIndex = -1;
+    Resource* last = _heap.takeLast();
+    if (index < _heap.size()) {
+        place(index, last);
+        update(last);
+    }
+}
+
+void ResourceRequestQueue::place(int index, Resource* resource) {
+    _heap[index] = resource;
+    resource->_queueIndex = index;
+}
+
+void ResourceRequestQueue::siftUp(int index) {
+    Resource* resource = _heap.at(index);
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (_heap.at(parent)->_loadPriority >= resource->_loadPriority) {
+            break;
+        }
+        place(index, _heap.at(parent));
+        index = parent;
+    }
+    place(index, resource);
+}
+
+void ResourceRequestQueue::siftDown(int index) {
+    Resource* resource = _heap.at(index);
+    for (int child; (child = index * 2 + 1) < _heap.size(); index = child) {
+        if (child + 1 < _heap.size() && _heap.at(child + 1)->_loadPriority > _heap.at(child)->_loadPriority) {
+            child++;
+        }
+        if (resource->_loadPriority >= _heap.at(child)->_loadPriority) {
+            break;
+        }
+        place(index, _heap.at(child));
+    }
+    place(index, resource);
+}
 
 Resource::Resource(const QUrl& url, bool delayLoad) :
     _url(url),
@@ -167,6 +376,9 @@ Resource::Resource(const QUrl& url, bool delayLoad) :
 }
 
 Resource::~Resource() {
+    if (_queueIndex != -1) {
+        ResourceCache::cancelPendingRequest(this);
+    }
     if (_reply) {
         ResourceCache::requestCompleted(this);
         delete _reply;
@@ -181,8 +393,28 @@ void Resource::ensureLoading() {
 }
 
 void Resource::setLoadPriority(const QPointer<QObject>& owner, float priority) {
-    if (!(_failedToLoad || _loaded)) {
+    if (_failedToLoad || _loaded) {
+        return;
+    }
+    QHash<QPointer<QObject>, float>::iterator it = _loadPriorities.find(owner);
+    if (it == _loadPriorities.end()) {
         _loadPriorities.insert(owner, priority);
+        if (priority > _loadPriority) {
+            setAggregateLoadPriority(priority);
+        }
+        return;
+    }
+    float previousPriority = it.value();
+    if (priority == previousPriority) {
+        return; // the usual case, since owners restate their priorities every frame
+    }
+    it.value() = priority;
+    if (priority > _loadPriority) {
+        setAggregateLoadPriority(priority);
+        
+    } else if (previousPriority == _loadPriority) {
+        // the highest priority may have dropped
+        updateLoadPriority();
     }
 }
 
@@ -194,15 +426,16 @@ void Resource::setLoadPriorities(const QHash<QPointer<QObject>, float>& prioriti
             it != priorities.constEnd(); it++) {
         _loadPriorities.insert(it.key(), it.value());
     }
+    updateLoadPriority();
 }
 
 void Resource::clearLoadPriority(const QPointer<QObject>& owner) {
-    if (!(_failedToLoad || _loaded)) {
-        _loadPriorities.remove(owner);
+    if (!(_failedToLoad || _loaded) && _loadPriorities.take(owner) == _loadPriority) {
+        updateLoadPriority();
     }
 }
 
-float Resource::getLoadPriority() {
+void Resource::updateLoadPriority() {
     float highestPriority = -FLT_MAX;
     for (QHash<QPointer<QObject>, float>::iterator it = _loadPriorities.begin(); it != _loadPriorities.end(); ) {
         if (it.key().isNull()) {
@@ -212,7 +445,14 @@ float Resource::getLoadPriority() {
         highestPriority = qMax(highestPriority, it.value());
         it++;
     }
-    return highestPriority;
+    setAggregateLoadPriority(highestPriority);
+}
+
+void Resource::setAggregateLoadPriority(float priority) {
+    if (_loadPriority != priority) {
+        _loadPriority = priority;
+        ResourceCache::requestPriorityChanged(this);
+    }
 }
 
 void Resource::refresh() {
@@ -259,6 +499,7 @@ void Resource::init() {
     _failedToLoad = false;
     _loaded = false;
     _attempts = 0;
+    _loadTimer.invalidate();
     
     if (_url.isEmpty()) {
         _startedLoading = _loaded = true;
@@ -270,6 +511,9 @@ void Resource::init() {
 
 void Resource::attemptRequest() {
     _startedLoading = true;
+    if (!_loadTimer.isValid()) {
+        _loadTimer.start();
+    }
     ResourceCache::attemptRequest(this);
 }
 
@@ -281,6 +525,12 @@ void Resource::finishedLoading(bool success) {
         _failedToLoad = true;
     }
     _loadPriorities.clear();
+    _loadPriority = -FLT_MAX;
+    
+    // let go of prefetched resources later, since that may add them to the unused list (or delete them)
+    if (_cache && _cache->_prefetchedResources.contains(_url)) {
+        QMetaObject::invokeMethod(_cache, "releasePrefetchedResource", Qt::QueuedConnection, Q_ARG(const QUrl&, _url));
+    }
 }
 
 void Resource::reinsert() {
@@ -303,6 +553,7 @@ void Resource::handleDownloadProgress(qint64 bytesReceived, qint64 bytesTotal) {
     _replyTimer->deleteLater();
     _replyTimer = nullptr;
     ResourceCache::requestCompleted(this);
+    ResourceCache::_loadTimeHistogram.add(_loadTimer.elapsed());
     
     downloadFinished(reply);
 }
@@ -327,6 +578,18 @@ void Resource::makeRequest() {
     connect(_replyTimer, SIGNAL(timeout()), SLOT(handleReplyTimeout()));
     _replyTimer->setSingleShot(true);
     _replyTimer->start(REPLY_TIMEOUT_MS);
+    _requestTimer.start();
+    _bytesReceived = _bytesTotal = 0;
+}
+
+void Resource::cancelRequest() {
+    _reply->disconnect(this);
+    _reply->abort();
+    _reply->deleteLater();
+    _reply = nullptr;
+    _replyTimer->disconnect(this);
+    _replyTimer->deleteLater();
+    _replyTimer = nullptr;
     _bytesReceived = _bytesTotal = 0;
 }
 
@@ -374,3 +637,199 @@ void Resource::handleReplyFinished() {
 uint qHash(const QPointer<QObject>& value, uint seed) {
     return qHash(value.data(), seed);
 }
+
+ProcessedResourceCache& ProcessedResourceCache::getInstance() {
+    static ProcessedResourceCache instance;
+    return instance;
+}
+
+QString ProcessedResourceCache::getKey(const QByteArray& type, const QByteArray& content, const QByteArray& parameters) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(parameters);
+    hash.addData(content);
+    return QString::fromLatin1(type + "-" + hash.result().toHex());
+}
+
+ProcessedResourceCache::ProcessedResourceCache() :
+    _directory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/processed") {
+}
+
+void ProcessedResourceCache::setDirectory(const QString& directory) {
+    QMutexLocker locker(&_mutex);
+    _directory = directory;
+    _indexed = false;
+    _indexing = false;
+    _entries.clear();
+    _lru.clear();
+    _size = 0;
+}
+
+QString ProcessedResourceCache::getDirectory() const {
+    QMutexLocker locker(&_mutex);
+    return _directory;
+}
+
+void ProcessedResourceCache::setMaxSize(qint64 maxSize) {
+    QMutexLocker locker(&_mutex);
+    _maxSize = clamp(maxSize, MIN_PROCESSED_MAX_SIZE, MAX_PROCESSED_MAX_SIZE);
+    if (_indexed) {
+        reserve(0);
+    }
+}
+
+qint64 ProcessedResourceCache::getMaxSize() const {
+    QMutexLocker locker(&_mutex);
+    return _maxSize;
+}
+
+qint64 ProcessedResourceCache::getSize() {
+    QMutexLocker locker(&_mutex);
+    ensureIndexed();
+    return _size;
+}
+
+QString ProcessedResourceCache::find(const QString& key) {
+    QMutexLocker locker(&_mutex);
+    ensureIndexed();
+    QString path = _directory + "/" + key;
+    QHash<QString, Entry>::iterator it = _entries.find(key);
+    if (it == _entries.end()) {
+        // until the index is built, look for the file itself
+        QFileInfo file(path);
+        if (_indexed || _directory.isEmpty() || !file.isFile()) {
+            return QString();
+        }
+        Entry entry = { file.size(), 0 };
+        it = _entries.insert(key, entry);
+        _size += entry.size;
+        
+    } else {
+        _lru.remove(it->lruKey);
+    }
+    _lru.insert(it->lruKey = ++_lastLRUKey, key);
+
+    // the modification time records the use, so that the order survives restarts
+    utime(QFile::encodeName(path).constData(), NULL);
+    return path;
+}
+
+QByteArray ProcessedResourceCache::load(const QString& key) {
+    QString path = find(key);
+    if (path.isEmpty()) {
+        return QByteArray();
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        remove(key);
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+void ProcessedResourceCache::insert(const QString& key, const QByteArray& data) {
+    QString directory;
+    {
+        QMutexLocker locker(&_mutex);
+        ensureIndexed();
+        if (_directory.isEmpty() || data.size() > _maxSize) {
+            return;
+        }
+        removeEntry(key);
+        if (_indexed) {
+            reserve(data.size());
+        }
+        directory = _directory;
+    }
+    // write outside the lock, through a temporary file so that readers never see partial entries
+    QDir().mkpath(directory);
+    QSaveFile file(directory + "/" + key);
+    if (!(file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit())) {
+        qDebug() << "Failed to write processed resource" << key << ":" << file.errorString();
+        return;
+    }
+    QMutexLocker locker(&_mutex);
+    if (directory != _directory) {
+        return;
+    }
+    removeEntry(key);
+    Entry entry = { data.size(), ++_lastLRUKey };
+    _entries.insert(key, entry);
+    _lru.insert(entry.lruKey, key);
+    _size += entry.size;
+}
+
+void ProcessedResourceCache::remove(const QString& key) {
+    QMutexLocker locker(&_mutex);
+    ensureIndexed();
+    removeEntry(key);
+    QFile::remove(_directory + "/" + key);
+}
+
+/// Scans the processed resource directory on a worker thread.
+class ProcessedResourceIndexer : public QRunnable {
+public:
+    
+    ProcessedResourceIndexer(const QString& directory) : _directory(directory) { }
+    
+    virtual void run() { ProcessedResourceCache::getInstance().buildIndex(_directory); }
+    
+private:
+    
+    QString _directory;
+};
+
+void ProcessedResourceCache::ensureIndexed() {
+    if (_indexed || _indexing) {
+        return;
+    }
+    if (_directory.isEmpty()) {
+        _indexed = true;
+        return;
+    }
+    // the scan can take a while for a large cache, so it mustn't hold up the lookups that want it
+    _indexing = true;
+    QThreadPool::globalInstance()->start(new ProcessedResourceIndexer(_directory));
+}
+
+void ProcessedResourceCache::buildIndex(const QString& directory) {
+    // order the existing entries by when they were last used, oldest first
+    QFileInfoList files = QDir(directory).entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+    
+    QMutexLocker locker(&_mutex);
+    if (!_indexing || directory != _directory) {
+        return; // the directory was changed while we were scanning
+    }
+    // the scanned entries are older than any found or inserted since the scan began, so they get lower keys
+    int lruKey = -files.size();
+    foreach (const QFileInfo& file, files) {
+        lruKey++;
+        if (_entries.contains(file.fileName())) {
+            continue;
+        }
+        Entry entry = { file.size(), lruKey };
+        _entries.insert(file.fileName(), entry);
+        _lru.insert(entry.lruKey, file.fileName());
+        _size += entry.size;
+    }
+    _indexing = false;
+    _indexed = true;
+    reserve(0);
+}
+
+void ProcessedResourceCache::reserve(qint64 size) {
+    while (!_lru.isEmpty() && _size + size > _maxSize) {
+        // evict the least recently used entry
+        QString key = _lru.begin().value();
+        removeEntry(key);
+        QFile::remove(_directory + "/" + key);
+    }
+}
+
+void ProcessedResourceCache::removeEntry(const QString& key) {
+    QHash<QString, Entry>::iterator it = _entries.find(key);
+    if (it != _entries.end()) {
+        _lru.remove(it->lruKey);
+        _size -= it->size;
+        _entries.erase(it);
+    }
+}
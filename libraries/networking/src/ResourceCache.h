@@ -12,14 +12,20 @@
 #ifndef hifi_ResourceCache_h
 #define hifi_ResourceCache_h
 
+#include <cfloat>
+
+#include <QElapsedTimer>
 #include <QHash>
 #include <QList>
+#include <QMap>
+#include <QMutex>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QObject>
 #include <QPointer>
 #include <QSharedPointer>
 #include <QUrl>
+#include <QVector>
 #include <QWeakPointer>
 
 class QNetworkReply;
@@ -40,26 +46,98 @@ static const qint64 DEFAULT_UNUSED_MAX_SIZE = 1024 * BYTES_PER_MEGABYTES;
 static const qint64 MIN_UNUSED_MAX_SIZE = 0;
 static const qint64 MAX_UNUSED_MAX_SIZE = 10 * BYTES_PER_GIGABYTES;
 
+static const qint64 DEFAULT_PROCESSED_MAX_SIZE = 2 * BYTES_PER_GIGABYTES;
+static const qint64 MIN_PROCESSED_MAX_SIZE = 0;
+static const qint64 MAX_PROCESSED_MAX_SIZE = 50 * BYTES_PER_GIGABYTES;
+
+/// A histogram of non-negative values with power-of-two bucket boundaries:  bucket zero counts zeros, and bucket n counts
+/// values in [2^(n-1), 2^n).  The last bucket also counts anything larger.
+class PowerOfTwoHistogram {
+public:
+    
+    static const int BUCKET_COUNT = 24;
+    
+    PowerOfTwoHistogram();
+    
+    void add(qint64 value);
+    
+    int getTotal() const { return _total; }
+    
+    const QVector<int>& getCounts() const { return _counts; }
+    
+    /// Returns the (inclusive) upper bound of the bucket containing the given fraction of the values added, or zero if
+    /// none have been.
+    qint64 getPercentile(float percentile) const;
+    
+private:
+    
+    QVector<int> _counts;
+    int _total;
+};
+
+/// An indexed binary max-heap of pending resources ordered by load priority.  Each resource records its position in the
+/// heap, so that its priority can be updated or it can be removed in O(log n).
+class ResourceRequestQueue {
+public:
+    
+    bool isEmpty() const { return _heap.isEmpty(); }
+    int size() const { return _heap.size(); }
+    
+    Resource* top() const { return _heap.first(); }
+    
+    void push(Resource* resource);
+    
+    /// Restores the heap order after the resource's load priority has changed.
+    void update(Resource* resource);
+    
+    void remove(Resource* resource);
+    
+private:
+    
+    void place(int index, Resource* resource);
+    void siftUp(int index);
+    void siftDown(int index);
+    
+    QVector<Resource*> _heap;
+};
+
 /// Base class for resource caches.
 class ResourceCache : public QObject {
     Q_OBJECT
     
 public:
-    static void setRequestLimit(int limit) { _requestLimit = limit; }
+    /// Sets the maximum number of requests in progress at once.
+    static void setRequestLimit(int limit);
     static int getRequestLimit() { return _requestLimit; }
     
+    /// Sets the maximum number of requests in progress at once to any one host.
+    static void setHostRequestLimit(int limit);
+    static int getHostRequestLimit() { return _hostRequestLimit; }
+    
     void setUnusedResourceCacheSize(qint64 unusedResourcesMaxSize);
     qint64 getUnusedResourceCacheSize() const { return _unusedResourcesMaxSize; }
 
     static const QList<Resource*>& getLoadingRequests() { return _loadingRequests; }
 
-    static int getPendingRequestCount() { return _pendingRequests.size(); }
+    static int getPendingRequestCount() { return _pendingRequestCount; }
+
+    /// Returns the histogram of pending queue lengths, sampled whenever a request has to wait.
+    static const PowerOfTwoHistogram& getQueueLengthHistogram() { return _queueLengthHistogram; }
+    
+    /// Returns the histogram of load times in milliseconds, from the first request to the finished download.
+    static const PowerOfTwoHistogram& getLoadTimeHistogram() { return _loadTimeHistogram; }
 
     ResourceCache(QObject* parent = NULL);
     virtual ~ResourceCache();
 
     void refresh(const QUrl& url);
 
+    /// Starts loading a resource before it's needed (when approaching a domain, say), so that by the time it is, it's
+    /// in memory or at least in the processed cache.  Prefetched resources are held until they finish loading, so that
+    /// they're charged at their full size when they then wait in the unused list until requested.
+    Q_INVOKABLE void prefetch(const QUrl& url);
+    Q_INVOKABLE void prefetch(const QString& url) { prefetch(QUrl(url)); }
+
 protected:
     qint64 _unusedResourcesMaxSize = DEFAULT_UNUSED_MAX_SIZE;
     qint64 _unusedResourcesSize = 0;
@@ -82,16 +160,41 @@ protected:
     
     static void attemptRequest(Resource* resource);
     static void requestCompleted(Resource* resource);
+    
+    /// Notes that the load priority of a pending or loading resource has changed.
+    static void requestPriorityChanged(Resource* resource);
+    
+    /// Removes a resource from the pending queue.
+    static void cancelPendingRequest(Resource* resource);
+
+private slots:
+    
+    void releasePrefetchedResource(const QUrl& url);
 
 private:
     friend class Resource;
 
+    /// Starts as many pending requests as the limits allow, in order of priority.  When nothing more can start, the
+    /// highest priority pending request may preempt the download of a resource of clearly lower priority that has been
+    /// under way long enough to know its size, but isn't yet half done.
+    static void startPendingRequests();
+    
+    static ResourceRequestQueue* getStartableQueue();
+    static Resource* findPreemptableRequest(Resource* pending);
+    static void releaseRequestSlot(Resource* resource);
+    
     QHash<QUrl, QWeakPointer<Resource> > _resources;
+    QHash<QUrl, QSharedPointer<Resource> > _prefetchedResources;
     int _lastLRUKey = 0;
     
     static int _requestLimit;
-    static QList<QPointer<Resource> > _pendingRequests;
+    static int _hostRequestLimit;
+    static QHash<QString, ResourceRequestQueue> _pendingRequests;
+    static int _pendingRequestCount;
     static QList<Resource*> _loadingRequests;
+    static QHash<QString, int> _hostRequestCounts;
+    static PowerOfTwoHistogram _queueLengthHistogram;
+    static PowerOfTwoHistogram _loadTimeHistogram;
 };
 
 /// Base class for resources.
@@ -119,7 +222,7 @@ public:
     virtual void clearLoadPriority(const QPointer<QObject>& owner);
     
     /// Returns the highest load priority across all owners.
-    float getLoadPriority();
+    float getLoadPriority() const { return _loadPriority; }
 
     /// Checks whether the resource has loaded.
     bool isLoaded() const { return _loaded; }
@@ -133,6 +236,9 @@ public:
     /// For loading resources, returns the load progress.
     float getProgress() const { return (_bytesTotal <= 0) ? 0.0f : (float)_bytesReceived / _bytesTotal; }
 
+    /// Returns the number of bytes charged against the cache's unused budget while this resource is unused.
+    virtual qint64 getBytes() const { return _bytesTotal; }
+
     /// Refreshes the resource.
     void refresh();
 
@@ -172,6 +278,7 @@ protected:
     bool _failedToLoad = false;
     bool _loaded = false;
     QHash<QPointer<QObject>, float> _loadPriorities;
+    float _loadPriority = -FLT_MAX;
     QWeakPointer<Resource> _self;
     QPointer<ResourceCache> _cache;
     
@@ -188,11 +295,23 @@ private:
     
     void makeRequest();
     
+    /// Abandons the download in progress, so that the request can be made again later.
+    void cancelRequest();
+    
+    /// Recomputes the highest load priority from those of the owners.
+    void updateLoadPriority();
+    void setAggregateLoadPriority(float priority);
+    
     void handleReplyError(QNetworkReply::NetworkError error, QDebug debug);
     
     friend class ResourceCache;
+    friend class ResourceRequestQueue;
     
     int _lruKey = 0;
+    qint64 _unusedBytes = 0; // the size charged to the cache when added to the unused list
+    int _queueIndex = -1;
+    QElapsedTimer _loadTimer;
+    QElapsedTimer _requestTimer;
     QNetworkReply* _reply = nullptr;
     QTimer* _replyTimer = nullptr;
     qint64 _bytesReceived = 0;
@@ -202,4 +321,68 @@ private:
 
 uint qHash(const QPointer<QObject>& value, uint seed = 0);
 
+/// A content-addressed disk cache of processed resources (baked geometry, prepared textures, converted sounds), shared by
+/// the resource caches so that repeat loads skip processing as well as downloading.  Entries are kept within a size budget
+/// by evicting the least recently used.  Safe to use from loader threads, but since it touches the disk, it should only be
+/// used from them.  The existing entries are indexed on a worker thread, and aren't evicted until they have been.
+class ProcessedResourceCache {
+public:
+
+    static ProcessedResourceCache& getInstance();
+
+    /// Returns the key for the result of processing the given content as the given type of resource with the given
+    /// parameters (which should include a version, to be changed along with the processing).
+    static QString getKey(const QByteArray& type, const QByteArray& content, const QByteArray& parameters = QByteArray());
+
+    /// Sets the cache directory (by default, "processed" in the cache location).  An empty path disables the cache.
+    void setDirectory(const QString& directory);
+    QString getDirectory() const;
+
+    void setMaxSize(qint64 maxSize);
+    qint64 getMaxSize() const;
+
+    /// Returns the total size of the cached entries (of those indexed so far).
+    qint64 getSize();
+
+    /// Returns the path of the file holding the entry with the given key and marks the entry as recently used, or returns
+    /// an empty string if there's no such entry.
+    QString find(const QString& key);
+
+    /// Returns the contents of the entry with the given key, or a null array if there's no such entry.
+    QByteArray load(const QString& key);
+
+    /// Stores an entry, evicting old ones as necessary to stay within budget.
+    void insert(const QString& key, const QByteArray& data);
+
+    /// Removes an entry (one found to be corrupt, say).
+    void remove(const QString& key);
+
+private:
+
+    ProcessedResourceCache();
+
+    friend class ProcessedResourceIndexer;
+
+    void ensureIndexed();
+    void buildIndex(const QString& directory);
+    void reserve(qint64 size);
+    void removeEntry(const QString& key);
+
+    class Entry {
+    public:
+        qint64 size;
+        int lruKey;
+    };
+
+    mutable QMutex _mutex;
+    QString _directory;
+    bool _indexed = false;
+    bool _indexing = false;
+    qint64 _maxSize = DEFAULT_PROCESSED_MAX_SIZE;
+    qint64 _size = 0;
+    QHash<QString, Entry> _entries;
+    QMap<int, QString> _lru;
+    int _lastLRUKey = 0;
+};
+
 #endif // hifi_ResourceCache_h
@@ -251,8 +251,9 @@ void OctreeEditPacketSender::queueOctreeEditMessage(PacketType type, unsigned ch
             QUuid nodeUUID = node->getUUID();
             bool isMyJurisdiction = true;
             
-            if (type == PacketTypeEntityErase) {
-                isMyJurisdiction = true; // send erase messages to all servers
+            if (type == PacketTypeEntityErase || type == PacketTypeEntityMotionUpdate) {
+                // send erase messages to all servers, and motion updates too since they mix entities from everywhere
+                isMyJurisdiction = true;
             } else if (_serverJurisdictions) {
                 // we need to get the jurisdiction for this
                 // here we need to get the "pending packet" for this server
@@ -284,12 +285,13 @@ void OctreeEditPacketSender::queueOctreeEditMessage(PacketType type, unsigned ch
                 // This is really the first time we know which server/node this particular edit message
                 // is going to, so we couldn't adjust for clock skew till now. But here's our chance.
                 // We call this virtual function that allows our specific type of EditPacketSender to
-                // fixup the buffer for any clock skew
+                // fixup the buffer for any clock skew.  The copy is adjusted rather than the message itself,
+                // since messages that go to every server would otherwise collect the skews of all of them.
+                unsigned char* messageCopy = &packetBuffer._currentBuffer[packetBuffer._currentSize];
+                memcpy(messageCopy, editPacketBuffer, length);
                 if (node->getClockSkewUsec() != 0) {
-                    adjustEditPacketForClockSkew(type, editPacketBuffer, length, node->getClockSkewUsec());
+                    adjustEditPacketForClockSkew(type, messageCopy, length, node->getClockSkewUsec());
                 }
-                
-                memcpy(&packetBuffer._currentBuffer[packetBuffer._currentSize], editPacketBuffer, length);
                 packetBuffer._currentSize += length;
                 packetBuffer._satoshiCost += satoshiCost;
             }
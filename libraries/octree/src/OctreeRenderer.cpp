@@ -174,11 +174,13 @@ void OctreeRenderer::render(RenderArgs::RenderMode renderMode, RenderArgs::Rende
     _meshesRendered = args._meshesRendered;
     _meshesOutOfView = args._meshesOutOfView;
     _meshesTooSmall = args._meshesTooSmall;
+    _meshesOccluded = args._meshesOccluded;
 
     _elementsTouched = args._elementsTouched;
     _itemsRendered = args._itemsRendered;
     _itemsOutOfView = args._itemsOutOfView;
     _itemsTooSmall = args._itemsTooSmall;
+    _itemsOccluded = args._itemsOccluded;
 
     _materialSwitches = args._materialSwitches;
     _trianglesRendered = args._trianglesRendered;
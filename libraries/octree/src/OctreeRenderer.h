@@ -66,11 +66,13 @@ public:
     int getItemsRendered() const { return _itemsRendered; }
     int getItemsOutOfView() const { return _itemsOutOfView; }
     int getItemsTooSmall() const { return _itemsTooSmall; }
+    int getItemsOccluded() const { return _itemsOccluded; }
 
     int getMeshesConsidered() const { return _meshesConsidered; }
     int getMeshesRendered() const { return _meshesRendered; }
     int getMeshesOutOfView() const { return _meshesOutOfView; }
     int getMeshesTooSmall() const { return _meshesTooSmall; }
+    int getMeshesOccluded() const { return _meshesOccluded; }
 
     int getMaterialSwitches() const { return _materialSwitches; }
     int getTrianglesRendered() const { return _trianglesRendered; }
@@ -90,11 +92,13 @@ protected:
     int _itemsRendered;
     int _itemsOutOfView;
     int _itemsTooSmall;
+    int _itemsOccluded;
 
     int _meshesConsidered;
     int _meshesRendered;
     int _meshesOutOfView;
     int _meshesTooSmall;
+    int _meshesOccluded;
 
     int _materialSwitches;
     int _trianglesRendered;
@@ -664,6 +664,22 @@ void ViewFrustum::printDebugDetails() const {
         _eyeOffsetOrientation.w );
 }
 
+glm::mat4 ViewFrustum::computeViewProjection() const {
+    glm::mat4 worldMatrix = glm::translate(_position) * glm::mat4(glm::mat3(_right, _up, -_direction)) *
+        glm::translate(_eyeOffsetPosition) * glm::mat4_cast(_eyeOffsetOrientation);
+    glm::mat4 projection;
+    if (_orthographic) {
+        projection = glm::ortho(-_width * 0.5f, _width * 0.5f, -_height * 0.5f, _height * 0.5f, _nearClip, _farClip);
+
+    } else {
+        float left, right, bottom, top, nearVal, farVal;
+        glm::vec4 nearClipPlane, farClipPlane;
+        computeOffAxisFrustum(left, right, bottom, top, nearVal, farVal, nearClipPlane, farClipPlane);
+        projection = glm::frustum(left, right, bottom, top, nearVal, farVal);
+    }
+    return projection * glm::inverse(worldMatrix);
+}
+
 glm::vec2 ViewFrustum::projectPoint(glm::vec3 point, bool& pointInView) const {
 
     glm::vec4 pointVec4 = glm::vec4(point,1);
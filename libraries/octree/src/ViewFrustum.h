@@ -115,6 +115,9 @@ public:
     void computeOffAxisFrustum(float& left, float& right, float& bottom, float& top, float& nearValue, float& farValue,
                                glm::vec4& nearClipPlane, glm::vec4& farClipPlane) const;
 
+    /// Computes the matrix taking world space to clip space, including the eye offset and any off-axis skew.
+    glm::mat4 computeViewProjection() const;
+
     void printDebugDetails() const;
 
     glm::vec2 projectPoint(glm::vec3 point, bool& pointInView) const;
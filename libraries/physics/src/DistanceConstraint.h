@@ -23,6 +23,8 @@ public:
     float enforce();
     void setDistance(float distance);
     float getDistance() const { return _distance; }
+    VerletPoint* getStartPoint() const { return _points[0]; }
+    VerletPoint* getEndPoint() const { return _points[1]; }
 private:
     float _distance;
     VerletPoint* _points[2];
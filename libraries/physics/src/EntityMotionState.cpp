@@ -179,15 +179,10 @@ void EntityMotionState::sendUpdate(OctreeEditPacketSender* packetSender, uint32_
         return; // never update entities that are unknown
     }
     if (_outgoingPacketFlags) {
-        EntityItemProperties properties = _entity->getProperties();
-
         if (_outgoingPacketFlags & EntityItem::DIRTY_POSITION) {
             btTransform worldTrans = _body->getWorldTransform();
             _sentPosition = bulletToGLM(worldTrans.getOrigin());
-            properties.setPosition(_sentPosition + ObjectMotionState::getWorldOffset());
-        
             _sentRotation = bulletToGLM(worldTrans.getRotation());
-            properties.setRotation(_sentRotation);
         }
     
         if (_outgoingPacketFlags & EntityItem::DIRTY_VELOCITY) {
@@ -212,11 +207,7 @@ void EntityMotionState::sendUpdate(OctreeEditPacketSender* packetSender, uint32_
                 _sentVelocity = _sentAngularVelocity = glm::vec3(0.0f);
                 _sentMoving = false;
             }
-            properties.setVelocity(_sentVelocity);
             _sentAcceleration = bulletToGLM(_body->getGravity());
-            properties.setGravity(_sentAcceleration);
-            // DANGER! EntityItem stores angularVelocity in degrees/sec!!!
-            properties.setAngularVelocity(glm::degrees(_sentAngularVelocity));
         }
 
         // RELIABLE_SEND_HACK: count number of updates for entities at rest so we can stop sending them after some limit.
@@ -225,32 +216,57 @@ void EntityMotionState::sendUpdate(OctreeEditPacketSender* packetSender, uint32_
         } else {
             _numNonMovingUpdates++;
         }
+        quint64 lastEdited = _entity->getLastEdited();
         if (_numNonMovingUpdates <= 1) {
             // we only update lastEdited when we're sending new physics data 
             // (i.e. NOT when we just simulate the positions forward, nore when we resend non-moving data)
             // NOTE: Andrew & Brad to discuss. Let's make sure we're using lastEdited, lastSimulated, and lastUpdated correctly
-            quint64 lastSimulated = _entity->getLastSimulated();
-            _entity->setLastEdited(lastSimulated);
-            properties.setLastEdited(lastSimulated);
+            lastEdited = _entity->getLastSimulated();
+            _entity->setLastEdited(lastEdited);
 
             #ifdef WANT_DEBUG
                 quint64 now = usecTimestampNow();
                 qDebug() << "EntityMotionState::sendUpdate()";
                 qDebug() << "        EntityItemId:" << _entity->getEntityItemID() << "---------------------------------------------";
-                qDebug() << "       lastSimulated:" << debugTime(lastSimulated, now);
+                qDebug() << "       lastSimulated:" << debugTime(lastEdited, now);
             #endif //def WANT_DEBUG
-
-        } else {
-            properties.setLastEdited(_entity->getLastEdited());
         }
 
-        if (EntityItem::getSendPhysicsUpdates()) {
-            EntityItemID id(_entity->getID());
+        // with no packetSender this is the authoritative simulation, and the lastEdited bump above
+        // is what streams the new motion to clients
+        if (packetSender && EntityItem::getSendPhysicsUpdates() && !EntityItem::getServerSimulatesPhysics()) {
             EntityEditPacketSender* entityPacketSender = static_cast<EntityEditPacketSender*>(packetSender);
-            #ifdef WANT_DEBUG
-                qDebug() << "EntityMotionState::sendUpdate()... calling queueEditEntityMessage()...";
-            #endif
-            entityPacketSender->queueEditEntityMessage(PacketTypeEntityAddOrEdit, id, properties);
+            if ((_outgoingPacketFlags & OUTGOING_DIRTY_PHYSICS_FLAGS) == OUTGOING_DIRTY_PHYSICS_FLAGS) {
+                // the common case: hand the motion to the sender, which packs it with the motion of other entities
+                EntityMotionUpdate update;
+                update.id = _entity->getID();
+                update.lastEdited = lastEdited;
+                update.position = _sentPosition + ObjectMotionState::getWorldOffset();
+                update.rotation = _sentRotation;
+                update.velocity = _sentVelocity;
+                update.angularVelocity = _sentAngularVelocity;
+                update.gravity = _sentAcceleration;
+                update.priority = _updatePriority;
+                entityPacketSender->queueMotionUpdate(update);
+            } else {
+                // an incoming change trumped part of the motion, so only send what is left in a regular edit
+                EntityItemProperties properties = _entity->getProperties();
+                if (_outgoingPacketFlags & EntityItem::DIRTY_POSITION) {
+                    properties.setPosition(_sentPosition + ObjectMotionState::getWorldOffset());
+                    properties.setRotation(_sentRotation);
+                }
+                if (_outgoingPacketFlags & EntityItem::DIRTY_VELOCITY) {
+                    properties.setVelocity(_sentVelocity);
+                    properties.setGravity(_sentAcceleration);
+                    // DANGER! EntityItem stores angularVelocity in degrees/sec!!!
+                    properties.setAngularVelocity(glm::degrees(_sentAngularVelocity));
+                }
+                properties.setLastEdited(lastEdited);
+                #ifdef WANT_DEBUG
+                    qDebug() << "EntityMotionState::sendUpdate()... calling queueEditEntityMessage()...";
+                #endif
+                entityPacketSender->queueEditEntityMessage(PacketTypeEntityAddOrEdit, EntityItemID(_entity->getID()), properties);
+            }
         } else {
             #ifdef WANT_DEBUG
                 qDebug() << "EntityMotionState::sendUpdate()... NOT sending update as requested.";
@@ -50,7 +50,8 @@ ObjectMotionState::ObjectMotionState() :
     _sentRotation(),
     _sentVelocity(0.0f),
     _sentAngularVelocity(0.0f),
-    _sentAcceleration(0.0f) {
+    _sentAcceleration(0.0f),
+    _updatePriority(0.0f) {
 }
 
 ObjectMotionState::~ObjectMotionState() {
@@ -98,6 +99,10 @@ void ObjectMotionState::getAngularVelocity(glm::vec3& angularVelocityOut) const
 // we alwasy resend packets for objects that have stopped moving up to some max limit.
 const int MAX_NUM_NON_MOVING_UPDATES = 5;
 
+// update priorities are the error relative to the error that triggers an update, so anything that is sent is at least 1
+const float RESTING_UPDATE_PRIORITY = 2.0f;
+const float REPEATED_UPDATE_PRIORITY = 1.0f;
+
 bool ObjectMotionState::doesNotNeedToSendUpdate() const { 
     return !_body->isActive() && _numNonMovingUpdates > MAX_NUM_NON_MOVING_UPDATES;
 }
@@ -128,12 +133,14 @@ bool ObjectMotionState::shouldSendUpdate(uint32_t simulationFrame) {
     if (!isActive) {
         if (_sentMoving) { 
             // this object just went inactive so send an update immediately
+            _updatePriority = RESTING_UPDATE_PRIORITY;
             return true;
         } else {
             const float NON_MOVING_UPDATE_PERIOD = 1.0f;
             if (dt > NON_MOVING_UPDATE_PERIOD && _numNonMovingUpdates < MAX_NUM_NON_MOVING_UPDATES) {
                 // RELIABLE_SEND_HACK: since we're not yet using a reliable method for non-moving update packets we repeat these
                 // at a faster rate than the MAX period above, and only send a limited number of them.
+                _updatePriority = REPEATED_UPDATE_PRIORITY;
                 return true;
             }
         }
@@ -168,6 +175,7 @@ bool ObjectMotionState::shouldSendUpdate(uint32_t simulationFrame) {
             qDebug() << "dx2:" << dx2;
         #endif
 
+        _updatePriority = dx2 / MAX_POSITION_ERROR_SQUARED;
         return true;
     }
     
@@ -201,7 +209,9 @@ bool ObjectMotionState::shouldSendUpdate(uint32_t simulationFrame) {
         }
     #endif
 
-    return (fabsf(glm::dot(actualRotation, _sentRotation)) < MIN_ROTATION_DOT);
+    float rotationDot = fabsf(glm::dot(actualRotation, _sentRotation));
+    _updatePriority = (1.0f - rotationDot) / (1.0f - MIN_ROTATION_DOT);
+    return (rotationDot < MIN_ROTATION_DOT);
 }
 
 void ObjectMotionState::setRigidBody(btRigidBody* body) {
@@ -88,6 +88,9 @@ public:
 
     bool doesNotNeedToSendUpdate() const;
     virtual bool shouldSendUpdate(uint32_t simulationFrame);
+
+    /// \return how far off the remote extrapolation was at the last shouldSendUpdate(), 1.0 being just enough to send
+    float getUpdatePriority() const { return _updatePriority; }
     virtual void sendUpdate(OctreeEditPacketSender* packetSender, uint32_t frame) = 0;
 
     virtual MotionType computeMotionType() const = 0;
@@ -130,6 +133,7 @@ protected:
     glm::vec3 _sentVelocity;
     glm::vec3 _sentAngularVelocity; // radians per second
     glm::vec3 _sentAcceleration;
+    float _updatePriority;
 };
 
 #endif // hifi_ObjectMotionState_h
@@ -9,6 +9,8 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <MovingEntitiesOperator.h>
+
 #include "PhysicsEngine.h"
 #include "ShapeInfoUtil.h"
 #include "PhysicsHelpers.h"
@@ -40,6 +42,7 @@ void PhysicsEngine::updateEntitiesInternal(const quint64& now) {
         // (4) send outgoing packets
     
         // this is step (4)
+        MovingEntitiesOperator updateOperator(_entityTree);
         QSet<ObjectMotionState*>::iterator stateItr = _outgoingPackets.begin();
         while (stateItr != _outgoingPackets.end()) {
             ObjectMotionState* state = *stateItr;
@@ -47,11 +50,21 @@ void PhysicsEngine::updateEntitiesInternal(const quint64& now) {
                 stateItr = _outgoingPackets.erase(stateItr);
             } else if (state->shouldSendUpdate(_numSubsteps)) {
                 state->sendUpdate(_entityPacketSender, _numSubsteps);
+                if (!_entityPacketSender && state->getType() == MOTION_STATE_TYPE_ENTITY) {
+                    // we are the authority: rather than sending an edit we mark the entity for the octree stream
+                    EntityItem* entity = static_cast<EntityMotionState*>(state)->getEntity();
+                    updateOperator.addEntityToUpdateList(entity, entity->getMaximumAACube());
+                }
                 ++stateItr;
             } else {
                 ++stateItr;
             }
         }
+        if (_entityPacketSender) {
+            _entityPacketSender->releaseMotionUpdates(now);
+        } else if (updateOperator.hasMovingEntities()) {
+            _entityTree->recurseTreeWithOperator(&updateOperator);
+        }
     }
 }
 
@@ -261,7 +274,8 @@ void PhysicsEngine::init(EntityEditPacketSender* packetSender) {
         _dynamicsWorld->setGravity(btVector3(0.0f, 0.0f, 0.0f));
     }
 
-    assert(packetSender);
+    // packetSender is NULL when this simulation is the authority (e.g. inside the EntityServer),
+    // in which case motion goes out through the octree stream rather than as edits
     _entityPacketSender = packetSender;
     EntityMotionState::setOutgoingEntityList(&_entitiesToBeSorted);
 }
@@ -287,6 +301,7 @@ void PhysicsEngine::stepSimulation() {
     int numSubsteps = _dynamicsWorld->stepSimulation(timeStep, MAX_NUM_SUBSTEPS, PHYSICS_ENGINE_FIXED_SUBSTEP);
     _numSubsteps += (uint32_t)numSubsteps;
     stepNonPhysicalKinematics(usecTimestampNow());
+    _lastStepTime = (quint64)_clock.getTimeMicroseconds();
     unlock();
 
     if (numSubsteps > 0) {
@@ -319,6 +334,22 @@ void PhysicsEngine::stepNonPhysicalKinematics(const quint64& now) {
 
 // TODO?: need to occasionally scan for stopped non-physical kinematics objects
 
+int PhysicsEngine::getNumActiveObjects() const {
+    if (!_dynamicsWorld) {
+        return 0;
+    }
+    // sleeping islands are deactivated by Bullet, so this only counts bodies that are still being integrated
+    int numActiveObjects = 0;
+    const btCollisionObjectArray& objects = _dynamicsWorld->getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); ++i) {
+        const btCollisionObject* object = objects[i];
+        if (object->isActive() && !object->isStaticOrKinematicObject()) {
+            ++numActiveObjects;
+        }
+    }
+    return numActiveObjects;
+}
+
 void PhysicsEngine::computeCollisionEvents() {
     // update all contacts every frame
     int numManifolds = _collisionDispatcher->getNumManifolds();
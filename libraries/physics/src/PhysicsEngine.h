@@ -62,6 +62,7 @@ public:
     void sortEntitiesThatMovedInternal();
     void clearEntitiesInternal();
 
+    /// \param packetSender where to send edits for moved entities, or NULL when this simulation is authoritative
     virtual void init(EntityEditPacketSender* packetSender);
 
     void stepSimulation();
@@ -69,6 +70,12 @@ public:
 
     void computeCollisionEvents();
 
+    /// \return number of dynamic bodies that are awake (not in a sleeping island)
+    int getNumActiveObjects() const;
+
+    /// \return usecs spent relaying changes and stepping the dynamics world during the last stepSimulation()
+    quint64 getLastStepTime() const { return _lastStepTime; }
+
     /// \param offset position of simulation origin in domain-frame
     void setOriginOffset(const glm::vec3& offset) { _originOffset = offset; }
 
@@ -113,6 +120,7 @@ private:
     ContactMap _contactMap;
     uint32_t _numContactFrames = 0;
     uint32_t _lastNumSubstepsAtUpdateInternal = 0;
+    quint64 _lastStepTime = 0;
 };
 
 #endif // hifi_PhysicsEngine_h
@@ -306,28 +306,32 @@ bool PhysicsSimulation::computeCollisions() {
     PerformanceTimer perfTimer("collide");
     _collisions.clear();
 
+    // the main ragdoll collides with itself and with others, the others don't collide with each other
+    _broadphase.clear();
     const QVector<Shape*> shapes = _entity->getShapes();
     int numShapes = shapes.size();
-    // collide main ragdoll with self
     for (int i = 0; i < numShapes; ++i) {
-        const Shape* shape = shapes.at(i);
-        if (!shape) {
-            continue;
-        }
-        for (int j = i+1; j < numShapes; ++j) {
-            const Shape* otherShape = shapes.at(j);
-            if (otherShape && _entity->collisionsAreEnabled(i, j)) {
-                ShapeCollider::collideShapes(shape, otherShape, _collisions);
-            }
-        }
+        _broadphase.addPrimaryShape(shapes.at(i), i);
     }
-
-    // collide main ragdoll with others
-    bool otherCollisions = false;
     int numEntities = _otherEntities.size();
     for (int i = 0; i < numEntities; ++i) {
-        const QVector<Shape*> otherShapes = _otherEntities.at(i)->getShapes();
-        otherCollisions = ShapeCollider::collideShapesWithShapes(shapes, otherShapes, _collisions) || otherCollisions;
+        _broadphase.addSecondaryShapes(_otherEntities.at(i)->getShapes());
+    }
+
+    bool otherCollisions = false;
+    const QVector<ShapePair>& pairs = _broadphase.computePairs();
+    int numPairs = pairs.size();
+    for (int i = 0; i < numPairs && !_collisions.isFull(); ++i) {
+        const ShapePair& pair = pairs.at(i);
+        if (pair.indexB != -1) {
+            // collide main ragdoll with self
+            if (_entity->collisionsAreEnabled(pair.indexA, pair.indexB)) {
+                ShapeCollider::collideShapes(pair.shapeA, pair.shapeB, _collisions);
+            }
+        } else {
+            // collide main ragdoll with others
+            otherCollisions = ShapeCollider::collideShapes(pair.shapeA, pair.shapeB, _collisions) || otherCollisions;
+        }
     }
     return otherCollisions;
 }
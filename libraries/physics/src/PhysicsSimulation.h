@@ -19,6 +19,7 @@
 #include "CollisionInfo.h"
 #include "ContactPoint.h"
 #include "RayIntersectionInfo.h"
+#include "ShapeBroadphase.h"
 
 class PhysicsEntity;
 class Ragdoll;
@@ -84,6 +85,7 @@ private:
     QVector<Ragdoll*> _otherRagdolls;
     QVector<PhysicsEntity*> _otherEntities;
     CollisionList _collisions;
+    ShapeBroadphase _broadphase;
     QMap<quint64, ContactPoint> _contacts;
 };
 
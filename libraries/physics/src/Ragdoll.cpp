@@ -52,18 +52,19 @@ void Ragdoll::clearConstraintsAndPoints() {
         delete _fixedConstraints[i];
     }
     _fixedConstraints.clear();
+    _boneSolver.clear();
     _points.clear();
 }
 
 float Ragdoll::enforceConstraints() {
     float maxDistance = 0.0f;
-    // enforce the bone constraints first
-    int numConstraints = _boneConstraints.size();
-    for (int i = 0; i < numConstraints; ++i) {
-        maxDistance = glm::max(maxDistance, _boneConstraints[i]->enforce());
+    // enforce the bone constraints first, subclasses build them (and the points) directly so pick up any changes here
+    if (!_boneSolver.isBuiltFor(_points, _boneConstraints)) {
+        _boneSolver.build(_points, _boneConstraints);
     }
+    maxDistance = _boneSolver.enforce(_points);
     // enforce FixedConstraints second
-    numConstraints = _fixedConstraints.size();
+    int numConstraints = _fixedConstraints.size();
     for (int i = 0; i < _fixedConstraints.size(); ++i) {
         maxDistance = glm::max(maxDistance, _fixedConstraints[i]->enforce());
     }
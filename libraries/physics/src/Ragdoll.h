@@ -17,6 +17,7 @@
 
 #include <QVector>
 
+#include "RagdollSolver.h"
 #include "VerletPoint.h"
 //#include "PhysicsSimulation.h"
 
@@ -75,6 +76,7 @@ protected:
     QVector<VerletPoint> _points;
     QVector<DistanceConstraint*> _boneConstraints;
     QVector<FixedConstraint*> _fixedConstraints;
+    RagdollSolver _boneSolver; // packed copy of _boneConstraints, rebuilt whenever they or the points change
 
     // The collisions are typically done in a simulation frame that is slaved to the center of one of the Ragdolls.
     // To allow the Ragdoll to provide feedback of its own displacement we store it in _accumulatedMovement.
@@ -0,0 +1,239 @@
+//
+//  RagdollSolver.cpp
+//  libraries/physics/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <math.h>
+
+#include <SharedUtil.h> // for EPSILON
+
+#include "DistanceConstraint.h"
+#include "RagdollSolver.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define RAGDOLL_SOLVER_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// number of constraints relaxed per pass within a batch
+const int BATCH_WIDTH = 4;
+
+RagdollSolver::RagdollSolver() : _numPoints(0), _firstPoint(NULL) {
+}
+
+void RagdollSolver::clear() {
+    _numPoints = 0;
+    _firstPoint = NULL;
+    _constraints.clear();
+    _pointIndices.clear();
+    _x.clear();
+    _y.clear();
+    _z.clear();
+    _startPoints.clear();
+    _endPoints.clear();
+    _distances.clear();
+    _batchEnds.clear();
+}
+
+void RagdollSolver::build(const QVector<VerletPoint>& points, const QVector<DistanceConstraint*>& constraints) {
+    clear();
+    _numPoints = points.size();
+    _firstPoint = points.constData();
+    _constraints = constraints;
+    const VerletPoint* firstPoint = _firstPoint;
+
+    // map ragdoll points to gathered points, in ragdoll order so the gather walks memory forward
+    QVector<int> localIndices(_numPoints, -1);
+    QVector<int> startPoints;
+    QVector<int> endPoints;
+    QVector<float> distances;
+    int numConstraints = constraints.size();
+    for (int i = 0; i < numConstraints; ++i) {
+        const DistanceConstraint* constraint = constraints.at(i);
+        int start = constraint->getStartPoint() - firstPoint;
+        int end = constraint->getEndPoint() - firstPoint;
+        if (start < 0 || start >= _numPoints || end < 0 || end >= _numPoints || start == end) {
+            continue; // not between two of the points, so not ours to solve
+        }
+        localIndices[start] = 0;
+        localIndices[end] = 0;
+        startPoints.push_back(start);
+        endPoints.push_back(end);
+        distances.push_back(constraint->getDistance());
+    }
+    for (int i = 0; i < _numPoints; ++i) {
+        if (localIndices.at(i) != -1) {
+            localIndices[i] = _pointIndices.size();
+            _pointIndices.push_back(i);
+        }
+    }
+    int numLocalPoints = _pointIndices.size();
+    _x.resize(numLocalPoints);
+    _y.resize(numLocalPoints);
+    _z.resize(numLocalPoints);
+
+    // greedy coloring: each constraint goes into the first batch where neither of its points is taken yet
+    QVector<int> colors;
+    QVector<QVector<bool> > pointTaken;
+    numConstraints = startPoints.size();
+    for (int i = 0; i < numConstraints; ++i) {
+        int start = localIndices.at(startPoints.at(i));
+        int end = localIndices.at(endPoints.at(i));
+        int color = 0;
+        while (color < pointTaken.size() && (pointTaken.at(color).at(start) || pointTaken.at(color).at(end))) {
+            ++color;
+        }
+        if (color == pointTaken.size()) {
+            pointTaken.push_back(QVector<bool>(numLocalPoints, false));
+        }
+        pointTaken[color][start] = true;
+        pointTaken[color][end] = true;
+        colors.push_back(color);
+    }
+
+    // lay the constraints out batch by batch, keeping their original order within each batch
+    int numBatches = pointTaken.size();
+    for (int color = 0; color < numBatches; ++color) {
+        for (int i = 0; i < numConstraints; ++i) {
+            if (colors.at(i) == color) {
+                _startPoints.push_back(localIndices.at(startPoints.at(i)));
+                _endPoints.push_back(localIndices.at(endPoints.at(i)));
+                _distances.push_back(distances.at(i));
+            }
+        }
+        _batchEnds.push_back(_distances.size());
+    }
+}
+
+bool RagdollSolver::isBuiltFor(const QVector<VerletPoint>& points, const QVector<DistanceConstraint*>& constraints) const {
+    return points.size() == _numPoints && points.constData() == _firstPoint && constraints == _constraints;
+}
+
+void RagdollSolver::getBatchRange(int batch, int& start, int& end) const {
+    start = (batch > 0) ? _batchEnds.at(batch - 1) : 0;
+    end = _batchEnds.at(batch);
+}
+
+void RagdollSolver::getConstraintPoints(int constraint, int& startPoint, int& endPoint) const {
+    startPoint = _pointIndices.at(_startPoints.at(constraint));
+    endPoint = _pointIndices.at(_endPoints.at(constraint));
+}
+
+float RagdollSolver::enforce(QVector<VerletPoint>& points) {
+    if (points.size() != _numPoints) {
+        // the points changed since we were built; the owner should have checked isBuiltFor() and rebuilt us
+        return 0.0f;
+    }
+    int numLocalPoints = _pointIndices.size();
+    VerletPoint* firstPoint = points.data();
+    for (int i = 0; i < numLocalPoints; ++i) {
+        const glm::vec3& position = firstPoint[_pointIndices.at(i)]._position;
+        _x[i] = position.x;
+        _y[i] = position.y;
+        _z[i] = position.z;
+    }
+
+    float maxDistance = 0.0f;
+    int start = 0;
+    int numBatches = _batchEnds.size();
+    for (int i = 0; i < numBatches; ++i) {
+        int end = _batchEnds.at(i);
+        maxDistance = glm::max(maxDistance, enforceBatch(start, end));
+        start = end;
+    }
+
+    for (int i = 0; i < numLocalPoints; ++i) {
+        firstPoint[_pointIndices.at(i)]._position = glm::vec3(_x.at(i), _y.at(i), _z.at(i));
+    }
+    return maxDistance;
+}
+
+float RagdollSolver::enforceBatch(int start, int end) {
+    float maxDistance = 0.0f;
+    int i = start;
+#ifdef RAGDOLL_SOLVER_USE_SSE
+    float* x = _x.data();
+    float* y = _y.data();
+    float* z = _z.data();
+    const int* startPoints = _startPoints.constData();
+    const int* endPoints = _endPoints.constData();
+    __m128 maxError = _mm_setzero_ps();
+    for (; i + BATCH_WIDTH <= end; i += BATCH_WIDTH) {
+        const int* a = startPoints + i;
+        const int* b = endPoints + i;
+        __m128 dx = _mm_sub_ps(_mm_setr_ps(x[a[0]], x[a[1]], x[a[2]], x[a[3]]), _mm_setr_ps(x[b[0]], x[b[1]], x[b[2]], x[b[3]]));
+        __m128 dy = _mm_sub_ps(_mm_setr_ps(y[a[0]], y[a[1]], y[a[2]], y[a[3]]), _mm_setr_ps(y[b[0]], y[b[1]], y[b[2]], y[b[3]]));
+        __m128 dz = _mm_sub_ps(_mm_setr_ps(z[a[0]], z[a[1]], z[a[2]], z[a[3]]), _mm_setr_ps(z[b[0]], z[b[1]], z[b[2]], z[b[3]]));
+        __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        if (_mm_movemask_ps(_mm_cmple_ps(distance2, _mm_set1_ps(EPSILON * EPSILON)))) {
+            // points on top of each other need a made up direction, leave those to the scalar path
+            for (int j = i; j < i + BATCH_WIDTH; ++j) {
+                maxDistance = glm::max(maxDistance, enforceConstraint(j));
+            }
+            continue;
+        }
+        __m128 distance = _mm_sqrt_ps(distance2);
+        __m128 targetDistance = _mm_loadu_ps(_distances.constData() + i);
+        __m128 error = _mm_sub_ps(targetDistance, distance);
+        maxError = _mm_max_ps(maxError, _mm_max_ps(error, _mm_sub_ps(_mm_setzero_ps(), error)));
+
+        // move both ends half of the error along the line between them
+        __m128 scale = _mm_div_ps(_mm_mul_ps(_mm_set1_ps(0.5f), error), distance);
+        float offsetX[BATCH_WIDTH];
+        float offsetY[BATCH_WIDTH];
+        float offsetZ[BATCH_WIDTH];
+        _mm_storeu_ps(offsetX, _mm_mul_ps(dx, scale));
+        _mm_storeu_ps(offsetY, _mm_mul_ps(dy, scale));
+        _mm_storeu_ps(offsetZ, _mm_mul_ps(dz, scale));
+        for (int lane = 0; lane < BATCH_WIDTH; ++lane) {
+            x[a[lane]] += offsetX[lane];
+            y[a[lane]] += offsetY[lane];
+            z[a[lane]] += offsetZ[lane];
+            x[b[lane]] -= offsetX[lane];
+            y[b[lane]] -= offsetY[lane];
+            z[b[lane]] -= offsetZ[lane];
+        }
+    }
+    float maxErrors[BATCH_WIDTH];
+    _mm_storeu_ps(maxErrors, maxError);
+    for (int lane = 0; lane < BATCH_WIDTH; ++lane) {
+        maxDistance = glm::max(maxDistance, maxErrors[lane]);
+    }
+#endif
+    for (; i < end; ++i) {
+        maxDistance = glm::max(maxDistance, enforceConstraint(i));
+    }
+    return maxDistance;
+}
+
+float RagdollSolver::enforceConstraint(int constraint) {
+    // same as DistanceConstraint::enforce()
+    int a = _startPoints.at(constraint);
+    int b = _endPoints.at(constraint);
+    glm::vec3 startPosition(_x.at(a), _y.at(a), _z.at(a));
+    glm::vec3 endPosition(_x.at(b), _y.at(b), _z.at(b));
+    float targetDistance = _distances.at(constraint);
+
+    float newDistance = glm::distance(startPosition, endPosition);
+    glm::vec3 direction(0.0f, 1.0f, 0.0f);
+    if (newDistance > EPSILON) {
+        direction = (startPosition - endPosition) / newDistance;
+    }
+    glm::vec3 center = 0.5f * (startPosition + endPosition);
+    startPosition = center + (0.5f * targetDistance) * direction;
+    endPosition = center - (0.5f * targetDistance) * direction;
+
+    _x[a] = startPosition.x;
+    _y[a] = startPosition.y;
+    _z[a] = startPosition.z;
+    _x[b] = endPosition.x;
+    _y[b] = endPosition.y;
+    _z[b] = endPosition.z;
+    return glm::abs(newDistance - targetDistance);
+}
@@ -0,0 +1,76 @@
+//
+//  RagdollSolver.h
+//  libraries/physics/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_RagdollSolver_h
+#define hifi_RagdollSolver_h
+
+#include <QVector>
+
+#include "VerletPoint.h"
+
+class DistanceConstraint;
+
+/// Relaxes a Ragdoll's DistanceConstraints out of packed arrays instead of through the constraint objects.
+/// The constraints are stored as pairs of point indices and split into batches in which no two constraints share
+/// a point, so every constraint within a batch can be relaxed at the same time.
+class RagdollSolver {
+public:
+    RagdollSolver();
+
+    void clear();
+
+    /// \param points the points the constraints refer to
+    /// \param constraints the constraints to pack, each must refer to two entries of points
+    void build(const QVector<VerletPoint>& points, const QVector<DistanceConstraint*>& constraints);
+
+    /// \return true if the solver was last built against these very points and constraints
+    bool isBuiltFor(const QVector<VerletPoint>& points, const QVector<DistanceConstraint*>& constraints) const;
+
+    int getNumConstraints() const { return _distances.size(); }
+    int getNumBatches() const { return _batchEnds.size(); }
+
+    /// \param batch index of batch
+    /// \param[out] start index of first constraint in batch
+    /// \param[out] end index one past the last constraint in batch
+    void getBatchRange(int batch, int& start, int& end) const;
+
+    /// \param constraint index of constraint in batch order
+    /// \param[out] startPoint index into the points of one end of the constraint
+    /// \param[out] endPoint index into the points of the other end of the constraint
+    void getConstraintPoints(int constraint, int& startPoint, int& endPoint) const;
+
+    /// Relax every constraint once, batch by batch.
+    /// \param points the same points the solver was built against
+    /// \return max distance error before relaxation
+    float enforce(QVector<VerletPoint>& points);
+
+private:
+    float enforceBatch(int start, int end);
+    float enforceConstraint(int constraint);
+
+    int _numPoints; // size of the points the solver was built against
+    const VerletPoint* _firstPoint; // where those points were
+    QVector<DistanceConstraint*> _constraints; // the constraints it was built from
+
+    // the points touched by any constraint, gathered from and scattered back to the ragdoll around each pass
+    QVector<int> _pointIndices;
+    QVector<float> _x;
+    QVector<float> _y;
+    QVector<float> _z;
+
+    // constraints in batch order, refering to the gathered points
+    QVector<int> _startPoints;
+    QVector<int> _endPoints;
+    QVector<float> _distances;
+    QVector<int> _batchEnds;
+};
+
+#endif // hifi_RagdollSolver_h
@@ -133,14 +133,14 @@ void AnimationHandle::simulate(float deltaTime) {
         }
     }
     
-    const FBXGeometry& animationGeometry = _animation->getGeometry();
-    if (animationGeometry.animationFrames.isEmpty()) {
+    int frameCount = _animation->getFrameCount();
+    if (frameCount == 0) {
         stop();
         return;
     }
     
-    if (_animationLoop.getMaxFrameIndexHint() != animationGeometry.animationFrames.size()) {
-        _animationLoop.setMaxFrameIndexHint(animationGeometry.animationFrames.size());
+    if (_animationLoop.getMaxFrameIndexHint() != frameCount) {
+        _animationLoop.setMaxFrameIndexHint(frameCount);
     }
         
     // blend between the closest two frames
@@ -148,16 +148,13 @@ void AnimationHandle::simulate(float deltaTime) {
 }
 
 void AnimationHandle::applyFrame(float frameIndex) {
-    const FBXGeometry& animationGeometry = _animation->getGeometry();
-    int frameCount = animationGeometry.animationFrames.size();
-    const FBXAnimationFrame& floorFrame = animationGeometry.animationFrames.at((int)glm::floor(frameIndex) % frameCount);
-    const FBXAnimationFrame& ceilFrame = animationGeometry.animationFrames.at((int)glm::ceil(frameIndex) % frameCount);
-    float frameFraction = glm::fract(frameIndex);
-    for (int i = 0; i < _jointMappings.size(); i++) {
+    // the pose is shared with any other handles playing the same animation at the same point
+    QVector<glm::quat> rotations = _animation->getPose(frameIndex);
+    for (int i = 0, n = qMin(_jointMappings.size(), rotations.size()); i < n; i++) {
         int mapping = _jointMappings.at(i);
         if (mapping != -1) {
             JointState& state = _model->_jointStates[mapping];
-            state.setRotationInConstrainedFrame(safeMix(floorFrame.rotations.at(i), ceilFrame.rotations.at(i), frameFraction), _priority);
+            state.setRotationInConstrainedFrame(rotations.at(i), _priority);
         }
     }
 }
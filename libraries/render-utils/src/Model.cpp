@@ -11,8 +11,8 @@
 
 #include <gpu/GPUConfig.h>
 
-#include <QMetaType>
 #include <QRunnable>
+#include <QSemaphore>
 #include <QThreadPool>
 
 #include <glm/gtx/transform.hpp>
@@ -22,6 +22,7 @@
 #include <GeometryUtil.h>
 #include <gpu/Batch.h>
 #include <gpu/GLBackend.h>
+#include <OcclusionBuffer.h>
 #include <PathUtils.h>
 #include <PerfStat.h>
 #include <PhysicsEntity.h>
@@ -55,15 +56,17 @@
 #include "model_lightmap_specular_map_frag.h"
 #include "model_translucent_frag.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MODEL_USE_SSE
+#include <xmmintrin.h>
+#endif
+
 
 #define GLBATCH( call ) batch._##call
 //#define GLBATCH( call ) call
 
 using namespace std;
 
-static int modelPointerTypeId = qRegisterMetaType<QPointer<Model> >();
-static int weakNetworkGeometryPointerTypeId = qRegisterMetaType<QWeakPointer<NetworkGeometry> >();
-static int vec3VectorTypeId = qRegisterMetaType<QVector<glm::vec3> >();
 float Model::FAKE_DIMENSION_PLACEHOLDER = -1.0f;
 
 Model::Model(QObject* parent) :
@@ -78,8 +81,8 @@ Model::Model(QObject* parent) :
     _lodDistance(0.0f),
     _pupilDilation(0.0f),
     _url("http://invalid.com"),
-    _blendNumber(0),
-    _appliedBlendNumber(0),
+    _updateRequired(false),
+    _blendRequired(false),
     _calculatedMeshBoxesValid(false),
     _calculatedMeshTrianglesValid(false),
     _meshGroupsKnown(false) {
@@ -378,7 +381,12 @@ bool Model::updateGeometry() {
 
     bool needToRebuild = false;
     if (_nextGeometry) {
-        _nextGeometry = _nextGeometry->getLODOrFallback(_lodDistance, _nextLODHysteresis);
+        QSharedPointer<NetworkGeometry> nextGeometry = _nextGeometry->getLODOrFallback(_lodDistance, _nextLODHysteresis);
+        if (_nextGeometry != nextGeometry) {
+            // we no longer want the LOD we were waiting for, so its priority shouldn't outlast our interest
+            _nextGeometry->clearLoadPriority(this);
+            _nextGeometry = nextGeometry;
+        }
         _nextGeometry->setLoadPriority(this, -_lodDistance);
         _nextGeometry->ensureLoading();
         if (_nextGeometry->isLoaded()) {
@@ -665,6 +673,9 @@ void Model::renderSetup(RenderArgs* args) {
 bool Model::render(float alpha, RenderMode mode, RenderArgs* args) {
     PROFILE_RANGE(__FUNCTION__);
 
+    // finish the updates of everything simulated since the last render
+    DependencyManager::get<ModelBlender>()->updateModels();
+
     // render the attachments
     foreach (Model* attachment, _attachments) {
         attachment->render(alpha, mode);
@@ -975,6 +986,10 @@ void Model::setURL(const QUrl& url, const QUrl& fallback, bool retainCurrent, bo
     }
     _url = url;
 
+    if (_nextGeometry) {
+        _nextGeometry->clearLoadPriority(this);
+    }
+
     // if so instructed, keep the current geometry until the new one is loaded 
     _nextBaseGeometry = _nextGeometry = DependencyManager::get<GeometryCache>()->getGeometry(url, fallback, delayLoad);
     _nextLODHysteresis = NetworkGeometry::NO_HYSTERESIS;
@@ -1072,68 +1087,6 @@ void Model::updateShapePositions() {
     // TODO: implement this when we know how to build shapes for regular Models
 }
 
-class Blender : public QRunnable {
-public:
-
-    Blender(Model* model, int blendNumber, const QWeakPointer<NetworkGeometry>& geometry,
-        const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients);
-    
-    virtual void run();
-
-private:
-    
-    QPointer<Model> _model;
-    int _blendNumber;
-    QWeakPointer<NetworkGeometry> _geometry;
-    QVector<FBXMesh> _meshes;
-    QVector<float> _blendshapeCoefficients;
-};
-
-Blender::Blender(Model* model, int blendNumber, const QWeakPointer<NetworkGeometry>& geometry,
-        const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients) :
-    _model(model),
-    _blendNumber(blendNumber),
-    _geometry(geometry),
-    _meshes(meshes),
-    _blendshapeCoefficients(blendshapeCoefficients) {
-}
-
-void Blender::run() {
-    QVector<glm::vec3> vertices, normals;
-    if (!_model.isNull()) {
-        int offset = 0;
-        foreach (const FBXMesh& mesh, _meshes) {
-            if (mesh.blendshapes.isEmpty()) {
-                continue;
-            }
-            vertices += mesh.vertices;
-            normals += mesh.normals;
-            glm::vec3* meshVertices = vertices.data() + offset;
-            glm::vec3* meshNormals = normals.data() + offset;
-            offset += mesh.vertices.size();
-            const float NORMAL_COEFFICIENT_SCALE = 0.01f;
-            for (int i = 0, n = qMin(_blendshapeCoefficients.size(), mesh.blendshapes.size()); i < n; i++) {
-                float vertexCoefficient = _blendshapeCoefficients.at(i);
-                if (vertexCoefficient < EPSILON) {
-                    continue;
-                }
-                float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
-                const FBXBlendshape& blendshape = mesh.blendshapes.at(i);
-                for (int j = 0; j < blendshape.indices.size(); j++) {
-                    int index = blendshape.indices.at(j);
-                    meshVertices[index] += blendshape.vertices.at(j) * vertexCoefficient;
-                    meshNormals[index] += blendshape.normals.at(j) * normalCoefficient;
-                }
-            }
-        }
-    }
-    // post the result to the geometry cache, which will dispatch to the model if still alive
-    QMetaObject::invokeMethod(DependencyManager::get<ModelBlender>().data(), "setBlendedVertices",
-        Q_ARG(const QPointer<Model>&, _model), Q_ARG(int, _blendNumber),
-        Q_ARG(const QWeakPointer<NetworkGeometry>&, _geometry), Q_ARG(const QVector<glm::vec3>&, vertices),
-        Q_ARG(const QVector<glm::vec3>&, normals));
-}
-
 void Model::setScaleToFit(bool scaleToFit, const glm::vec3& dimensions) {
     if (_scaleToFit != scaleToFit || _scaleToFitDimensions != dimensions) {
         _scaleToFit = scaleToFit;
@@ -1271,27 +1224,79 @@ void Model::simulateInternal(float deltaTime) {
         }
     }
     
-    glm::mat4 modelToWorld = glm::mat4_cast(_rotation);
-    for (int i = 0; i < _meshStates.size(); i++) {
-        MeshState& state = _meshStates[i];
-        const FBXMesh& mesh = geometry.meshes.at(i);
-        if (_showTrueJointTransforms) {
-            for (int j = 0; j < mesh.clusters.size(); j++) {
-                const FBXCluster& cluster = mesh.clusters.at(j);
-                state.clusterMatrices[j] = modelToWorld * _jointStates[cluster.jointIndex].getTransform() * cluster.inverseBindMatrix;
-            }
-        } else {
-            for (int j = 0; j < mesh.clusters.size(); j++) {
-                const FBXCluster& cluster = mesh.clusters.at(j);
-                state.clusterMatrices[j] = modelToWorld * _jointStates[cluster.jointIndex].getVisibleTransform() * cluster.inverseBindMatrix;
-            }
-        }
-    }
-    
-    // post the blender if we're not currently waiting for one to finish
+    // the cluster matrices and blended vertices aren't needed until we render, so they're computed then, in parallel
+    // with those of every other model simulated this frame
     if (geometry.hasBlendedMeshes() && _blendshapeCoefficients != _blendedBlendshapeCoefficients) {
         _blendedBlendshapeCoefficients = _blendshapeCoefficients;
-        DependencyManager::get<ModelBlender>()->noteRequiresBlend(this);
+        _blendRequired = true;
+    }
+    if (!_updateRequired) {
+        _updateRequired = true;
+        DependencyManager::get<ModelBlender>()->noteRequiresUpdate(this);
+    }
+}
+
+/// Adds a weighted blendshape to blended vertices and normals (of which there are the same number).  With SSE, each offset
+/// is added as a four-wide vector whose last lane is zero, so that loads and stores spill harmlessly into the following
+/// element; only an offset to the last vertex, or the last offset in the blendshape, has nothing following it to spill into.
+static void addBlendshape(const FBXBlendshape& blendshape, float vertexCoefficient, float normalCoefficient,
+        glm::vec3* vertices, glm::vec3* normals, int vertexCount) {
+    const int* indices = blendshape.indices.constData();
+    const glm::vec3* vertexOffsets = blendshape.vertices.constData();
+    const glm::vec3* normalOffsets = blendshape.normals.constData();
+    int offsetCount = blendshape.indices.size();
+    int i = 0;
+#ifdef MODEL_USE_SSE
+    __m128 mask = _mm_cmplt_ps(_mm_setzero_ps(), _mm_set_ps(0.0f, 1.0f, 1.0f, 1.0f));
+    __m128 vertexScale = _mm_set1_ps(vertexCoefficient);
+    __m128 normalScale = _mm_set1_ps(normalCoefficient);
+    for (int lastVertex = vertexCount - 1; i < offsetCount - 1; i++) {
+        int index = indices[i];
+        if (index == lastVertex) {
+            vertices[index] += vertexOffsets[i] * vertexCoefficient;
+            normals[index] += normalOffsets[i] * normalCoefficient;
+            continue;
+        }
+        float* vertex = &vertices[index].x;
+        _mm_storeu_ps(vertex, _mm_add_ps(_mm_loadu_ps(vertex),
+            _mm_mul_ps(_mm_and_ps(_mm_loadu_ps(&vertexOffsets[i].x), mask), vertexScale)));
+        float* normal = &normals[index].x;
+        _mm_storeu_ps(normal, _mm_add_ps(_mm_loadu_ps(normal),
+            _mm_mul_ps(_mm_and_ps(_mm_loadu_ps(&normalOffsets[i].x), mask), normalScale)));
+    }
+#endif
+    for (; i < offsetCount; i++) {
+        int index = indices[i];
+        vertices[index] += vertexOffsets[i] * vertexCoefficient;
+        normals[index] += normalOffsets[i] * normalCoefficient;
+    }
+}
+
+void Model::updateMesh(int meshIndex, glm::mat4* clusterMatrices, glm::vec3* blended) const {
+    const FBXMesh& mesh = _geometry->getFBXGeometry().meshes.at(meshIndex);
+    glm::mat4 modelToWorld = glm::mat4_cast(_rotation);
+    for (int i = 0; i < mesh.clusters.size(); i++) {
+        const FBXCluster& cluster = mesh.clusters.at(i);
+        const JointState& state = _jointStates.at(cluster.jointIndex);
+        clusterMatrices[i] = modelToWorld * (_showTrueJointTransforms ? state.getTransform() : state.getVisibleTransform()) *
+            cluster.inverseBindMatrix;
+    }
+    if (!blended) {
+        return;
+    }
+    // start from the base shape in the blended buffer itself, then add the weighted blendshapes
+    glm::vec3* vertices = blended;
+    glm::vec3* normals = blended + mesh.vertices.size();
+    memcpy(vertices, mesh.vertices.constData(), mesh.vertices.size() * sizeof(glm::vec3));
+    memcpy(normals, mesh.normals.constData(), mesh.normals.size() * sizeof(glm::vec3));
+    const float NORMAL_COEFFICIENT_SCALE = 0.01f;
+    for (int i = 0, n = qMin(_blendedBlendshapeCoefficients.size(), mesh.blendshapes.size()); i < n; i++) {
+        float vertexCoefficient = _blendedBlendshapeCoefficients.at(i);
+        if (vertexCoefficient < EPSILON) {
+            continue;
+        }
+        addBlendshape(mesh.blendshapes.at(i), vertexCoefficient, vertexCoefficient * NORMAL_COEFFICIENT_SCALE,
+            vertices, normals, mesh.vertices.size());
     }
 }
 
@@ -1554,39 +1559,6 @@ void Model::renderJointCollisionShapes(float alpha) {
     // implement this when we have shapes for regular models
 }
 
-bool Model::maybeStartBlender() {
-    const FBXGeometry& fbxGeometry = _geometry->getFBXGeometry();
-    if (fbxGeometry.hasBlendedMeshes()) {
-        QThreadPool::globalInstance()->start(new Blender(this, ++_blendNumber, _geometry,
-            fbxGeometry.meshes, _blendshapeCoefficients));
-        return true;
-    }
-    return false;
-}
-
-void Model::setBlendedVertices(int blendNumber, const QWeakPointer<NetworkGeometry>& geometry,
-        const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& normals) {
-    if (_geometry != geometry || _blendedVertexBuffers.empty() || blendNumber < _appliedBlendNumber) {
-        return;
-    }
-    _appliedBlendNumber = blendNumber;
-    const FBXGeometry& fbxGeometry = _geometry->getFBXGeometry();    
-    int index = 0;
-    for (int i = 0; i < fbxGeometry.meshes.size(); i++) {
-        const FBXMesh& mesh = fbxGeometry.meshes.at(i);
-        if (mesh.blendshapes.isEmpty()) {
-            continue;
-        }
-
-        gpu::BufferPointer& buffer = _blendedVertexBuffers[i];
-        buffer->setSubData(0, mesh.vertices.size() * sizeof(glm::vec3), (gpu::Resource::Byte*) vertices.constData() + index*sizeof(glm::vec3));
-        buffer->setSubData(mesh.vertices.size() * sizeof(glm::vec3),
-            mesh.normals.size() * sizeof(glm::vec3), (gpu::Resource::Byte*) normals.constData() + index*sizeof(glm::vec3));
-
-        index += mesh.vertices.size();
-    }
-}
-
 void Model::applyNextGeometry() {
     // delete our local geometry and custom textures
     deleteGeometry();
@@ -1624,6 +1596,9 @@ void Model::deleteGeometry() {
     if (_geometry) {
         _geometry->clearLoadPriority(this);
     }
+    if (_nextGeometry) {
+        _nextGeometry->clearLoadPriority(this);
+    }
     
     _blendedBlendshapeCoefficients.clear();
 }
@@ -1631,24 +1606,13 @@ void Model::deleteGeometry() {
 // Scene rendering support
 QVector<Model*> Model::_modelsInScene;
 gpu::Batch Model::_sceneRenderBatch;
+gpu::DrawQueue Model::_sceneDrawQueue;
 void Model::startScene(RenderArgs::RenderSide renderSide) {
     if (renderSide != RenderArgs::STEREO_RIGHT) {
         _modelsInScene.clear();
     }
 }
 
-void Model::setupBatchTransform(gpu::Batch& batch) {
-    GLBATCH(glPushMatrix)();
-    
-    // Capture the view matrix once for the rendering of this model
-    if (_transforms.empty()) {
-        _transforms.push_back(Transform());
-    }
-    _transforms[0] = _viewState->getViewTransform();
-    _transforms[0].preTranslate(-_translation);
-    batch.setViewTransform(_transforms[0]);
-}
-
 void Model::endScene(RenderMode mode, RenderArgs* args) {
     PROFILE_RANGE(__FUNCTION__);
 
@@ -1708,20 +1672,8 @@ void Model::endScene(RenderMode mode, RenderArgs* args) {
 
         int opaqueMeshPartsRendered = 0;
 
-        // now, for each model in the scene, render the mesh portions
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, false, false, false, false, args);
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, false, false, false, true, args);
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, false, false, true, false, args);
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, false, false, true, true, args);
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, false, true, false, false, args);
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, false, true, false, true, args);
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, false, true, true, false, args);
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, false, true, true, true, args);
-
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, true, false, false, false, args);
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, true, false, true, false, args);
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, true, true, false, false, args);
-        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, true, true, true, false, args);
+        // now, render the mesh parts of all the models in the scene, sorted by the state they use
+        opaqueMeshPartsRendered += renderMeshesForModelsInScene(batch, mode, false, DEFAULT_ALPHA_THRESHOLD, args);
 
         // render translucent meshes afterwards
         //DependencyManager::get<TextureCache>()->setPrimaryDrawBuffers(false, true, true);
@@ -1735,14 +1687,7 @@ void Model::endScene(RenderMode mode, RenderArgs* args) {
 
         int translucentParts = 0;
         const float MOSTLY_OPAQUE_THRESHOLD = 0.75f;
-        translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_OPAQUE_THRESHOLD, false, false, false, false, args);
-        translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_OPAQUE_THRESHOLD, false, false, false, true, args);
-        translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_OPAQUE_THRESHOLD, false, false, true, false, args);
-        translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_OPAQUE_THRESHOLD, false, false, true, true, args);
-        translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_OPAQUE_THRESHOLD, false, true, false, false, args);
-        translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_OPAQUE_THRESHOLD, false, true, false, true, args);
-        translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_OPAQUE_THRESHOLD, false, true, true, false, args);
-        translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_OPAQUE_THRESHOLD, false, true, true, true, args);
+        translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_OPAQUE_THRESHOLD, args);
 
         GLBATCH(glDisable)(GL_ALPHA_TEST);
         GLBATCH(glEnable)(GL_BLEND);
@@ -1759,14 +1704,7 @@ void Model::endScene(RenderMode mode, RenderArgs* args) {
     
         if (mode == DEFAULT_RENDER_MODE || mode == DIFFUSE_RENDER_MODE) {
             const float MOSTLY_TRANSPARENT_THRESHOLD = 0.0f;
-            translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_TRANSPARENT_THRESHOLD, false, false, false, false, args);
-            translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_TRANSPARENT_THRESHOLD, false, false, false, true, args);
-            translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_TRANSPARENT_THRESHOLD, false, false, true, false, args);
-            translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_TRANSPARENT_THRESHOLD, false, false, true, true, args);
-            translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_TRANSPARENT_THRESHOLD, false, true, false, false, args);
-            translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_TRANSPARENT_THRESHOLD, false, true, false, true, args);
-            translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_TRANSPARENT_THRESHOLD, false, true, true, false, args);
-            translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_TRANSPARENT_THRESHOLD, false, true, true, true, args);
+            translucentParts += renderMeshesForModelsInScene(batch, mode, true, MOSTLY_TRANSPARENT_THRESHOLD, args);
         }
 
         GLBATCH(glDepthMask)(true);
@@ -1820,6 +1758,9 @@ void Model::endScene(RenderMode mode, RenderArgs* args) {
 }
 
 bool Model::renderInScene(float alpha, RenderArgs* args) {
+    // finish the updates of everything simulated since the last render
+    DependencyManager::get<ModelBlender>()->updateModels();
+
     // render the attachments
     foreach (Model* attachment, _attachments) {
         attachment->renderInScene(alpha);
@@ -2250,35 +2191,293 @@ void Model::pickPrograms(gpu::Batch& batch, RenderMode mode, bool translucent, f
     }
 }
 
-int Model::renderMeshesForModelsInScene(gpu::Batch& batch, RenderMode mode, bool translucent, float alphaThreshold,
-                            bool hasLightmap, bool hasTangents, bool hasSpecular, bool isSkinned, RenderArgs* args) {
+// the bits of the program ids used as the most significant part of the scene's draw queue keys
+const int SKINNED_PROGRAM_BIT = 0x01;
+const int SPECULAR_PROGRAM_BIT = 0x02;
+const int TANGENTS_PROGRAM_BIT = 0x04;
+const int LIGHTMAP_PROGRAM_BIT = 0x08;
+const int PROGRAM_COUNT = 0x10;
 
-    PROFILE_RANGE(__FUNCTION__);
-    int meshPartsRendered = 0;
+/// Returns the id assigned to the key, assigning the next one if the key hasn't been seen.
+template<class K> static int getID(QHash<K, int>& ids, const K& key) {
+    typename QHash<K, int>::iterator it = ids.find(key);
+    if (it == ids.end()) {
+        it = ids.insert(key, ids.size());
+    }
+    return it.value();
+}
 
-    bool pickProgramsNeeded = true;
-    Locations* locations;
-    SkinLocations* skinLocations;
+/// Queues the mesh parts of the models in the scene and submits them in sorted order, binding each program, material, and
+/// mesh only when it changes and drawing parts of shared meshes with the same material as instances.
+class Model::SceneSubmitter : public gpu::DrawQueue::Submitter {
+public:
+
+    SceneSubmitter(RenderMode mode, bool translucent, float alphaThreshold, RenderArgs* args);
+
+    /// Adds the parts of the listed meshes of the model to the queue, to be drawn with the identified program.
+    void queueMeshes(Model* model, const QVector<int>& list, int program);
+
+    virtual void setProgram(gpu::Batch& batch, const gpu::DrawQueue::Item& item);
+    virtual void setMaterial(gpu::Batch& batch, const gpu::DrawQueue::Item& item);
+    virtual void setMesh(gpu::Batch& batch, const gpu::DrawQueue::Item& item);
+    virtual void draw(gpu::Batch& batch, const gpu::DrawQueue::Item& item);
+    virtual void drawInstanced(gpu::Batch& batch, const gpu::DrawQueue::Item& item, gpu::uint32 instanceCount,
+        gpu::uint32 firstInstance);
+
+private:
+
+    class Part {
+    public:
+        Model* model;
+        int mesh;
+        int part;
+        int offset; ///< the offset of the part's indices within the mesh's index buffer
+        Texture* diffuseMap;
+    };
+
+    void drawPart(gpu::Batch& batch, const Part& scenePart, int instanceCount, int firstInstance);
+
+    RenderMode _mode;
+    bool _translucent;
+    float _alphaThreshold;
+    RenderArgs* _args;
+    Locations* _locations;
+    SkinLocations* _skinLocations;
+    QSharedPointer<TextureCache> _textureCache;
+    QSharedPointer<GlowEffect> _glowEffect;
+    QVector<Part> _parts;
+    QHash<const void*, int> _meshIDs;
+    QHash<QPair<const void*, const void*>, int> _materialIDs;
+};
+
+Model::SceneSubmitter::SceneSubmitter(RenderMode mode, bool translucent, float alphaThreshold, RenderArgs* args) :
+    _mode(mode),
+    _translucent(translucent),
+    _alphaThreshold(alphaThreshold),
+    _args(args),
+    _locations(NULL),
+    _skinLocations(NULL),
+    _textureCache(DependencyManager::get<TextureCache>()),
+    _glowEffect(DependencyManager::get<GlowEffect>()) {
+}
+
+void Model::SceneSubmitter::queueMeshes(Model* model, const QVector<int>& list, int program) {
+    model->updateVisibleJointStates();
+    const FBXGeometry& geometry = model->_geometry->getFBXGeometry();
+    const QVector<NetworkMesh>& networkMeshes = model->_geometry->getMeshes();
     
-    foreach(Model* model, _modelsInScene) {
-        QVector<int>* whichList = model->pickMeshList(translucent, alphaThreshold, hasLightmap, hasTangents, hasSpecular, isSkinned);
-        if (whichList) {
-            QVector<int>& list = *whichList;
-            if (list.size() > 0) {
-                if (pickProgramsNeeded) {
-                    pickPrograms(batch, mode, translucent, alphaThreshold, hasLightmap, hasTangents, hasSpecular, isSkinned, args, locations, skinLocations);
-                    pickProgramsNeeded = false;
-                }
-                model->setupBatchTransform(batch);
-                meshPartsRendered += model->renderMeshesFromList(list, batch, mode, translucent, alphaThreshold, args, locations, skinLocations);
-                GLBATCH(glPopMatrix)();
+    // the parts are drawn with a shared view transform, so the model's translation goes in their model transforms
+    glm::mat4 translation = glm::translate(model->_translation);
+    foreach (int i, list) {
+        // if our index is ever out of range for either meshes or networkMeshes, then skip it, and set our
+        // _meshGroupsKnown to false to rebuild out mesh groups.
+        if (i < 0 || i >= networkMeshes.size() || i > geometry.meshes.size()) {
+            model->_meshGroupsKnown = false; // regenerate these lists next time around.
+            continue;
+        }
+        const NetworkMesh& networkMesh = networkMeshes.at(i);
+        const FBXMesh& mesh = geometry.meshes.at(i);
+        if (mesh.vertices.isEmpty() || !model->isMeshInView(i, _args)) {
+            continue;
+        }
+        
+        // meshes that are neither skinned nor blended are the same for every model using the geometry, and can be drawn
+        // as instances; the others get ids of their own
+        const MeshState& state = model->_meshStates.at(i);
+        bool skinned = state.clusterMatrices.size() > 1;
+        bool instanceable = !skinned && mesh.blendshapes.isEmpty();
+        int meshID = getID(_meshIDs, instanceable ? (const void*)&networkMesh : (const void*)&state);
+        glm::mat4 transform = skinned ? translation : translation * state.clusterMatrices.at(0);
+        
+        int offset = 0;
+        for (int j = 0; j < networkMesh.parts.size(); j++) {
+            const NetworkMeshPart& networkPart = networkMesh.parts.at(j);
+            const FBXMeshPart& part = mesh.parts.at(j);
+            int indexBytes = (part.quadIndices.size() + part.triangleIndices.size()) * sizeof(int);
+            if ((networkPart.isTranslucent() || part.opacity != 1.0f) != _translucent) {
+                offset += indexBytes;
+                continue;
+            }
+            Texture* diffuseMap = networkPart.diffuseTexture.data();
+            if (mesh.isEye && diffuseMap) {
+                diffuseMap = (model->_dilatedTextures[i][j] =
+                    static_cast<DilatableNetworkTexture*>(diffuseMap)->getDilatedTexture(model->_pupilDilation)).data();
+            }
+            // no material state is bound for shadows
+            int materialID = (_mode == SHADOW_RENDER_MODE) ? 0 :
+                getID(_materialIDs, qMakePair((const void*)part._material.data(), (const void*)diffuseMap));
+            
+            Part scenePart = { model, i, j, offset, diffuseMap };
+            _sceneDrawQueue.add(gpu::DrawQueue::makeKey(program, materialID, meshID, j), _parts.size(),
+                instanceable, transform);
+            _parts.append(scenePart);
+            offset += indexBytes;
+        }
+    }
+}
+
+void Model::SceneSubmitter::setProgram(gpu::Batch& batch, const gpu::DrawQueue::Item& item) {
+    int program = gpu::DrawQueue::getProgram(item.key);
+    pickPrograms(batch, _mode, _translucent, _alphaThreshold, (program & LIGHTMAP_PROGRAM_BIT) != 0,
+        (program & TANGENTS_PROGRAM_BIT) != 0, (program & SPECULAR_PROGRAM_BIT) != 0,
+        (program & SKINNED_PROGRAM_BIT) != 0, _args, _locations, _skinLocations);
+}
+
+void Model::SceneSubmitter::setMaterial(gpu::Batch& batch, const gpu::DrawQueue::Item& item) {
+    if (_mode == SHADOW_RENDER_MODE) {
+        return;
+    }
+    const Part& scenePart = _parts.at(item.data);
+    const FBXMesh& mesh = scenePart.model->_geometry->getFBXGeometry().meshes.at(scenePart.mesh);
+    const FBXMeshPart& part = mesh.parts.at(scenePart.part);
+    const NetworkMeshPart& networkPart = scenePart.model->_geometry->getMeshes().at(scenePart.mesh).parts.at(scenePart.part);
+    
+    if (_locations->glowIntensity >= 0) {
+        GLBATCH(glUniform1f)(_locations->glowIntensity, _glowEffect->getIntensity());
+    }
+    if (!(_translucent && _alphaThreshold == 0.0f)) {
+        GLBATCH(glAlphaFunc)(GL_EQUAL, _glowEffect->getIntensity());
+    }
+    if (_locations->materialBufferUnit >= 0) {
+        batch.setUniformBuffer(_locations->materialBufferUnit, part._material->getSchemaBuffer());
+    }
+    batch.setUniformTexture(0, scenePart.diffuseMap ? scenePart.diffuseMap->getGPUTexture() :
+        _textureCache->getWhiteTexture());
+
+    if (_locations->texcoordMatrices >= 0) {
+        glm::mat4 texcoordTransform[2];
+        if (!part.diffuseTexture.transform.isIdentity()) {
+            part.diffuseTexture.transform.getMatrix(texcoordTransform[0]);
+        }
+        if (!part.emissiveTexture.transform.isIdentity()) {
+            part.emissiveTexture.transform.getMatrix(texcoordTransform[1]);
+        }
+        GLBATCH(glUniformMatrix4fv)(_locations->texcoordMatrices, 2, false, (const float*) &texcoordTransform);
+    }
+    if (!mesh.tangents.isEmpty()) {
+        Texture* normalMap = networkPart.normalTexture.data();
+        batch.setUniformTexture(1, !normalMap ? _textureCache->getBlueTexture() : normalMap->getGPUTexture());
+    }
+    if (_locations->specularTextureUnit >= 0) {
+        Texture* specularMap = networkPart.specularTexture.data();
+        batch.setUniformTexture(_locations->specularTextureUnit, !specularMap ?
+            _textureCache->getWhiteTexture() : specularMap->getGPUTexture());
+    }
+    if (_args) {
+        _args->_materialSwitches++;
+    }
+}
+
+void Model::SceneSubmitter::setMesh(gpu::Batch& batch, const gpu::DrawQueue::Item& item) {
+    const Part& scenePart = _parts.at(item.data);
+    Model* model = scenePart.model;
+    const NetworkMesh& networkMesh = model->_geometry->getMeshes().at(scenePart.mesh);
+    const FBXMesh& mesh = model->_geometry->getFBXGeometry().meshes.at(scenePart.mesh);
+    const MeshState& state = model->_meshStates.at(scenePart.mesh);
+    
+    batch.setIndexBuffer(gpu::UINT32, (networkMesh._indexBuffer), 0);
+    if (state.clusterMatrices.size() > 1) {
+        GLBATCH(glUniformMatrix4fv)(_skinLocations->clusterMatrices, state.clusterMatrices.size(), false,
+            (const float*)state.clusterMatrices.constData());
+    }
+    batch.setInputFormat(networkMesh._vertexFormat);
+    if (mesh.blendshapes.isEmpty()) {
+        batch.setInputStream(0, *networkMesh._vertexStream);
+    } else {
+        int vertexCount = mesh.vertices.size();
+        batch.setInputBuffer(0, model->_blendedVertexBuffers[scenePart.mesh], 0, sizeof(glm::vec3));
+        batch.setInputBuffer(1, model->_blendedVertexBuffers[scenePart.mesh], vertexCount * sizeof(glm::vec3),
+            sizeof(glm::vec3));
+        batch.setInputStream(2, *networkMesh._vertexStream);
+    }
+    if (mesh.colors.isEmpty()) {
+        GLBATCH(glColor4f)(1.0f, 1.0f, 1.0f, 1.0f);
+    }
+}
+
+void Model::SceneSubmitter::draw(gpu::Batch& batch, const gpu::DrawQueue::Item& item) {
+    drawPart(batch, _parts.at(item.data), 1, -1);
+}
+
+void Model::SceneSubmitter::drawInstanced(gpu::Batch& batch, const gpu::DrawQueue::Item& item, gpu::uint32 instanceCount,
+        gpu::uint32 firstInstance) {
+    drawPart(batch, _parts.at(item.data), instanceCount, firstInstance);
+}
+
+void Model::SceneSubmitter::drawPart(gpu::Batch& batch, const Part& scenePart, int instanceCount, int firstInstance) {
+    const FBXMeshPart& part = scenePart.model->_geometry->getFBXGeometry().meshes.at(scenePart.mesh).parts.at(
+        scenePart.part);
+    
+    // HACK: For unkwon reason (yet!) this code that should be assigned only if the material changes need to be called
+    // for every drawcall with an emissive, so let's do it for now.
+    if (_mode != SHADOW_RENDER_MODE && _locations->emissiveTextureUnit >= 0) {
+        GLBATCH(glUniform2f)(_locations->emissiveParams, part.emissiveParams.x, part.emissiveParams.y);
+        
+        Texture* emissiveMap = scenePart.model->_geometry->getMeshes().at(scenePart.mesh).parts.at(
+            scenePart.part).emissiveTexture.data();
+        batch.setUniformTexture(_locations->emissiveTextureUnit, !emissiveMap ?
+            _textureCache->getWhiteTexture() : emissiveMap->getGPUTexture());
+    }
+    
+    // a negative first instance means that the part is drawn on its own
+    int offset = scenePart.offset;
+    if (part.quadIndices.size() > 0) {
+        if (firstInstance < 0) {
+            batch.drawIndexed(gpu::QUADS, part.quadIndices.size(), offset);
+        } else {
+            batch.drawIndexedInstanced(instanceCount, gpu::QUADS, part.quadIndices.size(), offset, firstInstance);
+        }
+        offset += part.quadIndices.size() * sizeof(int);
+    }
+    if (part.triangleIndices.size() > 0) {
+        if (firstInstance < 0) {
+            batch.drawIndexed(gpu::TRIANGLES, part.triangleIndices.size(), offset);
+        } else {
+            batch.drawIndexedInstanced(instanceCount, gpu::TRIANGLES, part.triangleIndices.size(), offset, firstInstance);
+        }
+    }
+    if (_args) {
+        const int INDICES_PER_TRIANGLE = 3;
+        const int INDICES_PER_QUAD = 4;
+        _args->_trianglesRendered += instanceCount * part.triangleIndices.size() / INDICES_PER_TRIANGLE;
+        _args->_quadsRendered += instanceCount * part.quadIndices.size() / INDICES_PER_QUAD;
+    }
+}
+
+int Model::renderMeshesForModelsInScene(gpu::Batch& batch, RenderMode mode, bool translucent, float alphaThreshold,
+                                        RenderArgs* args) {
+    PROFILE_RANGE(__FUNCTION__);
+    
+    // queue the parts of all models for all programs, so that they can be sorted by the state they use
+    SceneSubmitter submitter(mode, translucent, alphaThreshold, args);
+    for (int program = 0; program < PROGRAM_COUNT; program++) {
+        bool hasLightmap = (program & LIGHTMAP_PROGRAM_BIT) != 0;
+        bool hasTangents = (program & TANGENTS_PROGRAM_BIT) != 0;
+        bool hasSpecular = (program & SPECULAR_PROGRAM_BIT) != 0;
+        bool isSkinned = (program & SKINNED_PROGRAM_BIT) != 0;
+        
+        // there are no skinned lightmap programs, and lightmapped meshes are only rendered as opaque
+        if (hasLightmap && (isSkinned || translucent)) {
+            continue;
+        }
+        foreach (Model* model, _modelsInScene) {
+            QVector<int>* whichList = model->pickMeshList(translucent, alphaThreshold, hasLightmap,
+                hasTangents, hasSpecular, isSkinned);
+            if (whichList && !whichList->isEmpty()) {
+                submitter.queueMeshes(model, *whichList, program);
             }
         }
     }
-    // if we selected a program, then unselect it
-    if (!pickProgramsNeeded) {
-        GLBATCH(glUseProgram)(0);
+    int meshPartsRendered = _sceneDrawQueue.getItemCount();
+    if (meshPartsRendered == 0) {
+        return 0;
     }
+    GLBATCH(glPushMatrix)();
+    batch.setViewTransform(_viewState->getViewTransform());
+    _sceneDrawQueue.submit(batch, submitter);
+    GLBATCH(glPopMatrix)();
+    GLBATCH(glUseProgram)(0);
+    
     return meshPartsRendered;
 }
 
@@ -2311,6 +2510,37 @@ int Model::renderMeshes(gpu::Batch& batch, RenderMode mode, bool translucent, fl
 }
 
 
+bool Model::isMeshInView(int meshIndex, RenderArgs* args) {
+    if (!args) {
+        return true;
+    }
+    bool shouldRender = true;
+    args->_meshesConsidered++;
+
+    if (args->_viewFrustum) {
+        const AABox& box = _calculatedMeshBoxes.at(meshIndex);
+        shouldRender = args->_viewFrustum->boxInFrustum(box) != ViewFrustum::OUTSIDE;
+        if (shouldRender) {
+            float distance = args->_viewFrustum->distanceToCamera(box.calcCenter());
+            shouldRender = !_viewState ? false : _viewState->shouldRenderMesh(box.getLargestDimension(), distance);
+            if (!shouldRender) {
+                args->_meshesTooSmall++;
+
+            } else if (args->_occlusionBuffer && args->_occlusionBuffer->isOccluded(box)) {
+                shouldRender = false;
+                args->_meshesOccluded++;
+            }
+        } else {
+            args->_meshesOutOfView++;
+        }
+    }
+
+    if (shouldRender) {
+        args->_meshesRendered++;
+    }
+    return shouldRender;
+}
+
 int Model::renderMeshesFromList(QVector<int>& list, gpu::Batch& batch, RenderMode mode, bool translucent, float alphaThreshold, RenderArgs* args,
                                         Locations* locations, SkinLocations* skinLocations) {
     PROFILE_RANGE(__FUNCTION__);
@@ -2346,29 +2576,8 @@ int Model::renderMeshesFromList(QVector<int>& list, gpu::Batch& batch, RenderMod
         }
         
         // if we got here, then check to see if this mesh is in view
-        if (args) {
-            bool shouldRender = true;
-            args->_meshesConsidered++;
-
-            if (args->_viewFrustum) {
-                shouldRender = args->_viewFrustum->boxInFrustum(_calculatedMeshBoxes.at(i)) != ViewFrustum::OUTSIDE;
-                if (shouldRender) {
-                    float distance = args->_viewFrustum->distanceToCamera(_calculatedMeshBoxes.at(i).calcCenter());
-                    shouldRender = !_viewState ? false : _viewState->shouldRenderMesh(_calculatedMeshBoxes.at(i).getLargestDimension(),
-                                                                            distance);
-                    if (!shouldRender) {
-                        args->_meshesTooSmall++;
-                    }
-                } else {
-                    args->_meshesOutOfView++;
-                }
-            }
-
-            if (shouldRender) {
-                args->_meshesRendered++;
-            } else {
-                continue; // skip this mesh
-            }
+        if (!isMeshInView(i, args)) {
+            continue; // skip this mesh
         }
 
     //    GLBATCH(glPushMatrix)();
@@ -2515,37 +2724,77 @@ int Model::renderMeshesFromList(QVector<int>& list, gpu::Batch& batch, RenderMod
     return meshPartsRendered;
 }
 
-ModelBlender::ModelBlender() :
-    _pendingBlenders(0) {
+ModelBlender::ModelBlender() {
 }
 
 ModelBlender::~ModelBlender() {
 }
 
-void ModelBlender::noteRequiresBlend(Model* model) {
-    if (_pendingBlenders < QThread::idealThreadCount()) {
-        if (model->maybeStartBlender()) {
-            _pendingBlenders++;
-        }
-        return;
-    }
-    if (!_modelsRequiringBlends.contains(model)) {
-        _modelsRequiringBlends.append(model);
-    }
+void ModelBlender::noteRequiresUpdate(Model* model) {
+    _modelsRequiringUpdates.append(model);
 }
 
-void ModelBlender::setBlendedVertices(const QPointer<Model>& model, int blendNumber,
-        const QWeakPointer<NetworkGeometry>& geometry, const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& normals) {
-    if (!model.isNull()) {
-        model->setBlendedVertices(blendNumber, geometry, vertices, normals);
+class ModelUpdater : public QRunnable {
+public:
+
+    ModelUpdater(ModelBlender* blender, QSemaphore* finished) : _blender(blender), _finished(finished) { }
+    
+    virtual void run() {
+        _blender->updateNextMeshes();
+        _finished->release();
+    }
+
+private:
+    
+    ModelBlender* _blender;
+    QSemaphore* _finished;
+};
+
+void ModelBlender::updateModels() {
+    if (_modelsRequiringUpdates.isEmpty()) {
+        return;
     }
-    _pendingBlenders--;
-    while (!_modelsRequiringBlends.isEmpty()) {
-        Model* nextModel = _modelsRequiringBlends.takeFirst();
-        if (nextModel && nextModel->maybeStartBlender()) {
-            _pendingBlenders++;
-            return;
+    PROFILE_RANGE(__FUNCTION__);
+    
+    // gather the work here, so that the workers write to nothing but the meshes' own matrices and buffers
+    _meshUpdates.clear();
+    foreach (const QPointer<Model>& model, _modelsRequiringUpdates) {
+        if (!model) {
+            continue;
+        }
+        bool blend = model->_blendRequired;
+        model->_updateRequired = model->_blendRequired = false;
+        if (!model->isActive()) {
+            continue;
+        }
+        const FBXGeometry& geometry = model->_geometry->getFBXGeometry();
+        if (model->_meshStates.size() != geometry.meshes.size()) {
+            continue;
+        }
+        for (int i = 0; i < geometry.meshes.size(); i++) {
+            MeshUpdate update = { model.data(), i, model->_meshStates[i].clusterMatrices.data(), nullptr };
+            if (blend && !geometry.meshes.at(i).blendshapes.isEmpty()) {
+                update.blended = reinterpret_cast<glm::vec3*>(model->_blendedVertexBuffers[i]->editData());
+            }
+            _meshUpdates.append(update);
         }
     }
+    _modelsRequiringUpdates.clear();
+    
+    // this thread takes part, so there's no need to wait for workers that can't start immediately
+    _nextMeshUpdate.store(0);
+    QThreadPool* pool = QThreadPool::globalInstance();
+    QSemaphore finished;
+    int workers = 0;
+    for (int maxWorkers = qMin(_meshUpdates.size() - 1, pool->maxThreadCount()); workers < maxWorkers &&
+            pool->tryStart(new ModelUpdater(this, &finished)); workers++);
+    updateNextMeshes();
+    finished.acquire(workers);
 }
 
+void ModelBlender::updateNextMeshes() {
+    for (int index; (index = _nextMeshUpdate.fetchAndAddOrdered(1)) < _meshUpdates.size(); ) {
+        const MeshUpdate& update = _meshUpdates.at(index);
+        update.model->updateMesh(update.meshIndex, update.clusterMatrices, update.blended);
+    }
+}
@@ -14,8 +14,10 @@
 
 #include <gpu/GPUConfig.h>
 
+#include <QAtomicInt>
 #include <QBitArray>
 #include <QObject>
+#include <QPointer>
 #include <QUrl>
 
 #include <AABox.h>
@@ -24,6 +26,7 @@
 #include <GeometryUtil.h>
 #include <gpu/Stream.h>
 #include <gpu/Batch.h>
+#include <gpu/DrawQueue.h>
 #include <PhysicsEntity.h>
 #include <Transform.h>
 
@@ -185,12 +188,6 @@ public:
 
     virtual void renderJointCollisionShapes(float alpha);
     
-    bool maybeStartBlender();
-    
-    /// Sets blended vertices computed in a separate thread.
-    void setBlendedVertices(int blendNumber, const QWeakPointer<NetworkGeometry>& geometry,
-        const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& normals);
-
     void setShowTrueJointTransforms(bool show) { _showTrueJointTransforms = show; }
 
     QVector<JointState>& getJointStates() { return _jointStates; }
@@ -272,6 +269,11 @@ protected:
 private:
     
     friend class AnimationHandle;
+    friend class ModelBlender;
+    
+    /// Computes the cluster matrices of one mesh and, if given somewhere to put them, its blended vertices and normals.
+    /// Called from worker threads, for all meshes of the models simulated since the last render.
+    void updateMesh(int meshIndex, glm::mat4* clusterMatrices, glm::vec3* blended) const;
     
     void applyNextGeometry();
     void deleteGeometry();
@@ -303,8 +305,8 @@ private:
     QList<AnimationHandlePointer> _runningAnimations;
 
     QVector<float> _blendedBlendshapeCoefficients;
-    int _blendNumber;
-    int _appliedBlendNumber;
+    bool _updateRequired;
+    bool _blendRequired;
 
     static ProgramObject _program;
     static ProgramObject _normalMapProgram;
@@ -437,6 +439,9 @@ private:
     // Scene rendering support
     static QVector<Model*> _modelsInScene;
     static gpu::Batch _sceneRenderBatch;
+    static gpu::DrawQueue _sceneDrawQueue;
+
+    class SceneSubmitter;
 
     static void endSceneSimple(RenderMode mode = DEFAULT_RENDER_MODE, RenderArgs* args = NULL);
     static void endSceneSplitPass(RenderMode mode = DEFAULT_RENDER_MODE, RenderArgs* args = NULL);
@@ -446,9 +451,9 @@ private:
     bool renderCore(float alpha, RenderMode mode, RenderArgs* args);
     int renderMeshes(gpu::Batch& batch, RenderMode mode, bool translucent, float alphaThreshold, 
                         bool hasLightmap, bool hasTangents, bool hasSpecular, bool isSkinned, RenderArgs* args = NULL);
-    void setupBatchTransform(gpu::Batch& batch);
     QVector<int>* pickMeshList(bool translucent, float alphaThreshold, bool hasLightmap, bool hasTangents, bool hasSpecular, bool isSkinned);
 
+    bool isMeshInView(int meshIndex, RenderArgs* args);
     int renderMeshesFromList(QVector<int>& list, gpu::Batch& batch, RenderMode mode, bool translucent, float alphaThreshold,
                                         RenderArgs* args, Locations* locations, SkinLocations* skinLocations);
 
@@ -456,38 +461,47 @@ private:
                             bool hasLightmap, bool hasTangents, bool hasSpecular, bool isSkinned, RenderArgs* args,
                             Locations*& locations, SkinLocations*& skinLocations);
 
+    /// Renders the parts of all models in the scene that match the translucency, sorted by the state that they use.
     static int renderMeshesForModelsInScene(gpu::Batch& batch, RenderMode mode, bool translucent, float alphaThreshold,
-                            bool hasLightmap, bool hasTangents, bool hasSpecular, bool isSkinned, RenderArgs* args);
+                            RenderArgs* args);
 
 
     static AbstractViewStateInterface* _viewState;
 
 };
 
-Q_DECLARE_METATYPE(QPointer<Model>)
-Q_DECLARE_METATYPE(QWeakPointer<NetworkGeometry>)
-Q_DECLARE_METATYPE(QVector<glm::vec3>)
-
-/// Handle management of pending models that need blending
+/// Handles the updates of simulated models that aren't needed until they render:  the cluster matrices and blended
+/// vertices of all the models simulated since the last render are computed in parallel, just before the first renders.
 class ModelBlender : public QObject, public Dependency {
     Q_OBJECT
     SINGLETON_DEPENDENCY
 
 public:
 
-    /// Adds the specified model to the list requiring vertex blends.
-    void noteRequiresBlend(Model* model);
+    /// Adds the specified model to the list requiring updates before rendering.
+    void noteRequiresUpdate(Model* model);
 
-public slots:
-    void setBlendedVertices(const QPointer<Model>& model, int blendNumber, const QWeakPointer<NetworkGeometry>& geometry,
-        const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& normals);
+    /// Performs the pending updates, returning when they're all complete.
+    void updateModels();
+    
+    /// Performs pending mesh updates until none remain.  Called from the worker threads as well as the main one.
+    void updateNextMeshes();
 
 private:
     ModelBlender();
     virtual ~ModelBlender();
 
-    QList<QPointer<Model> > _modelsRequiringBlends;
-    int _pendingBlenders;
+    class MeshUpdate {
+    public:
+        const Model* model;
+        int meshIndex;
+        glm::mat4* clusterMatrices;
+        glm::vec3* blended;
+    };
+
+    QList<QPointer<Model> > _modelsRequiringUpdates;
+    QVector<MeshUpdate> _meshUpdates;
+    QAtomicInt _nextMeshUpdate;
 };
 
 
@@ -12,12 +12,17 @@
 // include this before QGLWidget, which includes an earlier version of OpenGL
 #include <gpu/GPUConfig.h>
 
+#include <QAtomicInt>
+#include <QDataStream>
+#include <QElapsedTimer>
 #include <QEvent>
+#include <QFile>
 #include <QGLWidget>
 #include <QNetworkReply>
 #include <QOpenGLFramebufferObject>
 #include <QResizeEvent>
 #include <QRunnable>
+#include <QSemaphore>
 #include <QThreadPool>
 
 #include <glm/glm.hpp>
@@ -27,6 +32,8 @@
 
 #include "gpu/GLBackend.h"
 
+static int imageVectorMetaTypeId = qRegisterMetaType<QVector<QImage> >();
+
 TextureCache::TextureCache() :
     _permutationNormalTexture(0),
     _whiteTexture(0),
@@ -428,6 +435,11 @@ public:
 
 private:
     
+    bool readPrepared(const QString& key, QImage& image, QVector<QImage>& mipmaps, bool& translucent,
+        QColor& averageColor, int& originalWidth, int& originalHeight);
+    void writePrepared(const QString& key, const QImage& image, const QVector<QImage>& mipmaps, bool translucent,
+        const QColor& averageColor, int originalWidth, int originalHeight);
+    
     QWeakPointer<Resource> _texture;
     QNetworkReply* _reply;
     QUrl _url;
@@ -442,6 +454,172 @@ ImageReader::ImageReader(const QWeakPointer<Resource>& texture, QNetworkReply* r
     _content(content) {
 }
 
+/// The number of rows handed to a thread at a time when processing images.
+const int ROWS_PER_BAND = 32;
+
+/// Hands out bands of rows to a function until they run out.
+template<class F> class RowBands {
+public:
+    
+    RowBands(int rows, const F& function) : _rows(rows), _function(function), _nextBand(0) { }
+    
+    int getBandCount() const { return (_rows + ROWS_PER_BAND - 1) / ROWS_PER_BAND; }
+    
+    void run() {
+        for (int start; (start = _nextBand.fetchAndAddOrdered(1) * ROWS_PER_BAND) < _rows; ) {
+            _function(start, qMin(start + ROWS_PER_BAND, _rows));
+        }
+    }
+    
+private:
+    
+    int _rows;
+    const F& _function;
+    QAtomicInt _nextBand;
+};
+
+/// Helps process a set of row bands on the thread pool.
+template<class F> class RowBandWorker : public QRunnable {
+public:
+    
+    RowBandWorker(RowBands<F>* bands, QSemaphore* finished) : _bands(bands), _finished(finished) { }
+    
+    virtual void run() {
+        _bands->run();
+        _finished->release();
+    }
+
+private:
+    
+    RowBands<F>* _bands;
+    QSemaphore* _finished;
+};
+
+/// Calls function(startRow, endRow) over all the rows of an image, spreading the bands of large images across the thread
+/// pool.  The calling thread takes part, so this never waits on workers that couldn't start immediately.
+template<class F> void forEachRowBand(int rows, int columns, const F& function) {
+    RowBands<F> bands(rows, function);
+    QSemaphore finished;
+    int workers = 0;
+    const int MIN_THREADED_PIXELS = 256 * 1024;
+    if (rows * columns >= MIN_THREADED_PIXELS) {
+        QThreadPool* pool = QThreadPool::globalInstance();
+        for (int maxWorkers = qMin(bands.getBandCount() - 1, pool->maxThreadCount()); workers < maxWorkers &&
+                pool->tryStart(new RowBandWorker<F>(&bands, &finished)); workers++);
+    }
+    bands.run();
+    finished.acquire(workers);
+}
+
+/// Color totals and alpha counts for a set of rows.
+class ImageStatistics {
+public:
+    qint64 redTotal;
+    qint64 greenTotal;
+    qint64 blueTotal;
+    qint64 alphaTotal;
+    int opaquePixels;
+    int translucentPixels;
+};
+
+const int EIGHT_BIT_MAXIMUM = 255;
+
+const double NSECS_PER_MSEC = 1000000.0;
+
+/// Scans an RGB888 or ARGB32 image for its color totals and alpha counts.  The inner loops run over raw scanlines with
+/// per-row accumulators and no branches, so that the compiler can vectorize them.
+static ImageStatistics scanImage(const QImage& image) {
+    int width = image.width();
+    QVector<ImageStatistics> bandStatistics(qMax((image.height() + ROWS_PER_BAND - 1) / ROWS_PER_BAND, 1));
+    bool hasAlpha = (image.format() == QImage::Format_ARGB32);
+    ImageStatistics* results = bandStatistics.data();
+    auto scanRows = [&](int start, int end) {
+        ImageStatistics statistics = { 0, 0, 0, 0, 0, 0 };
+        for (int y = start; y < end; y++) {
+            quint32 red = 0, green = 0, blue = 0, alpha = 0;
+            int opaque = 0, translucent = 0;
+            if (hasAlpha) {
+                const QRgb* pixels = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+                for (int x = 0; x < width; x++) {
+                    QRgb rgb = pixels[x];
+                    red += qRed(rgb);
+                    green += qGreen(rgb);
+                    blue += qBlue(rgb);
+                    int pixelAlpha = qAlpha(rgb);
+                    alpha += pixelAlpha;
+                    opaque += (pixelAlpha == EIGHT_BIT_MAXIMUM);
+                    translucent += (pixelAlpha != EIGHT_BIT_MAXIMUM && pixelAlpha != 0);
+                }
+            } else {
+                const uchar* pixels = image.constScanLine(y);
+                for (int x = 0; x < width; x++, pixels += 3) {
+                    red += pixels[0];
+                    green += pixels[1];
+                    blue += pixels[2];
+                }
+            }
+            statistics.redTotal += red;
+            statistics.greenTotal += green;
+            statistics.blueTotal += blue;
+            statistics.alphaTotal += alpha;
+            statistics.opaquePixels += opaque;
+            statistics.translucentPixels += translucent;
+        }
+        results[start / ROWS_PER_BAND] = statistics;
+    };
+    forEachRowBand(image.height(), width, scanRows);
+    
+    ImageStatistics totals = { 0, 0, 0, 0, 0, 0 };
+    foreach (const ImageStatistics& statistics, bandStatistics) {
+        totals.redTotal += statistics.redTotal;
+        totals.greenTotal += statistics.greenTotal;
+        totals.blueTotal += statistics.blueTotal;
+        totals.alphaTotal += statistics.alphaTotal;
+        totals.opaquePixels += statistics.opaquePixels;
+        totals.translucentPixels += statistics.translucentPixels;
+    }
+    return totals;
+}
+
+/// Generates the mipmap chain (down to 1x1) for an RGB888 or ARGB32 image with a 2x2 box filter.
+static QVector<QImage> generateMipmaps(const QImage& image) {
+    QVector<QImage> mipmaps;
+    int bytesPerPixel = (image.format() == QImage::Format_ARGB32) ? 4 : 3;
+    for (QImage source = image; source.width() > 1 || source.height() > 1; source = mipmaps.last()) {
+        QImage mipmap(qMax(source.width() / 2, 1), qMax(source.height() / 2, 1), image.format());
+        int width = mipmap.width();
+        int sourceWidth = source.width();
+        int sourceHeight = source.height();
+        
+        // scanLine detaches, so get the bits up front rather than calling it from the workers
+        uchar* bits = mipmap.bits();
+        int bytesPerLine = mipmap.bytesPerLine();
+        auto filterRows = [&](int start, int end) {
+            for (int y = start; y < end; y++) {
+                const uchar* top = source.constScanLine(qMin(y * 2, sourceHeight - 1));
+                const uchar* bottom = source.constScanLine(qMin(y * 2 + 1, sourceHeight - 1));
+                uchar* destination = bits + y * bytesPerLine;
+                for (int x = 0; x < width; x++) {
+                    int left = qMin(x * 2, sourceWidth - 1) * bytesPerPixel;
+                    int right = qMin(x * 2 + 1, sourceWidth - 1) * bytesPerPixel;
+                    for (int i = 0; i < bytesPerPixel; i++) {
+                        *destination++ = (top[left + i] + top[right + i] + bottom[left + i] + bottom[right + i] + 2) >> 2;
+                    }
+                }
+            }
+        };
+        forEachRowBand(mipmap.height(), width, filterRows);
+        mipmaps.append(mipmap);
+    }
+    return mipmaps;
+}
+
+/// Identifies prepared textures ("HFTX" when read as little-endian bytes).
+const quint32 PREPARED_TEXTURE_MAGIC = 0x58544648;
+
+/// Must be incremented whenever the preparation or the layout changes.
+const quint32 PREPARED_TEXTURE_VERSION = 1;
+
 void ImageReader::run() {
     QSharedPointer<Resource> texture = _texture.toStrongRef();
     if (texture.isNull()) {
@@ -455,10 +633,31 @@ void ImageReader::run() {
         _content = _reply->readAll();
         _reply->deleteLater();
     }
-    QImage image = QImage::fromData(_content);
-
-    int originalWidth = image.width();
-    int originalHeight = image.height();
+    QImage image;
+    QVector<QImage> mipmaps;
+    bool translucent = false;
+    QColor averageColor(EIGHT_BIT_MAXIMUM, EIGHT_BIT_MAXIMUM, EIGHT_BIT_MAXIMUM);
+    int originalWidth = 0;
+    int originalHeight = 0;
+    
+    // prepared images are cached by content, so warm loads skip decoding entirely
+    QElapsedTimer timer;
+    timer.start();
+    QString key = ProcessedResourceCache::getKey("texture", _content, QByteArray::number(PREPARED_TEXTURE_VERSION));
+    if (readPrepared(key, image, mipmaps, translucent, averageColor, originalWidth, originalHeight)) {
+        qDebug() << "Loaded prepared texture:" << _url << image.width() << image.height() << "in" <<
+            timer.nsecsElapsed() / NSECS_PER_MSEC << "ms";
+        QMetaObject::invokeMethod(texture.data(), "setImage", Q_ARG(const QImage&, image),
+            Q_ARG(const QVector<QImage>&, mipmaps), Q_ARG(bool, translucent), Q_ARG(const QColor&, averageColor),
+            Q_ARG(int, originalWidth), Q_ARG(int, originalHeight));
+        return;
+    }
+    image = QImage::fromData(_content);
+    qint64 decodeTime = timer.nsecsElapsed();
+    timer.restart();
+    
+    originalWidth = image.width();
+    originalHeight = image.height();
     
     // enforce a fixed maximum area (1024 * 2048)
     const int MAXIMUM_AREA_SIZE = 2097152;
@@ -473,59 +672,99 @@ void ImageReader::run() {
         imageArea = image.width() * image.height();
     }
     
-    const int EIGHT_BIT_MAXIMUM = 255;
     if (!image.hasAlphaChannel()) {
         if (image.format() != QImage::Format_RGB888) {
             image = image.convertToFormat(QImage::Format_RGB888);
         }
-        int redTotal = 0, greenTotal = 0, blueTotal = 0;
-        for (int y = 0; y < image.height(); y++) {
-            for (int x = 0; x < image.width(); x++) {
-                QRgb rgb = image.pixel(x, y);
-                redTotal += qRed(rgb);
-                greenTotal += qGreen(rgb);
-                blueTotal += qBlue(rgb);
-            }
-        }
-        QColor averageColor(EIGHT_BIT_MAXIMUM, EIGHT_BIT_MAXIMUM, EIGHT_BIT_MAXIMUM);
         if (imageArea > 0) {
-            averageColor.setRgb(redTotal / imageArea, greenTotal / imageArea, blueTotal / imageArea);
+            ImageStatistics statistics = scanImage(image);
+            averageColor.setRgb(statistics.redTotal / imageArea, statistics.greenTotal / imageArea,
+                statistics.blueTotal / imageArea);
         }
-        QMetaObject::invokeMethod(texture.data(), "setImage", Q_ARG(const QImage&, image), Q_ARG(bool, false),
-            Q_ARG(const QColor&, averageColor), Q_ARG(int, originalWidth), Q_ARG(int, originalHeight));
-        return;
+    } else {
+        if (image.format() != QImage::Format_ARGB32) {
+            image = image.convertToFormat(QImage::Format_ARGB32);
+        }
+        
+        // check for translucency/false transparency
+        ImageStatistics statistics = scanImage(image);
+        if (statistics.opaquePixels == imageArea) {
+            qDebug() << "Image with alpha channel is completely opaque:" << _url;
+            image = image.convertToFormat(QImage::Format_RGB888);
+        }
+        translucent = (statistics.translucentPixels >= imageArea / 2);
+        averageColor = QColor(statistics.redTotal / imageArea, statistics.greenTotal / imageArea,
+            statistics.blueTotal / imageArea, statistics.alphaTotal / imageArea);
     }
-    if (image.format() != QImage::Format_ARGB32) {
-        image = image.convertToFormat(QImage::Format_ARGB32);
+    if (imageArea > 0) {
+        mipmaps = generateMipmaps(image);
     }
+    qint64 prepareTime = timer.nsecsElapsed();
+    qDebug() << "Prepared texture:" << _url << image.width() << image.height() << "decode" <<
+        decodeTime / NSECS_PER_MSEC << "ms, prepare" << prepareTime / NSECS_PER_MSEC << "ms";
     
-    // check for translucency/false transparency
-    int opaquePixels = 0;
-    int translucentPixels = 0;
-    int redTotal = 0, greenTotal = 0, blueTotal = 0, alphaTotal = 0;
-    for (int y = 0; y < image.height(); y++) {
-        for (int x = 0; x < image.width(); x++) {
-            QRgb rgb = image.pixel(x, y);
-            redTotal += qRed(rgb);
-            greenTotal += qGreen(rgb);
-            blueTotal += qBlue(rgb);
-            int alpha = qAlpha(rgb);
-            alphaTotal += alpha;
-            if (alpha == EIGHT_BIT_MAXIMUM) {
-                opaquePixels++;
-            } else if (alpha != 0) {
-                translucentPixels++;
-            }
+    QMetaObject::invokeMethod(texture.data(), "setImage", Q_ARG(const QImage&, image),
+        Q_ARG(const QVector<QImage>&, mipmaps), Q_ARG(bool, translucent), Q_ARG(const QColor&, averageColor),
+        Q_ARG(int, originalWidth), Q_ARG(int, originalHeight));
+    
+    if (imageArea > 0) {
+        writePrepared(key, image, mipmaps, translucent, averageColor, originalWidth, originalHeight);
+    }
+}
+
+bool ImageReader::readPrepared(const QString& key, QImage& image, QVector<QImage>& mipmaps, bool& translucent,
+        QColor& averageColor, int& originalWidth, int& originalHeight) {
+    QString path = ProcessedResourceCache::getInstance().find(key);
+    if (path.isEmpty()) {
+        return false;
+    }
+    QFile file(path);
+    uchar* mapped = NULL;
+    if (!(file.open(QIODevice::ReadOnly) && (mapped = file.map(0, file.size())))) {
+        file.close();
+        ProcessedResourceCache::getInstance().remove(key);
+        return false;
+    }
+    QByteArray data = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), file.size());
+    QDataStream in(data);
+    quint32 magic, version;
+    qint32 format, levels;
+    in >> magic >> version >> format >> translucent >> averageColor >> originalWidth >> originalHeight >> levels;
+    bool valid = (in.status() == QDataStream::Ok && magic == PREPARED_TEXTURE_MAGIC &&
+        version == PREPARED_TEXTURE_VERSION && (format == QImage::Format_RGB888 || format == QImage::Format_ARGB32));
+    for (int i = 0; valid && i < levels; i++) {
+        qint32 width, height;
+        in >> width >> height;
+        QImage level(width, height, (QImage::Format)format);
+        valid = (in.status() == QDataStream::Ok && !level.isNull() &&
+            in.readRawData(reinterpret_cast<char*>(level.bits()), level.byteCount()) == level.byteCount());
+        if (i == 0) {
+            image = level;
+        } else {
+            mipmaps.append(level);
         }
     }
-    if (opaquePixels == imageArea) {
-        qDebug() << "Image with alpha channel is completely opaque:" << _url;
-        image = image.convertToFormat(QImage::Format_RGB888);
+    file.unmap(mapped);
+    file.close();
+    if (!valid) {
+        mipmaps.clear();
+        ProcessedResourceCache::getInstance().remove(key);
     }
-    QMetaObject::invokeMethod(texture.data(), "setImage", Q_ARG(const QImage&, image),
-        Q_ARG(bool, translucentPixels >= imageArea / 2), Q_ARG(const QColor&, QColor(redTotal / imageArea,
-            greenTotal / imageArea, blueTotal / imageArea, alphaTotal / imageArea)),
-        Q_ARG(int, originalWidth), Q_ARG(int, originalHeight));
+    return valid;
+}
+
+void ImageReader::writePrepared(const QString& key, const QImage& image, const QVector<QImage>& mipmaps,
+        bool translucent, const QColor& averageColor, int originalWidth, int originalHeight) {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << PREPARED_TEXTURE_MAGIC << PREPARED_TEXTURE_VERSION << (qint32)image.format() << translucent << averageColor <<
+        originalWidth << originalHeight << (qint32)(mipmaps.size() + 1);
+    for (int i = -1; i < mipmaps.size(); i++) {
+        const QImage& level = (i == -1) ? image : mipmaps.at(i);
+        out << (qint32)level.width() << (qint32)level.height();
+        out.writeRawData(reinterpret_cast<const char*>(level.constBits()), level.byteCount());
+    }
+    ProcessedResourceCache::getInstance().insert(key, data);
 }
 
 void NetworkTexture::downloadFinished(QNetworkReply* reply) {
@@ -537,8 +776,8 @@ void NetworkTexture::loadContent(const QByteArray& content) {
     QThreadPool::globalInstance()->start(new ImageReader(_self, NULL, _url, content));
 }
 
-void NetworkTexture::setImage(const QImage& image, bool translucent, const QColor& averageColor, int originalWidth,
-                              int originalHeight) {
+void NetworkTexture::setImage(const QImage& image, const QVector<QImage>& mipmaps, bool translucent,
+                              const QColor& averageColor, int originalWidth, int originalHeight) {
     _translucent = translucent;
     _averageColor = averageColor;
     _originalWidth = originalWidth;
@@ -560,7 +799,14 @@ void NetworkTexture::setImage(const QImage& image, bool translucent, const QColo
         }
         _gpuTexture = gpu::TexturePointer(gpu::Texture::create2D(formatGPU, image.width(), image.height()));
         _gpuTexture->assignStoredMip(0, formatMip, image.byteCount(), image.constBits());
-        _gpuTexture->autoGenerateMips(-1);
+        if (mipmaps.isEmpty()) {
+            _gpuTexture->autoGenerateMips(-1);
+        } else {
+            for (int i = 0; i < mipmaps.size(); i++) {
+                const QImage& mipmap = mipmaps.at(i);
+                _gpuTexture->assignStoredMip(i + 1, formatMip, mipmap.byteCount(), mipmap.constBits());
+            }
+        }
     }
 }
 
@@ -17,6 +17,7 @@
 
 #include <QImage>
 #include <QMap>
+#include <QVector>
 #include <QGLWidget>
 
 #include <DependencyManager.h>
@@ -165,8 +166,8 @@ protected:
     virtual void downloadFinished(QNetworkReply* reply);
           
     Q_INVOKABLE void loadContent(const QByteArray& content);
-    Q_INVOKABLE void setImage(const QImage& image, bool translucent, const QColor& averageColor, int originalWidth,
-                              int originalHeight);
+    Q_INVOKABLE void setImage(const QImage& image, const QVector<QImage>& mipmaps, bool translucent,
+                              const QColor& averageColor, int originalWidth, int originalHeight);
 
     virtual void imageLoaded(const QImage& image);
 
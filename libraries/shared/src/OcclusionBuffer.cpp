@@ -0,0 +1,252 @@
+//
+//  OcclusionBuffer.cpp
+//  libraries/shared/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cfloat>
+
+#include "AABox.h"
+#include "OcclusionBuffer.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define OCCLUSION_BUFFER_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+const float OcclusionBuffer::NEAR_DEPTH = 0.1f;
+
+const int TILE_PIXELS = OcclusionBuffer::TILE_SIZE * OcclusionBuffer::TILE_SIZE;
+
+// tested bounds are brought this much nearer, so that rounding can't let a box occluder hide its own bounds
+const float DEPTH_BIAS = 1.0001f;
+
+static const glm::vec3 UNIT_CUBE_VERTICES[] = {
+    glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.5f, -0.5f, -0.5f), glm::vec3(-0.5f, 0.5f, -0.5f),
+    glm::vec3(0.5f, 0.5f, -0.5f), glm::vec3(-0.5f, -0.5f, 0.5f), glm::vec3(0.5f, -0.5f, 0.5f),
+    glm::vec3(-0.5f, 0.5f, 0.5f), glm::vec3(0.5f, 0.5f, 0.5f) };
+
+static const int UNIT_CUBE_VERTEX_COUNT = sizeof(UNIT_CUBE_VERTICES) / sizeof(UNIT_CUBE_VERTICES[0]);
+
+static const int UNIT_CUBE_INDICES[] = { 0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6, 0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5,
+    0, 1, 5, 0, 5, 4, 2, 6, 7, 2, 7, 3 };
+
+static const int UNIT_CUBE_INDEX_COUNT = sizeof(UNIT_CUBE_INDICES) / sizeof(UNIT_CUBE_INDICES[0]);
+
+OcclusionBuffer::OcclusionBuffer() :
+    _occluderCount(0),
+    _depths(WIDTH * HEIGHT, 0.0f),
+    _farthestDepths(TILE_COLUMNS * TILE_ROWS, 0.0f) {
+}
+
+void OcclusionBuffer::begin(const glm::mat4& viewProjection) {
+    _viewProjection = viewProjection;
+    _occluderCount = 0;
+    std::fill(_depths.begin(), _depths.end(), 0.0f);
+    std::fill(_farthestDepths.begin(), _farthestDepths.end(), 0.0f);
+}
+
+void OcclusionBuffer::addOccluderBox(const glm::mat4& transform) {
+    addOccluderTriangles(UNIT_CUBE_VERTICES, UNIT_CUBE_VERTEX_COUNT, UNIT_CUBE_INDICES, UNIT_CUBE_INDEX_COUNT, transform);
+}
+
+void OcclusionBuffer::addOccluderTriangles(const glm::vec3* vertices, int vertexCount, const int* indices, int indexCount,
+        const glm::mat4& transform) {
+    glm::mat4 matrix = _viewProjection * transform;
+    _clipVertices.resize(vertexCount);
+    for (int i = 0; i < vertexCount; i++) {
+        _clipVertices[i] = matrix * glm::vec4(vertices[i], 1.0f);
+    }
+    // a mirroring transform reverses the winding
+    bool mirrored = glm::determinant(glm::mat3(transform)) < 0.0f;
+    for (int i = 0; i + 2 < indexCount; i += 3) {
+        const glm::vec4& v0 = _clipVertices[indices[i]];
+        const glm::vec4& v1 = _clipVertices[indices[i + 1]];
+        const glm::vec4& v2 = _clipVertices[indices[i + 2]];
+        if (mirrored) {
+            rasterizeTriangle(v0, v2, v1);
+        } else {
+            rasterizeTriangle(v0, v1, v2);
+        }
+    }
+    _occluderCount++;
+}
+
+bool OcclusionBuffer::isOccluded(const AABox& box) const {
+    if (_occluderCount == 0) {
+        return false;
+    }
+    // find the screen bounds of the corners and the inverse depth of the nearest, which is that of the nearest point
+    float minX = FLT_MAX, maxX = -FLT_MAX, minY = FLT_MAX, maxY = -FLT_MAX;
+    float nearestDepth = 0.0f;
+    const glm::vec3& corner = box.getCorner();
+    const glm::vec3& scale = box.getScale();
+    for (int i = 0; i < 8; i++) {
+        glm::vec4 clip = _viewProjection * glm::vec4(corner.x + ((i & 1) ? scale.x : 0.0f),
+            corner.y + ((i & 2) ? scale.y : 0.0f), corner.z + ((i & 4) ? scale.z : 0.0f), 1.0f);
+        if (clip.w < NEAR_DEPTH) {
+            return false;
+        }
+        float inverseDepth = 1.0f / clip.w;
+        float x = (clip.x * inverseDepth * 0.5f + 0.5f) * WIDTH;
+        float y = (clip.y * inverseDepth * 0.5f + 0.5f) * HEIGHT;
+        minX = glm::min(minX, x);
+        maxX = glm::max(maxX, x);
+        minY = glm::min(minY, y);
+        maxY = glm::max(maxY, y);
+        nearestDepth = glm::max(nearestDepth, inverseDepth);
+    }
+    if (maxX < 0.0f || minX >= WIDTH || maxY < 0.0f || minY >= HEIGHT) {
+        return false; // off screen entirely, which is for the frustum test to say
+    }
+    nearestDepth *= DEPTH_BIAS;
+
+    // widen the bounds by a pixel, since the occluders only cover the pixels whose centers they cover
+    int x0 = (int)glm::clamp(glm::floor(minX) - 1.0f, 0.0f, WIDTH - 1.0f);
+    int x1 = (int)glm::clamp(glm::floor(maxX) + 1.0f, 0.0f, WIDTH - 1.0f);
+    int y0 = (int)glm::clamp(glm::floor(minY) - 1.0f, 0.0f, HEIGHT - 1.0f);
+    int y1 = (int)glm::clamp(glm::floor(maxY) + 1.0f, 0.0f, HEIGHT - 1.0f);
+
+    for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++) {
+        for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++) {
+            int tile = ty * TILE_COLUMNS + tx;
+            if (_farthestDepths[tile] > nearestDepth) {
+                continue; // the whole tile is nearer
+            }
+            int tileX = tx * TILE_SIZE, tileY = ty * TILE_SIZE;
+            if (x0 <= tileX && x1 >= tileX + TILE_SIZE - 1 && y0 <= tileY && y1 >= tileY + TILE_SIZE - 1) {
+                return false; // the box covers the whole tile, and so covers its farthest pixel
+            }
+            const float* depths = _depths.data() + tile * TILE_PIXELS;
+            for (int y = glm::max(y0, tileY), yEnd = glm::min(y1, tileY + TILE_SIZE - 1); y <= yEnd; y++) {
+                for (int x = glm::max(x0, tileX), xEnd = glm::min(x1, tileX + TILE_SIZE - 1); x <= xEnd; x++) {
+                    if (depths[(y - tileY) * TILE_SIZE + x - tileX] <= nearestDepth) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+float OcclusionBuffer::getDepth(int x, int y) const {
+    int tile = (y / TILE_SIZE) * TILE_COLUMNS + x / TILE_SIZE;
+    return _depths[tile * TILE_PIXELS + (y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE];
+}
+
+static glm::vec3 project(const glm::vec4& clip) {
+    float inverseDepth = 1.0f / clip.w;
+    return glm::vec3((clip.x * inverseDepth * 0.5f + 0.5f) * OcclusionBuffer::WIDTH,
+        (clip.y * inverseDepth * 0.5f + 0.5f) * OcclusionBuffer::HEIGHT, inverseDepth);
+}
+
+void OcclusionBuffer::rasterizeTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2) {
+    // clip against the near depth, which leaves a triangle or a quad
+    const glm::vec4* vertices[] = { &v0, &v1, &v2 };
+    glm::vec3 projected[4];
+    int count = 0;
+    for (int i = 0; i < 3; i++) {
+        const glm::vec4& current = *vertices[i];
+        const glm::vec4& next = *vertices[(i + 1) % 3];
+        bool currentInside = current.w >= NEAR_DEPTH;
+        if (currentInside) {
+            projected[count++] = project(current);
+        }
+        if (currentInside != (next.w >= NEAR_DEPTH)) {
+            projected[count++] = project(glm::mix(current, next, (NEAR_DEPTH - current.w) / (next.w - current.w)));
+        }
+    }
+    for (int i = 2; i < count; i++) {
+        rasterizeClippedTriangle(projected[0], projected[i - 1], projected[i]);
+    }
+}
+
+void OcclusionBuffer::rasterizeClippedTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) {
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    if (area <= 0.0f) {
+        return; // back facing or degenerate
+    }
+    float minX = glm::min(v0.x, glm::min(v1.x, v2.x)), maxX = glm::max(v0.x, glm::max(v1.x, v2.x));
+    float minY = glm::min(v0.y, glm::min(v1.y, v2.y)), maxY = glm::max(v0.y, glm::max(v1.y, v2.y));
+    if (maxX < 0.0f || minX >= WIDTH || maxY < 0.0f || minY >= HEIGHT) {
+        return;
+    }
+    int x0 = (int)glm::clamp(glm::floor(minX), 0.0f, WIDTH - 1.0f);
+    int x1 = (int)glm::clamp(glm::floor(maxX), 0.0f, WIDTH - 1.0f);
+    int y0 = (int)glm::clamp(glm::floor(minY), 0.0f, HEIGHT - 1.0f);
+    int y1 = (int)glm::clamp(glm::floor(maxY), 0.0f, HEIGHT - 1.0f);
+
+    // the edge functions, scaled to give the barycentric coordinate of the opposite vertex, and the depth plane
+    float inverseArea = 1.0f / area;
+    const glm::vec3* vertices[] = { &v0, &v1, &v2 };
+    float a[3], b[3], c[3];
+    float depthA = 0.0f, depthB = 0.0f, depthC = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        const glm::vec3& start = *vertices[(i + 1) % 3];
+        const glm::vec3& end = *vertices[(i + 2) % 3];
+        a[i] = (start.y - end.y) * inverseArea;
+        b[i] = (end.x - start.x) * inverseArea;
+        c[i] = -a[i] * start.x - b[i] * start.y;
+        depthA += vertices[i]->z * a[i];
+        depthB += vertices[i]->z * b[i];
+        depthC += vertices[i]->z * c[i];
+    }
+    float nearestDepth = glm::max(v0.z, glm::max(v1.z, v2.z));
+
+    for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++) {
+        for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++) {
+            int tile = ty * TILE_COLUMNS + tx;
+            if (_farthestDepths[tile] >= nearestDepth) {
+                continue; // nothing in the tile is farther than the triangle
+            }
+            float* depths = _depths.data() + tile * TILE_PIXELS;
+            float tileX = (float)(tx * TILE_SIZE) + 0.5f;
+            for (int row = 0; row < TILE_SIZE; row++, depths += TILE_SIZE) {
+                float y = (float)(ty * TILE_SIZE + row) + 0.5f;
+#ifdef OCCLUSION_BUFFER_USE_SSE
+                const int SSE_WIDTH = 4;
+                __m128 x = _mm_add_ps(_mm_set1_ps(tileX), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+                __m128 zero = _mm_setzero_ps();
+                for (int column = 0; column < TILE_SIZE; column += SSE_WIDTH) {
+                    __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), x),
+                        _mm_set1_ps(b[0] * y + c[0])), zero);
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[1]), x),
+                        _mm_set1_ps(b[1] * y + c[1])), zero));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[2]), x),
+                        _mm_set1_ps(b[2] * y + c[2])), zero));
+                    __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(depthA), x), _mm_set1_ps(depthB * y + depthC));
+                    __m128 existing = _mm_loadu_ps(depths + column);
+                    _mm_storeu_ps(depths + column, _mm_or_ps(_mm_and_ps(inside, _mm_max_ps(existing, depth)),
+                        _mm_andnot_ps(inside, existing)));
+                    x = _mm_add_ps(x, _mm_set1_ps((float)SSE_WIDTH));
+                }
+#else
+                for (int column = 0; column < TILE_SIZE; column++) {
+                    float x = tileX + column;
+                    if (a[0] * x + b[0] * y + c[0] >= 0.0f && a[1] * x + b[1] * y + c[1] >= 0.0f &&
+                            a[2] * x + b[2] * y + c[2] >= 0.0f) {
+                        depths[column] = glm::max(depths[column], depthA * x + depthB * y + depthC);
+                    }
+                }
+#endif
+            }
+            updateFarthestDepth(tile);
+        }
+    }
+}
+
+void OcclusionBuffer::updateFarthestDepth(int tile) {
+    const float* depths = _depths.data() + tile * TILE_PIXELS;
+    float farthest = depths[0];
+    for (int i = 1; i < TILE_PIXELS; i++) {
+        farthest = glm::min(farthest, depths[i]);
+    }
+    _farthestDepths[tile] = farthest;
+}
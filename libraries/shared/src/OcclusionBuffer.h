@@ -0,0 +1,71 @@
+//
+//  OcclusionBuffer.h
+//  libraries/shared/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OcclusionBuffer_h
+#define hifi_OcclusionBuffer_h
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class AABox;
+
+/// A small depth buffer rasterized on the CPU from a few large occluders, against which the bounds of the things to be
+/// drawn can be tested so that those entirely hidden behind the occluders are skipped.  Depths are stored as inverse view
+/// depths (so that they interpolate linearly across the screen, and zero is infinitely far) in tiles of eight by eight
+/// pixels, with the farthest depth of each tile kept for testing large bounds quickly.
+class OcclusionBuffer {
+public:
+
+    static const int WIDTH = 256;
+    static const int HEIGHT = 128;
+    static const int TILE_SIZE = 8;
+    static const int TILE_COLUMNS = WIDTH / TILE_SIZE;
+    static const int TILE_ROWS = HEIGHT / TILE_SIZE;
+
+    /// Occluders are clipped to this view depth, and bounds reaching any nearer are never occluded.
+    static const float NEAR_DEPTH;
+
+    OcclusionBuffer();
+
+    /// Clears the buffer for a new view.
+    /// \param viewProjection the matrix taking world space to clip space
+    void begin(const glm::mat4& viewProjection);
+
+    int getOccluderCount() const { return _occluderCount; }
+
+    /// Rasterizes a solid box, given as the transform of a unit cube centered at the origin.
+    void addOccluderBox(const glm::mat4& transform);
+
+    /// Rasterizes the front faces of solid geometry, whose triangles wind counterclockwise when seen from outside.
+    void addOccluderTriangles(const glm::vec3* vertices, int vertexCount, const int* indices, int indexCount,
+        const glm::mat4& transform);
+
+    /// Checks whether the box is hidden behind the occluders everywhere it might cover on screen.
+    bool isOccluded(const AABox& box) const;
+
+    /// Returns the inverse depth stored at the given pixel (with y increasing upwards).
+    float getDepth(int x, int y) const;
+
+private:
+
+    void rasterizeTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2);
+    void rasterizeClippedTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2);
+    void updateFarthestDepth(int tile);
+
+    glm::mat4 _viewProjection;
+    int _occluderCount;
+    std::vector<float> _depths;
+    std::vector<float> _farthestDepths;
+    std::vector<glm::vec4> _clipVertices;
+};
+
+#endif // hifi_OcclusionBuffer_h
@@ -12,6 +12,7 @@
 #ifndef hifi_RenderArgs_h
 #define hifi_RenderArgs_h
 
+class OcclusionBuffer;
 class ViewFrustum;
 class OctreeRenderer;
 
@@ -31,11 +32,13 @@ public:
     int _itemsRendered;
     int _itemsOutOfView;
     int _itemsTooSmall;
+    int _itemsOccluded;
 
     int _meshesConsidered;
     int _meshesRendered;
     int _meshesOutOfView;
     int _meshesTooSmall;
+    int _meshesOccluded;
 
     int _materialSwitches;
     int _trianglesRendered;
@@ -43,6 +46,8 @@ public:
 
     int _translucentMeshPartsRendered;
     int _opaqueMeshPartsRendered;
+
+    OcclusionBuffer* _occlusionBuffer; ///< if non-null, the occluders against which to test bounds after the frustum
 };
 
 #endif // hifi_RenderArgs_h
@@ -0,0 +1,371 @@
+//
+//  ShapeBatch.cpp
+//  libraries/shared/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "CapsuleShape.h"
+#include "ShapeBatch.h"
+#include "ShapeCollider.h"
+#include "SphereShape.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SHAPE_BATCH_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// number of packed shapes tested per pass
+const int BATCH_WIDTH = 4;
+
+// the packed tests only pick candidates and the scalar helpers make the final call,
+// so they can afford to be generous rather than lose a touching pair to rounding
+const float CANDIDATE_MARGIN = 1.001f;
+
+void SphereBatch::clear() {
+    // keep the capacity around, the same shapes come back every substep
+    x.resize(0);
+    y.resize(0);
+    z.resize(0);
+    radius.resize(0);
+    shapes.resize(0);
+}
+
+void SphereBatch::add(const Shape* shape, const glm::vec3& center, float sphereRadius) {
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(sphereRadius);
+    shapes.push_back(shape);
+}
+
+void CapsuleBatch::clear() {
+    x.resize(0);
+    y.resize(0);
+    z.resize(0);
+    axisX.resize(0);
+    axisY.resize(0);
+    axisZ.resize(0);
+    halfHeight.resize(0);
+    radius.resize(0);
+    shapes.resize(0);
+}
+
+void CapsuleBatch::add(const Shape* shape, const glm::vec3& center, const glm::vec3& axis,
+        float capsuleHalfHeight, float capsuleRadius) {
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    axisX.push_back(axis.x);
+    axisY.push_back(axis.y);
+    axisZ.push_back(axis.z);
+    halfHeight.push_back(capsuleHalfHeight);
+    radius.push_back(capsuleRadius);
+    shapes.push_back(shape);
+}
+
+void ShapeBatch::clear() {
+    spheres.clear();
+    capsules.clear();
+    otherShapes.resize(0);
+}
+
+void ShapeBatch::addShape(const Shape* shape) {
+    if (!shape) {
+        return;
+    }
+    Shape::Type type = shape->getType();
+    if (type == SPHERE_SHAPE) {
+        const SphereShape* sphere = static_cast<const SphereShape*>(shape);
+        spheres.add(shape, sphere->getTranslation(), sphere->getRadius());
+    } else if (type == CAPSULE_SHAPE) {
+        const CapsuleShape* capsule = static_cast<const CapsuleShape*>(shape);
+        glm::vec3 axis;
+        capsule->computeNormalizedAxis(axis);
+        capsules.add(shape, capsule->getTranslation(), axis, capsule->getHalfHeight(), capsule->getRadius());
+    } else {
+        otherShapes.push_back(shape);
+    }
+}
+
+void ShapeBatch::addShapes(const QVector<Shape*>& shapes) {
+    int numShapes = shapes.size();
+    for (int i = 0; i < numShapes; ++i) {
+        addShape(shapes.at(i));
+    }
+}
+
+// Each of the candidate functions below tests the packed shapes [start, start + BATCH_WIDTH) and returns a bit mask
+// of the ones that might touch the given shape.
+
+static int findSphereCandidates(const glm::vec3& center, float radius, const SphereBatch& spheres, int start) {
+    int count = spheres.size() - start;
+#ifdef SHAPE_BATCH_USE_SSE
+    if (count >= BATCH_WIDTH) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(spheres.x.constData() + start), _mm_set1_ps(center.x));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(spheres.y.constData() + start), _mm_set1_ps(center.y));
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(spheres.z.constData() + start), _mm_set1_ps(center.z));
+        __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 reach = _mm_add_ps(_mm_loadu_ps(spheres.radius.constData() + start), _mm_set1_ps(radius));
+        __m128 reach2 = _mm_mul_ps(_mm_mul_ps(reach, reach), _mm_set1_ps(CANDIDATE_MARGIN));
+        return _mm_movemask_ps(_mm_cmple_ps(distance2, reach2));
+    }
+#endif
+    int mask = 0;
+    for (int lane = 0; lane < count && lane < BATCH_WIDTH; ++lane) {
+        int i = start + lane;
+        glm::vec3 offset(spheres.x.at(i) - center.x, spheres.y.at(i) - center.y, spheres.z.at(i) - center.z);
+        float reach = spheres.radius.at(i) + radius;
+        if (glm::dot(offset, offset) <= reach * reach * CANDIDATE_MARGIN) {
+            mask |= 1 << lane;
+        }
+    }
+    return mask;
+}
+
+static int findCapsuleCandidatesForSphere(const glm::vec3& center, float radius, const CapsuleBatch& capsules, int start) {
+    int count = capsules.size() - start;
+#ifdef SHAPE_BATCH_USE_SSE
+    if (count >= BATCH_WIDTH) {
+        // offset from sphere to capsule center, and its projection onto the capsule axis clamped to the segment
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(capsules.x.constData() + start), _mm_set1_ps(center.x));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(capsules.y.constData() + start), _mm_set1_ps(center.y));
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(capsules.z.constData() + start), _mm_set1_ps(center.z));
+        __m128 ax = _mm_loadu_ps(capsules.axisX.constData() + start);
+        __m128 ay = _mm_loadu_ps(capsules.axisY.constData() + start);
+        __m128 az = _mm_loadu_ps(capsules.axisZ.constData() + start);
+        __m128 halfHeight = _mm_loadu_ps(capsules.halfHeight.constData() + start);
+        __m128 axial = _mm_sub_ps(_mm_setzero_ps(),
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, ax), _mm_mul_ps(dy, ay)), _mm_mul_ps(dz, az)));
+        axial = _mm_min_ps(_mm_max_ps(axial, _mm_sub_ps(_mm_setzero_ps(), halfHeight)), halfHeight);
+        dx = _mm_add_ps(dx, _mm_mul_ps(axial, ax));
+        dy = _mm_add_ps(dy, _mm_mul_ps(axial, ay));
+        dz = _mm_add_ps(dz, _mm_mul_ps(axial, az));
+        __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 reach = _mm_add_ps(_mm_loadu_ps(capsules.radius.constData() + start), _mm_set1_ps(radius));
+        __m128 reach2 = _mm_mul_ps(_mm_mul_ps(reach, reach), _mm_set1_ps(CANDIDATE_MARGIN));
+        return _mm_movemask_ps(_mm_cmple_ps(distance2, reach2));
+    }
+#endif
+    int mask = 0;
+    for (int lane = 0; lane < count && lane < BATCH_WIDTH; ++lane) {
+        int i = start + lane;
+        glm::vec3 offset(capsules.x.at(i) - center.x, capsules.y.at(i) - center.y, capsules.z.at(i) - center.z);
+        glm::vec3 axis(capsules.axisX.at(i), capsules.axisY.at(i), capsules.axisZ.at(i));
+        float halfHeight = capsules.halfHeight.at(i);
+        offset += glm::clamp(-glm::dot(offset, axis), -halfHeight, halfHeight) * axis;
+        float reach = capsules.radius.at(i) + radius;
+        if (glm::dot(offset, offset) <= reach * reach * CANDIDATE_MARGIN) {
+            mask |= 1 << lane;
+        }
+    }
+    return mask;
+}
+
+static int findSphereCandidatesForCapsule(const glm::vec3& center, const glm::vec3& axis, float halfHeight, float radius,
+        const SphereBatch& spheres, int start) {
+    int count = spheres.size() - start;
+#ifdef SHAPE_BATCH_USE_SSE
+    if (count >= BATCH_WIDTH) {
+        // offset from each sphere to the capsule center, and its projection onto the axis clamped to the segment
+        __m128 dx = _mm_sub_ps(_mm_set1_ps(center.x), _mm_loadu_ps(spheres.x.constData() + start));
+        __m128 dy = _mm_sub_ps(_mm_set1_ps(center.y), _mm_loadu_ps(spheres.y.constData() + start));
+        __m128 dz = _mm_sub_ps(_mm_set1_ps(center.z), _mm_loadu_ps(spheres.z.constData() + start));
+        __m128 ax = _mm_set1_ps(axis.x);
+        __m128 ay = _mm_set1_ps(axis.y);
+        __m128 az = _mm_set1_ps(axis.z);
+        __m128 axial = _mm_sub_ps(_mm_setzero_ps(),
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, ax), _mm_mul_ps(dy, ay)), _mm_mul_ps(dz, az)));
+        axial = _mm_min_ps(_mm_max_ps(axial, _mm_set1_ps(-halfHeight)), _mm_set1_ps(halfHeight));
+        dx = _mm_add_ps(dx, _mm_mul_ps(axial, ax));
+        dy = _mm_add_ps(dy, _mm_mul_ps(axial, ay));
+        dz = _mm_add_ps(dz, _mm_mul_ps(axial, az));
+        __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 reach = _mm_add_ps(_mm_loadu_ps(spheres.radius.constData() + start), _mm_set1_ps(radius));
+        __m128 reach2 = _mm_mul_ps(_mm_mul_ps(reach, reach), _mm_set1_ps(CANDIDATE_MARGIN));
+        return _mm_movemask_ps(_mm_cmple_ps(distance2, reach2));
+    }
+#endif
+    int mask = 0;
+    for (int lane = 0; lane < count && lane < BATCH_WIDTH; ++lane) {
+        int i = start + lane;
+        glm::vec3 offset(center.x - spheres.x.at(i), center.y - spheres.y.at(i), center.z - spheres.z.at(i));
+        offset += glm::clamp(-glm::dot(offset, axis), -halfHeight, halfHeight) * axis;
+        float reach = spheres.radius.at(i) + radius;
+        if (glm::dot(offset, offset) <= reach * reach * CANDIDATE_MARGIN) {
+            mask |= 1 << lane;
+        }
+    }
+    return mask;
+}
+
+static int findCapsuleCandidatesForCapsule(const glm::vec3& center, float boundingRadius,
+        const CapsuleBatch& capsules, int start) {
+    // bounding spheres only, capsuleVsCapsule() sorts out the rest
+    int count = capsules.size() - start;
+#ifdef SHAPE_BATCH_USE_SSE
+    if (count >= BATCH_WIDTH) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(capsules.x.constData() + start), _mm_set1_ps(center.x));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(capsules.y.constData() + start), _mm_set1_ps(center.y));
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(capsules.z.constData() + start), _mm_set1_ps(center.z));
+        __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 reach = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(capsules.radius.constData() + start),
+            _mm_loadu_ps(capsules.halfHeight.constData() + start)), _mm_set1_ps(boundingRadius));
+        __m128 reach2 = _mm_mul_ps(_mm_mul_ps(reach, reach), _mm_set1_ps(CANDIDATE_MARGIN));
+        return _mm_movemask_ps(_mm_cmple_ps(distance2, reach2));
+    }
+#endif
+    int mask = 0;
+    for (int lane = 0; lane < count && lane < BATCH_WIDTH; ++lane) {
+        int i = start + lane;
+        glm::vec3 offset(capsules.x.at(i) - center.x, capsules.y.at(i) - center.y, capsules.z.at(i) - center.z);
+        float reach = capsules.radius.at(i) + capsules.halfHeight.at(i) + boundingRadius;
+        if (glm::dot(offset, offset) <= reach * reach * CANDIDATE_MARGIN) {
+            mask |= 1 << lane;
+        }
+    }
+    return mask;
+}
+
+namespace ShapeCollider {
+
+bool sphereVsSpheres(const Shape* shapeA, const SphereBatch& spheres, CollisionList& collisions) {
+    const SphereShape* sphereA = static_cast<const SphereShape*>(shapeA);
+    glm::vec3 centerA = sphereA->getTranslation();
+    float radiusA = sphereA->getRadius();
+    bool collided = false;
+    int numSpheres = spheres.size();
+    for (int start = 0; start < numSpheres; start += BATCH_WIDTH) {
+        int mask = findSphereCandidates(centerA, radiusA, spheres, start);
+        for (int i = start; mask; ++i, mask >>= 1) {
+            if (!(mask & 1)) {
+                continue;
+            }
+            CollisionInfo* collision = sphereVsSphereHelper(centerA, radiusA,
+                glm::vec3(spheres.x.at(i), spheres.y.at(i), spheres.z.at(i)), spheres.radius.at(i), collisions);
+            if (collision) {
+                collision->_shapeA = shapeA;
+                collision->_shapeB = spheres.shapes.at(i);
+                collided = true;
+                if (collisions.isFull()) {
+                    return true;
+                }
+            }
+        }
+    }
+    return collided;
+}
+
+bool sphereVsCapsules(const Shape* shapeA, const CapsuleBatch& capsules, CollisionList& collisions) {
+    const SphereShape* sphereA = static_cast<const SphereShape*>(shapeA);
+    glm::vec3 centerA = sphereA->getTranslation();
+    float radiusA = sphereA->getRadius();
+    bool collided = false;
+    int numCapsules = capsules.size();
+    for (int start = 0; start < numCapsules; start += BATCH_WIDTH) {
+        int mask = findCapsuleCandidatesForSphere(centerA, radiusA, capsules, start);
+        for (int i = start; mask; ++i, mask >>= 1) {
+            if (!(mask & 1)) {
+                continue;
+            }
+            CollisionInfo* collision = sphereVsCapsuleHelper(centerA, radiusA,
+                glm::vec3(capsules.x.at(i), capsules.y.at(i), capsules.z.at(i)),
+                glm::vec3(capsules.axisX.at(i), capsules.axisY.at(i), capsules.axisZ.at(i)),
+                capsules.halfHeight.at(i), capsules.radius.at(i), collisions);
+            if (collision) {
+                collision->_shapeA = shapeA;
+                collision->_shapeB = capsules.shapes.at(i);
+                collided = true;
+                if (collisions.isFull()) {
+                    return true;
+                }
+            }
+        }
+    }
+    return collided;
+}
+
+bool capsuleVsSpheres(const Shape* shapeA, const SphereBatch& spheres, CollisionList& collisions) {
+    const CapsuleShape* capsuleA = static_cast<const CapsuleShape*>(shapeA);
+    glm::vec3 centerA = capsuleA->getTranslation();
+    glm::vec3 axisA;
+    capsuleA->computeNormalizedAxis(axisA);
+    float halfHeightA = capsuleA->getHalfHeight();
+    float radiusA = capsuleA->getRadius();
+    bool collided = false;
+    int numSpheres = spheres.size();
+    for (int start = 0; start < numSpheres; start += BATCH_WIDTH) {
+        int mask = findSphereCandidatesForCapsule(centerA, axisA, halfHeightA, radiusA, spheres, start);
+        for (int i = start; mask; ++i, mask >>= 1) {
+            if (!(mask & 1)) {
+                continue;
+            }
+            CollisionInfo* collision = sphereVsCapsuleHelper(glm::vec3(spheres.x.at(i), spheres.y.at(i), spheres.z.at(i)),
+                spheres.radius.at(i), centerA, axisA, halfHeightA, radiusA, collisions);
+            if (collision) {
+                // same as capsuleVsSphere(): the contact is reported from the sphere's point of view
+                collision->_shapeA = spheres.shapes.at(i);
+                collision->_shapeB = shapeA;
+                collided = true;
+                if (collisions.isFull()) {
+                    return true;
+                }
+            }
+        }
+    }
+    return collided;
+}
+
+bool capsuleVsCapsules(const Shape* shapeA, const CapsuleBatch& capsules, CollisionList& collisions) {
+    const CapsuleShape* capsuleA = static_cast<const CapsuleShape*>(shapeA);
+    glm::vec3 centerA = capsuleA->getTranslation();
+    float boundingRadiusA = capsuleA->getRadius() + capsuleA->getHalfHeight();
+    bool collided = false;
+    int numCapsules = capsules.size();
+    for (int start = 0; start < numCapsules; start += BATCH_WIDTH) {
+        int mask = findCapsuleCandidatesForCapsule(centerA, boundingRadiusA, capsules, start);
+        for (int i = start; mask; ++i, mask >>= 1) {
+            if ((mask & 1) && capsuleVsCapsule(shapeA, capsules.shapes.at(i), collisions)) {
+                collided = true;
+                if (collisions.isFull()) {
+                    return true;
+                }
+            }
+        }
+    }
+    return collided;
+}
+
+bool collideShapeWithBatch(const Shape* shapeA, const ShapeBatch& batch, CollisionList& collisions) {
+    bool collided = false;
+    Shape::Type typeA = shapeA->getType();
+    if (typeA == SPHERE_SHAPE) {
+        collided = sphereVsSpheres(shapeA, batch.spheres, collisions);
+        if (!collisions.isFull()) {
+            collided = sphereVsCapsules(shapeA, batch.capsules, collisions) || collided;
+        }
+    } else if (typeA == CAPSULE_SHAPE) {
+        collided = capsuleVsSpheres(shapeA, batch.spheres, collisions);
+        if (!collisions.isFull()) {
+            collided = capsuleVsCapsules(shapeA, batch.capsules, collisions) || collided;
+        }
+    } else {
+        // nothing to gain from the packed copies, go through the dispatch table
+        for (int i = 0; i < batch.spheres.size() && !collisions.isFull(); ++i) {
+            collided = collideShapes(shapeA, batch.spheres.shapes.at(i), collisions) || collided;
+        }
+        for (int i = 0; i < batch.capsules.size() && !collisions.isFull(); ++i) {
+            collided = collideShapes(shapeA, batch.capsules.shapes.at(i), collisions) || collided;
+        }
+    }
+    for (int i = 0; i < batch.otherShapes.size() && !collisions.isFull(); ++i) {
+        collided = collideShapes(shapeA, batch.otherShapes.at(i), collisions) || collided;
+    }
+    return collided;
+}
+
+}   // namespace ShapeCollider
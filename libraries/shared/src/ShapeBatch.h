@@ -0,0 +1,71 @@
+//
+//  ShapeBatch.h
+//  libraries/shared/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ShapeBatch_h
+#define hifi_ShapeBatch_h
+
+#include <glm/glm.hpp>
+#include <QVector>
+
+class Shape;
+
+/// Spheres packed one array per component so that one shape can be tested against several of them at once.
+class SphereBatch {
+public:
+    void clear();
+    void add(const Shape* shape, const glm::vec3& center, float sphereRadius);
+    int size() const { return shapes.size(); }
+
+    QVector<float> x;
+    QVector<float> y;
+    QVector<float> z;
+    QVector<float> radius;
+    QVector<const Shape*> shapes;
+};
+
+/// Capsules packed one array per component, with their axes already normalized.
+class CapsuleBatch {
+public:
+    void clear();
+    void add(const Shape* shape, const glm::vec3& center, const glm::vec3& axis, float capsuleHalfHeight, float capsuleRadius);
+    int size() const { return shapes.size(); }
+
+    QVector<float> x;
+    QVector<float> y;
+    QVector<float> z;
+    QVector<float> axisX;
+    QVector<float> axisY;
+    QVector<float> axisZ;
+    QVector<float> halfHeight;
+    QVector<float> radius;
+    QVector<const Shape*> shapes;
+};
+
+/// Copies of the spheres and capsules among a set of shapes for ShapeCollider::collideShapeWithBatch().
+/// The copies do not follow the shapes around so the batch must be refilled after they move.
+class ShapeBatch {
+public:
+    void clear();
+
+    /// \param shape may be NULL, in which case it is ignored
+    /// Spheres and capsules are packed, any other shape is kept as is and goes through the regular dispatch.
+    void addShape(const Shape* shape);
+
+    void addShapes(const QVector<Shape*>& shapes);
+
+    int size() const { return spheres.size() + capsules.size() + otherShapes.size(); }
+
+    SphereBatch spheres;
+    CapsuleBatch capsules;
+    QVector<const Shape*> otherShapes;
+};
+
+#endif // hifi_ShapeBatch_h
@@ -0,0 +1,120 @@
+//
+//  ShapeBroadphase.cpp
+//  libraries/shared/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <float.h>
+
+#include "AACubeShape.h"
+#include "Shape.h"
+#include "ShapeBroadphase.h"
+
+void ShapeBroadphase::clear() {
+    // keep the capacity around, the same shapes come back every substep
+    _proxies.resize(0);
+    _pairs.resize(0);
+}
+
+void ShapeBroadphase::addPrimaryShape(const Shape* shape, int index) {
+    if (shape) {
+        addProxy(shape, index);
+    }
+}
+
+void ShapeBroadphase::addSecondaryShape(const Shape* shape) {
+    if (shape) {
+        addProxy(shape, -1);
+    }
+}
+
+void ShapeBroadphase::addSecondaryShapes(const QVector<Shape*>& shapes) {
+    int numShapes = shapes.size();
+    for (int i = 0; i < numShapes; ++i) {
+        addSecondaryShape(shapes.at(i));
+    }
+}
+
+void ShapeBroadphase::addProxy(const Shape* shape, int index) {
+    Proxy proxy;
+    computeBounds(shape, proxy.minimum, proxy.maximum);
+    proxy.shape = shape;
+    proxy.index = index;
+    proxy.order = _proxies.size();
+    _proxies.push_back(proxy);
+}
+
+const QVector<ShapePair>& ShapeBroadphase::computePairs() {
+    _pairs.resize(0);
+
+    // secondary shapes can only pair with primary ones, so drop those outside the primary shapes' bounds before sorting
+    glm::vec3 primaryMinimum(FLT_MAX);
+    glm::vec3 primaryMaximum(-FLT_MAX);
+    foreach (const Proxy& proxy, _proxies) {
+        if (proxy.index != -1) {
+            primaryMinimum = glm::min(primaryMinimum, proxy.minimum);
+            primaryMaximum = glm::max(primaryMaximum, proxy.maximum);
+        }
+    }
+    int numKept = 0;
+    for (int i = 0; i < _proxies.size(); ++i) {
+        const Proxy& proxy = _proxies.at(i);
+        if (proxy.index != -1 || (glm::all(glm::lessThanEqual(proxy.minimum, primaryMaximum)) &&
+                glm::all(glm::greaterThanEqual(proxy.maximum, primaryMinimum)))) {
+            _proxies[numKept++] = proxy;
+        }
+    }
+    _proxies.resize(numKept);
+
+    // sweep along x: once a proxy starts beyond the end of the current one nothing further along can overlap it
+    std::sort(_proxies.begin(), _proxies.end());
+    int numProxies = _proxies.size();
+    for (int i = 0; i < numProxies; ++i) {
+        const Proxy& proxy = _proxies.at(i);
+        for (int j = i + 1; j < numProxies; ++j) {
+            const Proxy& other = _proxies.at(j);
+            if (other.minimum.x > proxy.maximum.x) {
+                break;
+            }
+            if ((proxy.index == -1 && other.index == -1) ||
+                    other.minimum.y > proxy.maximum.y || proxy.minimum.y > other.maximum.y ||
+                    other.minimum.z > proxy.maximum.z || proxy.minimum.z > other.maximum.z) {
+                continue;
+            }
+            // ShapeCollider reports contacts from shapeA's point of view, so keep the same order the all-pairs loops used
+            const Proxy* first = &proxy;
+            const Proxy* second = &other;
+            if (first->index == -1 || (second->index != -1 && second->order < first->order)) {
+                std::swap(first, second);
+            }
+            ShapePair pair = { first->shape, second->shape, first->index, second->index };
+            _pairs.push_back(pair);
+        }
+    }
+    return _pairs;
+}
+
+void ShapeBroadphase::computeBounds(const Shape* shape, glm::vec3& minimum, glm::vec3& maximum) {
+    Shape::Type type = shape->getType();
+    if (type == PLANE_SHAPE) {
+        minimum = glm::vec3(-FLT_MAX);
+        maximum = glm::vec3(FLT_MAX);
+        return;
+    }
+    glm::vec3 extent;
+    if (type == AACUBE_SHAPE) {
+        extent = glm::vec3(0.5f * static_cast<const AACubeShape*>(shape)->getScale());
+    } else {
+        // spheres, capsules and lists keep their bounding radius about their translation
+        extent = glm::vec3(shape->getBoundingRadius());
+    }
+    const glm::vec3& center = shape->getTranslation();
+    minimum = center - extent;
+    maximum = center + extent;
+}
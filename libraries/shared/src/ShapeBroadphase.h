@@ -0,0 +1,72 @@
+//
+//  ShapeBroadphase.h
+//  libraries/shared/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ShapeBroadphase_h
+#define hifi_ShapeBroadphase_h
+
+#include <glm/glm.hpp>
+#include <QVector>
+
+class Shape;
+
+/// A pair of shapes whose bounding boxes overlap and so need to go through ShapeCollider.
+class ShapePair {
+public:
+    const Shape* shapeA;
+    const Shape* shapeB;
+    int indexA; // index of shapeA among the primary shapes
+    int indexB; // index of shapeB among the primary shapes, or -1 if shapeB is a secondary shape
+};
+
+/// Sweep and prune over the axis aligned bounds of shapes.  Primary shapes are paired with each other and with
+/// secondary shapes, secondary shapes are never paired with each other.  Within a pair the primary shape is always
+/// shapeA, and for two primary shapes the one added first.
+class ShapeBroadphase {
+public:
+    void clear();
+
+    /// \param shape may be NULL, in which case it is ignored
+    /// \param index the caller's index for shape, handed back in ShapePair
+    void addPrimaryShape(const Shape* shape, int index);
+
+    /// \param shape may be NULL, in which case it is ignored
+    void addSecondaryShape(const Shape* shape);
+
+    void addSecondaryShapes(const QVector<Shape*>& shapes);
+
+    /// \return pairs of shapes with overlapping bounds, valid until the next clear() or computePairs()
+    const QVector<ShapePair>& computePairs();
+
+    /// \param shape pointer to shape (cannot be NULL)
+    /// \param[out] minimum corner of the shape's bounds
+    /// \param[out] maximum corner of the shape's bounds
+    /// Shapes without finite bounds (planes) get the largest possible box.
+    static void computeBounds(const Shape* shape, glm::vec3& minimum, glm::vec3& maximum);
+
+private:
+    class Proxy {
+    public:
+        glm::vec3 minimum;
+        glm::vec3 maximum;
+        const Shape* shape;
+        int index; // -1 for secondary shapes
+        int order; // insertion order, used to keep primary pairs in the order they were added
+
+        bool operator<(const Proxy& other) const { return minimum.x < other.minimum.x; }
+    };
+
+    void addProxy(const Shape* shape, int index);
+
+    QVector<Proxy> _proxies;
+    QVector<ShapePair> _pairs;
+};
+
+#endif // hifi_ShapeBroadphase_h
@@ -149,12 +149,11 @@ bool collideShapeWithAACubeLegacy(const Shape* shapeA, const glm::vec3& cubeCent
     return false;
 }
 
-bool sphereVsSphere(const Shape* shapeA, const Shape* shapeB, CollisionList& collisions) {
-    const SphereShape* sphereA = static_cast<const SphereShape*>(shapeA);
-    const SphereShape* sphereB = static_cast<const SphereShape*>(shapeB);
-    glm::vec3 BA = sphereB->getTranslation() - sphereA->getTranslation();
+CollisionInfo* sphereVsSphereHelper(const glm::vec3& centerA, float radiusA, 
+        const glm::vec3& centerB, float radiusB, CollisionList& collisions) {
+    glm::vec3 BA = centerB - centerA;
     float distanceSquared = glm::dot(BA, BA);
-    float totalRadius = sphereA->getRadius() + sphereB->getRadius();
+    float totalRadius = radiusA + radiusB;
     if (distanceSquared < totalRadius * totalRadius) {
         // normalize BA
         float distance = sqrtf(distanceSquared);
@@ -170,81 +169,101 @@ bool sphereVsSphere(const Shape* shapeA, const Shape* shapeB, CollisionList& col
         if (collision) {
             collision->_penetration = BA * (totalRadius - distance);
             // contactPoint is on surface of A
-            collision->_contactPoint = sphereA->getTranslation() + sphereA->getRadius() * BA;
-            collision->_shapeA = shapeA;
-            collision->_shapeB = shapeB;
-            return true;
+            collision->_contactPoint = centerA + radiusA * BA;
+            return collision;
         }
     }
-    return false;
+    return NULL;
 }
 
-bool sphereVsCapsule(const Shape* shapeA, const Shape* shapeB, CollisionList& collisions) {
+bool sphereVsSphere(const Shape* shapeA, const Shape* shapeB, CollisionList& collisions) {
     const SphereShape* sphereA = static_cast<const SphereShape*>(shapeA);
-    const CapsuleShape* capsuleB = static_cast<const CapsuleShape*>(shapeB);
-    // find sphereA's closest approach to axis of capsuleB
-    glm::vec3 BA = capsuleB->getTranslation() - sphereA->getTranslation();
-    glm::vec3 capsuleAxis; 
-    capsuleB->computeNormalizedAxis(capsuleAxis);
+    const SphereShape* sphereB = static_cast<const SphereShape*>(shapeB);
+    CollisionInfo* collision = sphereVsSphereHelper(sphereA->getTranslation(), sphereA->getRadius(), 
+            sphereB->getTranslation(), sphereB->getRadius(), collisions);
+    if (collision) {
+        collision->_shapeA = shapeA;
+        collision->_shapeB = shapeB;
+        return true;
+    }
+    return false;
+}
+
+CollisionInfo* sphereVsCapsuleHelper(const glm::vec3& sphereCenter, float sphereRadius, const glm::vec3& capsuleCenter, 
+        const glm::vec3& capsuleAxis, float capsuleHalfHeight, float capsuleRadius, CollisionList& collisions) {
+    // find sphere's closest approach to axis of capsule
+    glm::vec3 BA = capsuleCenter - sphereCenter;
     float axialDistance = - glm::dot(BA, capsuleAxis);
     float absAxialDistance = fabsf(axialDistance);
-    float totalRadius = sphereA->getRadius() + capsuleB->getRadius();
-    if (absAxialDistance < totalRadius + capsuleB->getHalfHeight()) {
+    float totalRadius = sphereRadius + capsuleRadius;
+    if (absAxialDistance < totalRadius + capsuleHalfHeight) {
         glm::vec3 radialAxis = BA + axialDistance * capsuleAxis; // points from A to axis of B
         float radialDistance2 = glm::length2(radialAxis);
         float totalRadius2 = totalRadius * totalRadius;
         if (radialDistance2 > totalRadius2) {
             // sphere is too far from capsule axis
-            return false;
+            return NULL;
         }
-        if (absAxialDistance > capsuleB->getHalfHeight()) {
-            // sphere hits capsule on a cap --> recompute radialAxis to point from spherA to cap center
+        if (absAxialDistance > capsuleHalfHeight) {
+            // sphere hits capsule on a cap --> recompute radialAxis to point from sphere to cap center
             float sign = (axialDistance > 0.0f) ? 1.0f : -1.0f;
-            radialAxis = BA + (sign * capsuleB->getHalfHeight()) * capsuleAxis;
+            radialAxis = BA + (sign * capsuleHalfHeight) * capsuleAxis;
             radialDistance2 = glm::length2(radialAxis);
             if (radialDistance2 > totalRadius2) {
-                return false;
+                return NULL;
             }
         }
         if (radialDistance2 > EPSILON * EPSILON) {
             CollisionInfo* collision = collisions.getNewCollision();
             if (!collision) {
                 // collisions list is full
-                return false;
+                return NULL;
             }
             // normalize the radialAxis
             float radialDistance = sqrtf(radialDistance2);
             radialAxis /= radialDistance;
             // penetration points from A into B
             collision->_penetration = (totalRadius - radialDistance) * radialAxis; // points from A into B
-            // contactPoint is on surface of sphereA
-            collision->_contactPoint = sphereA->getTranslation() + sphereA->getRadius() * radialAxis;
-            collision->_shapeA = shapeA;
-            collision->_shapeB = shapeB;
-        } else {
-            // A is on B's axis, so the penetration is undefined... 
-            if (absAxialDistance > capsuleB->getHalfHeight()) {
-                // ...for the cylinder case (for now we pretend the collision doesn't exist)
-                return false;
-            }
-            CollisionInfo* collision = collisions.getNewCollision();
-            if (!collision) {
-                // collisions list is full
-                return false;
-            }
-            // ... but still defined for the cap case
-            if (axialDistance < 0.0f) {
-                // we're hitting the start cap, so we negate the capsuleAxis
-                capsuleAxis *= -1;
-            }
-            // penetration points from A into B
-            float sign = (axialDistance > 0.0f) ? -1.0f : 1.0f;
-            collision->_penetration = (sign * (totalRadius + capsuleB->getHalfHeight() - absAxialDistance)) * capsuleAxis;
-            // contactPoint is on surface of sphereA
-            collision->_contactPoint = sphereA->getTranslation() + (sign * sphereA->getRadius()) * capsuleAxis;
-            collision->_shapeA = shapeA;
-            collision->_shapeB = shapeB;
+            // contactPoint is on surface of sphere
+            collision->_contactPoint = sphereCenter + sphereRadius * radialAxis;
+            return collision;
+        }
+        // A is on B's axis, so the penetration is undefined... 
+        if (absAxialDistance > capsuleHalfHeight) {
+            // ...for the cylinder case (for now we pretend the collision doesn't exist)
+            return NULL;
+        }
+        CollisionInfo* collision = collisions.getNewCollision();
+        if (!collision) {
+            // collisions list is full
+            return NULL;
+        }
+        // ... but still defined for the cap case
+        glm::vec3 axis = capsuleAxis;
+        if (axialDistance < 0.0f) {
+            // we're hitting the start cap, so we negate the capsuleAxis
+            axis *= -1;
         }
+        // penetration points from A into B
+        float sign = (axialDistance > 0.0f) ? -1.0f : 1.0f;
+        collision->_penetration = (sign * (totalRadius + capsuleHalfHeight - absAxialDistance)) * axis;
+        // contactPoint is on surface of sphere
+        collision->_contactPoint = sphereCenter + (sign * sphereRadius) * axis;
+        return collision;
+    }
+    return NULL;
+}
+
+bool sphereVsCapsule(const Shape* shapeA, const Shape* shapeB, CollisionList& collisions) {
+    const SphereShape* sphereA = static_cast<const SphereShape*>(shapeA);
+    const CapsuleShape* capsuleB = static_cast<const CapsuleShape*>(shapeB);
+    glm::vec3 capsuleAxis; 
+    capsuleB->computeNormalizedAxis(capsuleAxis);
+    CollisionInfo* collision = sphereVsCapsuleHelper(sphereA->getTranslation(), sphereA->getRadius(), 
+            capsuleB->getTranslation(), capsuleAxis, capsuleB->getHalfHeight(), capsuleB->getRadius(), collisions);
+    if (collision) {
+        collision->_shapeA = shapeA;
+        collision->_shapeB = shapeB;
         return true;
     }
     return false;
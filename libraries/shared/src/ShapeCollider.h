@@ -22,6 +22,9 @@
 class Shape;
 class SphereShape;
 class CapsuleShape;
+class ShapeBatch;
+class SphereBatch;
+class CapsuleBatch;
 
 namespace ShapeCollider {
 
@@ -37,6 +40,38 @@ namespace ShapeCollider {
     bool collideShapeWithShapes(const Shape* shapeA, const QVector<Shape*>& shapes, int startIndex, CollisionList& collisions);
     bool collideShapesWithShapes(const QVector<Shape*>& shapesA, const QVector<Shape*>& shapesB, CollisionList& collisions);
 
+    /// Same collisions as collideShapeWithShapes() over the shapes that were added to the batch, but spheres and
+    /// capsules are tested several at a time straight out of the packed arrays (spheres first, then capsules).
+    /// \param shapeA pointer to shape (cannot be NULL)
+    /// \param batch packed shapes to test against shapeA
+    /// \param[out] collisions where to append collision details
+    /// \return true if shapeA collides with any shape in the batch
+    bool collideShapeWithBatch(const Shape* shapeA, const ShapeBatch& batch, CollisionList& collisions);
+
+    /// \param sphereA pointer to sphere (cannot be NULL)
+    /// \param spheres packed spheres
+    /// \param[out] collisions where to append collision details
+    /// \return true if sphereA collides with any of the spheres
+    bool sphereVsSpheres(const Shape* sphereA, const SphereBatch& spheres, CollisionList& collisions);
+
+    /// \param sphereA pointer to sphere (cannot be NULL)
+    /// \param capsules packed capsules
+    /// \param[out] collisions where to append collision details
+    /// \return true if sphereA collides with any of the capsules
+    bool sphereVsCapsules(const Shape* sphereA, const CapsuleBatch& capsules, CollisionList& collisions);
+
+    /// \param capsuleA pointer to capsule (cannot be NULL)
+    /// \param spheres packed spheres
+    /// \param[out] collisions where to append collision details
+    /// \return true if capsuleA collides with any of the spheres
+    bool capsuleVsSpheres(const Shape* capsuleA, const SphereBatch& spheres, CollisionList& collisions);
+
+    /// \param capsuleA pointer to capsule (cannot be NULL)
+    /// \param capsules packed capsules
+    /// \param[out] collisions where to append collision details
+    /// \return true if capsuleA collides with any of the capsules
+    bool capsuleVsCapsules(const Shape* capsuleA, const CapsuleBatch& capsules, CollisionList& collisions);
+
     /// \param shapeA a pointer to a shape (cannot be NULL)
     /// \param cubeCenter center of cube
     /// \param cubeSide lenght of side of cube
@@ -50,6 +85,28 @@ namespace ShapeCollider {
     /// \return true if shapes collide
     bool sphereVsSphere(const Shape* sphereA, const Shape* sphereB, CollisionList& collisions);
 
+    /// helper function for sphereVsSphere() and the batched sphere tests
+    /// \param centerA center of first sphere
+    /// \param radiusA radius of first sphere
+    /// \param centerB center of second sphere
+    /// \param radiusB radius of second sphere
+    /// \param[out] collisions where to append collision details
+    /// \return valid pointer to CollisionInfo (caller sets its shapes) if spheres overlap or NULL if not
+    CollisionInfo* sphereVsSphereHelper(const glm::vec3& centerA, float radiusA,
+            const glm::vec3& centerB, float radiusB, CollisionList& collisions);
+
+    /// helper function for sphereVsCapsule() and the batched sphere/capsule tests
+    /// \param sphereCenter center of sphere
+    /// \param sphereRadius radius of sphere
+    /// \param capsuleCenter center of capsule
+    /// \param capsuleAxis normalized axis of capsule
+    /// \param capsuleHalfHeight half height of capsule
+    /// \param capsuleRadius radius of capsule
+    /// \param[out] collisions where to append collision details
+    /// \return valid pointer to CollisionInfo (caller sets its shapes) if sphere and capsule overlap or NULL if not
+    CollisionInfo* sphereVsCapsuleHelper(const glm::vec3& sphereCenter, float sphereRadius, const glm::vec3& capsuleCenter,
+            const glm::vec3& capsuleAxis, float capsuleHalfHeight, float capsuleRadius, CollisionList& collisions);
+
     /// \param sphereA pointer to first shape (cannot be NULL)
     /// \param capsuleB pointer to second shape (cannot be NULL)
     /// \param[out] collisions where to append collision details
@@ -0,0 +1,95 @@
+//
+//  BatchTests.cpp
+//  tests/gpu/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDebug>
+
+#include <gpu/Batch.h>
+#include <gpu/NullBackend.h>
+
+#include "BatchTests.h"
+
+using namespace gpu;
+
+static bool verify(const char* name, int actual, int expected) {
+    if (actual != expected) {
+        qDebug() << "FAIL:" << name << "was" << actual << "rather than" << expected;
+        return false;
+    }
+    return true;
+}
+
+static void testCacheSharing() {
+    qDebug() << "testing cache sharing...";
+    BufferPointer first(new Buffer());
+    BufferPointer second(new Buffer());
+    Batch batch;
+    batch.setInputBuffer(0, first, 0, 12);
+    batch.setInputBuffer(1, first, 12, 12);
+    batch.setIndexBuffer(UINT32, second, 0);
+    batch.setInputBuffer(0, first, 0, 12);
+
+    bool pass = verify("cached buffers", batch._buffers._items.size(), 3) &
+        verify("first buffer", batch._buffers.get(batch._params[batch.getCommandOffsets()[1] + 2]._uint) == first, true) &
+        verify("second buffer", batch._buffers.get(batch._params[batch.getCommandOffsets()[2] + 1]._uint) == second, true);
+    if (pass) {
+        qDebug() << "\tpassed";
+    }
+}
+
+static void testRunBatch() {
+    qDebug() << "testing running batches...";
+    Batch inner;
+    inner.setModelTransform(Transform());
+    inner.drawIndexed(TRIANGLES, 3);
+
+    Batch middle;
+    middle.runBatch(inner);
+    middle.draw(TRIANGLES, 3);
+
+    Batch outer;
+    outer.runBatch(middle);
+    outer.runBatch(inner);
+
+    NullBackend backend;
+    backend.renderBatch(outer);
+    const NullBackend::Stats& stats = backend.getStats();
+    bool pass = verify("commands", stats.commands, 8) & verify("draws", stats.draws, 3) &
+        verify("transforms", stats.transforms, 2);
+    if (pass) {
+        qDebug() << "\tpassed";
+    }
+}
+
+static void testRecycling() {
+    qDebug() << "testing storage recycling...";
+    const int DRAWS = 100;
+    uint32 capacity;
+    {
+        Batch batch;
+        for (int i = 0; i < DRAWS; i++) {
+            batch.draw(TRIANGLES, 3);
+        }
+        capacity = batch._params.capacity();
+    }
+    // the next batch on this thread should get the storage of the one just destroyed, emptied
+    Batch batch;
+    bool pass = verify("commands", batch.getCommands().size(), 0) & verify("params", batch._params.size(), 0) &
+        verify("params capacity", batch._params.capacity(), capacity);
+    if (pass) {
+        qDebug() << "\tpassed";
+    }
+}
+
+void BatchTests::runAllTests() {
+    testCacheSharing();
+    testRunBatch();
+    testRecycling();
+}
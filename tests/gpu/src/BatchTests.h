@@ -0,0 +1,20 @@
+//
+//  BatchTests.h
+//  tests/gpu/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BatchTests_h
+#define hifi_BatchTests_h
+
+namespace BatchTests {
+
+    void runAllTests();
+}
+
+#endif // hifi_BatchTests_h
@@ -0,0 +1,141 @@
+//
+//  DrawQueueTests.cpp
+//  tests/gpu/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDebug>
+
+#include <algorithm>
+
+#include <glm/gtx/transform.hpp>
+
+#include <gpu/DrawQueue.h>
+#include <gpu/NullBackend.h>
+
+#include "DrawQueueTests.h"
+
+using namespace gpu;
+
+/// Records a minimal command for each state change and draw, and checks that instances are allocated in order.
+class TestSubmitter : public DrawQueue::Submitter {
+public:
+
+    int programs;
+    int materials;
+    int meshes;
+    uint32 nextInstance;
+    bool instancesInOrder;
+
+    TestSubmitter() : programs(0), materials(0), meshes(0), nextInstance(0), instancesInOrder(true) { }
+
+    virtual void setProgram(Batch& batch, const DrawQueue::Item& item) {
+        programs++;
+        batch._glUseProgram(DrawQueue::getProgram(item.key) + 1);
+    }
+
+    virtual void setMaterial(Batch& batch, const DrawQueue::Item& item) {
+        materials++;
+        batch.setUniformTexture(0, TexturePointer());
+    }
+
+    virtual void setMesh(Batch& batch, const DrawQueue::Item& item) {
+        meshes++;
+        batch.setIndexBuffer(UINT32, BufferPointer(), 0);
+    }
+
+    virtual void draw(Batch& batch, const DrawQueue::Item& item) {
+        batch.drawIndexed(TRIANGLES, 3);
+    }
+
+    virtual void drawInstanced(Batch& batch, const DrawQueue::Item& item, uint32 instanceCount, uint32 firstInstance) {
+        instancesInOrder = instancesInOrder && (firstInstance == nextInstance);
+        nextInstance = firstInstance + instanceCount;
+        batch.drawIndexedInstanced(instanceCount, TRIANGLES, 3, 0, firstInstance);
+    }
+};
+
+static bool verify(const char* name, int actual, int expected) {
+    if (actual != expected) {
+        qDebug() << "FAIL:" << name << "was" << actual << "rather than" << expected;
+        return false;
+    }
+    return true;
+}
+
+static void testKeys() {
+    qDebug() << "testing sort keys...";
+    quint64 key = DrawQueue::makeKey(5, 1000, 123456, 7);
+    bool pass = verify("program", DrawQueue::getProgram(key), 5) & verify("material", DrawQueue::getMaterial(key), 1000) &
+        verify("mesh", DrawQueue::getMesh(key), 123456) & verify("part", DrawQueue::getPart(key), 7);
+
+    // the program should outweigh everything else
+    pass &= verify("ordering", DrawQueue::makeKey(1, 0, 0, 0) > DrawQueue::makeKey(0, 1000, 123456, 7), true);
+    if (pass) {
+        qDebug() << "\tpassed";
+    }
+}
+
+static void testInstancing() {
+    qDebug() << "testing sorting and instancing...";
+
+    // add instances of a few meshes, in an order that would change state with every item if submitted as is
+    const int PROGRAMS = 2;
+    const int MATERIALS = 3;
+    const int MESHES = 4;
+    const int INSTANCES = 5;
+    std::vector<quint64> keys;
+    for (int i = 0; i < INSTANCES; i++) {
+        for (int program = 0; program < PROGRAMS; program++) {
+            for (int material = 0; material < MATERIALS; material++) {
+                for (int mesh = 0; mesh < MESHES; mesh++) {
+                    keys.push_back(DrawQueue::makeKey(program, material, mesh, 0));
+                }
+            }
+        }
+    }
+    std::random_shuffle(keys.begin(), keys.end());
+    DrawQueue queue;
+    for (uint32 i = 0; i < keys.size(); i++) {
+        queue.add(keys.at(i), i, true, glm::translate(glm::vec3((float)i, 0.0f, 0.0f)));
+    }
+
+    // add a few items that can't be instanced, all with the same key
+    const int UNIQUE_ITEMS = 3;
+    for (int i = 0; i < UNIQUE_ITEMS; i++) {
+        queue.add(DrawQueue::makeKey(PROGRAMS, 0, 0, 0), i, false, glm::mat4());
+    }
+
+    Batch batch;
+    TestSubmitter submitter;
+    int draws = queue.submit(batch, submitter);
+
+    NullBackend backend;
+    backend.renderBatch(batch);
+    const NullBackend::Stats& stats = backend.getStats();
+
+    const int RUNS = PROGRAMS * MATERIALS * MESHES;
+    bool pass = verify("draws", draws, RUNS + UNIQUE_ITEMS) & verify("queue emptied", queue.getItemCount(), 0) &
+        verify("program changes", submitter.programs, PROGRAMS + 1) &
+        verify("material changes", submitter.materials, PROGRAMS * MATERIALS + 1) &
+        verify("mesh changes", submitter.meshes, RUNS + 1) &
+        verify("instances in order", submitter.instancesInOrder, true) &
+        verify("program binds", stats.programBinds, PROGRAMS + 1) &
+        verify("texture binds", stats.textureBinds, PROGRAMS * MATERIALS + 1) &
+        verify("backend draws", stats.draws, RUNS + UNIQUE_ITEMS) &
+        verify("instances", stats.instances, RUNS * INSTANCES + UNIQUE_ITEMS) &
+        verify("model transforms", stats.transforms, UNIQUE_ITEMS);
+    if (pass) {
+        qDebug() << "\tpassed";
+    }
+}
+
+void DrawQueueTests::runAllTests() {
+    testKeys();
+    testInstancing();
+}
@@ -0,0 +1,20 @@
+//
+//  DrawQueueTests.h
+//  tests/gpu/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_DrawQueueTests_h
+#define hifi_DrawQueueTests_h
+
+namespace DrawQueueTests {
+
+    void runAllTests();
+}
+
+#endif // hifi_DrawQueueTests_h
@@ -0,0 +1,23 @@
+//
+//  main.cpp
+//  tests/gpu/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <stdio.h>
+
+#include "BatchTests.h"
+#include "DrawQueueTests.h"
+
+int main(int argc, char** argv) {
+    BatchTests::runAllTests();
+    DrawQueueTests::runAllTests();
+    printf("tests complete, press enter to exit\n");
+    getchar();
+    return 0;
+}
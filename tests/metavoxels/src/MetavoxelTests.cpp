@@ -11,11 +11,14 @@
 
 #include <stdlib.h>
 
+#include <QElapsedTimer>
 #include <QScriptValueIterator>
 
 #include <SharedUtil.h>
 
+#include <DataBlockCodec.h>
 #include <MetavoxelMessages.h>
+#include <Spanner.h>
 
 #include "MetavoxelTests.h"
 
@@ -439,6 +442,51 @@ static bool testSerialization(Bitstream::MetadataType metadataType) {
     return false;
 }
 
+static bool testSharedDelta();
+static bool testDataBlockCodecs();
+static bool testParallelTraversal();
+
+static bool testSerializationSpeed() {
+    const int OBJECT_COUNT = 10000;
+    QVector<SharedObjectPointer> objects;
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        objects.append(new TestSharedObjectB(randFloat(), createRandomBytes(), TestSharedObjectB::THIRD_TEST_ENUM,
+            TestSharedObjectB::SECOND_TEST_FLAG));
+    }
+    QElapsedTimer timer;
+    timer.start();
+    QByteArray array;
+    QDataStream outStream(&array, QIODevice::WriteOnly);
+    Bitstream out(outStream);
+    foreach (const SharedObjectPointer& object, objects) {
+        out << object;
+    }
+    out.flush();
+    qint64 writeTime = timer.nsecsElapsed();
+    
+    timer.restart();
+    QDataStream inStream(array);
+    Bitstream in(inStream);
+    QVector<SharedObjectPointer> objectsRead;
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        SharedObjectPointer object;
+        in >> object;
+        objectsRead.append(object);
+    }
+    qint64 readTime = timer.nsecsElapsed();
+    
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        if (!objectsRead.at(i) || !objectsRead.at(i)->equals(objects.at(i))) {
+            qDebug() << "Read/write mismatch" << objects.at(i) << objectsRead.at(i);
+            return true;
+        }
+    }
+    const qint64 NSECS_PER_USEC = 1000;
+    qDebug() << "Wrote" << OBJECT_COUNT << "objects in" << (writeTime / NSECS_PER_USEC) << "us, read in" <<
+        (readTime / NSECS_PER_USEC) << "us";
+    return false;
+}
+
 bool MetavoxelTests::run() {
     DependencyManager::set<LimitedNodeList>();
 
@@ -528,7 +576,8 @@ bool MetavoxelTests::run() {
         qDebug() << "Running serialization test...";
         qDebug();
         
-        if (testSerialization(Bitstream::HASH_METADATA) || testSerialization(Bitstream::FULL_METADATA)) {
+        if (testSerialization(Bitstream::HASH_METADATA) || testSerialization(Bitstream::FULL_METADATA) ||
+                testSerializationSpeed()) {
             return true;
         }
     }
@@ -561,6 +610,33 @@ bool MetavoxelTests::run() {
             "spanner mutations";
     }
     
+    if (test == 0 || test == 6) {
+        qDebug() << "Running shared delta test...";
+        qDebug();
+        
+        if (testSharedDelta()) {
+            return true;
+        }
+    }
+    
+    if (test == 0 || test == 7) {
+        qDebug() << "Running data block codec test...";
+        qDebug();
+        
+        if (testDataBlockCodecs()) {
+            return true;
+        }
+    }
+    
+    if (test == 0 || test == 8) {
+        qDebug() << "Running parallel traversal test...";
+        qDebug();
+        
+        if (testParallelTraversal()) {
+            return true;
+        }
+    }
+    
     qDebug() << "All tests passed!";
     
     return false;
@@ -602,6 +678,254 @@ int RandomVisitor::visit(MetavoxelInfo& info) {
     return STOP_RECURSION;
 }
 
+static bool testSharedDelta() {
+    MetavoxelData reference;
+    RandomVisitor referenceVisitor;
+    reference.guide(referenceVisitor);
+    MetavoxelData data = reference;
+    RandomVisitor visitor;
+    data.guide(visitor);
+    MetavoxelLOD lod(glm::vec3(), 0.5f);
+    
+    // write the delta directly to one stream and through a scratch stream (as the server does when sharing) to another
+    QByteArray directBytes;
+    QDataStream directUnderlying(&directBytes, QIODevice::WriteOnly);
+    Bitstream direct(directUnderlying);
+    QByteArray sharedBytes;
+    QDataStream sharedUnderlying(&sharedBytes, QIODevice::WriteOnly);
+    Bitstream shared(sharedUnderlying);
+    foreach (Bitstream* out, QList<Bitstream*>() << &direct << &shared) {
+        *out << QVariant::fromValue(MetavoxelDeltaMessage());
+        out->persistAndResetWriteMappings();
+        *out << QVariant::fromValue(MetavoxelDeltaMessage()) << true;
+    }
+    data.writeDelta(reference, lod, direct, lod);
+    
+    QByteArray scratchBytes;
+    QDataStream scratchUnderlying(&scratchBytes, QIODevice::WriteOnly);
+    Bitstream scratch(scratchUnderlying);
+    scratch.copyPersistentMappings(shared);
+    if (!scratch.hasSamePersistentWriteMappings(shared) || shared.hasTransientWriteMappings()) {
+        qDebug() << "Scratch stream mappings differ.";
+        return true;
+    }
+    data.writeDelta(reference, lod, scratch, lod);
+    int bits = scratchBytes.size() * BITS_IN_BYTE + scratch.getUnflushedBits();
+    scratch.flush();
+    shared.write(scratchBytes.constData(), bits);
+    shared.setTransientWriteMappings(scratch.getAndResetWriteMappings());
+    
+    // anything written afterwards must continue the transient ids where the delta left them
+    foreach (Bitstream* out, QList<Bitstream*>() << &direct << &shared) {
+        *out << AttributeRegistry::getInstance()->getAttribute("testAttribute") <<
+            AttributeRegistry::getInstance()->getSpannersAttribute() << QVariant::fromValue(lod);
+        out->flush();
+    }
+    if (directBytes != sharedBytes) {
+        qDebug() << "Shared delta differs from direct delta." << directBytes.size() << sharedBytes.size();
+        return true;
+    }
+    Bitstream::WriteMappings directMappings = direct.getAndResetWriteMappings();
+    Bitstream::WriteMappings sharedMappings = shared.getAndResetWriteMappings();
+    if (directMappings.attributeOffsets != sharedMappings.attributeOffsets ||
+            directMappings.typeStreamerOffsets != sharedMappings.typeStreamerOffsets) {
+        qDebug() << "Shared delta mappings differ from direct delta mappings.";
+        return true;
+    }
+    return false;
+}
+
+static const char* getCodecName(DataBlockCodec::Codec codec) {
+    return (codec == DataBlockCodec::LEGACY_CODEC) ? "legacy" : "rANS";
+}
+
+static bool testDataBlockCodecs() {
+    // rolling terrain with some noise and a hole in it, plus a color texture to go with it
+    const int SIZE = 258;
+    const int HOLE_START = 100;
+    const int HOLE_END = 150;
+    QVector<quint16> heights(SIZE * SIZE);
+    QByteArray colors(SIZE * SIZE * DataBlock::COLOR_BYTES, 0);
+    quint16* height = heights.data();
+    uchar* color = (uchar*)colors.data();
+    for (int y = 0; y < SIZE; y++) {
+        for (int x = 0; x < SIZE; x++, height++, color += DataBlock::COLOR_BYTES) {
+            float value = 0.5f + 0.25f * glm::sin(x * 0.03f) * glm::cos(y * 0.05f) + 0.1f * glm::sin(x * 0.13f + y * 0.07f);
+            *height = (x >= HOLE_START && x < HOLE_END && y >= HOLE_START && y < HOLE_END) ? 0 :
+                (quint16)(value * 60000.0f) + randIntInRange(1, 16);
+            color[0] = value * 255.0f;
+            color[1] = 128.0f + 64.0f * glm::sin(y * 0.1f);
+            color[2] = (x + y) / 4 + randIntInRange(0, 7);
+        }
+    }
+    const int OFFSET_X = 3;
+    const int OFFSET_Y = 5;
+    const int ITERATIONS = 10;
+    const qint64 NSECS_PER_USEC = 1000;
+    const float MAX_MEAN_COLOR_ERROR = 4.0f;
+    foreach (DataBlockCodec::Codec codec, QList<DataBlockCodec::Codec>() << DataBlockCodec::LEGACY_CODEC <<
+            DataBlockCodec::RANS_CODEC) {
+        QElapsedTimer timer;
+        timer.start();
+        QByteArray encoded;
+        for (int i = 0; i < ITERATIONS; i++) {
+            encoded = DataBlockCodec::encodeHeights(OFFSET_X, OFFSET_Y, SIZE, SIZE, heights, codec);
+        }
+        qint64 encodeTime = timer.nsecsElapsed() / ITERATIONS;
+        timer.restart();
+        int offsetX, offsetY, width, height;
+        QVector<quint16> decodedHeights;
+        for (int i = 0; i < ITERATIONS; i++) {
+            decodedHeights = DataBlockCodec::decodeHeights(encoded, offsetX, offsetY, width, height);
+        }
+        qint64 decodeTime = timer.nsecsElapsed() / ITERATIONS;
+        if (decodedHeights != heights || offsetX != OFFSET_X || offsetY != OFFSET_Y || width != SIZE || height != SIZE) {
+            qDebug() << "Heights mismatch for codec" << getCodecName(codec);
+            return true;
+        }
+        qDebug() << "Heights with" << getCodecName(codec) << "codec:" << encoded.size() << "bytes, encoded in" <<
+            (encodeTime / NSECS_PER_USEC) << "us, decoded in" << (decodeTime / NSECS_PER_USEC) << "us";
+        
+        timer.restart();
+        for (int i = 0; i < ITERATIONS; i++) {
+            encoded = DataBlockCodec::encodeColors(OFFSET_X, OFFSET_Y, SIZE, SIZE, colors, codec);
+        }
+        encodeTime = timer.nsecsElapsed() / ITERATIONS;
+        timer.restart();
+        QByteArray decodedColors;
+        for (int i = 0; i < ITERATIONS; i++) {
+            decodedColors = DataBlockCodec::decodeColors(encoded, offsetX, offsetY, width, height);
+        }
+        decodeTime = timer.nsecsElapsed() / ITERATIONS;
+        if (decodedColors.size() != colors.size() || offsetX != OFFSET_X || offsetY != OFFSET_Y ||
+                width != SIZE || height != SIZE) {
+            qDebug() << "Colors mismatch for codec" << getCodecName(codec);
+            return true;
+        }
+        float totalError = 0.0f;
+        for (int i = 0; i < colors.size(); i++) {
+            totalError += qAbs((int)(uchar)colors.at(i) - (int)(uchar)decodedColors.at(i));
+        }
+        float meanError = totalError / colors.size();
+        if (meanError > MAX_MEAN_COLOR_ERROR) {
+            qDebug() << "Color error too large for codec" << getCodecName(codec) << meanError;
+            return true;
+        }
+        qDebug() << "Colors with" << getCodecName(codec) << "codec:" << encoded.size() << "bytes, encoded in" <<
+            (encodeTime / NSECS_PER_USEC) << "us, decoded in" << (decodeTime / NSECS_PER_USEC) << "us, mean error" <<
+            meanError;
+    }
+    
+    // blocks without contents keep their headers
+    foreach (DataBlockCodec::Codec codec, QList<DataBlockCodec::Codec>() << DataBlockCodec::LEGACY_CODEC <<
+            DataBlockCodec::RANS_CODEC) {
+        int offsetX, offsetY, width, height;
+        if (!DataBlockCodec::decodeHeights(DataBlockCodec::encodeHeights(OFFSET_X, OFFSET_Y, SIZE, SIZE,
+                QVector<quint16>(), codec), offsetX, offsetY, width, height).isEmpty() || width != SIZE) {
+            qDebug() << "Empty heights mismatch for codec" << getCodecName(codec);
+            return true;
+        }
+    }
+    return false;
+}
+
+class CountVisitor : public SpannerVisitor {
+public:
+    
+    int nodeCount;
+    int spannerCount;
+    
+    CountVisitor(bool parallel);
+    
+    virtual bool isParallel() const;
+    virtual MetavoxelVisitor* createThreadVisitor();
+    virtual void mergeThreadVisitor(MetavoxelVisitor* visitor);
+    
+    virtual bool visit(Spanner* spanner);
+    virtual int visit(MetavoxelInfo& info);
+
+private:
+    
+    bool _parallel;
+};
+
+CountVisitor::CountVisitor(bool parallel) :
+    SpannerVisitor(QVector<AttributePointer>() << AttributeRegistry::getInstance()->getSpannersAttribute()),
+    nodeCount(0),
+    spannerCount(0),
+    _parallel(parallel) {
+}
+
+bool CountVisitor::isParallel() const {
+    return _parallel;
+}
+
+MetavoxelVisitor* CountVisitor::createThreadVisitor() {
+    CountVisitor* visitor = new CountVisitor(*this);
+    visitor->nodeCount = visitor->spannerCount = 0;
+    return visitor;
+}
+
+void CountVisitor::mergeThreadVisitor(MetavoxelVisitor* visitor) {
+    nodeCount += static_cast<CountVisitor*>(visitor)->nodeCount;
+    spannerCount += static_cast<CountVisitor*>(visitor)->spannerCount;
+}
+
+bool CountVisitor::visit(Spanner* spanner) {
+    spannerCount++;
+    return true;
+}
+
+int CountVisitor::visit(MetavoxelInfo& info) {
+    nodeCount++;
+    return SpannerVisitor::visit(info);
+}
+
+static bool testParallelTraversal() {
+    // scatter a bunch of small spheres, deep enough to split the tour into all of its subtrees
+    const int SPHERE_COUNT = 1000;
+    const float MINIMUM_SCALE = 0.005f;
+    const float MAXIMUM_SCALE = 0.02f;
+    AttributePointer attribute = AttributeRegistry::getInstance()->getSpannersAttribute();
+    MetavoxelData data;
+    QList<SharedObjectPointer> spheres;
+    for (int i = 0; i < SPHERE_COUNT; i++) {
+        Sphere* sphere = new Sphere();
+        sphere->setTranslation(glm::vec3(randFloat(), randFloat(), randFloat()));
+        sphere->setScale(randFloatInRange(MINIMUM_SCALE, MAXIMUM_SCALE));
+        spheres.append(sphere);
+        data.insert(attribute, sphere);
+    }
+    
+    CountVisitor serial(false);
+    data.guide(serial);
+    CountVisitor parallel(true);
+    data.guide(parallel);
+    if (parallel.nodeCount != serial.nodeCount || parallel.spannerCount != serial.spannerCount ||
+            serial.spannerCount != SPHERE_COUNT) {
+        qDebug() << "Parallel counts differ from serial." << serial.nodeCount << parallel.nodeCount <<
+            serial.spannerCount << parallel.spannerCount;
+        return true;
+    }
+    
+    // fetching spanners merges the results of the workers
+    Box bounds(glm::vec3(0.25f, 0.25f, 0.25f), glm::vec3(0.75f, 0.75f, 0.75f));
+    QVector<SharedObjectPointer> results;
+    data.getIntersecting(attribute, bounds, results);
+    QSet<SharedObjectPointer> expected;
+    foreach (const SharedObjectPointer& sphere, spheres) {
+        if (static_cast<Spanner*>(sphere.data())->getBounds().intersects(bounds)) {
+            expected.insert(sphere);
+        }
+    }
+    if (results.size() != expected.size() || results.toList().toSet() != expected) {
+        qDebug() << "Parallel fetch mismatch." << results.size() << expected.size();
+        return true;
+    }
+    qDebug() << "Visited" << serial.nodeCount << "nodes and" << serial.spannerCount << "spanners.";
+    return false;
+}
+
 class TestSendRecord : public PacketRecord {
 public:
     
@@ -0,0 +1,160 @@
+//
+//  ResourceCacheTests.cpp
+//  tests/networking/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cassert>
+#include <cstdlib>
+
+#include <QSet>
+
+#include <ResourceCache.h>
+
+#include "ResourceCacheTests.h"
+
+/// A resource that never loads, whose priority is set directly rather than through owners.
+class TestResource : public Resource {
+public:
+    
+    TestResource(float priority) : Resource(QUrl("http://test/"), true) { _loadPriority = priority; }
+    
+    void setPriority(float priority) { _loadPriority = priority; }
+
+protected:
+    
+    virtual void downloadFinished(QNetworkReply* reply) { }
+};
+
+static float randomPriority() {
+    const int PRIORITY_RANGE = 1000;
+    return (float)(rand() % PRIORITY_RANGE);
+}
+
+/// Empties the queue by repeatedly removing the top, checking that the priorities come out highest first.
+static QList<Resource*> drain(ResourceRequestQueue& queue) {
+    QList<Resource*> order;
+    while (!queue.isEmpty()) {
+        Resource* top = queue.top();
+        assert(order.isEmpty() || order.last()->getLoadPriority() >= top->getLoadPriority());
+        order.append(top);
+        queue.remove(top);
+    }
+    return order;
+}
+
+void ResourceCacheTests::runAllTests() {
+    srand(0);
+    queueOrderTest();
+    queueUpdateTest();
+    queueRemoveTest();
+    histogramPercentileTest();
+}
+
+void ResourceCacheTests::queueOrderTest() {
+    ResourceRequestQueue queue;
+    QList<TestResource*> resources;
+    const int RESOURCE_COUNT = 100;
+    for (int i = 0; i < RESOURCE_COUNT; i++) {
+        resources.append(new TestResource(randomPriority()));
+        queue.push(resources.last());
+        assert(queue.size() == i + 1);
+    }
+    QList<Resource*> order = drain(queue);
+    assert(order.size() == RESOURCE_COUNT);
+    qDeleteAll(resources);
+}
+
+void ResourceCacheTests::queueUpdateTest() {
+    ResourceRequestQueue queue;
+    QList<TestResource*> resources;
+    const int RESOURCE_COUNT = 50;
+    for (int i = 0; i < RESOURCE_COUNT; i++) {
+        resources.append(new TestResource(randomPriority()));
+        queue.push(resources.last());
+    }
+    // raising one above the rest brings it to the top
+    const float HIGHEST_PRIORITY = 2000.0f;
+    TestResource* raised = resources.at(RESOURCE_COUNT / 2);
+    raised->setPriority(HIGHEST_PRIORITY);
+    queue.update(raised);
+    assert(queue.top() == raised);
+    
+    // move others both ways
+    for (int i = 0; i < RESOURCE_COUNT; i += 3) {
+        if (resources.at(i) != raised) {
+            resources.at(i)->setPriority(resources.at(i)->getLoadPriority() * ((i % 2 == 0) ? 0.5f : 1.5f));
+            queue.update(resources.at(i));
+        }
+    }
+    
+    // lowering the top hands the place to the next highest
+    raised->setPriority(-1.0f);
+    queue.update(raised);
+    assert(queue.top() != raised);
+    
+    QList<Resource*> order = drain(queue);
+    assert(order.size() == RESOURCE_COUNT);
+    assert(order.last() == raised);
+    qDeleteAll(resources);
+}
+
+void ResourceCacheTests::queueRemoveTest() {
+    ResourceRequestQueue queue;
+    QList<TestResource*> resources;
+    const int RESOURCE_COUNT = 50;
+    for (int i = 0; i < RESOURCE_COUNT; i++) {
+        resources.append(new TestResource(randomPriority()));
+        queue.push(resources.last());
+    }
+    // remove from the middle of the heap (anything but the top), then the last pushed and the top
+    QSet<Resource*> removed;
+    for (int i = 0; i < RESOURCE_COUNT - 1; i += 4) {
+        if (resources.at(i) != queue.top()) {
+            queue.remove(resources.at(i));
+            removed.insert(resources.at(i));
+        }
+    }
+    if (!removed.contains(resources.last())) {
+        queue.remove(resources.last());
+        removed.insert(resources.last());
+    }
+    removed.insert(queue.top());
+    queue.remove(queue.top());
+    assert(queue.size() == RESOURCE_COUNT - removed.size());
+    
+    QList<Resource*> order = drain(queue);
+    assert(order.size() == RESOURCE_COUNT - removed.size());
+    foreach (Resource* resource, order) {
+        assert(!removed.contains(resource));
+    }
+    qDeleteAll(resources);
+}
+
+void ResourceCacheTests::histogramPercentileTest() {
+    PowerOfTwoHistogram histogram;
+    assert(histogram.getTotal() == 0);
+    assert(histogram.getPercentile(0.5f) == 0);
+    
+    // one value each in the buckets [0, 0], [1, 1], [2, 3] and [4, 7]
+    histogram.add(0);
+    histogram.add(1);
+    histogram.add(3);
+    histogram.add(5);
+    assert(histogram.getTotal() == 4);
+    assert(histogram.getPercentile(0.25f) == 0);
+    assert(histogram.getPercentile(0.5f) == 1);
+    assert(histogram.getPercentile(0.75f) == 3);
+    assert(histogram.getPercentile(1.0f) == 7);
+    
+    // the last bucket takes anything too large for the rest
+    PowerOfTwoHistogram large;
+    large.add((qint64)1 << 40);
+    assert(large.getCounts().at(PowerOfTwoHistogram::BUCKET_COUNT - 1) == 1);
+    assert(large.getPercentile(1.0f) == (qint64)1 << (PowerOfTwoHistogram::BUCKET_COUNT - 1));
+}
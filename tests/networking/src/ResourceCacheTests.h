@@ -0,0 +1,25 @@
+//
+//  ResourceCacheTests.h
+//  tests/networking/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ResourceCacheTests_h
+#define hifi_ResourceCacheTests_h
+
+namespace ResourceCacheTests {
+
+    void runAllTests();
+
+    void queueOrderTest();
+    void queueUpdateTest();
+    void queueRemoveTest();
+    void histogramPercentileTest();
+};
+
+#endif // hifi_ResourceCacheTests_h
@@ -15,8 +15,10 @@
 #include <QDebug>
 
 #include <EntityItem.h>
+#include <EntityMotionUpdate.h>
 #include <EntityTree.h>
 #include <EntityTreeElement.h>
+#include <LimitedNodeList.h>
 #include <Octree.h>
 #include <OctreeConstants.h>
 #include <PropertyFlags.h>
@@ -517,8 +519,135 @@ void EntityTests::entityTreeTests(bool verbose) {
     }
 }
 
+void EntityTests::motionUpdateTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    qDebug() << "EntityTests::motionUpdateTests()";
+
+    const int NUM_ENTITIES = 50;
+    QVector<EntityMotionUpdate> updates;
+    for (int i = 0; i < NUM_ENTITIES; ++i) {
+        EntityMotionUpdate update;
+        update.id = QUuid::createUuid();
+        update.position = glm::vec3(10.0f + (float)i, 20.0f, 30.0f - 0.5f * (float)i);
+        update.rotation = glm::normalize(glm::angleAxis(0.1f * (float)i, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f))));
+        update.velocity = glm::vec3(0.25f * (float)i, -9.8f, 1.0f);
+        update.angularVelocity = glm::vec3(0.0f, 0.1f * (float)i, -2.0f);
+        updates.push_back(update);
+    }
+
+    {
+        testsTaken++;
+        QString testName = "pack and unpack motion updates";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        unsigned char buffer[MAX_PACKET_SIZE];
+        QVector<EntityMotionUpdate> unpackedUpdates;
+        int start = 0;
+        bool passed = true;
+        while (start < updates.size()) {
+            int numPacked = 0;
+            int packedBytes = EntityMotionUpdate::packMessage(updates, start, buffer, MAX_PACKET_SIZE, numPacked);
+            int unpackedBytes = EntityMotionUpdate::unpackMessage(buffer, packedBytes, unpackedUpdates);
+            if (numPacked == 0 || unpackedBytes != packedBytes) {
+                passed = false;
+                break;
+            }
+            start += numPacked;
+        }
+
+        // velocities are quantized to 1/64 m/sec and 1/512 rad/sec, rotations to 16 bits per component
+        const float VELOCITY_TOLERANCE = 1.0f / 64.0f;
+        const float ANGULAR_VELOCITY_TOLERANCE = 1.0f / 512.0f;
+        const float MIN_ROTATION_DOT = 0.9999f;
+        passed = passed && unpackedUpdates.size() == updates.size();
+        for (int i = 0; passed && i < updates.size(); ++i) {
+            const EntityMotionUpdate& update = updates.at(i);
+            const EntityMotionUpdate& unpacked = unpackedUpdates.at(i);
+            glm::vec3 velocityError = glm::abs(update.velocity - unpacked.velocity);
+            glm::vec3 angularVelocityError = glm::abs(update.angularVelocity - unpacked.angularVelocity);
+            if (unpacked.id != update.id || unpacked.position != update.position
+                    || fabsf(glm::dot(unpacked.rotation, update.rotation)) < MIN_ROTATION_DOT
+                    || glm::max(velocityError.x, glm::max(velocityError.y, velocityError.z)) > VELOCITY_TOLERANCE
+                    || glm::max(angularVelocityError.x, glm::max(angularVelocityError.y, angularVelocityError.z))
+                        > ANGULAR_VELOCITY_TOLERANCE) {
+                if (verbose) {
+                    qDebug() << "update" << i << "did not survive packing";
+                }
+                passed = false;
+            }
+        }
+
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "apply motion update message to tree";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        EntityTree tree(true);
+        for (int i = 0; i < NUM_ENTITIES; ++i) {
+            EntityItemID entityID(updates.at(i).id);
+            entityID.isKnownID = false; // this is a temporary workaround to allow local tree entities to be added with known IDs
+            EntityItemProperties properties;
+            properties.setPosition(glm::vec3(1.0f));
+            tree.addEntity(entityID, properties);
+        }
+
+        // skip the first entity so we know the others don't depend on it, and add one the tree doesn't know
+        QVector<EntityMotionUpdate> messageUpdates = updates.mid(1);
+        EntityMotionUpdate unknownUpdate;
+        unknownUpdate.id = QUuid::createUuid();
+        messageUpdates.push_back(unknownUpdate);
+
+        unsigned char buffer[MAX_PACKET_SIZE];
+        int numPacked = 0;
+        int packedBytes = EntityMotionUpdate::packMessage(messageUpdates, 0, buffer, MAX_PACKET_SIZE, numPacked);
+        int processedBytes = tree.processMotionUpdateMessage(buffer, packedBytes);
+
+        const float POSITION_TOLERANCE = 0.001f;
+        bool passed = (processedBytes == packedBytes);
+        for (int i = 0; passed && i < NUM_ENTITIES; ++i) {
+            EntityItemID entityID(updates.at(i).id);
+            const EntityItem* entity = tree.findEntityByEntityItemID(entityID);
+            EntityTreeElement* containingElement = tree.getContainingElement(entityID);
+            bool wasInMessage = (i > 0 && i < numPacked + 1);
+            glm::vec3 expectedPosition = wasInMessage ? updates.at(i).position : glm::vec3(1.0f);
+            if (!entity || !containingElement || containingElement != entity->getElement()
+                    || glm::distance(entity->getPositionInMeters(), expectedPosition) > POSITION_TOLERANCE
+                    || !containingElement->getAACube().contains(entity->getPosition())) {
+                if (verbose) {
+                    qDebug() << "entity" << i << "was not moved as expected";
+                }
+                passed = false;
+            }
+        }
+
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+}
 
 void EntityTests::runAllTests(bool verbose) {
     entityTreeTests(verbose);
+    motionUpdateTests(verbose);
 }
 
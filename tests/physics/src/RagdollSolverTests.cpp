@@ -0,0 +1,209 @@
+//
+//  RagdollSolverTests.cpp
+//  tests/physics/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <iostream>
+
+#include <QSet>
+
+#include <DistanceConstraint.h>
+#include <RagdollSolver.h>
+#include <SharedUtil.h>
+#include <VerletPoint.h>
+
+#include "RagdollSolverTests.h"
+
+// about as many joints as an avatar skeleton
+const int NUM_SKELETON_POINTS = 60;
+
+static glm::vec3 randomOffset(float range) {
+    return glm::vec3(randFloatInRange(-range, range), randFloatInRange(-range, range), randFloatInRange(-range, range));
+}
+
+// builds a random tree of bones plus constraints between siblings, the way SkeletonRagdoll does,
+// then scrambles the points so the constraints have work to do
+static void buildSkeleton(QVector<VerletPoint>& points, QVector<DistanceConstraint*>& constraints) {
+    points.fill(VerletPoint(), NUM_SKELETON_POINTS);
+    points[0].initPosition(glm::vec3(0.0f));
+    QVector<int> lastChild(NUM_SKELETON_POINTS, -1);
+    for (int i = 1; i < NUM_SKELETON_POINTS; ++i) {
+        // mostly chains, sometimes a branch
+        int parent = (randFloat() < 0.8f) ? i - 1 : rand() % i;
+        points[i].initPosition(points.at(parent)._position + randomOffset(0.3f));
+        constraints.push_back(new DistanceConstraint(&(points[i]), &(points[parent])));
+        if (lastChild.at(parent) != -1) {
+            constraints.push_back(new DistanceConstraint(&(points[lastChild.at(parent)]), &(points[i])));
+        }
+        lastChild[parent] = i;
+    }
+    for (int i = 0; i < NUM_SKELETON_POINTS; ++i) {
+        points[i].shift(randomOffset(0.05f));
+    }
+}
+
+void RagdollSolverTests::batchesAreIndependent() {
+    QVector<VerletPoint> points;
+    QVector<DistanceConstraint*> constraints;
+    buildSkeleton(points, constraints);
+
+    RagdollSolver solver;
+    solver.build(points, constraints);
+    if (solver.getNumConstraints() != constraints.size()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: solver holds " << solver.getNumConstraints()
+            << " constraints but should hold " << constraints.size() << std::endl;
+    }
+    if (solver.getNumBatches() < 2 || solver.getNumBatches() > 8) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: unexpected number of batches: "
+            << solver.getNumBatches() << std::endl;
+    }
+
+    for (int batch = 0; batch < solver.getNumBatches(); ++batch) {
+        int start = 0;
+        int end = 0;
+        solver.getBatchRange(batch, start, end);
+        QSet<int> usedPoints;
+        for (int i = start; i < end; ++i) {
+            int startPoint = -1;
+            int endPoint = -1;
+            solver.getConstraintPoints(i, startPoint, endPoint);
+            if (usedPoints.contains(startPoint) || usedPoints.contains(endPoint)) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR: batch " << batch
+                    << " has two constraints on the same point" << std::endl;
+            }
+            usedPoints.insert(startPoint);
+            usedPoints.insert(endPoint);
+        }
+    }
+    qDeleteAll(constraints);
+}
+
+void RagdollSolverTests::solverMatchesConstraints() {
+    QVector<VerletPoint> points;
+    QVector<DistanceConstraint*> constraints;
+    buildSkeleton(points, constraints);
+    // two points on top of each other need the fallback direction
+    points[2]._position = points.at(1)._position;
+
+    RagdollSolver solver;
+    solver.build(points, constraints);
+
+    // the solver relaxes in a different order so the points end up elsewhere, but both have to converge
+    const int MAX_ITERATIONS = 100;
+    const float MAX_ERROR = 1.0e-4f;
+    float error = 0.0f;
+    for (int i = 0; i < MAX_ITERATIONS; ++i) {
+        error = solver.enforce(points);
+        if (error < MAX_ERROR) {
+            break;
+        }
+    }
+    if (error > MAX_ERROR) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: solver did not converge, error = " << error << std::endl;
+    }
+    for (int i = 0; i < constraints.size(); ++i) {
+        const DistanceConstraint* constraint = constraints.at(i);
+        float distance = glm::distance(constraint->getStartPoint()->_position, constraint->getEndPoint()->_position);
+        if (fabsf(distance - constraint->getDistance()) > 10.0f * MAX_ERROR) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: constraint " << i << " has length " << distance
+                << " but should have " << constraint->getDistance() << std::endl;
+        }
+    }
+    qDeleteAll(constraints);
+}
+
+void RagdollSolverTests::solverNoticesChanges() {
+    QVector<VerletPoint> points;
+    QVector<DistanceConstraint*> constraints;
+    buildSkeleton(points, constraints);
+
+    RagdollSolver solver;
+    solver.build(points, constraints);
+    if (!solver.isBuiltFor(points, constraints)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: solver does not recognize what it was built for" << std::endl;
+    }
+
+    // swapping a constraint for another keeps the count but changes the set
+    QVector<DistanceConstraint*> swapped = constraints;
+    DistanceConstraint* replacement = new DistanceConstraint(&(points[0]), &(points[NUM_SKELETON_POINTS - 1]));
+    swapped[0] = replacement;
+    if (solver.isBuiltFor(points, swapped)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: solver missed a replaced constraint" << std::endl;
+    }
+
+    // more points, even with the same constraints, means a rebuild; until then enforcing must do nothing
+    QVector<VerletPoint> morePoints = points;
+    morePoints.push_back(VerletPoint());
+    if (solver.isBuiltFor(morePoints, constraints)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: solver missed a change in point count" << std::endl;
+    }
+    if (solver.enforce(morePoints) != 0.0f) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: solver enforced against the wrong points" << std::endl;
+    }
+    delete replacement;
+    qDeleteAll(constraints);
+}
+
+void RagdollSolverTests::measureTimeOfSolver() {
+    const int NUM_RAGDOLLS = 100;
+    const int NUM_ITERATIONS = 20;
+
+    QVector<QVector<VerletPoint> > ragdollPoints(NUM_RAGDOLLS);
+    QVector<QVector<DistanceConstraint*> > ragdollConstraints(NUM_RAGDOLLS);
+    QVector<RagdollSolver> solvers(NUM_RAGDOLLS);
+    for (int i = 0; i < NUM_RAGDOLLS; ++i) {
+        buildSkeleton(ragdollPoints[i], ragdollConstraints[i]);
+        solvers[i].build(ragdollPoints.at(i), ragdollConstraints.at(i));
+    }
+    // copy element by element, an implicitly shared copy would detach and move the points out from under the constraints
+    QVector<QVector<VerletPoint> > startPoints(NUM_RAGDOLLS);
+    for (int i = 0; i < NUM_RAGDOLLS; ++i) {
+        for (int j = 0; j < NUM_SKELETON_POINTS; ++j) {
+            startPoints[i].push_back(ragdollPoints.at(i).at(j));
+        }
+    }
+
+    quint64 startTime = usecTimestampNow();
+    for (int i = 0; i < NUM_RAGDOLLS; ++i) {
+        QVector<DistanceConstraint*>& constraints = ragdollConstraints[i];
+        for (int j = 0; j < NUM_ITERATIONS; ++j) {
+            for (int k = 0; k < constraints.size(); ++k) {
+                constraints[k]->enforce();
+            }
+        }
+    }
+    quint64 constraintTime = usecTimestampNow() - startTime;
+
+    for (int i = 0; i < NUM_RAGDOLLS; ++i) {
+        for (int j = 0; j < NUM_SKELETON_POINTS; ++j) {
+            ragdollPoints[i][j] = startPoints.at(i).at(j);
+        }
+    }
+    startTime = usecTimestampNow();
+    for (int i = 0; i < NUM_RAGDOLLS; ++i) {
+        for (int j = 0; j < NUM_ITERATIONS; ++j) {
+            solvers[i].enforce(ragdollPoints[i]);
+        }
+    }
+    quint64 solverTime = usecTimestampNow() - startTime;
+
+    std::cout << NUM_RAGDOLLS << " ragdolls, " << NUM_ITERATIONS << " iterations: constraints " << constraintTime
+        << " usec, solver " << solverTime << " usec" << std::endl;
+
+    for (int i = 0; i < NUM_RAGDOLLS; ++i) {
+        qDeleteAll(ragdollConstraints.at(i));
+    }
+}
+
+void RagdollSolverTests::runAllTests() {
+    batchesAreIndependent();
+    solverMatchesConstraints();
+    solverNoticesChanges();
+    measureTimeOfSolver();
+}
@@ -0,0 +1,25 @@
+//
+//  RagdollSolverTests.h
+//  tests/physics/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_RagdollSolverTests_h
+#define hifi_RagdollSolverTests_h
+
+namespace RagdollSolverTests {
+    void batchesAreIndependent();
+    void solverMatchesConstraints();
+    void solverNoticesChanges();
+
+    void measureTimeOfSolver();
+
+    void runAllTests(); 
+}
+
+#endif // hifi_RagdollSolverTests_h
@@ -0,0 +1,219 @@
+//
+//  ShapeBroadphaseTests.cpp
+//  tests/physics/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <iostream>
+#include <math.h>
+
+#include <QPair>
+#include <QSet>
+
+#include <AACubeShape.h>
+#include <CapsuleShape.h>
+#include <CollisionInfo.h>
+#include <PlaneShape.h>
+#include <ShapeBroadphase.h>
+#include <ShapeCollider.h>
+#include <SharedUtil.h>
+#include <SphereShape.h>
+
+#include "ShapeBroadphaseTests.h"
+
+typedef QPair<const Shape*, const Shape*> OrderedShapePair;
+
+static glm::vec3 randomPosition(float range) {
+    return glm::vec3(randFloatInRange(-range, range), randFloatInRange(-range, range), randFloatInRange(-range, range));
+}
+
+static Shape* createRandomShape(float range) {
+    const float MIN_SIZE = 0.05f;
+    const float MAX_SIZE = 0.5f;
+    int type = rand() % 3;
+    if (type == 0) {
+        return new SphereShape(randFloatInRange(MIN_SIZE, MAX_SIZE), randomPosition(range));
+    } else if (type == 1) {
+        glm::vec3 start = randomPosition(range);
+        glm::vec3 end = start + randomPosition(MAX_SIZE);
+        return new CapsuleShape(randFloatInRange(MIN_SIZE, MAX_SIZE), start, end);
+    }
+    return new AACubeShape(randFloatInRange(MIN_SIZE, 2.0f * MAX_SIZE), randomPosition(range));
+}
+
+static void createRandomShapes(QVector<Shape*>& shapes, int numShapes, float range) {
+    for (int i = 0; i < numShapes; ++i) {
+        shapes.push_back(createRandomShape(range));
+    }
+}
+
+static void collectCollidingPairs(const Shape* shapeA, const Shape* shapeB, QSet<OrderedShapePair>& pairs) {
+    CollisionList collisions(16);
+    if (ShapeCollider::collideShapes(shapeA, shapeB, collisions)) {
+        pairs.insert(OrderedShapePair(shapeA, shapeB));
+    }
+}
+
+void ShapeBroadphaseTests::pairsMatchAllPairs() {
+    const float RANGE = 2.0f;
+    QVector<Shape*> primaryShapes;
+    QVector<Shape*> secondaryShapes;
+    createRandomShapes(primaryShapes, 30, RANGE);
+    createRandomShapes(secondaryShapes, 200, RANGE);
+    // planes have no finite bounds and must still reach the narrowphase
+    secondaryShapes.push_back(new PlaneShape(glm::vec4(0.0f, 1.0f, 0.0f, RANGE)));
+    primaryShapes.push_back(NULL);
+
+    // all pairs, the way PhysicsSimulation used to do it
+    QSet<OrderedShapePair> expectedPairs;
+    int numPrimary = primaryShapes.size();
+    for (int i = 0; i < numPrimary; ++i) {
+        if (!primaryShapes.at(i)) {
+            continue;
+        }
+        for (int j = i + 1; j < numPrimary; ++j) {
+            if (primaryShapes.at(j)) {
+                collectCollidingPairs(primaryShapes.at(i), primaryShapes.at(j), expectedPairs);
+            }
+        }
+        for (int j = 0; j < secondaryShapes.size(); ++j) {
+            collectCollidingPairs(primaryShapes.at(i), secondaryShapes.at(j), expectedPairs);
+        }
+    }
+
+    ShapeBroadphase broadphase;
+    for (int i = 0; i < numPrimary; ++i) {
+        broadphase.addPrimaryShape(primaryShapes.at(i), i);
+    }
+    broadphase.addSecondaryShapes(secondaryShapes);
+    const QVector<ShapePair>& candidates = broadphase.computePairs();
+
+    QSet<OrderedShapePair> foundPairs;
+    for (int i = 0; i < candidates.size(); ++i) {
+        const ShapePair& pair = candidates.at(i);
+        if (pair.indexB == -1 && primaryShapes.contains(const_cast<Shape*>(pair.shapeB))) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: primary shape reported as secondary" << std::endl;
+        }
+        collectCollidingPairs(pair.shapeA, pair.shapeB, foundPairs);
+    }
+
+    if (foundPairs != expectedPairs) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: broadphase found " << foundPairs.size() << " colliding pairs"
+            << " but all pairs found " << expectedPairs.size() << std::endl;
+    }
+    if (candidates.size() >= numPrimary * (numPrimary - 1) / 2 + numPrimary * secondaryShapes.size()) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: broadphase did not prune any pairs" << std::endl;
+    }
+
+    qDeleteAll(primaryShapes);
+    qDeleteAll(secondaryShapes);
+}
+
+void ShapeBroadphaseTests::primaryShapeComesFirst() {
+    SphereShape primaryA(1.0f, glm::vec3(0.0f));
+    SphereShape primaryB(1.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+    SphereShape secondary(1.0f, glm::vec3(-1.0f, 0.0f, 0.0f));
+
+    // add in an order that sorts the secondary shape and the later primary shape first along the sweep axis
+    ShapeBroadphase broadphase;
+    broadphase.addPrimaryShape(&primaryB, 0);
+    broadphase.addPrimaryShape(&primaryA, 1);
+    broadphase.addSecondaryShape(&secondary);
+    const QVector<ShapePair>& pairs = broadphase.computePairs();
+
+    if (pairs.size() != 3) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: expected 3 pairs but found " << pairs.size() << std::endl;
+    }
+    for (int i = 0; i < pairs.size(); ++i) {
+        const ShapePair& pair = pairs.at(i);
+        if (pair.shapeA == &secondary) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: secondary shape should never be shapeA" << std::endl;
+        }
+        if (pair.indexB != -1 && pair.indexA > pair.indexB) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: primary pair out of order: " << pair.indexA << " " << pair.indexB << std::endl;
+        }
+        if ((pair.shapeB == &secondary) != (pair.indexB == -1)) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: secondary shape should have index -1" << std::endl;
+        }
+    }
+}
+
+void ShapeBroadphaseTests::measureBroadphaseScaling() {
+    // a ragdoll sized cluster of shapes walking through progressively busier scenes of constant density
+    const int NUM_RAGDOLL_SHAPES = 20;
+    const float RAGDOLL_RANGE = 1.0f;
+    const int NUM_STEPS = 20;
+    const float SHAPES_PER_CUBIC_METER = 2.0f;
+
+    QVector<Shape*> ragdollShapes;
+    createRandomShapes(ragdollShapes, NUM_RAGDOLL_SHAPES, RAGDOLL_RANGE);
+
+    std::cout << "broadphase vs all pairs, " << NUM_RAGDOLL_SHAPES << " ragdoll shapes, " << NUM_STEPS << " steps:" << std::endl;
+    for (int numOtherShapes = 64; numOtherShapes <= 4096; numOtherShapes *= 4) {
+        float range = 0.5f * powf(numOtherShapes / SHAPES_PER_CUBIC_METER, 1.0f / 3.0f);
+        QVector<Shape*> otherShapes;
+        createRandomShapes(otherShapes, numOtherShapes, range);
+
+        CollisionList collisions(256);
+        int allPairsCollisions = 0;
+        quint64 startTime = usecTimestampNow();
+        for (int step = 0; step < NUM_STEPS; ++step) {
+            collisions.clear();
+            for (int i = 0; i < NUM_RAGDOLL_SHAPES; ++i) {
+                ShapeCollider::collideShapeWithShapes(ragdollShapes.at(i), ragdollShapes, i + 1, collisions);
+            }
+            ShapeCollider::collideShapesWithShapes(ragdollShapes, otherShapes, collisions);
+            allPairsCollisions += collisions.size();
+        }
+        quint64 allPairsTime = usecTimestampNow() - startTime;
+
+        ShapeBroadphase broadphase;
+        int broadphaseCollisions = 0;
+        startTime = usecTimestampNow();
+        for (int step = 0; step < NUM_STEPS; ++step) {
+            collisions.clear();
+            broadphase.clear();
+            for (int i = 0; i < NUM_RAGDOLL_SHAPES; ++i) {
+                broadphase.addPrimaryShape(ragdollShapes.at(i), i);
+            }
+            broadphase.addSecondaryShapes(otherShapes);
+            const QVector<ShapePair>& pairs = broadphase.computePairs();
+            for (int i = 0; i < pairs.size() && !collisions.isFull(); ++i) {
+                ShapeCollider::collideShapes(pairs.at(i).shapeA, pairs.at(i).shapeB, collisions);
+            }
+            broadphaseCollisions += collisions.size();
+        }
+        quint64 broadphaseTime = usecTimestampNow() - startTime;
+
+        if (broadphaseCollisions != allPairsCollisions) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: broadphase found " << broadphaseCollisions << " collisions"
+                << " but all pairs found " << allPairsCollisions << std::endl;
+        }
+        std::cout << "    " << numOtherShapes << " other shapes: all pairs " << allPairsTime << " usec, broadphase "
+            << broadphaseTime << " usec" << std::endl;
+
+        qDeleteAll(otherShapes);
+    }
+    qDeleteAll(ragdollShapes);
+}
+
+void ShapeBroadphaseTests::runAllTests() {
+    ShapeCollider::initDispatchTable();
+
+    pairsMatchAllPairs();
+    primaryShapeComesFirst();
+    measureBroadphaseScaling();
+}
@@ -0,0 +1,23 @@
+//
+//  ShapeBroadphaseTests.h
+//  tests/physics/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ShapeBroadphaseTests_h
+#define hifi_ShapeBroadphaseTests_h
+
+namespace ShapeBroadphaseTests {
+    void pairsMatchAllPairs();
+    void primaryShapeComesFirst();
+    void measureBroadphaseScaling();
+
+    void runAllTests();
+}
+
+#endif // hifi_ShapeBroadphaseTests_h
@@ -13,6 +13,8 @@
 #include <iostream>
 #include <math.h>
 
+#include <QHash>
+
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
 
@@ -20,6 +22,7 @@
 #include <CapsuleShape.h>
 #include <CollisionInfo.h>
 #include <PlaneShape.h>
+#include <ShapeBatch.h>
 #include <ShapeCollider.h>
 #include <SharedUtil.h>
 #include <SphereShape.h>
@@ -2477,6 +2480,112 @@ void ShapeColliderTests::rayMissesAACube() {
 
 }
 
+static glm::vec3 randomPoint(float range) {
+    return glm::vec3(randFloatInRange(-range, range), randFloatInRange(-range, range), randFloatInRange(-range, range));
+}
+
+static void createRandomSpheresAndCapsules(QVector<Shape*>& shapes, int numShapes, float range) {
+    const float MIN_RADIUS = 0.05f;
+    const float MAX_RADIUS = 0.5f;
+    for (int i = 0; i < numShapes; ++i) {
+        glm::vec3 start = randomPoint(range);
+        if (randFloat() > 0.5f) {
+            shapes.push_back(new SphereShape(randFloatInRange(MIN_RADIUS, MAX_RADIUS), start));
+        } else {
+            shapes.push_back(new CapsuleShape(randFloatInRange(MIN_RADIUS, MAX_RADIUS), start, start + randomPoint(1.0f)));
+        }
+    }
+}
+
+static void compareCollisionLists(CollisionList& scalarCollisions, CollisionList& batchedCollisions, int line) {
+    if (batchedCollisions.size() != scalarCollisions.size()) {
+        std::cout << __FILE__ << ":" << line << " ERROR: batched tests found " << batchedCollisions.size()
+            << " collisions but scalar tests found " << scalarCollisions.size() << std::endl;
+        return;
+    }
+    // the batch tests spheres before capsules so the order may differ, match them up by shape pair
+    QHash<quint64, CollisionInfo*> scalarPairs;
+    for (int i = 0; i < scalarCollisions.size(); ++i) {
+        scalarPairs.insert(scalarCollisions.getCollision(i)->getShapePairKey(), scalarCollisions.getCollision(i));
+    }
+    for (int i = 0; i < batchedCollisions.size(); ++i) {
+        CollisionInfo* batched = batchedCollisions.getCollision(i);
+        CollisionInfo* scalar = scalarPairs.value(batched->getShapePairKey());
+        if (!scalar) {
+            std::cout << __FILE__ << ":" << line << " ERROR: batched collision " << i
+                << " has no scalar counterpart" << std::endl;
+            continue;
+        }
+        if (batched->_shapeA != scalar->_shapeA || batched->_shapeB != scalar->_shapeB) {
+            std::cout << __FILE__ << ":" << line << " ERROR: batched collision " << i
+                << " has its shapes swapped" << std::endl;
+        }
+        if (glm::distance(batched->_penetration, scalar->_penetration) > EPSILON) {
+            std::cout << __FILE__ << ":" << line << " ERROR: batched penetration = " << batched->_penetration
+                << " but scalar penetration = " << scalar->_penetration << std::endl;
+        }
+        if (glm::distance(batched->_contactPoint, scalar->_contactPoint) > EPSILON) {
+            std::cout << __FILE__ << ":" << line << " ERROR: batched contactPoint = " << batched->_contactPoint
+                << " but scalar contactPoint = " << scalar->_contactPoint << std::endl;
+        }
+    }
+}
+
+void ShapeColliderTests::batchedCollisionsMatchScalar() {
+    const float RANGE = 3.0f;
+    QVector<Shape*> shapes;
+    // an odd count leaves a partial batch at the end
+    createRandomSpheresAndCapsules(shapes, 301, RANGE);
+    // degenerate cases: a sphere right on top of a capsule axis and one centered on another sphere
+    CapsuleShape* capsule = new CapsuleShape(0.2f, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    shapes.push_back(capsule);
+    shapes.push_back(new SphereShape(0.3f, capsule->getTranslation()));
+    // shapes that can't be packed still go through the regular dispatch
+    shapes.push_back(new PlaneShape(glm::vec4(0.0f, 1.0f, 0.0f, RANGE)));
+    shapes.push_back(NULL);
+
+    ShapeBatch batch;
+    batch.addShapes(shapes);
+    if (batch.size() != shapes.size() - 1) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: batch holds " << batch.size()
+            << " shapes but should hold " << (shapes.size() - 1) << std::endl;
+    }
+
+    QVector<Shape*> queryShapes;
+    createRandomSpheresAndCapsules(queryShapes, 40, RANGE);
+    queryShapes.push_back(new SphereShape(0.1f, capsule->getTranslation()));
+    queryShapes.push_back(new CapsuleShape(0.1f, 0.5f, capsule->getTranslation(), glm::quat()));
+    queryShapes.push_back(new AACubeShape(1.0f, glm::vec3(0.5f)));
+
+    CollisionList scalarCollisions(512);
+    CollisionList batchedCollisions(512);
+    for (int i = 0; i < queryShapes.size(); ++i) {
+        scalarCollisions.clear();
+        batchedCollisions.clear();
+        bool scalarHit = ShapeCollider::collideShapeWithShapes(queryShapes.at(i), shapes, 0, scalarCollisions);
+        bool batchedHit = ShapeCollider::collideShapeWithBatch(queryShapes.at(i), batch, batchedCollisions);
+        if (scalarHit != batchedHit) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: query shape " << i << " batched hit = " << batchedHit
+                << " but scalar hit = " << scalarHit << std::endl;
+        }
+        compareCollisionLists(scalarCollisions, batchedCollisions, __LINE__);
+    }
+
+    // a full list stops both of them at the same count
+    CollisionList smallScalarCollisions(2);
+    CollisionList smallBatchedCollisions(2);
+    SphereShape bigSphere(RANGE, glm::vec3(0.0f));
+    ShapeCollider::collideShapeWithShapes(&bigSphere, shapes, 0, smallScalarCollisions);
+    ShapeCollider::collideShapeWithBatch(&bigSphere, batch, smallBatchedCollisions);
+    if (!smallBatchedCollisions.isFull() || !smallScalarCollisions.isFull()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: batched collisions should fill the list like scalar ones: "
+            << smallBatchedCollisions.size() << " vs " << smallScalarCollisions.size() << std::endl;
+    }
+
+    qDeleteAll(shapes);
+    qDeleteAll(queryShapes);
+}
+
 void ShapeColliderTests::measureTimeOfCollisionDispatch() {
     /* KEEP for future manual testing
     // create two non-colliding spheres
@@ -2507,6 +2616,59 @@ void ShapeColliderTests::measureTimeOfCollisionDispatch() {
     */
 }
 
+void ShapeColliderTests::measureTimeOfBatchedCollisions() {
+    // a handful of ragdoll shapes against a crowd of others, the batch refilled every step as if everything moved
+    const int NUM_QUERY_SHAPES = 20;
+    const int NUM_STEPS = 100;
+    const float RANGE = 10.0f;
+
+    QVector<Shape*> queryShapes;
+    createRandomSpheresAndCapsules(queryShapes, NUM_QUERY_SHAPES, 1.0f);
+
+    std::cout << "batched vs scalar narrowphase, " << NUM_QUERY_SHAPES << " shapes, " << NUM_STEPS << " steps:" << std::endl;
+    for (int numShapes = 256; numShapes <= 4096; numShapes *= 4) {
+        QVector<Shape*> shapes;
+        createRandomSpheresAndCapsules(shapes, numShapes, RANGE);
+        CollisionList collisions(1024);
+
+        int scalarCollisions = 0;
+        quint64 startTime = usecTimestampNow();
+        for (int step = 0; step < NUM_STEPS; ++step) {
+            collisions.clear();
+            for (int i = 0; i < NUM_QUERY_SHAPES; ++i) {
+                ShapeCollider::collideShapeWithShapes(queryShapes.at(i), shapes, 0, collisions);
+            }
+            scalarCollisions += collisions.size();
+        }
+        quint64 scalarTime = usecTimestampNow() - startTime;
+
+        ShapeBatch batch;
+        int batchedCollisions = 0;
+        startTime = usecTimestampNow();
+        for (int step = 0; step < NUM_STEPS; ++step) {
+            collisions.clear();
+            batch.clear();
+            batch.addShapes(shapes);
+            for (int i = 0; i < NUM_QUERY_SHAPES; ++i) {
+                ShapeCollider::collideShapeWithBatch(queryShapes.at(i), batch, collisions);
+            }
+            batchedCollisions += collisions.size();
+        }
+        quint64 batchedTime = usecTimestampNow() - startTime;
+
+        if (batchedCollisions != scalarCollisions) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: batched tests found " << batchedCollisions
+                << " collisions but scalar tests found " << scalarCollisions << std::endl;
+        }
+        int numPairs = NUM_STEPS * NUM_QUERY_SHAPES * numShapes;
+        std::cout << "    " << numShapes << " shapes: scalar " << scalarTime << " usec, batched " << batchedTime
+            << " usec (" << (batchedTime > 0 ? numPairs / batchedTime : 0) << " pairs/usec)" << std::endl;
+
+        qDeleteAll(shapes);
+    }
+    qDeleteAll(queryShapes);
+}
+
 void ShapeColliderTests::runAllTests() {
     ShapeCollider::initDispatchTable();
 
@@ -2539,4 +2701,7 @@ void ShapeColliderTests::runAllTests() {
 
     rayHitsAACube();
     rayMissesAACube();
+
+    batchedCollisionsMatchScalar();
+    measureTimeOfBatchedCollisions();
 }
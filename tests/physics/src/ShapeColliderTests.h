@@ -41,7 +41,10 @@ namespace ShapeColliderTests {
     void rayHitsAACube();
     void rayMissesAACube();
 
+    void batchedCollisionsMatchScalar();
+
     void measureTimeOfCollisionDispatch();
+    void measureTimeOfBatchedCollisions();
 
     void runAllTests(); 
 }
@@ -8,6 +8,8 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include "RagdollSolverTests.h"
+#include "ShapeBroadphaseTests.h"
 #include "ShapeColliderTests.h"
 #include "VerletShapeTests.h"
 #include "ShapeInfoTests.h"
@@ -16,7 +18,9 @@
 
 int main(int argc, char** argv) {
     ShapeColliderTests::runAllTests();
+    ShapeBroadphaseTests::runAllTests();
     VerletShapeTests::runAllTests();
+    RagdollSolverTests::runAllTests();
     ShapeInfoTests::runAllTests();
     ShapeManagerTests::runAllTests();
     BulletUtilTests::runAllTests();
@@ -0,0 +1,91 @@
+//
+//  OcclusionBufferTests.cpp
+//  tests/shared/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDebug>
+
+#include <glm/gtx/transform.hpp>
+
+#include <AABox.h>
+#include <OcclusionBuffer.h>
+
+#include "OcclusionBufferTests.h"
+
+static bool verify(const char* name, bool actual, bool expected) {
+    if (actual != expected) {
+        qDebug() << "FAIL:" << name << "was" << actual << "rather than" << expected;
+        return false;
+    }
+    return true;
+}
+
+/// Makes a box of the given dimensions centered on the given point.
+static AABox makeBox(const glm::vec3& center, const glm::vec3& dimensions) {
+    return AABox(center - dimensions * 0.5f, dimensions);
+}
+
+// a camera at the origin looking down -z, with a field of view of about ninety degrees by fifty
+static glm::mat4 getViewProjection() {
+    return glm::frustum(-0.1f, 0.1f, -0.05f, 0.05f, 0.1f, 1000.0f);
+}
+
+static void testWall() {
+    qDebug() << "testing a wall...";
+    OcclusionBuffer buffer;
+    buffer.begin(getViewProjection());
+    bool pass = verify("nothing occluded without occluders", buffer.isOccluded(makeBox(glm::vec3(0.0f, 0.0f, -20.0f),
+        glm::vec3(1.0f))), false);
+
+    // a wall four meters across, its front face nine and a half meters away
+    glm::vec3 wallCenter(0.0f, 0.0f, -10.0f);
+    glm::vec3 wallDimensions(4.0f, 4.0f, 1.0f);
+    buffer.addOccluderBox(glm::translate(wallCenter) * glm::scale(wallDimensions));
+
+    float centerDepth = buffer.getDepth(OcclusionBuffer::WIDTH / 2, OcclusionBuffer::HEIGHT / 2);
+    pass &= verify("front face depth", glm::abs(centerDepth - 1.0f / 9.5f) < 0.0001f, true);
+    pass &= verify("uncovered depth", buffer.getDepth(0, 0) == 0.0f, true);
+    pass &= verify("wall", buffer.isOccluded(makeBox(wallCenter, wallDimensions)), false);
+    pass &= verify("behind", buffer.isOccluded(makeBox(glm::vec3(0.0f, 0.0f, -20.0f), glm::vec3(1.0f))), true);
+    pass &= verify("in front", buffer.isOccluded(makeBox(glm::vec3(0.0f, 0.0f, -5.0f), glm::vec3(1.0f))), false);
+    pass &= verify("beside", buffer.isOccluded(makeBox(glm::vec3(6.0f, 0.0f, -20.0f), glm::vec3(1.0f))), false);
+    pass &= verify("across the edge", buffer.isOccluded(makeBox(glm::vec3(4.0f, 0.0f, -20.0f), glm::vec3(1.0f))), false);
+    pass &= verify("intersecting", buffer.isOccluded(makeBox(glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(1.0f, 1.0f, 2.0f))),
+        false);
+    pass &= verify("behind the camera", buffer.isOccluded(makeBox(glm::vec3(0.0f, 0.0f, 20.0f), glm::vec3(1.0f))), false);
+
+    // starting over clears the occluders
+    buffer.begin(getViewProjection());
+    pass &= verify("cleared", buffer.isOccluded(makeBox(glm::vec3(0.0f, 0.0f, -20.0f), glm::vec3(1.0f))), false);
+    if (pass) {
+        qDebug() << "\tpassed";
+    }
+}
+
+static void testNearClipping() {
+    qDebug() << "testing a floor crossing the near plane...";
+    OcclusionBuffer buffer;
+    buffer.begin(getViewProjection());
+
+    // a floor two meters below, reaching from behind the camera to well in front of it
+    buffer.addOccluderBox(glm::translate(glm::vec3(0.0f, -2.5f, -40.0f)) * glm::scale(glm::vec3(100.0f, 1.0f, 100.0f)));
+
+    bool pass = verify("under the floor", buffer.isOccluded(makeBox(glm::vec3(0.0f, -5.0f, -30.0f), glm::vec3(1.0f))),
+        true);
+    pass &= verify("on the floor", buffer.isOccluded(makeBox(glm::vec3(0.0f, -1.5f, -30.0f), glm::vec3(1.0f))), false);
+    pass &= verify("above the floor", buffer.isOccluded(makeBox(glm::vec3(0.0f, 0.0f, -30.0f), glm::vec3(1.0f))), false);
+    if (pass) {
+        qDebug() << "\tpassed";
+    }
+}
+
+void OcclusionBufferTests::runAllTests() {
+    testWall();
+    testNearClipping();
+}
@@ -0,0 +1,215 @@
+//
+//  main.cpp
+//  tools/batch-bench/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cstdlib>
+#include <new>
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <gpu/Batch.h>
+#include <gpu/NullBackend.h>
+
+using namespace gpu;
+
+/// The number of heap allocations made by any thread since startup.
+static QAtomicInt allocationCount;
+
+void* operator new(size_t size) {
+    allocationCount.fetchAndAddRelaxed(1);
+    void* pointer = malloc(size);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) throw() {
+    free(pointer);
+}
+
+void operator delete[](void* pointer) throw() {
+    free(pointer);
+}
+
+/// The state shared by the recorded draws.
+class Scene {
+public:
+    BufferPointer vertices;
+    BufferPointer indices;
+    TexturePointer texture;
+};
+
+const int COMMANDS_PER_DRAW = 6;
+
+/// Records the commands that a typical mesh part draw records.
+static void recordDraws(Batch& batch, const Scene& scene, int first, int count) {
+    const Offset NORMAL_OFFSET = 1024;
+    const int INDICES_PER_DRAW = 36;
+    for (int i = first; i < first + count; i++) {
+        Transform model;
+        model.setTranslation(glm::vec3((float)i, 0.0f, 0.0f));
+        batch.setModelTransform(model);
+        batch.setInputBuffer(0, scene.vertices, 0, sizeof(glm::vec3));
+        batch.setInputBuffer(1, scene.vertices, NORMAL_OFFSET, sizeof(glm::vec3));
+        batch.setIndexBuffer(UINT32, scene.indices, 0);
+        batch.setUniformTexture(0, scene.texture);
+        batch.drawIndexed(TRIANGLES, INDICES_PER_DRAW);
+    }
+}
+
+/// Records a share of the draws into its own batch on a worker thread.
+class Recorder : public QRunnable {
+public:
+
+    Recorder(const Scene& scene, QSemaphore& finished) : _scene(scene), _finished(finished), _first(0), _count(0) {
+        setAutoDelete(false);
+    }
+
+    Batch& getBatch() { return _batch; }
+
+    void setRange(int first, int count) { _first = first; _count = count; }
+
+    virtual void run() {
+        _batch.clear();
+        recordDraws(_batch, _scene, _first, _count);
+        _finished.release();
+    }
+
+private:
+
+    const Scene& _scene;
+    QSemaphore& _finished;
+    Batch _batch;
+    int _first;
+    int _count;
+};
+
+enum Mode { FRESH, REUSED, PARALLEL, STATIC, MODE_COUNT };
+
+static const char* MODE_NAMES[] = { "fresh", "reused", "parallel", "static" };
+
+/// Times the recording and replaying of the given number of draws per frame in one of the modes.
+static void benchmark(QTextStream& out, Mode mode, const Scene& scene, int draws, int frames, int threads) {
+    QSemaphore finished;
+    QList<Recorder*> recorders;
+    for (int i = 0; i < threads; i++) {
+        recorders.append(new Recorder(scene, finished));
+    }
+    Batch reusedBatch;
+    Batch staticBatch;
+    recordDraws(staticBatch, scene, 0, draws);
+
+    NullBackend backend;
+    QElapsedTimer timer;
+    qint64 recordTime = 0;
+    qint64 replayTime = 0;
+    int allocations = 0;
+
+    // the first frames warm up the recycled storage and the thread pool
+    const int WARMUP_FRAMES = 3;
+    for (int frame = -WARMUP_FRAMES; frame < frames; frame++) {
+        int startAllocations = allocationCount.load();
+        timer.restart();
+        Batch* fresh = (mode == FRESH) ? new Batch() : NULL;
+        Batch& batch = fresh ? *fresh : reusedBatch;
+        batch.clear();
+        switch (mode) {
+            case FRESH:
+            case REUSED:
+                recordDraws(batch, scene, 0, draws);
+                break;
+
+            case PARALLEL:
+                for (int i = 0; i < threads; i++) {
+                    int first = draws * i / threads;
+                    recorders.at(i)->setRange(first, draws * (i + 1) / threads - first);
+                    QThreadPool::globalInstance()->start(recorders.at(i));
+                }
+                finished.acquire(threads);
+                for (int i = 0; i < threads; i++) {
+                    batch.runBatch(recorders.at(i)->getBatch());
+                }
+                break;
+
+            case STATIC:
+                batch.runBatch(staticBatch);
+                break;
+
+            default:
+                break;
+        }
+        qint64 frameRecordTime = timer.nsecsElapsed();
+
+        timer.restart();
+        backend.renderBatch(batch);
+        qint64 frameReplayTime = timer.nsecsElapsed();
+        delete fresh;
+
+        if (frame >= 0) {
+            recordTime += frameRecordTime;
+            replayTime += frameReplayTime;
+            allocations += allocationCount.load() - startAllocations;
+        }
+    }
+    qDeleteAll(recorders);
+
+    double commands = (double)draws * COMMANDS_PER_DRAW * frames;
+    out << MODE_NAMES[mode] << "\t" << draws << "\t" << (mode == PARALLEL ? threads : 1) << "\t" <<
+        recordTime / commands << "\t" << replayTime / commands << "\t" << allocations / (double)frames << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QStringList arguments = app.arguments().mid(1);
+    int draws = 10000;
+    int frames = 100;
+    int threads = QThread::idealThreadCount();
+    for (int i = 0; i + 1 < arguments.size(); i += 2) {
+        int value = arguments.at(i + 1).toInt();
+        if (arguments.at(i) == "--draws") {
+            draws = qMax(1, value);
+
+        } else if (arguments.at(i) == "--frames") {
+            frames = qMax(1, value);
+
+        } else if (arguments.at(i) == "--threads") {
+            threads = qMax(1, value);
+
+        } else {
+            out << "Usage: batch-bench [--draws count] [--frames count] [--threads count]\n";
+            return 1;
+        }
+    }
+    QThreadPool::globalInstance()->setMaxThreadCount(qMax(threads, QThreadPool::globalInstance()->maxThreadCount()));
+
+    Scene scene;
+    scene.vertices = BufferPointer(new Buffer());
+    scene.indices = BufferPointer(new Buffer());
+
+    out << "mode\tdraws\tthreads\trecord ns/cmd\treplay ns/cmd\tallocs/frame\n";
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+        benchmark(out, (Mode)mode, scene, draws, frames, threads);
+    }
+    return 0;
+}
@@ -0,0 +1,237 @@
+//
+//  ReferenceFBXParser.cpp
+//  tools/fbx-bench/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDataStream>
+#include <QtEndian>
+
+#include "ReferenceFBXParser.h"
+
+template<class T> static QVariant readBinaryArray(QDataStream& in, int& position) {
+    quint32 arrayLength;
+    quint32 encoding;
+    quint32 compressedLength;
+
+    in >> arrayLength;
+    in >> encoding;
+    in >> compressedLength;
+    position += sizeof(quint32) * 3;
+
+    QVector<T> values;
+    const unsigned int DEFLATE_ENCODING = 1;
+    if (encoding == DEFLATE_ENCODING) {
+        // preface encoded data with uncompressed length
+        QByteArray compressed(sizeof(quint32) + compressedLength, 0);
+        *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
+        in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
+        position += compressedLength;
+        QByteArray uncompressed = qUncompress(compressed);
+        QDataStream uncompressedIn(uncompressed);
+        uncompressedIn.setByteOrder(QDataStream::LittleEndian);
+        uncompressedIn.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
+        for (quint32 i = 0; i < arrayLength; i++) {
+            T value;
+            uncompressedIn >> value;
+            values.append(value);
+        }
+    } else {
+        for (quint32 i = 0; i < arrayLength; i++) {
+            T value;
+            in >> value;
+            position += sizeof(T);
+            values.append(value);
+        }
+    }
+    return QVariant::fromValue(values);
+}
+
+template<class T> static QVariant readBinaryValue(QDataStream& in, int& position) {
+    T value;
+    in >> value;
+    position += sizeof(T);
+    return QVariant::fromValue(value);
+}
+
+static QVariant parseBinaryFBXProperty(QDataStream& in, int& position) {
+    char ch;
+    in.device()->getChar(&ch);
+    position++;
+    switch (ch) {
+        case 'Y':
+            return readBinaryValue<qint16>(in, position);
+
+        case 'C':
+            return readBinaryValue<bool>(in, position);
+
+        case 'I':
+            return readBinaryValue<qint32>(in, position);
+
+        case 'F':
+            return readBinaryValue<float>(in, position);
+
+        case 'D':
+            return readBinaryValue<double>(in, position);
+
+        case 'L':
+            return readBinaryValue<qint64>(in, position);
+
+        case 'f':
+            return readBinaryArray<float>(in, position);
+
+        case 'd':
+            return readBinaryArray<double>(in, position);
+
+        case 'l':
+            return readBinaryArray<qint64>(in, position);
+
+        case 'i':
+            return readBinaryArray<qint32>(in, position);
+
+        case 'b':
+            return readBinaryArray<bool>(in, position);
+
+        case 'S':
+        case 'R': {
+            quint32 length;
+            in >> length;
+            position += sizeof(quint32) + length;
+            return QVariant::fromValue(in.device()->read(length));
+        }
+        default:
+            throw QString("Unknown property type: ") + ch;
+    }
+}
+
+static FBXNode parseBinaryFBXNode(QDataStream& in, int& position) {
+    qint32 endOffset;
+    quint32 propertyCount;
+    quint32 propertyListLength;
+    quint8 nameLength;
+
+    in >> endOffset;
+    in >> propertyCount;
+    in >> propertyListLength;
+    in >> nameLength;
+    position += sizeof(quint32) * 3 + sizeof(quint8);
+
+    FBXNode node;
+    const int MIN_VALID_OFFSET = 40;
+    if (endOffset < MIN_VALID_OFFSET || nameLength == 0) {
+        // use a null name to indicate a null node
+        return node;
+    }
+    node.name = in.device()->read(nameLength);
+    position += nameLength;
+
+    for (quint32 i = 0; i < propertyCount; i++) {
+        node.properties.append(parseBinaryFBXProperty(in, position));
+    }
+
+    while (endOffset > position) {
+        FBXNode child = parseBinaryFBXNode(in, position);
+        if (child.name.isNull()) {
+            return node;
+
+        } else {
+            node.children.append(child);
+        }
+    }
+
+    return node;
+}
+
+FBXNode parseReferenceFBX(const QByteArray& model) {
+    const QByteArray BINARY_PROLOG = "Kaydara FBX Binary  ";
+    if (!model.startsWith(BINARY_PROLOG)) {
+        throw QString("Not a binary FBX file.");
+    }
+    QDataStream in(model);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
+
+    // skip the rest of the header
+    const int HEADER_SIZE = 27;
+    in.skipRawData(HEADER_SIZE);
+    int position = HEADER_SIZE;
+
+    // parse the top-level node
+    FBXNode top;
+    while (in.device()->bytesAvailable()) {
+        FBXNode next = parseBinaryFBXNode(in, position);
+        if (next.name.isNull()) {
+            return top;
+
+        } else {
+            top.children.append(next);
+        }
+    }
+
+    return top;
+}
+
+template<class T> static bool arraysMatch(const QVariant& reference, const QVariant& parsed) {
+    return reference.value<QVector<T> >() == parsed.value<QVector<T> >();
+}
+
+/// Compares property values, including the array types that QVariant can't compare by value.
+static bool propertiesMatch(const QVariant& reference, const QVariant& parsed) {
+    if (reference.userType() != parsed.userType()) {
+        return false;
+    }
+    int type = reference.userType();
+    if (type == qMetaTypeId<QVector<float> >()) {
+        return arraysMatch<float>(reference, parsed);
+
+    } else if (type == qMetaTypeId<QVector<double> >()) {
+        return arraysMatch<double>(reference, parsed);
+
+    } else if (type == qMetaTypeId<QVector<qint64> >()) {
+        return arraysMatch<qint64>(reference, parsed);
+
+    } else if (type == qMetaTypeId<QVector<qint32> >()) {
+        return arraysMatch<qint32>(reference, parsed);
+
+    } else if (type == qMetaTypeId<QVector<bool> >()) {
+        return arraysMatch<bool>(reference, parsed);
+    }
+    return reference == parsed;
+}
+
+bool matchesReferenceFBX(const FBXNode& reference, const FBXNode& parsed, QString& difference) {
+    if (reference.name != parsed.name) {
+        difference = parsed.name;
+        return false;
+    }
+    if (reference.properties.size() != parsed.properties.size()) {
+        difference = parsed.name + " (property count)";
+        return false;
+    }
+    for (int i = 0; i < parsed.properties.size(); i++) {
+        if (!propertiesMatch(reference.properties.at(i), parsed.properties.at(i))) {
+            difference = parsed.name + QString(" (property %1)").arg(i);
+            return false;
+        }
+    }
+    int referenceIndex = 0;
+    foreach (const FBXNode& child, parsed.children) {
+        while (referenceIndex < reference.children.size() && reference.children.at(referenceIndex).name != child.name) {
+            referenceIndex++;
+        }
+        if (referenceIndex == reference.children.size()) {
+            difference = parsed.name + "/" + child.name + " (missing from reference)";
+            return false;
+        }
+        if (!matchesReferenceFBX(reference.children.at(referenceIndex++), child, difference)) {
+            difference = parsed.name + "/" + difference;
+            return false;
+        }
+    }
+    return true;
+}
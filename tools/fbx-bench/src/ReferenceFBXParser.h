@@ -0,0 +1,26 @@
+//
+//  ReferenceFBXParser.h
+//  tools/fbx-bench/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ReferenceFBXParser_h
+#define hifi_ReferenceFBXParser_h
+
+#include <FBXReader.h>
+
+/// Parses every record of a binary FBX document through QDataStream, the way FBXReader did before it parsed from memory.
+/// \exception QString if the document isn't binary
+FBXNode parseReferenceFBX(const QByteArray& model);
+
+/// Checks that each node of the parsed tree matches, in order, a node of the reference tree with the same properties and
+/// children.  Reference nodes that the parser skips are passed over.
+/// \param difference set to the path of the first node that differs
+bool matchesReferenceFBX(const FBXNode& reference, const FBXNode& parsed, QString& difference);
+
+#endif // hifi_ReferenceFBXParser_h
@@ -0,0 +1,175 @@
+//
+//  main.cpp
+//  tools/fbx-bench/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <AnimationClip.h>
+#include <BakedFBX.h>
+#include <GLMHelpers.h>
+#include <ResourceCache.h>
+
+#include "ReferenceFBXParser.h"
+
+static int countVertices(const FBXGeometry& geometry) {
+    int vertices = 0;
+    foreach (const FBXMesh& mesh, geometry.meshes) {
+        vertices += mesh.vertices.size();
+    }
+    return vertices;
+}
+
+static const double NSECS_PER_MSEC = 1000000.0;
+
+/// Receives a component of each sampled pose, so that the compiler can't discard the sampling being timed.
+static volatile float sampleSink;
+
+/// Compares the memory use, sampling speed, and accuracy of an animation's frames in raw form and as a compressed clip.
+static void benchmarkAnimation(QTextStream& out, const QString& name, const QVector<FBXAnimationFrame>& frames,
+        int iterations) {
+    QElapsedTimer timer;
+    timer.start();
+    AnimationClip clip(frames);
+    qint64 compressTime = timer.nsecsElapsed();
+    
+    int frameCount = frames.size();
+    int jointCount = clip.getJointCount();
+    qint64 rawSize = frameCount * (sizeof(FBXAnimationFrame) + jointCount * sizeof(glm::quat));
+    
+    // sample at fractional frame indices spread through the animation, the way AnimationHandle used to and now does
+    const int SAMPLES_PER_ITERATION = 1000;
+    const float SAMPLE_OFFSET = 0.37f;
+    QVector<glm::quat> rotations(qMax(jointCount, 1));
+    timer.restart();
+    for (int i = 0; i < iterations * SAMPLES_PER_ITERATION; i++) {
+        float frameIndex = (i % SAMPLES_PER_ITERATION) * frameCount / (float)SAMPLES_PER_ITERATION + SAMPLE_OFFSET;
+        const FBXAnimationFrame& floorFrame = frames.at((int)glm::floor(frameIndex) % frameCount);
+        const FBXAnimationFrame& ceilFrame = frames.at((int)glm::ceil(frameIndex) % frameCount);
+        float frameFraction = glm::fract(frameIndex);
+        for (int j = 0; j < jointCount; j++) {
+            rotations[j] = safeMix(floorFrame.rotations.at(j), ceilFrame.rotations.at(j), frameFraction);
+        }
+        sampleSink = rotations.at(0).w;
+    }
+    qint64 rawTime = timer.nsecsElapsed();
+    
+    timer.restart();
+    for (int i = 0; i < iterations * SAMPLES_PER_ITERATION; i++) {
+        float frameIndex = (i % SAMPLES_PER_ITERATION) * frameCount / (float)SAMPLES_PER_ITERATION + SAMPLE_OFFSET;
+        clip.sample(frameIndex, rotations.data());
+        sampleSink = rotations.at(0).w;
+    }
+    qint64 clipTime = timer.nsecsElapsed();
+    
+    // measure the largest difference from the original frames
+    float maxError = 0.0f;
+    for (int i = 0; i < frameCount; i++) {
+        clip.sample(i, rotations.data());
+        for (int j = 0; j < jointCount; j++) {
+            float dot = glm::abs(glm::dot(glm::normalize(frames.at(i).rotations.at(j)), rotations.at(j)));
+            maxError = qMax(maxError, 2.0f * acosf(qMin(dot, 1.0f)));
+        }
+    }
+    
+    double samples = (double)iterations * SAMPLES_PER_ITERATION * qMax(jointCount, 1);
+    out << name << "\t" << frameCount << "\t" << jointCount << "\t" << clip.getKeyCount() << "\t" <<
+        rawSize / 1024 << "\t" << clip.getMemoryUsage() / 1024 << "\t" << compressTime / NSECS_PER_MSEC << "\t" <<
+        rawTime / samples << "\t" << clipTime / samples << "\t" << glm::degrees(maxError) << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QStringList arguments = app.arguments().mid(1);
+    int iterations = 10;
+    int index = arguments.indexOf("--iterations");
+    if (index != -1 && index + 1 < arguments.size()) {
+        iterations = qMax(1, arguments.at(index + 1).toInt());
+        arguments.removeAt(index + 1);
+        arguments.removeAt(index);
+    }
+    if (arguments.isEmpty()) {
+        out << "Usage: fbx-bench [--iterations count] file.fbx [file.fbx ...]\n";
+        return 1;
+    }
+
+    // start from an empty cache so that the first load of each model is cold
+    QTemporaryDir directory;
+    ProcessedResourceCache::getInstance().setDirectory(directory.path());
+
+    out << "model\tmeshes\tvertices\tparse ms\tcold ms\twarm ms\tbaked KB\n";
+    QList<QPair<QString, QVector<FBXAnimationFrame> > > animations;
+    foreach (const QString& path, arguments) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            out << path << "\tcannot open: " << file.errorString() << "\n";
+            continue;
+        }
+        QByteArray model = file.readAll();
+        QVariantHash mapping;
+        try {
+            QElapsedTimer timer;
+            timer.start();
+            FBXGeometry parsed = readFBX(model, mapping);
+            qint64 parseTime = timer.nsecsElapsed();
+
+            timer.restart();
+            readFBXCached(model, mapping);
+            qint64 coldTime = timer.nsecsElapsed();
+
+            qint64 warmTime = 0;
+            FBXGeometry baked;
+            for (int i = 0; i < iterations; i++) {
+                timer.restart();
+                baked = readFBXCached(model, mapping);
+                warmTime += timer.nsecsElapsed();
+            }
+            // binary records must parse the same as they did through QDataStream
+            if (model.startsWith("Kaydara FBX Binary  ")) {
+                QBuffer buffer(&model);
+                buffer.open(QIODevice::ReadOnly);
+                QString difference;
+                if (!matchesReferenceFBX(parseReferenceFBX(model), parseFBX(&buffer), difference)) {
+                    out << path << "\tparsed records differ from reference parser at " << difference << "\n";
+                    continue;
+                }
+            }
+            if (baked.meshes.size() != parsed.meshes.size() || countVertices(baked) != countVertices(parsed) ||
+                    baked.joints.size() != parsed.joints.size()) {
+                out << path << "\tbaked geometry differs from parsed geometry\n";
+                continue;
+            }
+            if (!parsed.animationFrames.isEmpty()) {
+                animations.append(qMakePair(QFileInfo(path).fileName(), parsed.animationFrames));
+            }
+            out << QFileInfo(path).fileName() << "\t" << parsed.meshes.size() << "\t" << countVertices(parsed) << "\t" <<
+                parseTime / NSECS_PER_MSEC << "\t" << coldTime / NSECS_PER_MSEC << "\t" <<
+                warmTime / (iterations * NSECS_PER_MSEC) << "\t" << bakeFBX(parsed).size() / 1024 << "\n";
+
+        } catch (const QString& error) {
+            out << path << "\terror: " << error << "\n";
+        }
+    }
+    if (!animations.isEmpty()) {
+        out << "\nanimation\tframes\tjoints\tkeys\traw KB\tclip KB\tcompress ms\tslerp ns/joint\tclip ns/joint\t" <<
+            "max error deg\n";
+        for (int i = 0; i < animations.size(); i++) {
+            benchmarkAnimation(out, animations.at(i).first, animations.at(i).second, iterations);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,528 @@
+//
+//  LoadTester.cpp
+//  tools/mixer-loadtest/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <iostream>
+
+#include <QDataStream>
+#include <QFile>
+#include <QJsonDocument>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <AddressManager.h>
+#include <AudioConstants.h>
+#include <AudioInjector.h>
+#include <AudioInjectorScheduler.h>
+#include <HifiConfigVariantMap.h>
+#include <LogUtils.h>
+#include <NetworkAccessManager.h>
+#include <NodeList.h>
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+#include <UUID.h>
+
+#include "LoadTester.h"
+
+const QString DEFAULT_DOMAIN_HOSTNAME = "localhost";
+const int DEFAULT_NUM_SYNTHETIC_AVATARS = 50;
+const int AVATAR_DATA_SEND_INTERVAL_MSECS = 1000 / 60;
+const int REPORT_INTERVAL_MSECS = 1000;
+
+// the gap stats keep one sample per packet, windowed over roughly the last ten seconds of audio frames
+const int GAP_STATS_INTERVAL_SAMPLES = 100;
+const int GAP_STATS_WINDOW_INTERVALS = 10;
+
+const float MIN_WALK_RADIUS = 2.0f;
+const float MAX_WALK_RADIUS = 30.0f;
+const float MIN_ANGULAR_SPEED = 0.05f; // radians per second
+const float MAX_ANGULAR_SPEED = 0.5f;
+
+// talk spurts and pauses are drawn uniformly between these lengths, roughly matching conversational speech
+const float MIN_SPURT_SECONDS = 0.5f;
+const float MAX_SPURT_SECONDS = 3.0f;
+const float VOICE_SECONDS = 4.0f;
+
+MixerStreamStats::MixerStreamStats() :
+    sequenceStats(),
+    gapStats(GAP_STATS_INTERVAL_SAMPLES, GAP_STATS_WINDOW_INTERVALS),
+    lastPacketUsecs(0),
+    totalPackets(0),
+    totalBytes(0),
+    intervalPackets(0),
+    intervalBytes(0)
+{
+}
+
+void MixerStreamStats::packetReceived(int packetSize) {
+    quint64 now = usecTimestampNow();
+    if (lastPacketUsecs != 0) {
+        gapStats.update(now - lastPacketUsecs);
+    }
+    lastPacketUsecs = now;
+
+    totalPackets++;
+    totalBytes += packetSize;
+    intervalPackets++;
+    intervalBytes += packetSize;
+}
+
+QJsonObject MixerStreamStats::toJSONObject(float intervalSeconds) {
+    QJsonObject statsObject;
+    statsObject["packets_per_second"] = intervalPackets / intervalSeconds;
+    statsObject["bytes_per_second"] = intervalBytes / intervalSeconds;
+    statsObject["total_packets"] = (double)totalPackets;
+    statsObject["total_bytes"] = (double)totalBytes;
+    statsObject["gap_usecs_min"] = (double)gapStats.getWindowMin();
+    statsObject["gap_usecs_max"] = (double)gapStats.getWindowMax();
+    statsObject["gap_usecs_avg"] = gapStats.getWindowAverage();
+
+    if (sequenceStats.getReceived() > 0) {
+        statsObject["lost"] = (double)sequenceStats.getLost();
+        statsObject["lost_rate"] = sequenceStats.getStats().getLostRate();
+        statsObject["out_of_order"] = (double)sequenceStats.getOutOfOrder();
+    }
+
+    intervalPackets = 0;
+    intervalBytes = 0;
+    return statsObject;
+}
+
+LoadTester::LoadTester(int& argc, char** argv) :
+    QCoreApplication(argc, argv),
+    _domainHostname(DEFAULT_DOMAIN_HOSTNAME),
+    _sendAudio(true),
+    _observerAudioSequence(0),
+    _nextAudioFrameUsecs(0),
+    _receivedAvatarEntries(0),
+    _intervalAvatarEntries(0)
+{
+    LogUtils::init();
+    setApplicationName("mixer-loadtest");
+
+    // we are a regular agent as far as the domain is concerned
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<AddressManager>();
+    auto nodeList = DependencyManager::set<NodeList>(NodeType::Agent);
+
+    const QVariantMap argumentVariantMap = HifiConfigVariantMap::mergeCLParametersWithJSONConfig(arguments());
+
+    const QString NUM_AVATARS_OPTION = "avatars";
+    const QString DOMAIN_OPTION = "domain";
+    const QString DURATION_OPTION = "duration";
+    const QString OUTPUT_OPTION = "output";
+    const QString NO_AUDIO_OPTION = "no-audio";
+
+    int numAvatars = argumentVariantMap.value(NUM_AVATARS_OPTION, DEFAULT_NUM_SYNTHETIC_AVATARS).toInt();
+    if (argumentVariantMap.contains(DOMAIN_OPTION)) {
+        _domainHostname = argumentVariantMap.value(DOMAIN_OPTION).toString();
+    }
+    _outputFilename = argumentVariantMap.value(OUTPUT_OPTION).toString();
+    _sendAudio = !argumentVariantMap.contains(NO_AUDIO_OPTION);
+
+    nodeList->addSetOfNodeTypesToNodeInterestSet(NodeSet() << NodeType::AvatarMixer << NodeType::AudioMixer);
+    nodeList->getDomainHandler().setHostnameAndPort(_domainHostname);
+
+    connect(&nodeList->getNodeSocket(), &QUdpSocket::readyRead, this, &LoadTester::readPendingDatagrams);
+
+    QTimer* domainServerTimer = new QTimer(this);
+    connect(domainServerTimer, &QTimer::timeout, this, &LoadTester::checkInWithDomainServer);
+    domainServerTimer->start(DOMAIN_SERVER_CHECK_IN_MSECS);
+
+    QTimer* silentNodeRemovalTimer = new QTimer(this);
+    connect(silentNodeRemovalTimer, SIGNAL(timeout()), nodeList.data(), SLOT(removeSilentNodes()));
+    silentNodeRemovalTimer->start(NODE_SILENCE_THRESHOLD_MSECS);
+
+    _observer.setDisplayName("mixer-loadtest observer");
+    _observer.setFaceModelURL(QUrl());
+    _observer.setSkeletonModelURL(QUrl());
+
+    createSyntheticAvatars(numAvatars);
+    if (_sendAudio) {
+        generateVoice();
+    }
+
+    QTimer* avatarDataTimer = new QTimer(this);
+    connect(avatarDataTimer, &QTimer::timeout, this, &LoadTester::sendAvatarData);
+    avatarDataTimer->start(AVATAR_DATA_SEND_INTERVAL_MSECS);
+
+    QTimer* identityTimer = new QTimer(this);
+    connect(identityTimer, &QTimer::timeout, this, &LoadTester::sendAvatarIdentities);
+    identityTimer->start(AVATAR_IDENTITY_PACKET_SEND_INTERVAL_MSECS);
+
+    // audio frames are scheduled against the wall clock in sendAudio, the timer only needs to fire often enough
+    QTimer* audioTimer = new QTimer(this);
+    audioTimer->setTimerType(Qt::PreciseTimer);
+    connect(audioTimer, &QTimer::timeout, this, &LoadTester::sendAudio);
+    audioTimer->start(AudioConstants::NETWORK_FRAME_MSECS / 2);
+
+    QTimer* reportTimer = new QTimer(this);
+    connect(reportTimer, &QTimer::timeout, this, &LoadTester::sendReport);
+    reportTimer->start(REPORT_INTERVAL_MSECS);
+
+    if (argumentVariantMap.contains(DURATION_OPTION)) {
+        QTimer::singleShot(argumentVariantMap.value(DURATION_OPTION).toInt() * MSECS_PER_SECOND, this, SLOT(finish()));
+    }
+
+    _runTimer.start();
+    _intervalTimer.start();
+
+    qDebug() << "Driving" << numAvatars << "synthetic avatars through the mixers of" << _domainHostname;
+}
+
+void LoadTester::createSyntheticAvatars(int numAvatars) {
+    _syntheticAvatars.resize(numAvatars);
+
+    for (int i = 0; i < numAvatars; i++) {
+        SyntheticAvatar& synthetic = _syntheticAvatars[i];
+        synthetic.uuid = QUuid::createUuid();
+        synthetic.avatar = QSharedPointer<AvatarData>(new AvatarData());
+        synthetic.avatar->setSessionUUID(synthetic.uuid);
+        synthetic.avatar->setDisplayName(QString("loadtest %1").arg(i));
+        synthetic.avatar->setFaceModelURL(QUrl());
+        synthetic.avatar->setSkeletonModelURL(QUrl());
+        synthetic.avatar->setForceFaceshiftConnected(true);
+
+        synthetic.angle = randFloatInRange(0.0f, TWO_PI);
+        synthetic.angularSpeed = randFloatInRange(MIN_ANGULAR_SPEED, MAX_ANGULAR_SPEED);
+        synthetic.radius = randFloatInRange(MIN_WALK_RADIUS, MAX_WALK_RADIUS);
+        synthetic.headPhase = randFloatInRange(0.0f, TWO_PI);
+
+        // stagger the talk spurts so the avatars do not all start talking together
+        synthetic.isTalking = randFloat() < 0.5f;
+        synthetic.spurtFramesRemaining = randFloatInRange(MIN_SPURT_SECONDS, MAX_SPURT_SECONDS)
+            * USECS_PER_SECOND / AudioConstants::NETWORK_FRAME_USECS;
+    }
+}
+
+void LoadTester::generateVoice() {
+    // a voiced buzz with a wandering pitch, shaped by a couple of formants and a syllable envelope -
+    // close enough to speech for the mixer's loudness and attenuation paths, and cheap to share across avatars
+    const int numSamples = VOICE_SECONDS * AudioConstants::SAMPLE_RATE;
+    const float BASE_PITCH = 140.0f;
+    const float PITCH_VARIATION = 30.0f;
+    const float SYLLABLES_PER_SECOND = 4.0f;
+    const int NUM_HARMONICS = 20;
+    const float FORMANTS[] = { 700.0f, 1200.0f };
+    const float FORMANT_WIDTH = 250.0f;
+    const float PEAK_AMPLITUDE = 0.3f * AudioConstants::MAX_SAMPLE_VALUE;
+
+    _voice.resize(numSamples);
+    float phase = 0.0f;
+    for (int i = 0; i < numSamples; i++) {
+        float t = (float)i / AudioConstants::SAMPLE_RATE;
+        float pitch = BASE_PITCH + PITCH_VARIATION * sinf(TWO_PI * 0.7f * t);
+        phase += TWO_PI * pitch / AudioConstants::SAMPLE_RATE;
+
+        float sample = 0.0f;
+        for (int harmonic = 1; harmonic <= NUM_HARMONICS; harmonic++) {
+            float frequency = pitch * harmonic;
+            float gain = 0.0f;
+            for (unsigned int j = 0; j < sizeof(FORMANTS) / sizeof(FORMANTS[0]); j++) {
+                float distance = (frequency - FORMANTS[j]) / FORMANT_WIDTH;
+                gain += expf(-distance * distance);
+            }
+            sample += gain * sinf(phase * harmonic) / harmonic;
+        }
+        float envelope = powf(fabsf(sinf(PI * SYLLABLES_PER_SECOND * t)), 0.5f);
+        _voice[i] = (qint16)glm::clamp(PEAK_AMPLITUDE * envelope * sample,
+                                       (float)AudioConstants::MIN_SAMPLE_VALUE, (float)AudioConstants::MAX_SAMPLE_VALUE);
+    }
+}
+
+void LoadTester::checkInWithDomainServer() {
+    DependencyManager::get<NodeList>()->sendDomainServerCheckIn();
+}
+
+void LoadTester::readPendingDatagrams() {
+    auto nodeList = DependencyManager::get<NodeList>();
+    QUdpSocket& nodeSocket = nodeList->getNodeSocket();
+
+    QByteArray receivedPacket;
+    HifiSockAddr senderSockAddr;
+
+    while (nodeSocket.hasPendingDatagrams()) {
+        receivedPacket.resize(nodeSocket.pendingDatagramSize());
+        nodeSocket.readDatagram(receivedPacket.data(), receivedPacket.size(),
+                                senderSockAddr.getAddressPointer(), senderSockAddr.getPortPointer());
+
+        if (!nodeList->packetVersionAndHashMatch(receivedPacket)) {
+            continue;
+        }
+
+        PacketType packetType = packetTypeForPacket(receivedPacket);
+        if (packetType == PacketTypeBulkAvatarData) {
+            _avatarMixerStats.packetReceived(receivedPacket.size());
+            parseBulkAvatarData(receivedPacket);
+
+        } else if (packetType == PacketTypeMixedAudio || packetType == PacketTypeSilentAudioFrame) {
+            _audioMixerStats.packetReceived(receivedPacket.size());
+
+            quint16 sequence = *reinterpret_cast<const quint16*>(receivedPacket.constData()
+                                                                 + numBytesForPacketHeader(receivedPacket));
+            SharedNodePointer audioMixer = nodeList->sendingNodeForPacket(receivedPacket);
+            _audioMixerStats.sequenceStats.sequenceNumberReceived(sequence,
+                                                                  audioMixer ? audioMixer->getUUID() : QUuid());
+        }
+
+        // let everything continue through to the NodeList so it handles the domain list
+        // and updates last heard timestamps for the mixers
+        nodeList->processNodeData(senderSockAddr, receivedPacket);
+    }
+}
+
+void LoadTester::parseBulkAvatarData(const QByteArray& packet) {
+    int bytesRead = numBytesForPacketHeader(packet);
+
+    while (bytesRead < packet.size()) {
+        QUuid sessionUUID = QUuid::fromRfc4122(packet.mid(bytesRead, NUM_BYTES_RFC4122_UUID));
+        bytesRead += NUM_BYTES_RFC4122_UUID;
+
+        int bytesParsed = _parsedAvatar.parseDataAtOffset(packet, bytesRead);
+        if (bytesParsed <= 0) {
+            break;
+        }
+        bytesRead += bytesParsed;
+
+        _receivedAvatarUUIDs.insert(sessionUUID);
+        _receivedAvatarEntries++;
+        _intervalAvatarEntries++;
+    }
+}
+
+void LoadTester::sendAvatarData() {
+    auto nodeList = DependencyManager::get<NodeList>();
+    const float deltaTime = AVATAR_DATA_SEND_INTERVAL_MSECS / (float)MSECS_PER_SECOND;
+    const float HEAD_YAW_RANGE = 45.0f;
+    const float HEAD_PITCH_RANGE = 15.0f;
+    float seconds = _runTimer.elapsed() / (float)MSECS_PER_SECOND;
+
+    // the observer stands still in the middle of the crowd, it is the node the mixers send back to
+    QByteArray avatarPacket = byteArrayWithPopulatedHeader(PacketTypeAvatarData);
+    avatarPacket.append(_observer.toByteArray());
+    nodeList->broadcastToNodes(avatarPacket, NodeSet() << NodeType::AvatarMixer);
+
+    // pack as many synthetic avatars as fit in each hosted avatar packet
+    QByteArray hostedAvatarPacket = byteArrayWithPopulatedHeader(PacketTypeHostedAvatarData);
+    int numPacketHeaderBytes = hostedAvatarPacket.size();
+
+    for (int i = 0; i < _syntheticAvatars.size(); i++) {
+        SyntheticAvatar& synthetic = _syntheticAvatars[i];
+        synthetic.angle += synthetic.angularSpeed * deltaTime;
+
+        AvatarData* avatar = synthetic.avatar.data();
+        avatar->setPosition(glm::vec3(synthetic.radius * cosf(synthetic.angle), 0.0f,
+                                      synthetic.radius * sinf(synthetic.angle)));
+        avatar->setOrientation(glm::quat(glm::vec3(0.0f, -synthetic.angle, 0.0f)));
+
+        // head data is allocated lazily by the first toByteArray
+        if (avatar->getHeadData()) {
+            avatar->setHeadYaw(HEAD_YAW_RANGE * sinf(seconds + synthetic.headPhase));
+            avatar->setHeadPitch(HEAD_PITCH_RANGE * sinf(0.5f * seconds + synthetic.headPhase));
+        }
+
+        QByteArray avatarByteArray = synthetic.uuid.toRfc4122();
+        avatarByteArray.append(avatar->toByteArray());
+
+        if (hostedAvatarPacket.size() + avatarByteArray.size() > MAX_PACKET_SIZE) {
+            nodeList->broadcastToNodes(hostedAvatarPacket, NodeSet() << NodeType::AvatarMixer);
+            hostedAvatarPacket.resize(numPacketHeaderBytes);
+        }
+        hostedAvatarPacket.append(avatarByteArray);
+    }
+    if (hostedAvatarPacket.size() > numPacketHeaderBytes) {
+        nodeList->broadcastToNodes(hostedAvatarPacket, NodeSet() << NodeType::AvatarMixer);
+    }
+}
+
+void LoadTester::sendAvatarIdentities() {
+    auto nodeList = DependencyManager::get<NodeList>();
+
+    QByteArray observerIdentityPacket = byteArrayWithPopulatedHeader(PacketTypeAvatarIdentity);
+    observerIdentityPacket.append(_observer.identityByteArray());
+    nodeList->broadcastToNodes(observerIdentityPacket, NodeSet() << NodeType::AvatarMixer);
+
+    foreach (const SyntheticAvatar& synthetic, _syntheticAvatars) {
+        // the mixer tells hosted avatars apart by the UUID at the start of the identity
+        QByteArray identityPacket = byteArrayWithPopulatedHeader(PacketTypeAvatarIdentity);
+        QByteArray individualData = synthetic.avatar->identityByteArray();
+        individualData.replace(0, NUM_BYTES_RFC4122_UUID, synthetic.uuid.toRfc4122());
+        identityPacket.append(individualData);
+        nodeList->broadcastToNodes(identityPacket, NodeSet() << NodeType::AvatarMixer);
+    }
+}
+
+void LoadTester::sendAudio() {
+    qint64 now = usecTimestampNow();
+    if (_nextAudioFrameUsecs == 0) {
+        _nextAudioFrameUsecs = now;
+    }
+
+    // catch up on any frames we are late for so the mixer sees a steady frame rate
+    while (_nextAudioFrameUsecs <= now) {
+        sendAudioFrame();
+        _nextAudioFrameUsecs += AudioConstants::NETWORK_FRAME_USECS;
+    }
+}
+
+void LoadTester::sendAudioFrame() {
+    auto nodeList = DependencyManager::get<NodeList>();
+    SharedNodePointer audioMixer = nodeList->soloNodeOfType(NodeType::AudioMixer);
+    if (!audioMixer || !audioMixer->getActiveSocket()) {
+        return;
+    }
+
+    // the observer sends silent frames, which is enough for the mixer to start sending it mixes
+    QByteArray silentPacket = byteArrayWithPopulatedHeader(PacketTypeSilentAudioFrame);
+    QDataStream silentStream(&silentPacket, QIODevice::Append);
+    silentStream << _observerAudioSequence++;
+    const int16_t numSilentSamples = AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL;
+    silentStream.writeRawData(reinterpret_cast<const char*>(&numSilentSamples), sizeof(int16_t));
+    silentStream.writeRawData(reinterpret_cast<const char*>(&_observer.getPosition()), sizeof(glm::vec3));
+    glm::quat observerOrientation = _observer.getOrientation();
+    silentStream.writeRawData(reinterpret_cast<const char*>(&observerOrientation), sizeof(glm::quat));
+    nodeList->writeDatagram(silentPacket, audioMixer);
+
+    if (!_sendAudio) {
+        return;
+    }
+
+    for (int i = 0; i < _syntheticAvatars.size(); i++) {
+        SyntheticAvatar& synthetic = _syntheticAvatars[i];
+        if (--synthetic.spurtFramesRemaining <= 0) {
+            synthetic.isTalking = !synthetic.isTalking;
+            synthetic.spurtFramesRemaining = randFloatInRange(MIN_SPURT_SECONDS, MAX_SPURT_SECONDS)
+                * USECS_PER_SECOND / AudioConstants::NETWORK_FRAME_USECS;
+            if (synthetic.isTalking) {
+                startTalking(synthetic, synthetic.spurtFramesRemaining);
+            }
+        }
+    }
+}
+
+void LoadTester::startTalking(SyntheticAvatar& synthetic, int numFrames) {
+    // each spurt starts somewhere else in the shared voice so the avatars don't sound in unison
+    const int numFrameSamples = AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL;
+    const int framesPerVoice = _voice.size() / numFrameSamples;
+    int voiceFrame = rand() % framesPerVoice;
+    QByteArray spurt;
+    spurt.reserve(numFrames * AudioConstants::NETWORK_FRAME_BYTES_PER_CHANNEL);
+    for (int i = 0; i < numFrames; i++) {
+        spurt.append(reinterpret_cast<const char*>(_voice.constData() + voiceFrame * numFrameSamples),
+                     AudioConstants::NETWORK_FRAME_BYTES_PER_CHANNEL);
+        voiceFrame = (voiceFrame + 1) % framesPerVoice;
+    }
+
+    // the voice is sent from where the avatar was when the spurt began, the injector can't follow it while sending
+    AudioInjectorOptions options;
+    options.position = synthetic.avatar->getPosition();
+    options.orientation = synthetic.avatar->getOrientation();
+
+    AudioInjector* injector = new AudioInjector(spurt, options);
+    connect(injector, &AudioInjector::finished, injector, &AudioInjector::deleteLater);
+    AudioInjectorScheduler::getInstance().start(injector);
+}
+
+void LoadTester::requestMixerStats(NodeType_t mixerType) {
+    SharedNodePointer mixer = DependencyManager::get<NodeList>()->soloNodeOfType(mixerType);
+    if (!mixer) {
+        return;
+    }
+
+    // the domain-server keeps the last stats packet each assignment sent it
+    QUrl statsURL;
+    statsURL.setScheme("http");
+    statsURL.setHost(_domainHostname);
+    statsURL.setPort(DOMAIN_SERVER_HTTP_PORT);
+    statsURL.setPath(QString("/nodes/%1.json").arg(uuidStringWithoutCurlyBraces(mixer->getUUID())));
+
+    QNetworkReply* reply = NetworkAccessManager::getInstance().get(QNetworkRequest(statsURL));
+    reply->setProperty("mixerType", NodeType::getNodeTypeName(mixerType).toLower().replace(' ', '_'));
+    connect(reply, &QNetworkReply::finished, this, &LoadTester::handleMixerStatsReply);
+}
+
+void LoadTester::handleMixerStatsReply() {
+    QNetworkReply* reply = static_cast<QNetworkReply*>(sender());
+    if (reply->error() == QNetworkReply::NoError) {
+        QJsonDocument statsDocument = QJsonDocument::fromJson(reply->readAll());
+        _mixerStats[reply->property("mixerType").toString()] = statsDocument.object();
+    }
+    reply->deleteLater();
+}
+
+QJsonObject LoadTester::buildReport() {
+    float intervalSeconds = _intervalTimer.restart() / (float)MSECS_PER_SECOND;
+
+    QJsonObject report;
+    report["elapsed_seconds"] = _runTimer.elapsed() / (float)MSECS_PER_SECOND;
+    report["synthetic_avatars"] = _syntheticAvatars.size();
+
+    QJsonObject avatarMixerObject = _avatarMixerStats.toJSONObject(intervalSeconds);
+    avatarMixerObject["avatars_per_second"] = _intervalAvatarEntries / intervalSeconds;
+    avatarMixerObject["total_avatar_entries"] = (double)_receivedAvatarEntries;
+    avatarMixerObject["unique_avatars_seen"] = _receivedAvatarUUIDs.size();
+    _intervalAvatarEntries = 0;
+    report["avatar_mixer"] = avatarMixerObject;
+
+    report["audio_mixer"] = _audioMixerStats.toJSONObject(intervalSeconds);
+    report["mixer_stats"] = _mixerStats;
+
+    return report;
+}
+
+void LoadTester::sendReport() {
+    _lastReport = buildReport();
+    std::cout << QJsonDocument(_lastReport).toJson(QJsonDocument::Compact).constData() << std::endl;
+
+    requestMixerStats(NodeType::AvatarMixer);
+    requestMixerStats(NodeType::AudioMixer);
+}
+
+void LoadTester::finish() {
+    QJsonObject summary = buildReport();
+
+    // over the whole run, rates are only meaningful as totals divided by the run time
+    float runSeconds = _runTimer.elapsed() / (float)MSECS_PER_SECOND;
+    QJsonObject avatarMixerObject = summary["avatar_mixer"].toObject();
+    avatarMixerObject["packets_per_second"] = _avatarMixerStats.totalPackets / runSeconds;
+    avatarMixerObject["bytes_per_second"] = _avatarMixerStats.totalBytes / runSeconds;
+    avatarMixerObject["avatars_per_second"] = _receivedAvatarEntries / runSeconds;
+    summary["avatar_mixer"] = avatarMixerObject;
+
+    QJsonObject audioMixerObject = summary["audio_mixer"].toObject();
+    audioMixerObject["packets_per_second"] = _audioMixerStats.totalPackets / runSeconds;
+    audioMixerObject["bytes_per_second"] = _audioMixerStats.totalBytes / runSeconds;
+    summary["audio_mixer"] = audioMixerObject;
+
+    QByteArray summaryJSON = QJsonDocument(summary).toJson();
+    if (_outputFilename.isEmpty()) {
+        std::cout << summaryJSON.constData() << std::endl;
+    } else {
+        QFile outputFile(_outputFilename);
+        if (outputFile.open(QIODevice::WriteOnly)) {
+            outputFile.write(summaryJSON);
+        } else {
+            qDebug() << "Failed to write the summary to" << _outputFilename << "-" << outputFile.errorString();
+        }
+    }
+
+    // tell the avatar mixer to drop our synthetic avatars right away instead of waiting for them to time out
+    auto nodeList = DependencyManager::get<NodeList>();
+    foreach (const SyntheticAvatar& synthetic, _syntheticAvatars) {
+        QByteArray killPacket = byteArrayWithPopulatedHeader(PacketTypeKillAvatar);
+        killPacket += synthetic.uuid.toRfc4122();
+        nodeList->broadcastToNodes(killPacket, NodeSet() << NodeType::AvatarMixer);
+    }
+
+    quit();
+}
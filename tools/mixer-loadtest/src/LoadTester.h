@@ -0,0 +1,112 @@
+//
+//  LoadTester.h
+//  tools/mixer-loadtest/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_LoadTester_h
+#define hifi_LoadTester_h
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QUuid>
+#include <QVector>
+
+#include <AvatarData.h>
+#include <MovingMinMaxAvg.h>
+#include <Node.h>
+#include <SequenceNumberStats.h>
+
+/// One avatar driven by the load tester, sent to the avatar mixer as a hosted avatar.
+class SyntheticAvatar {
+public:
+    QUuid uuid;
+    QSharedPointer<AvatarData> avatar;
+
+    float angle;
+    float angularSpeed;
+    float radius;
+    float headPhase;
+
+    // talk spurt state, each spurt is injected by its own AudioInjector
+    bool isTalking;
+    int spurtFramesRemaining;
+};
+
+/// Receive side statistics for the packets coming back from one mixer.
+class MixerStreamStats {
+public:
+    MixerStreamStats();
+
+    void packetReceived(int packetSize);
+    QJsonObject toJSONObject(float intervalSeconds);
+
+    SequenceNumberStats sequenceStats;
+    MovingMinMaxAvg<quint64> gapStats;
+
+    quint64 lastPacketUsecs;
+    quint64 totalPackets;
+    quint64 totalBytes;
+    int intervalPackets;
+    int intervalBytes;
+};
+
+/// Headless client that joins a domain, drives a configurable number of synthetic avatars through the avatar and
+/// audio mixers and reports what comes back, so mixer changes can be measured under a repeatable load.
+class LoadTester : public QCoreApplication {
+    Q_OBJECT
+public:
+    LoadTester(int& argc, char** argv);
+
+private slots:
+    void checkInWithDomainServer();
+    void readPendingDatagrams();
+    void sendAvatarData();
+    void sendAvatarIdentities();
+    void sendAudio();
+    void sendReport();
+    void handleMixerStatsReply();
+    void finish();
+
+private:
+    void createSyntheticAvatars(int numAvatars);
+    void generateVoice();
+    void sendAudioFrame();
+    void startTalking(SyntheticAvatar& synthetic, int numFrames);
+    void requestMixerStats(NodeType_t mixerType);
+    void parseBulkAvatarData(const QByteArray& packet);
+    QJsonObject buildReport();
+
+    QString _domainHostname;
+    QString _outputFilename;
+    bool _sendAudio;
+
+    AvatarData _observer;
+    QVector<SyntheticAvatar> _syntheticAvatars;
+    AvatarData _parsedAvatar; // scratch target for bulk avatar data coming back from the mixer
+
+    QVector<qint16> _voice;
+    quint16 _observerAudioSequence;
+    qint64 _nextAudioFrameUsecs;
+
+    MixerStreamStats _avatarMixerStats;
+    MixerStreamStats _audioMixerStats;
+    QSet<QUuid> _receivedAvatarUUIDs;
+    quint64 _receivedAvatarEntries;
+    int _intervalAvatarEntries;
+    QJsonObject _mixerStats;
+
+    QElapsedTimer _runTimer;
+    QElapsedTimer _intervalTimer;
+    QJsonObject _lastReport;
+};
+
+#endif // hifi_LoadTester_h
@@ -0,0 +1,17 @@
+//
+//  main.cpp
+//  tools/mixer-loadtest/src
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "LoadTester.h"
+
+int main(int argc, char* argv[]) {
+    LoadTester loadTester(argc, argv);
+    return loadTester.exec();
+}